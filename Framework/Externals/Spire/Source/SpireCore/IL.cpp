@@ -417,7 +417,7 @@ namespace Spire
             return tailInstr;
         }
 
-        int NamingCounter = 0;
+        thread_local int NamingCounter = 0;
 
         void CFGNode::NameAllInstructions()
         {
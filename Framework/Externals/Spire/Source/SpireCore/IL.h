@@ -22,7 +22,7 @@ namespace Spire
         };
         int SizeofBaseType(ILBaseType type);
         int RoundToAlignment(int offset, int alignment);
-        extern int NamingCounter;
+        extern thread_local int NamingCounter;
 
         enum class BindableResourceType
         {
@@ -3,8 +3,10 @@
 
 #include "Diagnostics.h"
 #include "Lexer.h"
+#include "../CoreLib/LibIO.h"
 
 #include <assert.h>
+#include <sys/stat.h>
 
 using namespace CoreLib;
 using namespace CoreLib::Text;
@@ -95,8 +97,8 @@ struct PreprocessorInputStream
 
 struct SourceTextInputStream : PreprocessorInputStream
 {
-    // The pre-tokenized input
-    TokenList           lexedTokens;
+    // The pre-tokenized input, which may be shared with other preprocessors
+    RefPtr<LexedSourceFile> file;
 };
 
 struct MacroExpansion : PreprocessorInputStream
@@ -164,6 +166,10 @@ struct Preprocessor
     // Currently-defined macros
     PreprocessorEnvironment                 globalEnv;
 
+    // Paths of all the files that have been read so far, used to
+    // honor `#pragma once`
+    HashSet<String>                         includedFiles;
+
     // A pre-allocated token that can be returned to
     // represent end-of-input situations.
     Token                                   endOfFileToken;
@@ -201,20 +207,26 @@ static void DestroyInputStream(Preprocessor* /*preprocessor*/, PreprocessorInput
 }
 
 // Create an input stream to represent a pre-tokenized input file.
-// TODO(tfoley): pre-tokenizing files isn't going to work in the long run.
-static PreprocessorInputStream* CreateInputStreamForSource(Preprocessor* preprocessor, CoreLib::String const& source, CoreLib::String const& fileName)
+static PreprocessorInputStream* CreateInputStreamForFile(Preprocessor* preprocessor, RefPtr<LexedSourceFile> file)
 {
     SourceTextInputStream* inputStream = new SourceTextInputStream();
     InitializeInputStream(preprocessor, inputStream);
 
-    // Use existing `Lexer` to generate a token stream.
-    Lexer lexer;
-    inputStream->lexedTokens = lexer.Parse(fileName, source, GetSink(preprocessor));
-    inputStream->tokenReader = TokenReader(inputStream->lexedTokens);
+    inputStream->file = file;
+    inputStream->tokenReader = TokenReader(file->tokens);
+
+    preprocessor->includedFiles.Add(file->path);
 
     return inputStream;
 }
 
+// Create an input stream for a source file that hasn't been lexed yet.
+// TODO(tfoley): pre-tokenizing files isn't going to work in the long run.
+static PreprocessorInputStream* CreateInputStreamForSource(Preprocessor* preprocessor, CoreLib::String const& source, CoreLib::String const& fileName)
+{
+    return CreateInputStreamForFile(preprocessor, LexSourceFile(source, fileName, GetSink(preprocessor)));
+}
+
 
 
 static void PushInputStream(Preprocessor* preprocessor, PreprocessorInputStream* inputStream)
@@ -1417,24 +1429,40 @@ static void HandleIncludeDirective(PreprocessorDirectiveContext* context)
     String foundSource;
 
 
-    IncludeHandler* includeHandler = context->preprocessor->includeHandler;
+    Preprocessor* preprocessor = context->preprocessor;
+    IncludeHandler* includeHandler = preprocessor->includeHandler;
     if (!includeHandler)
     {
         GetSink(context)->diagnose(pathToken.Position, Diagnostics::includeFailed, path);
         GetSink(context)->diagnose(pathToken.Position, Diagnostics::noIncludeHandlerSpecified);
         return;
     }
-    if (!includeHandler->TryToFindIncludeFile(path, pathIncludedFrom, &foundPath, &foundSource))
+
+    // Prefer a file the handler has already lexed, and only read and lex the file otherwise
+    RefPtr<LexedSourceFile> file = includeHandler->TryToFindLexedIncludeFile(path, pathIncludedFrom, GetSink(context));
+    if (!file)
     {
-        GetSink(context)->diagnose(pathToken.Position, Diagnostics::includeFailed, path);
-        return;
+        if (!includeHandler->TryToFindIncludeFile(path, pathIncludedFrom, &foundPath, &foundSource))
+        {
+            GetSink(context)->diagnose(pathToken.Position, Diagnostics::includeFailed, path);
+            return;
+        }
+        file = LexSourceFile(foundSource, foundPath, GetSink(context));
     }
 
+    // A file that has already been included and is protected by `#pragma once`
+    // or an include guard would only produce skipped tokens, so don't
+    // bother walking through it again.
+    if (file->isPragmaOnce && preprocessor->includedFiles.Contains(file->path))
+        return;
+    if (file->includeGuard.Length() && LookupMacro(&preprocessor->globalEnv, file->includeGuard))
+        return;
+
     // Push the new file onto our stack of input streams
     // TODO(tfoley): check if we have made our include stack too deep
-    PreprocessorInputStream* inputStream = CreateInputStreamForSource(context->preprocessor, foundSource, foundPath);
-    inputStream->parent = context->preprocessor->inputStream;
-    context->preprocessor->inputStream = inputStream;
+    PreprocessorInputStream* inputStream = CreateInputStreamForFile(preprocessor, file);
+    inputStream->parent = preprocessor->inputStream;
+    preprocessor->inputStream = inputStream;
 }
 
 // Handle a `#define` directive
@@ -1869,6 +1897,178 @@ static TokenList ReadAllTokens(
 }
 
 
+//
+// Lexed Files
+//
+
+// Is the token at `index` the `#` that starts a directive with the given name?
+static bool IsDirective(List<Token> const& tokens, int index, char const* name)
+{
+    if (index + 1 >= tokens.Count())
+        return false;
+    Token const& poundToken = tokens[index];
+    Token const& nameToken = tokens[index + 1];
+    return poundToken.Type == TokenType::Pound
+        && (poundToken.flags & TokenFlag::AtStartOfLine)
+        && nameToken.Type == TokenType::Identifier
+        && !(nameToken.flags & TokenFlag::AtStartOfLine)
+        && nameToken.Content == name;
+}
+
+// Find the first token on the line after the one containing `index`
+static int SkipToNextLine(List<Token> const& tokens, int index)
+{
+    index++;
+    while (index < tokens.Count()
+        && tokens[index].Type != TokenType::EndOfFile
+        && !(tokens[index].flags & TokenFlag::AtStartOfLine))
+    {
+        index++;
+    }
+    return index;
+}
+
+// Look for `#pragma once` and for an include guard wrapping the whole file.
+// The guard doesn't need to be `#define`d by the file itself: if the guard
+// macro is defined when the file is included, everything in it is skipped.
+static void DetectIncludeProtection(LexedSourceFile* file)
+{
+    List<Token> const& tokens = file->tokens.mTokens;
+
+    // An include guard has to be the first thing in the file
+    String guard;
+    if (IsDirective(tokens, 0, "ifndef")
+        && tokens.Count() > 2
+        && tokens[2].Type == TokenType::Identifier
+        && !(tokens[2].flags & TokenFlag::AtStartOfLine))
+    {
+        guard = tokens[2].Content;
+    }
+
+    int depth = 0;
+    for (int ii = 0; ii < tokens.Count() && tokens[ii].Type != TokenType::EndOfFile; ii = SkipToNextLine(tokens, ii))
+    {
+        if (IsDirective(tokens, ii, "if") || IsDirective(tokens, ii, "ifdef") || IsDirective(tokens, ii, "ifndef"))
+        {
+            depth++;
+        }
+        else if (IsDirective(tokens, ii, "else") || IsDirective(tokens, ii, "elif"))
+        {
+            // The guard doesn't cover the `#else` branch
+            if (depth == 1)
+                guard = String();
+        }
+        else if (IsDirective(tokens, ii, "endif"))
+        {
+            depth--;
+
+            // The guard has to end at the end of the file
+            if (depth == 0 && guard.Length())
+            {
+                int next = SkipToNextLine(tokens, ii);
+                if (next < tokens.Count() && tokens[next].Type != TokenType::EndOfFile)
+                    guard = String();
+            }
+        }
+        else if (IsDirective(tokens, ii, "pragma") && depth == 0)
+        {
+            if (ii + 2 < tokens.Count()
+                && tokens[ii + 2].Type == TokenType::Identifier
+                && !(tokens[ii + 2].flags & TokenFlag::AtStartOfLine)
+                && tokens[ii + 2].Content == "once")
+            {
+                file->isPragmaOnce = true;
+            }
+        }
+    }
+
+    // Unbalanced conditionals are reported by the preprocessor; just don't trust the guard
+    if (depth != 0)
+        guard = String();
+
+    file->includeGuard = guard;
+}
+
+RefPtr<LexedSourceFile> LexSourceFile(
+    CoreLib::String const& source,
+    CoreLib::String const& fileName,
+    DiagnosticSink* sink)
+{
+    RefPtr<LexedSourceFile> file = new LexedSourceFile();
+    file->path = fileName;
+
+    // Use existing `Lexer` to generate a token stream.
+    Lexer lexer;
+    file->tokens = lexer.Parse(fileName, source, sink);
+
+    DetectIncludeProtection(file.Ptr());
+    return file;
+}
+
+// Get the modification time and size of a file, or return false if it doesn't exist
+static bool GetFileStamp(String const& path, long long* outModifiedTime, long long* outSize)
+{
+#ifdef _WIN32
+    struct _stat64 statVar;
+    if (::_wstat64(path.ToWString(), &statVar) != 0)
+        return false;
+#else
+    struct stat statVar;
+    if (::stat(path.Buffer(), &statVar) != 0)
+        return false;
+#endif
+    *outModifiedTime = (long long)statVar.st_mtime;
+    *outSize = (long long)statVar.st_size;
+    return true;
+}
+
+RefPtr<LexedSourceFile> IncludeFileCache::GetFile(
+    CoreLib::String const& path,
+    DiagnosticSink* sink)
+{
+    long long modifiedTime = 0;
+    long long size = 0;
+    if (!GetFileStamp(path, &modifiedTime, &size))
+        return NULL;
+
+    Entry* entry = entries.TryGetValue(path);
+    if (entry && entry->modifiedTime == modifiedTime && entry->size == size)
+        return entry->file;
+
+    String source;
+    try
+    {
+        source = CoreLib::IO::File::ReadAllText(path);
+    }
+    catch (CoreLib::IO::IOException)
+    {
+        return NULL;
+    }
+
+    // Files with lexer errors aren't cached, so that the errors get reported
+    // by every translation unit that includes them
+    int errorCount = sink->GetErrorCount();
+    RefPtr<LexedSourceFile> file = LexSourceFile(source, path, sink);
+    if (sink->GetErrorCount() == errorCount)
+    {
+        Entry newEntry;
+        newEntry.modifiedTime = modifiedTime;
+        newEntry.size = size;
+        newEntry.file = file;
+        entries[path] = newEntry;
+    }
+    else
+    {
+        entries.Remove(path);
+    }
+    return file;
+}
+
+void IncludeFileCache::Clear()
+{
+    entries.Clear();
+}
+
 // Take a string of source code and preprocess it into a list of tokens.
 TokenList PreprocessSource(
     CoreLib::String const& source,
@@ -10,6 +10,59 @@ namespace Spire{ namespace Compiler {
 
 class DiagnosticSink;
 
+// A source file that has been lexed into tokens, so that it can be
+// included by many translation units without being read and lexed again.
+struct LexedSourceFile : CoreLib::RefObject
+{
+    // The path the file was loaded from
+    CoreLib::String     path;
+
+    // The tokens of the file, ending with an end-of-file token
+    TokenList           tokens;
+
+    // If the whole file is wrapped in `#ifndef X` ... `#endif`, the name
+    // of the guard macro `X`. Otherwise empty.
+    CoreLib::String     includeGuard;
+
+    // Does the file contain an unconditional `#pragma once`?
+    bool                isPragmaOnce = false;
+};
+
+// Lex a source file, and detect whether it is protected against
+// being included more than once.
+CoreLib::RefPtr<LexedSourceFile> LexSourceFile(
+    CoreLib::String const& source,
+    CoreLib::String const& fileName,
+    DiagnosticSink* sink);
+
+// A cache of lexed files, keyed on their path and modification time.
+// Sharing a cache between compile requests means every include file
+// is only read and lexed once, no matter how many translation units
+// and define permutations include it.
+//
+// The cache isn't thread-safe; it should belong to a single session.
+class IncludeFileCache
+{
+public:
+    // Get the lexed tokens for the file at `path`, reading and lexing
+    // it if it isn't cached or has changed. Returns NULL if the file
+    // doesn't exist.
+    CoreLib::RefPtr<LexedSourceFile> GetFile(
+        CoreLib::String const& path,
+        DiagnosticSink* sink);
+
+    void Clear();
+
+private:
+    struct Entry
+    {
+        long long                           modifiedTime = 0;
+        long long                           size = 0;
+        CoreLib::RefPtr<LexedSourceFile>    file;
+    };
+    CoreLib::Dictionary<CoreLib::String, Entry> entries;
+};
+
 // Callback interface for the preprocessor to use when looking
 // for files in `#include` directives.
 struct IncludeHandler
@@ -19,6 +72,17 @@ struct IncludeHandler
         CoreLib::String const& pathIncludedFrom,
         CoreLib::String* outFoundPath,
         CoreLib::String* outFoundSource) = 0;
+
+    // Find an included file and return it already lexed. Handlers that keep
+    // an `IncludeFileCache` can override this to reuse lexed files.
+    // Returning NULL makes the preprocessor fall back to `TryToFindIncludeFile`.
+    virtual CoreLib::RefPtr<LexedSourceFile> TryToFindLexedIncludeFile(
+        CoreLib::String const& /*pathToInclude*/,
+        CoreLib::String const& /*pathIncludedFrom*/,
+        DiagnosticSink* /*sink*/)
+    {
+        return NULL;
+    }
 };
 
 // Take a string of source code and preprocess it into a list of tokens.
@@ -52,7 +52,8 @@ namespace Spire
 
         //
 
-        int compilerInstances = 0;
+        // Per-thread, since the builtin types it initializes are per-thread
+        thread_local int compilerInstances = 0;
 
         class ShaderCompilerImpl : public ShaderCompiler
         {
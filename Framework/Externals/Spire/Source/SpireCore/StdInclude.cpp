@@ -977,7 +977,7 @@ namespace Spire
 {
     namespace Compiler
     {
-        String SpireStdLib::code;
+        thread_local String SpireStdLib::code;
 
         String SpireStdLib::GetCode()
         {
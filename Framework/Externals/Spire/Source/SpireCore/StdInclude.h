@@ -10,7 +10,7 @@ namespace Spire
         class SpireStdLib
         {
         private:
-            static CoreLib::String code;
+            static thread_local CoreLib::String code;
         public:
             static CoreLib::String GetCode();
             static void Finalize();
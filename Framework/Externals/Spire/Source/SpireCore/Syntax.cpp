@@ -339,12 +339,12 @@ namespace Spire
         RefPtr<ExpressionType> ExpressionType::Float2;
         RefPtr<ExpressionType> ExpressionType::Void;
 #endif
-        RefPtr<ExpressionType> ExpressionType::Error;
-        RefPtr<ExpressionType> ExpressionType::Overloaded;
+        thread_local RefPtr<ExpressionType> ExpressionType::Error;
+        thread_local RefPtr<ExpressionType> ExpressionType::Overloaded;
 
-        Dictionary<int, RefPtr<ExpressionType>> ExpressionType::sBuiltinTypes;
-        Dictionary<String, Decl*> ExpressionType::sMagicDecls;
-        List<RefPtr<ExpressionType>> ExpressionType::sCanonicalTypes;
+        thread_local Dictionary<int, RefPtr<ExpressionType>> ExpressionType::sBuiltinTypes;
+        thread_local Dictionary<String, Decl*> ExpressionType::sMagicDecls;
+        thread_local List<RefPtr<ExpressionType>> ExpressionType::sCanonicalTypes;
 
         void ExpressionType::Init()
         {
@@ -372,15 +372,18 @@ namespace Spire
             static RefPtr<ExpressionType> Float2;
             static RefPtr<ExpressionType> Void;
 #endif
-            static RefPtr<ExpressionType> Error;
-            static RefPtr<ExpressionType> Overloaded;
+            // The builtin types are registered by the session which checks the
+            // stdlib. They are per-thread, so that every thread can own a
+            // session and compile concurrently.
+            static thread_local RefPtr<ExpressionType> Error;
+            static thread_local RefPtr<ExpressionType> Overloaded;
 
-            static Dictionary<int, RefPtr<ExpressionType>> sBuiltinTypes;
-            static Dictionary<String, Decl*> sMagicDecls;
+            static thread_local Dictionary<int, RefPtr<ExpressionType>> sBuiltinTypes;
+            static thread_local Dictionary<String, Decl*> sMagicDecls;
 
             // Note: just exists to make sure we can clean up
             // canonical types we create along the way
-            static List<RefPtr<ExpressionType>> sCanonicalTypes;
+            static thread_local List<RefPtr<ExpressionType>> sCanonicalTypes;
 
 
 
@@ -389,7 +389,7 @@ namespace SpireLib
         int Id;
         Shader(String name, String source)
         {
-            static int idAllocator = 0;
+            static thread_local int idAllocator = 0;
             Id = idAllocator++;
             shaderName = name;
             src = source;
@@ -415,6 +415,311 @@ namespace SpireLib
 #endif
     }
 
+    // Hash of the binary which contains the compiler. Anything cached from the
+    // output of a compiler is only valid for that exact compiler (including the
+    // stdlib, which is embedded in it), so caches are keyed on this hash. The
+    // file is hashed in 64-bit words, which is fast enough to do once per
+    // process. Returns 0 if the binary can't be read.
+    static unsigned long long computeCompilerHash()
+    {
+#ifdef _WIN32
+        HMODULE module = nullptr;
+        if(!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCWSTR)&computeCompilerHash, &module))
+            return 0;
+
+        wchar_t modulePath[MAX_PATH];
+        DWORD pathLength = GetModuleFileNameW(module, modulePath, MAX_PATH);
+        if(pathLength == 0 || pathLength == MAX_PATH)
+            return 0;
+
+        HANDLE file = CreateFileW(modulePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(file == INVALID_HANDLE_VALUE)
+            return 0;
+
+        unsigned long long hash = 0xcbf29ce484222325ull;
+        unsigned long long totalSize = 0;
+        List<unsigned long long> buffer;
+        buffer.SetSize(1 << 14);
+        DWORD bytesRead = 0;
+        bool good = true;
+        for(;;)
+        {
+            if(!ReadFile(file, buffer.Buffer(), (DWORD)(buffer.Count() * sizeof(unsigned long long)), &bytesRead, nullptr))
+            {
+                good = false;
+                break;
+            }
+            if(bytesRead == 0)
+                break;
+
+            // Zero the tail of a partial word, so that the hash only depends on the file contents
+            int wordCount = (int)((bytesRead + sizeof(unsigned long long) - 1) / sizeof(unsigned long long));
+            memset((char*)buffer.Buffer() + bytesRead, 0, wordCount * sizeof(unsigned long long) - bytesRead);
+            for(int i = 0; i < wordCount; i++)
+            {
+                hash ^= buffer[i];
+                hash *= 0x100000001b3ull;
+            }
+            totalSize += bytesRead;
+        }
+        CloseHandle(file);
+        if(!good)
+            return 0;
+
+        hash ^= totalSize;
+        hash *= 0x100000001b3ull;
+        return hash ? hash : 1;
+#else
+        return 0;
+#endif
+    }
+
+    static unsigned long long getCompilerHash()
+    {
+        static const unsigned long long hash = computeCompilerHash();
+        return hash;
+    }
+
+    // Builtin sources (the stdlib, and anything added with `spAddBuiltins`) are
+    // preprocessed once and the resulting tokens are stored in the session's
+    // cache directory. Later sessions load the tokens with a single read,
+    // instead of lexing and preprocessing the source again.
+    //
+    // Entries are keyed on a hash of the source text. The compiler hash is
+    // stored in each entry, since the token representation may change when
+    // Spire is rebuilt. Tokens aren't cached if the compiler hash is unknown.
+    //
+    // Only the tokens are cached. Parsing and checking the builtins still
+    // happens in every session.
+    static const unsigned int kTokenCacheMagic = 0x434b5453; // 'STKC'
+    static const unsigned int kTokenCacheVersion = 2;
+
+    static String getTokenCacheBuildId()
+    {
+        char hashString[32];
+        sprintf_s(hashString, sizeof(hashString), "%016llx", getCompilerHash());
+        return String(hashString);
+    }
+
+    static unsigned long long hashSource(String const& source)
+    {
+        unsigned long long hash = 0xcbf29ce484222325ull;
+        char const* data = source.Buffer();
+        for(int i = 0; i < source.Length(); i++)
+        {
+            hash ^= (unsigned char)data[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    static String getTokenCachePath(
+        String const& cacheDir,
+        String const& path,
+        String const& source)
+    {
+        char hashString[32];
+        sprintf_s(hashString, sizeof(hashString), "%016llx", hashSource(source));
+        return Path::Combine(cacheDir, Path::GetFileName(path) + "-" + String(hashString) + ".spiretokens");
+    }
+
+    struct TokenCacheWriter
+    {
+        List<unsigned char> data;
+
+        void writeBytes(void const* src, int size)
+        {
+            data.AddRange((unsigned char const*)src, size);
+        }
+
+        void writeInt(int value)
+        {
+            writeBytes(&value, sizeof(value));
+        }
+
+        void writeString(String const& str)
+        {
+            writeInt(str.Length());
+            writeBytes(str.Buffer(), str.Length());
+        }
+    };
+
+    struct TokenCacheReader
+    {
+        List<unsigned char> data;
+        int offset = 0;
+        bool failed = false;
+
+        void readBytes(void* dst, int size)
+        {
+            if(failed || size < 0 || offset + size > data.Count())
+            {
+                failed = true;
+                memset(dst, 0, size > 0 ? size : 0);
+                return;
+            }
+            memcpy(dst, data.Buffer() + offset, size);
+            offset += size;
+        }
+
+        int readInt()
+        {
+            int value = 0;
+            readBytes(&value, sizeof(value));
+            return value;
+        }
+
+        String readString()
+        {
+            int length = readInt();
+            if(failed || length < 0 || offset + length > data.Count())
+            {
+                failed = true;
+                return String();
+            }
+            if(length == 0)
+                return String();
+            RefPtr<char, RefPtrArrayDestructor> buffer = new char[length + 1];
+            memcpy(buffer.Ptr(), data.Buffer() + offset, length);
+            buffer[length] = '\0';
+            offset += length;
+            return String::FromBuffer(buffer, length);
+        }
+    };
+
+    static bool loadCachedTokens(
+        String const&   cachePath,
+        String const&   source,
+        TokenList&      outTokens)
+    {
+        TokenCacheReader reader;
+        try
+        {
+            if(!File::Exists(cachePath))
+                return false;
+
+            FileStream stream(cachePath, FileMode::Open, FileAccess::Read, FileShare::ReadWrite);
+            stream.Seek(SeekOrigin::End, 0);
+            int size = (int)stream.GetPosition();
+            stream.Seek(SeekOrigin::Start, 0);
+            reader.data.SetSize(size);
+            if(size == 0 || stream.Read(reader.data.Buffer(), size) != size)
+                return false;
+        }
+        catch(Exception)
+        {
+            return false;
+        }
+
+        if(reader.readInt() != (int)kTokenCacheMagic || reader.readInt() != (int)kTokenCacheVersion)
+            return false;
+        if(reader.readString() != getTokenCacheBuildId())
+            return false;
+
+        // The entry is addressed by the hash, so compare the source length as an extra check
+        if(reader.readInt() != source.Length())
+            return false;
+
+        List<String> fileNames;
+        int fileNameCount = reader.readInt();
+        for(int i = 0; i < fileNameCount && !reader.failed; i++)
+        {
+            fileNames.Add(reader.readString());
+        }
+
+        int tokenCount = reader.readInt();
+        if(reader.failed || tokenCount <= 0)
+            return false;
+
+        List<Token> tokens;
+        tokens.Reserve(tokenCount);
+        for(int i = 0; i < tokenCount && !reader.failed; i++)
+        {
+            Token token;
+            token.Type = (TokenType)reader.readInt();
+            token.flags = (TokenFlags)reader.readInt();
+            token.Position.Line = reader.readInt();
+            token.Position.Col = reader.readInt();
+            token.Position.Pos = reader.readInt();
+            int fileIndex = reader.readInt();
+            if(fileIndex < 0 || fileIndex >= fileNames.Count())
+                return false;
+            token.Position.FileName = fileNames[fileIndex];
+            token.Content = reader.readString();
+            tokens.Add(token);
+        }
+
+        if(reader.failed || tokens.Last().Type != TokenType::EndOfFile)
+            return false;
+
+        outTokens.mTokens = _Move(tokens);
+        return true;
+    }
+
+    static void storeCachedTokens(
+        String const&       cachePath,
+        String const&       source,
+        TokenList const&    tokens)
+    {
+        TokenCacheWriter writer;
+        writer.writeInt((int)kTokenCacheMagic);
+        writer.writeInt((int)kTokenCacheVersion);
+        writer.writeString(getTokenCacheBuildId());
+        writer.writeInt(source.Length());
+
+        List<String> fileNames;
+        List<int> fileIndices;
+        for(auto& token : tokens.mTokens)
+        {
+            int index = fileNames.IndexOf(token.Position.FileName);
+            if(index < 0)
+            {
+                index = fileNames.Count();
+                fileNames.Add(token.Position.FileName);
+            }
+            fileIndices.Add(index);
+        }
+
+        writer.writeInt(fileNames.Count());
+        for(auto& fileName : fileNames)
+        {
+            writer.writeString(fileName);
+        }
+
+        writer.writeInt(tokens.mTokens.Count());
+        for(int i = 0; i < tokens.mTokens.Count(); i++)
+        {
+            auto& token = tokens.mTokens[i];
+            writer.writeInt((int)token.Type);
+            writer.writeInt((int)token.flags);
+            writer.writeInt(token.Position.Line);
+            writer.writeInt(token.Position.Col);
+            writer.writeInt(token.Position.Pos);
+            writer.writeInt(fileIndices[i]);
+            writer.writeString(token.Content);
+        }
+
+        // Write to a temporary file and rename it, so that concurrent sessions never read a partial entry.
+        // Sessions of the same process may run on different threads, so the thread is part of the name.
+        String tempPath = cachePath + ".tmp" + String((int)GetCurrentProcessId()) + "-" + String((int)GetCurrentThreadId());
+        try
+        {
+            FileStream stream(tempPath, FileMode::Create);
+            stream.Write(writer.data.Buffer(), writer.data.Count());
+            stream.Close();
+        }
+        catch(Exception)
+        {
+            remove(tempPath.Buffer());
+            return;
+        }
+
+        if(rename(tempPath.Buffer(), cachePath.Buffer()) != 0)
+        {
+            remove(tempPath.Buffer());
+        }
+    }
+
     class Session
     {
     public:
@@ -431,8 +736,13 @@ namespace SpireLib
         RefPtr<ShaderCompiler> compiler;
         CompileUnit predefUnit;
 
+        // Lexed `#include` files, shared by every request in the session
+        IncludeFileCache includeFileCache;
 
-        Session(bool /*pUseCache*/, CoreLib::String /*pCacheDir*/)
+
+        Session(bool pUseCache, CoreLib::String pCacheDir)
+            : useCache(pUseCache)
+            , cacheDir(pCacheDir)
         {
             compiler = CreateShaderCompiler();
             compileContext.Add(new Spire::Compiler::CompilationContext());
@@ -470,15 +780,25 @@ namespace SpireLib
             CompileOptions options;
             auto& preprocesorDefinitions = options.PreprocessorDefinitions;
 
-            auto tokens = PreprocessSource(
-                sourceFile->content,
-                sourceFile->path,
-                &sink,
-                nullptr,
-                preprocesorDefinitions);
-            if(sink.GetErrorCount())
+            TokenList tokens;
+            bool cacheTokens = useCache && getCompilerHash() != 0;
+            String cachePath = cacheTokens ? getTokenCachePath(cacheDir, path, source) : String();
+            if(!cacheTokens || !loadCachedTokens(cachePath, source, tokens))
             {
-                assert(!"error in stdlib");
+                tokens = PreprocessSource(
+                    sourceFile->content,
+                    sourceFile->path,
+                    &sink,
+                    nullptr,
+                    preprocesorDefinitions);
+                if(sink.GetErrorCount())
+                {
+                    assert(!"error in stdlib");
+                }
+                else if(cacheTokens)
+                {
+                    storeCachedTokens(cachePath, source, tokens);
+                }
             }
 
             predefUnit.options.sourceFiles.Add(sourceFile);
@@ -761,20 +1081,15 @@ namespace SpireLib
 
             List<String> searchDirs;
 
-            virtual bool TryToFindIncludeFile(
+            bool FindIncludePath(
                 CoreLib::String const& pathToInclude,
                 CoreLib::String const& pathIncludedFrom,
-                CoreLib::String* outFoundPath,
-                CoreLib::String* outFoundSource) override
+                CoreLib::String* outFoundPath)
             {
                 String path = Path::Combine(Path::GetDirectoryName(pathIncludedFrom), pathToInclude);
                 if (File::Exists(path))
                 {
                     *outFoundPath = path;
-                    *outFoundSource = File::ReadAllText(path);
-
-                    request->mDependencyFilePaths.Add(path);
-
                     return true;
                 }
 
@@ -784,15 +1099,46 @@ namespace SpireLib
                     if (File::Exists(path))
                     {
                         *outFoundPath = path;
-                        *outFoundSource = File::ReadAllText(path);
-
-                        request->mDependencyFilePaths.Add(path);
-
                         return true;
                     }
                 }
                 return false;
             }
+
+            virtual bool TryToFindIncludeFile(
+                CoreLib::String const& pathToInclude,
+                CoreLib::String const& pathIncludedFrom,
+                CoreLib::String* outFoundPath,
+                CoreLib::String* outFoundSource) override
+            {
+                String path;
+                if (!FindIncludePath(pathToInclude, pathIncludedFrom, &path))
+                    return false;
+
+                *outFoundPath = path;
+                *outFoundSource = File::ReadAllText(path);
+
+                request->mDependencyFilePaths.Add(path);
+
+                return true;
+            }
+
+            virtual RefPtr<LexedSourceFile> TryToFindLexedIncludeFile(
+                CoreLib::String const& pathToInclude,
+                CoreLib::String const& pathIncludedFrom,
+                DiagnosticSink* sink) override
+            {
+                String path;
+                if (!FindIncludePath(pathToInclude, pathIncludedFrom, &path))
+                    return NULL;
+
+                RefPtr<LexedSourceFile> file = request->mSession->includeFileCache.GetFile(path, sink);
+                if (file)
+                {
+                    request->mDependencyFilePaths.Add(path);
+                }
+                return file;
+            }
         };
 
 
@@ -972,6 +1318,11 @@ SPIRE_API void spDestroySession(
     delete SESSION(session);
 }
 
+SPIRE_API unsigned long long spGetCompilerHash()
+{
+    return getCompilerHash();
+}
+
 SPIRE_API void spAddBuiltins(
     SpireSession*   session,
     char const*     sourcePath,
@@ -145,6 +145,12 @@ extern "C"
     SPIRE_API void spDestroySession(
         SpireSession*   session);
 
+    /*!
+    @brief Get a hash of the binary which contains the Spire compiler. Use it to key anything cached from the compiler's output.
+    @return The hash, or 0 if it couldn't be computed.
+    */
+    SPIRE_API unsigned long long spGetCompilerHash();
+
 
     /*!
     @brief Add new builtin declarations to be used in subsequent compiles.
@@ -0,0 +1,122 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Caches data resolved from a reflection object and a shader variable name, such as the offsets and register indices of a struct inside a program.
+        Resolving a layout usually means building strings and searching the reflection maps. The cache does it once per (reflection, name) pair and returns the stored layout on later calls.
+        Entries hold a weak reference to the reflection object, so a layout is never returned for a reflection object which was released and whose address was reused.
+        The cache is usually a function-local static shared by every thread which binds the variable, so access is serialized with a mutex.
+        \tparam ReflectionType ProgramReflection or ProgramReflection::BufferReflection
+        \tparam LayoutType The resolved data
+    */
+    template<typename ReflectionType, typename LayoutType>
+    class BindingLayoutCache
+    {
+    public:
+        using ReflectionPtr = std::shared_ptr<const ReflectionType>;
+
+        /** Get the layout of a variable, resolving it if it isn't in the cache.
+            \param[in] pReflector The reflection object the layout is resolved from
+            \param[in] varName The shader variable name
+            \param[in] createFunc Function with the signature LayoutType(const ReflectionType* pReflector, const std::string& varName), called when the layout is not found in the cache
+            \return A copy of the layout. A reference could be invalidated by another thread adding an entry.
+        */
+        template<typename CreateFunc>
+        LayoutType get(const ReflectionPtr& pReflector, const std::string& varName, CreateFunc createFunc)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            // Most calls bind the same variable with the same program as the previous call
+            if(mLastHit < mEntries.size() && isMatch(mEntries[mLastHit], pReflector.get(), varName))
+            {
+                return mEntries[mLastHit].layout;
+            }
+
+            for(size_t i = 0; i < mEntries.size(); i++)
+            {
+                if(isMatch(mEntries[i], pReflector.get(), varName))
+                {
+                    mLastHit = i;
+                    return mEntries[i].layout;
+                }
+            }
+
+            removeExpiredEntries();
+            mEntries.push_back({pReflector.get(), pReflector, varName, createFunc(pReflector.get(), varName)});
+            mLastHit = mEntries.size() - 1;
+            return mEntries.back().layout;
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mEntries.clear();
+        }
+
+    private:
+        struct Entry
+        {
+            const ReflectionType* pKey;
+            std::weak_ptr<const ReflectionType> pReflector;
+            std::string varName;
+            LayoutType layout;
+        };
+
+        static bool isMatch(const Entry& entry, const ReflectionType* pKey, const std::string& varName)
+        {
+            return entry.pKey == pKey && entry.varName == varName && entry.pReflector.expired() == false;
+        }
+
+        void removeExpiredEntries()
+        {
+            size_t count = 0;
+            for(size_t i = 0; i < mEntries.size(); i++)
+            {
+                if(mEntries[i].pReflector.expired() == false)
+                {
+                    if(count != i)
+                    {
+                        mEntries[count] = std::move(mEntries[i]);
+                    }
+                    count++;
+                }
+            }
+            mEntries.resize(count);
+        }
+
+        std::vector<Entry> mEntries;
+        size_t mLastHit = 0;
+        std::mutex mMutex;
+    };
+}
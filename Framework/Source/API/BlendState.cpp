@@ -65,4 +65,66 @@ namespace Falcor
         mRtDesc[rtIndex].writeMask.writeAlpha = writeAlpha;
         return *this;
     }
+
+    bool BlendState::Desc::operator==(const Desc& other) const
+    {
+        if(mEnableIndependentBlend != other.mEnableIndependentBlend || mAlphaToCoverageEnabled != other.mAlphaToCoverageEnabled || mBlendFactor != other.mBlendFactor || mRtDesc.size() != other.mRtDesc.size())
+        {
+            return false;
+        }
+
+        for(size_t i = 0; i < mRtDesc.size(); i++)
+        {
+            const RenderTargetDesc& a = mRtDesc[i];
+            const RenderTargetDesc& b = other.mRtDesc[i];
+            if(a.blendEnabled != b.blendEnabled || a.rgbBlendOp != b.rgbBlendOp || a.alphaBlendOp != b.alphaBlendOp ||
+                a.srcRgbFunc != b.srcRgbFunc || a.srcAlphaFunc != b.srcAlphaFunc || a.dstRgbFunc != b.dstRgbFunc || a.dstAlphaFunc != b.dstAlphaFunc ||
+                a.writeMask.writeRed != b.writeMask.writeRed || a.writeMask.writeGreen != b.writeMask.writeGreen || a.writeMask.writeBlue != b.writeMask.writeBlue || a.writeMask.writeAlpha != b.writeMask.writeAlpha)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t BlendState::Desc::getHash() const
+    {
+        size_t hash = 0;
+        hashCombine(hash, mEnableIndependentBlend);
+        hashCombine(hash, mAlphaToCoverageEnabled);
+        for(uint32_t i = 0; i < 4; i++)
+        {
+            hashCombine(hash, mBlendFactor[i]);
+        }
+
+        for(const RenderTargetDesc& rt : mRtDesc)
+        {
+            hashCombine(hash, rt.blendEnabled);
+            hashCombine(hash, (uint32_t)rt.rgbBlendOp);
+            hashCombine(hash, (uint32_t)rt.alphaBlendOp);
+            hashCombine(hash, (uint32_t)rt.srcRgbFunc);
+            hashCombine(hash, (uint32_t)rt.srcAlphaFunc);
+            hashCombine(hash, (uint32_t)rt.dstRgbFunc);
+            hashCombine(hash, (uint32_t)rt.dstAlphaFunc);
+            uint32_t writeMask = (rt.writeMask.writeRed ? 1 : 0) | (rt.writeMask.writeGreen ? 2 : 0) | (rt.writeMask.writeBlue ? 4 : 0) | (rt.writeMask.writeAlpha ? 8 : 0);
+            hashCombine(hash, writeMask);
+        }
+        return hash;
+    }
+
+    static ObjectCache<BlendState, BlendState::Desc>& getBlendStateCache()
+    {
+        static ObjectCache<BlendState, BlendState::Desc> sCache;
+        return sCache;
+    }
+
+    BlendState::SharedPtr BlendState::create(const Desc& desc)
+    {
+        return getBlendStateCache().get(desc, apiCreate);
+    }
+
+    ObjectCacheStats BlendState::getCacheStats()
+    {
+        return getBlendStateCache().getStats();
+    }
 }
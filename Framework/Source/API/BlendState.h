@@ -27,6 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include "glm/vec4.hpp"
+#include "API/ObjectCache.h"
 
 namespace Falcor
 {
@@ -132,6 +133,15 @@ namespace Falcor
                 WriteMask writeMask;
             };
 
+            /** Compare all the fields of the descs
+            */
+            bool operator==(const Desc& other) const;
+            bool operator!=(const Desc& other) const { return !(*this == other); }
+
+            /** Get a hash of the desc. Equal descs have the same hash.
+            */
+            size_t getHash() const;
+
         protected:
             std::vector<RenderTargetDesc> mRtDesc;
             bool mEnableIndependentBlend = false;
@@ -139,10 +149,18 @@ namespace Falcor
             glm::vec4 mBlendFactor       = glm::vec4(0, 0, 0, 0);
         };
 
-        /** create a new blend state object
+        /** Get a blend state object. Blend states are immutable, so equal descs return the same object.
             \param[in] Desc Blend state descriptor
         */
         static BlendState::SharedPtr create(const Desc& desc);
+
+        /** Get the number of blend state objects requested and created
+        */
+        static ObjectCacheStats getCacheStats();
+
+        /** Get the desc the object was created with
+        */
+        const Desc& getDesc() const { return mDesc; }
         ~BlendState();
 
         /** Get the constant blend factor color
@@ -190,6 +208,7 @@ namespace Falcor
 
     private:
         BlendState(const Desc& Desc) : mDesc(Desc) {}
+        static SharedPtr apiCreate(const Desc& desc);
         const Desc mDesc;
         BlendStateHandle mApiHandle;
     };
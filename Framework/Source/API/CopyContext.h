@@ -90,12 +90,24 @@ namespace Falcor
 
         /** Override the low-level context data with a user provided object
         */
-        void setLowLevelContextData(LowLevelContextData::SharedPtr pLowLevelData) { mpLowLevelData = pLowLevelData; }
+        void setLowLevelContextData(LowLevelContextData::SharedPtr pLowLevelData) { mpLowLevelData = pLowLevelData; invalidateBoundVars(); }
 #endif
+
+        /** Get the ID of the ProgramVars whose root signature and root parameters are set on the command list, or 0 if it's unknown.
+            ProgramVars::apply() uses it to skip the root parameters which are already set.
+        */
+        uint64_t getBoundVarsId(bool forGraphics) const { return mBoundVarsId[forGraphics ? 1 : 0]; }
+        void setBoundVarsId(bool forGraphics, uint64_t varsId) { mBoundVarsId[forGraphics ? 1 : 0] = varsId; }
+
+        /** Forget which ProgramVars are bound. Call it after setting the root signature or root parameters with raw API calls.
+        */
+        void invalidateBoundVars() { mBoundVarsId[0] = 0; mBoundVarsId[1] = 0; }
+
     protected:
         void bindDescriptorHeaps();
         CopyContext() = default;
         bool mCommandsPending = false;
+        uint64_t mBoundVarsId[2] = { 0, 0 };    // Compute, graphics
 #ifdef FALCOR_LOW_LEVEL_API
         LowLevelContextData::SharedPtr mpLowLevelData;
 #endif
@@ -96,7 +96,7 @@ namespace Falcor
         }
     }
 
-    BlendState::SharedPtr BlendState::create(const Desc& desc)
+    BlendState::SharedPtr BlendState::apiCreate(const Desc& desc)
     {
         D3D11_BLEND_DESC dxDesc;
         dxDesc.AlphaToCoverageEnable = dxBool(desc.mAlphaToCoverageEnabled);
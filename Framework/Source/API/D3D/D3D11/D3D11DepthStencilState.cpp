@@ -34,7 +34,7 @@ namespace Falcor
 
 
 
-    DepthStencilState::SharedPtr DepthStencilState::create(const Desc& desc)
+    DepthStencilState::SharedPtr DepthStencilState::apiCreate(const Desc& desc)
     {
         auto pDsState = SharedPtr(new DepthStencilState(desc));
         D3D11_DEPTH_STENCIL_DESC dxDesc;
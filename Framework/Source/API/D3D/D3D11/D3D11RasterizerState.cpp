@@ -62,7 +62,7 @@ namespace Falcor
         }
     }
 
-    RasterizerState::SharedPtr RasterizerState::create(const Desc& desc)
+    RasterizerState::SharedPtr RasterizerState::apiCreate(const Desc& desc)
     {
         D3D11_RASTERIZER_DESC dxDesc;
         dxDesc.FillMode = getD3DFillMode(desc.mFillMode);
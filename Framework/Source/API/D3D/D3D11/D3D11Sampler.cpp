@@ -37,7 +37,7 @@ namespace Falcor
         return D3D11_MAX_MAXANISOTROPY;
     }
 
-    Sampler::SharedPtr Sampler::create(const Desc& desc)
+    Sampler::SharedPtr Sampler::apiCreate(const Desc& desc)
     {
         SharedPtr pSampler = SharedPtr(new Sampler(desc));
 
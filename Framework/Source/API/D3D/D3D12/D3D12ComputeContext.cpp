@@ -67,6 +67,7 @@ namespace Falcor
         else
         {
             mpLowLevelData->getCommandList()->SetComputeRootSignature(RootSignature::getEmpty()->getApiHandle());
+            setBoundVarsId(false, 0);
         }
 
         mpLowLevelData->getCommandList()->SetPipelineState(mpComputeState->getCSO(mpComputeVars.get())->getApiHandle());
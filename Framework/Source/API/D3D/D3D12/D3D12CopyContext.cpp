@@ -65,6 +65,7 @@ namespace Falcor
     {
         flush();
         mpLowLevelData->reset();
+        invalidateBoundVars();
         bindDescriptorHeaps();
     }
 
@@ -94,6 +95,7 @@ namespace Falcor
         {
             mpLowLevelData->flush();
             mCommandsPending = false;
+            invalidateBoundVars();
             bindDescriptorHeaps();
         }
 
@@ -119,13 +121,14 @@ namespace Falcor
         mCommandsPending = true;
         // Allocate a buffer on the upload heap
         Buffer::SharedPtr pUploadBuffer = Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Write, nullptr);
-        pUploadBuffer->updateData(pData, offset, size);
+        pUploadBuffer->updateData(pData, 0, size);
         ID3D12ResourcePtr pResource = pUploadBuffer->getApiHandle();
 
         resourceBarrier(pBuffer, Resource::State::CopyDest);
 
-        offset = pUploadBuffer->getGpuAddress() - pResource->GetGPUVirtualAddress();
-        mpLowLevelData->getCommandList()->CopyBufferRegion(pBuffer->getApiHandle(), 0, pResource, offset, size);
+        // The upload buffer is sub-allocated from a larger resource, so copy from its offset inside that resource into the requested range of the destination
+        uint64_t srcOffset = pUploadBuffer->getGpuAddress() - pResource->GetGPUVirtualAddress();
+        mpLowLevelData->getCommandList()->CopyBufferRegion(pBuffer->getApiHandle(), offset, pResource, srcOffset, size);
     }
 
     void CopyContext::updateTextureSubresources(const Texture* pTexture, uint32_t firstSubresource, uint32_t subresourceCount, const void* pData)
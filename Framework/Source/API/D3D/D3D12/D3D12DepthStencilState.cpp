@@ -32,7 +32,7 @@ namespace Falcor
 {
     DepthStencilState::~DepthStencilState() = default;
 
-    DepthStencilState::SharedPtr DepthStencilState::create(const Desc& desc)
+    DepthStencilState::SharedPtr DepthStencilState::apiCreate(const Desc& desc)
     {
         return SharedPtr(new DepthStencilState(desc));
     }
@@ -27,8 +27,207 @@
 ***************************************************************************/
 #include "Framework.h"
 #include "API/ProgramVars.h"
+#include "API/Buffer.h"
+#include "API/CopyContext.h"
+#include "API/RenderContext.h"
+#include "API/DescriptorSet.h"
+#include "API/Device.h"
 
 namespace Falcor
 {
+    static void transitionResource(CopyContext* pContext, const Resource* pResource, Resource::State state, ProgramVars::ApplyStats& stats)
+    {
+        if (pResource->getState() != state)
+        {
+            pContext->resourceBarrier(pResource, state);
+            stats.barriersEmitted++;
+        }
+    }
 
+    template<typename ViewType, bool isUav, bool forGraphics>
+    void bindUavSrvCommon(CopyContext* pContext, const ProgramVars::ResourceMap<ViewType>& resMap, bool bindAll, ProgramVars::ApplyStats& stats)
+    {
+        ID3D12GraphicsCommandList* pList = pContext->getLowLevelData()->getCommandList();
+        for (auto& resIt : resMap)
+        {
+            auto& resDesc = resIt.second;
+            uint32_t rootOffset = resDesc.rootSigOffset;
+            const Resource* pResource = resDesc.pResource.get();
+
+            // The resource still has to be uploaded and transitioned, even if the descriptor is already bound. It might have been modified or used with a different state since the last call.
+            if (pResource)
+            {
+                // If it's a typed buffer, upload it to the GPU
+                const TypedBufferBase* pTypedBuffer = (resDesc.kind == ProgramVars::ResourceKind::TypedBuffer) ? static_cast<const TypedBufferBase*>(pResource) : nullptr;
+                if (pTypedBuffer)
+                {
+                    pTypedBuffer->uploadToGPU();
+                }
+                const StructuredBuffer* pStructured = (resDesc.kind == ProgramVars::ResourceKind::StructuredBuffer) ? static_cast<const StructuredBuffer*>(pResource) : nullptr;
+                if (pStructured)
+                {
+                    pStructured->uploadToGPU();
+
+                    if (isUav && pStructured->hasUAVCounter())
+                    {
+                        transitionResource(pContext, pStructured->getUAVCounter().get(), Resource::State::UnorderedAccess, stats);
+                    }
+                }
+
+                transitionResource(pContext, pResource, isUav ? Resource::State::UnorderedAccess : Resource::State::ShaderResource, stats);
+                if (isUav)
+                {
+                    if (pTypedBuffer)
+                    {
+                        pTypedBuffer->setGpuCopyDirty();
+                    }
+                    if (pStructured)
+                    {
+                        pStructured->setGpuCopyDirty();
+                    }
+                }
+            }
+
+            // Allocate a GPU descriptor. The set is released when the binding changes, so a new set means the root parameter is stale.
+            bool bind = bindAll;
+            if (resDesc.pDescSet == nullptr)
+            {
+                ViewType::ApiHandle handle = pResource ? resDesc.pView->getApiHandle() : (isUav ? UnorderedAccessView::getNullView()->getApiHandle() : ShaderResourceView::getNullView()->getApiHandle());
+                DescriptorSet::Layout layout;
+                layout.addRange(isUav ? DescriptorSet::Type::Uav : DescriptorSet::Type::Srv, 1);
+                resDesc.pDescSet = DescriptorSet::create(gpDevice->getGpuDescriptorPool(), layout);
+                auto srcHandle = handle->getCpuHandle(0);
+                auto dstHandle = resDesc.pDescSet->getCpuHandle(0);
+                gpDevice->getApiHandle()->CopyDescriptorsSimple(1, dstHandle, srcHandle, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+                bind = true;
+            }
+
+            if (bind == false)
+            {
+                stats.bindingsSkipped++;
+                continue;
+            }
+
+            auto viewHandle = resDesc.pDescSet->getGpuHandle(0);
+            if(forGraphics)
+            {
+                pList->SetGraphicsRootDescriptorTable(rootOffset, viewHandle);
+            }
+            else
+            {
+                pList->SetComputeRootDescriptorTable(rootOffset, viewHandle);
+            }
+            stats.bindingsEmitted++;
+        }
+    }
+
+    template<bool forGraphics, typename ContextType>
+    void ProgramVars::applyCommon(ContextType* pContext) const
+    {
+        ID3D12GraphicsCommandList* pList = pContext->getLowLevelData()->getCommandList();
+        ApplyStats stats;
+        stats.applyCount = 1;
+
+        // The root parameters set by the last call are still valid if no other vars were applied to this context since, and the command list wasn't reset.
+        // If this object was applied to another context in-between, the released descriptor sets don't tell what changed since the last call on this context.
+        bool bindAll = (pContext->getBoundVarsId(forGraphics) != mId) || (mpLastApplyContext != pContext);
+        if (bindAll)
+        {
+            if(forGraphics)
+            {
+                pList->SetGraphicsRootSignature(mpRootSignature->getApiHandle());
+            }
+            else
+            {
+                pList->SetComputeRootSignature(mpRootSignature->getApiHandle());
+            }
+            pContext->setBoundVarsId(forGraphics, mId);
+            mpLastApplyContext = pContext;
+            stats.fullApplyCount = 1;
+        }
+
+        // Bind the constant-buffers. Uploading the data may move the buffer to a new address.
+        for (auto& bufIt : mAssignedCbs)
+        {
+            uint32_t rootOffset = bufIt.second.rootSigOffset;
+            const ConstantBuffer* pCB = static_cast<const ConstantBuffer*>(bufIt.second.pResource.get());
+            pCB->uploadToGPU();
+            uint64_t gpuAddress = pCB->getGpuAddress();
+            if (bindAll == false && gpuAddress == bufIt.second.boundGpuAddress)
+            {
+                stats.bindingsSkipped++;
+                continue;
+            }
+
+            if(forGraphics)
+            {
+                pList->SetGraphicsRootConstantBufferView(rootOffset, gpuAddress);
+            }
+            else
+            {
+                pList->SetComputeRootConstantBufferView(rootOffset, gpuAddress);
+            }
+            bufIt.second.boundGpuAddress = gpuAddress;
+            stats.bindingsEmitted++;
+        }
+
+        // Bind the SRVs and UAVs
+        bindUavSrvCommon<ShaderResourceView, false, forGraphics>(pContext, mAssignedSrvs, bindAll, stats);
+        bindUavSrvCommon<UnorderedAccessView, true, forGraphics>(pContext, mAssignedUavs, bindAll, stats);
+
+        // Bind the samplers
+        for (auto& samplerIt : mAssignedSamplers)
+        {
+            uint32_t rootOffset = samplerIt.second.rootSigOffset;
+            bool bind = bindAll;
+
+            // Allocate a GPU descriptor
+            if (samplerIt.second.pDescSet == nullptr)
+            {
+                const Sampler* pSampler = samplerIt.second.pSampler.get();
+                if (pSampler == nullptr)
+                {
+                    pSampler = Sampler::getDefault().get();
+                }
+
+                DescriptorSet::Layout layout;
+                layout.addRange(DescriptorSet::Type::Sampler, 1);
+                samplerIt.second.pDescSet = DescriptorSet::create(gpDevice->getGpuDescriptorPool(), layout);
+                auto srcHandle = pSampler->getApiHandle()->getCpuHandle(0);
+                auto dstHandle = samplerIt.second.pDescSet->getCpuHandle(0);
+                gpDevice->getApiHandle()->CopyDescriptorsSimple(1, dstHandle, srcHandle, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+                bind = true;
+            }
+
+            if (bind == false)
+            {
+                stats.bindingsSkipped++;
+                continue;
+            }
+
+            auto samplerHandler = samplerIt.second.pDescSet->getGpuHandle(0);
+
+            if (forGraphics)
+            {
+                pList->SetGraphicsRootDescriptorTable(rootOffset, samplerHandler);
+            }
+            else
+            {
+                pList->SetComputeRootDescriptorTable(rootOffset, samplerHandler);
+            }
+            stats.bindingsEmitted++;
+        }
+
+        recordApplyStats(stats);
+    }
+
+    void ComputeVars::apply(ComputeContext* pContext) const
+    {
+        applyCommon<false>(pContext);
+    }
+
+    void GraphicsVars::apply(RenderContext* pContext) const
+    {
+        applyCommon<true>(pContext);
+    }
 }
@@ -32,7 +32,7 @@ namespace Falcor
 {
     RasterizerState::~RasterizerState() = default;
     
-    RasterizerState::SharedPtr RasterizerState::create(const Desc& desc)
+    RasterizerState::SharedPtr RasterizerState::apiCreate(const Desc& desc)
     {
         return SharedPtr(new RasterizerState(desc));
     }
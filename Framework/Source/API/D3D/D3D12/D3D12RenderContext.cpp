@@ -200,6 +200,7 @@ namespace Falcor
         else
         {
             mpLowLevelData->getCommandList()->SetGraphicsRootSignature(RootSignature::getEmpty()->getApiHandle());
+            setBoundVarsId(true, 0);
         }
 
         CommandListHandle pList = mpLowLevelData->getCommandList();
@@ -38,7 +38,7 @@ namespace Falcor
         return D3D12_MAX_MAXANISOTROPY;
     }
 
-    Sampler::SharedPtr Sampler::create(const Desc& desc)
+    Sampler::SharedPtr Sampler::apiCreate(const Desc& desc)
     {
         SharedPtr pSampler = SharedPtr(new Sampler(desc));
         D3D12_SAMPLER_DESC d3dDesc;
@@ -186,7 +186,7 @@ namespace Falcor
         {
             return false;
         }
-#elif defined FALCOR_D3D12
+#elif defined FALCOR_D3D12 || defined FALCOR_NULL
         mApiHandle = { pData->pBlob->GetBufferPointer(), pData->pBlob->GetBufferSize() };
 #endif
 
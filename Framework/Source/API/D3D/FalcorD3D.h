@@ -55,6 +55,10 @@ __forceinline BOOL dxBool(bool b) { return b ? TRUE : FALSE; }
 #include "D3D12/FalcorD3D12.h"
 #endif
 
+#ifdef FALCOR_NULL
+#include "API/Null/FalcorNull.h"
+#endif
+
 #pragma comment(lib, "d3dcompiler.lib")
 #pragma comment(lib, "dxgi.lib")
 
@@ -76,4 +76,55 @@ namespace Falcor
         assert(face != Face::FrontAndBack);
         return (face == Face::Front) ? mDesc.mStencilFront : mDesc.mStencilBack;
     }
+
+    static bool isEqual(const DepthStencilState::StencilDesc& a, const DepthStencilState::StencilDesc& b)
+    {
+        return a.func == b.func && a.stencilFailOp == b.stencilFailOp && a.depthFailOp == b.depthFailOp && a.depthStencilPassOp == b.depthStencilPassOp;
+    }
+
+    static void hashStencilDesc(size_t& hash, const DepthStencilState::StencilDesc& desc)
+    {
+        hashCombine(hash, (uint32_t)desc.func);
+        hashCombine(hash, (uint32_t)desc.stencilFailOp);
+        hashCombine(hash, (uint32_t)desc.depthFailOp);
+        hashCombine(hash, (uint32_t)desc.depthStencilPassOp);
+    }
+
+    bool DepthStencilState::Desc::operator==(const Desc& other) const
+    {
+        return mDepthEnabled == other.mDepthEnabled && mWriteDepth == other.mWriteDepth && mDepthFunc == other.mDepthFunc && mStencilEnabled == other.mStencilEnabled &&
+            isEqual(mStencilFront, other.mStencilFront) && isEqual(mStencilBack, other.mStencilBack) &&
+            mStencilReadMask == other.mStencilReadMask && mStencilWriteMask == other.mStencilWriteMask && mStencilRef == other.mStencilRef;
+    }
+
+    size_t DepthStencilState::Desc::getHash() const
+    {
+        size_t hash = 0;
+        hashCombine(hash, mDepthEnabled);
+        hashCombine(hash, mWriteDepth);
+        hashCombine(hash, (uint32_t)mDepthFunc);
+        hashCombine(hash, mStencilEnabled);
+        hashStencilDesc(hash, mStencilFront);
+        hashStencilDesc(hash, mStencilBack);
+        hashCombine(hash, mStencilReadMask);
+        hashCombine(hash, mStencilWriteMask);
+        hashCombine(hash, mStencilRef);
+        return hash;
+    }
+
+    static ObjectCache<DepthStencilState, DepthStencilState::Desc>& getDepthStencilStateCache()
+    {
+        static ObjectCache<DepthStencilState, DepthStencilState::Desc> sCache;
+        return sCache;
+    }
+
+    DepthStencilState::SharedPtr DepthStencilState::create(const Desc& desc)
+    {
+        return getDepthStencilStateCache().get(desc, apiCreate);
+    }
+
+    ObjectCacheStats DepthStencilState::getCacheStats()
+    {
+        return getDepthStencilStateCache().getStats();
+    }
 }
@@ -26,6 +26,7 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
+#include "API/ObjectCache.h"
 
 namespace Falcor
 {
@@ -133,6 +134,15 @@ namespace Falcor
             */
             Desc& setStencilRef(uint8_t value) { mStencilRef = value; return *this; };
 
+            /** Compare all the fields of the descs
+            */
+            bool operator==(const Desc& other) const;
+            bool operator!=(const Desc& other) const { return !(*this == other); }
+
+            /** Get a hash of the desc. Equal descs have the same hash.
+            */
+            size_t getHash() const;
+
         protected:
             bool mDepthEnabled = true;
             bool mWriteDepth = true;
@@ -146,12 +156,20 @@ namespace Falcor
         };
 
         ~DepthStencilState();
-        /** create a new depth-stencil state object
+        /** Get a depth-stencil state object. Depth-stencil states are immutable, so equal descs return the same object.
             \param desc Depth-stencil descriptor
-            \return New object, or nullptr if an error occurred
+            \return The object, or nullptr if an error occurred
         */
         static SharedPtr create(const Desc& desc);
 
+        /** Get the number of depth-stencil state objects requested and created
+        */
+        static ObjectCacheStats getCacheStats();
+
+        /** Get the desc the object was created with
+        */
+        const Desc& getDesc() const { return mDesc; }
+
         /** Check if depth test is enabled or disabled
         */
         bool isDepthTestEnabled() const { return mDesc.mDepthEnabled; }
@@ -187,6 +205,7 @@ namespace Falcor
     private:
         DepthStencilStateHandle mApiHandle;
         DepthStencilState(const Desc& Desc) : mDesc(Desc) {}
+        static SharedPtr apiCreate(const Desc& desc);
         Desc mDesc;
     };
 }
\ No newline at end of file
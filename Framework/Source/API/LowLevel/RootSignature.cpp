@@ -105,14 +105,132 @@ namespace Falcor
         return spEmptySig;
     }
 
-    RootSignature::SharedPtr RootSignature::create(const Desc& desc)
+    static bool isEqual(const RootSignature::CommonDesc& a, const RootSignature::CommonDesc& b)
+    {
+        return a.regIndex == b.regIndex && a.regSpace == b.regSpace && a.visibility == b.visibility;
+    }
+
+    static void hashCommonDesc(size_t& hash, const RootSignature::CommonDesc& desc)
+    {
+        hashCombine(hash, desc.regIndex);
+        hashCombine(hash, desc.regSpace);
+        hashCombine(hash, (uint32_t)desc.visibility);
+    }
+
+    bool RootSignature::Desc::operator==(const Desc& other) const
+    {
+        if (mConstants.size() != other.mConstants.size() || mRootDescriptors.size() != other.mRootDescriptors.size() ||
+            mDescriptorTables.size() != other.mDescriptorTables.size() || mSamplers.size() != other.mSamplers.size())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < mConstants.size(); i++)
+        {
+            if (isEqual(mConstants[i], other.mConstants[i]) == false || mConstants[i].dwordCount != other.mConstants[i].dwordCount)
+            {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < mRootDescriptors.size(); i++)
+        {
+            if (isEqual(mRootDescriptors[i], other.mRootDescriptors[i]) == false || mRootDescriptors[i].type != other.mRootDescriptors[i].type)
+            {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < mDescriptorTables.size(); i++)
+        {
+            const DescriptorTable& a = mDescriptorTables[i];
+            const DescriptorTable& b = other.mDescriptorTables[i];
+            if (a.mVisibility != b.mVisibility || a.mRanges.size() != b.mRanges.size())
+            {
+                return false;
+            }
+            for (size_t r = 0; r < a.mRanges.size(); r++)
+            {
+                const DescriptorTable::Range& ra = a.mRanges[r];
+                const DescriptorTable::Range& rb = b.mRanges[r];
+                if (ra.type != rb.type || ra.firstRegIndex != rb.firstRegIndex || ra.descCount != rb.descCount || ra.regSpace != rb.regSpace || ra.offsetFromTableStart != rb.offsetFromTableStart)
+                {
+                    return false;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < mSamplers.size(); i++)
+        {
+            const SamplerDesc& a = mSamplers[i];
+            const SamplerDesc& b = other.mSamplers[i];
+            if (isEqual(a, b) == false || a.borderColor != b.borderColor || a.pSampler != b.pSampler)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t RootSignature::Desc::getHash() const
     {
-        SharedPtr pSig = SharedPtr(new RootSignature(desc));
-        if (pSig->apiInit() == false)
+        size_t hash = 0;
+        for (const auto& c : mConstants)
+        {
+            hashCommonDesc(hash, c);
+            hashCombine(hash, c.dwordCount);
+        }
+
+        for (const auto& d : mRootDescriptors)
+        {
+            hashCommonDesc(hash, d);
+            hashCombine(hash, (uint32_t)d.type);
+        }
+
+        for (const auto& t : mDescriptorTables)
+        {
+            hashCombine(hash, (uint32_t)t.mVisibility);
+            for (const auto& r : t.mRanges)
+            {
+                hashCombine(hash, (uint32_t)r.type);
+                hashCombine(hash, r.firstRegIndex);
+                hashCombine(hash, r.descCount);
+                hashCombine(hash, r.regSpace);
+                hashCombine(hash, r.offsetFromTableStart);
+            }
+        }
+
+        for (const auto& s : mSamplers)
         {
-            pSig = nullptr;
+            hashCommonDesc(hash, s);
+            hashCombine(hash, (uint32_t)s.borderColor);
+            hashCombine(hash, s.pSampler.get());
         }
-        return pSig;
+        return hash;
+    }
+
+    static ObjectCache<RootSignature, RootSignature::Desc>& getRootSignatureCache()
+    {
+        static ObjectCache<RootSignature, RootSignature::Desc> sCache;
+        return sCache;
+    }
+
+    RootSignature::SharedPtr RootSignature::create(const Desc& desc)
+    {
+        return getRootSignatureCache().get(desc, [](const Desc& desc)
+        {
+            SharedPtr pSig = SharedPtr(new RootSignature(desc));
+            if (pSig->apiInit() == false)
+            {
+                pSig = nullptr;
+            }
+            return pSig;
+        });
+    }
+
+    ObjectCacheStats RootSignature::getCacheStats()
+    {
+        return getRootSignatureCache().getStats();
     }
 
     static ProgramReflection::ShaderAccess getRequiredShaderAccess(RootSignature::DescType type)
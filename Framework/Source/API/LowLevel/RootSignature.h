@@ -125,6 +125,15 @@ namespace Falcor
             Desc& addSampler(uint32_t regIndex, Sampler::SharedConstPtr pSampler, ShaderVisibility visiblityMask, BorderColor borderColor = BorderColor::OpaqueBlack, uint32_t regSpace = 0);
             Desc& addDescriptor(uint32_t regIndex, DescType type, ShaderVisibility visiblityMask, uint32_t regSpace = 0);
             Desc& addDescriptorTable(const DescriptorTable& table) { if (table.getRangeCount()) { mDescriptorTables.push_back(table); } return *this; }
+
+            /** Compare all the elements of the descs. Static samplers are compared by pointer, which works because samplers are interned by their desc.
+            */
+            bool operator==(const Desc& other) const;
+            bool operator!=(const Desc& other) const { return !(*this == other); }
+
+            /** Get a hash of the desc. Equal descs have the same hash.
+            */
+            size_t getHash() const;
         private:
             friend class RootSignature;
             std::vector<ConstantDesc> mConstants;
@@ -135,10 +144,19 @@ namespace Falcor
 
         ~RootSignature();
         static SharedPtr getEmpty();
+
+        /** Get a root signature. Programs with the same layout share a single root signature, which saves the API object and lets the state caches match it by pointer.
+            \return The root signature, or nullptr if creation failed
+        */
         static SharedPtr create(const Desc& desc);
         static SharedPtr create(const ProgramReflection* pReflection);
 
+        /** Get the number of root signatures requested and created
+        */
+        static ObjectCacheStats getCacheStats();
+
         ApiHandle getApiHandle() const { return mApiHandle; }
+        const Desc& getDesc() const { return mDesc; }
 
         size_t getDescriptorTableCount() const { return mDesc.mDescriptorTables.size(); }
         const DescriptorTable& getDescriptorTable(size_t index) const { return mDesc.mDescriptorTables[index]; }
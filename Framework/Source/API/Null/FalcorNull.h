@@ -0,0 +1,198 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+
+namespace Falcor
+{
+    class DescriptorSet;
+    /*!
+    *  \addtogroup Falcor
+    *  @{
+    */
+
+    /** The null backend doesn't talk to a GPU. Resources live in system memory, copies are executed immediately by the CPU and every other command is recorded into the command list and counted, but never executed.
+        This allows running the CPU side of the renderer on machines without a GPU, and measuring how much API work a frame generates.
+    */
+    enum class NullCommand : uint32_t
+    {
+        Draw,
+        DrawIndexed,
+        DrawIndirect,
+        Dispatch,
+        DispatchIndirect,
+        SetPipelineState,
+        SetRootSignature,
+        SetRootConstantBuffer,
+        SetRootDescriptorTable,
+        SetDescriptorHeaps,
+        SetVertexBuffers,
+        SetIndexBuffer,
+        SetRenderTargets,
+        SetViewportsAndScissors,
+        SetBlendFactor,
+        SetStencilRef,
+        ClearRtv,
+        ClearDsv,
+        ClearUav,
+        ResourceBarrier,
+        CopyResource,
+        CopyBufferRegion,
+        CopyTextureRegion,
+        BeginQuery,
+        EndQuery,
+
+        Count
+    };
+
+    /** Accumulated statistics of the work submitted to the null device. Use Device::getApiHandle() to access the object.
+    */
+    struct NullApiCounters
+    {
+        uint64_t commands[(uint32_t)NullCommand::Count] = {};
+        uint64_t commandListsSubmitted = 0;
+        uint64_t bytesCopied = 0;
+        uint64_t descriptorsCopied = 0;
+        uint64_t pipelineStatesCreated = 0;
+
+        uint64_t getCount(NullCommand command) const { return commands[(uint32_t)command]; }
+        uint64_t getDrawCount() const { return getCount(NullCommand::Draw) + getCount(NullCommand::DrawIndexed) + getCount(NullCommand::DrawIndirect); }
+        uint64_t getDispatchCount() const { return getCount(NullCommand::Dispatch) + getCount(NullCommand::DispatchIndirect); }
+        void reset() { *this = NullApiCounters(); }
+    };
+
+    struct NullDevice
+    {
+        NullApiCounters counters;
+    };
+
+    /** Opaque API object. Used for objects which only need an identity in the null backend (pipeline states, root signatures, heaps, allocators)
+    */
+    struct NullApiObject
+    {
+    };
+
+    /** A resource backed by system memory. For textures, the subresources are tightly packed in subresource-index order
+    */
+    struct NullResource
+    {
+        std::vector<uint8_t> data;
+        uint64_t getGpuAddress() const { return (uint64_t)data.data(); }
+    };
+
+    /** A descriptor references the object it was created for
+    */
+    struct NullDescriptor
+    {
+        const void* pObject = nullptr;
+    };
+
+    struct NullShaderBytecode
+    {
+        const void* pCode;
+        size_t codeSize;
+    };
+
+    class NullCommandList
+    {
+    public:
+        NullCommandList(NullApiCounters* pCounters) : mpCounters(pCounters) {}
+        void record(NullCommand command) { mCommands.push_back(command); mpCounters->commands[(uint32_t)command]++; }
+        void reset() { mCommands.clear(); }
+        const std::vector<NullCommand>& getCommands() const { return mCommands; }
+        NullApiCounters* getCounters() const { return mpCounters; }
+    private:
+        std::vector<NullCommand> mCommands;
+        NullApiCounters* mpCounters;
+    };
+
+    struct NullFence
+    {
+        uint64_t completedValue = 0;
+    };
+
+    /** Submitted command lists complete immediately, so signals are visible as soon as they are queued
+    */
+    class NullCommandQueue
+    {
+    public:
+        NullCommandQueue(NullApiCounters* pCounters) : mpCounters(pCounters) {}
+        void execute(NullCommandList* pList) { mpCounters->commandListsSubmitted++; }
+        void signal(NullFence* pFence, uint64_t value) { pFence->completedValue = value; }
+    private:
+        NullApiCounters* mpCounters;
+    };
+
+    using ApiObjectHandle = std::shared_ptr<void>;
+
+    using HeapCpuHandle = NullDescriptor*;
+    using HeapGpuHandle = NullDescriptor*;
+
+    using WindowHandle = HWND;
+    using DeviceHandle = std::shared_ptr<NullDevice>;
+    using CommandListHandle = std::shared_ptr<NullCommandList>;
+    using CommandQueueHandle = std::shared_ptr<NullCommandQueue>;
+    using CommandAllocatorHandle = std::shared_ptr<NullApiObject>;
+    using CommandSignatureHandle = std::shared_ptr<NullApiObject>;
+    using FenceHandle = std::shared_ptr<NullFence>;
+    using ResourceHandle = std::shared_ptr<NullResource>;
+    using RtvHandle = std::shared_ptr<DescriptorSet>;
+    using DsvHandle = std::shared_ptr<DescriptorSet>;
+    using SrvHandle = std::shared_ptr<DescriptorSet>;
+    using SamplerHandle = std::shared_ptr<DescriptorSet>;
+    using UavHandle = std::shared_ptr<DescriptorSet>;
+    using GpuAddress = uint64_t;
+
+    using PsoHandle = std::shared_ptr<NullApiObject>;
+    using ComputeStateHandle = std::shared_ptr<NullApiObject>;
+    using ShaderHandle = NullShaderBytecode;
+    using RootSignatureHandle = std::shared_ptr<NullApiObject>;
+    using DescriptorHeapHandle = std::shared_ptr<NullApiObject>;
+
+    using VaoHandle = void*;
+    using VertexShaderHandle = void*;
+    using FragmentShaderHandle = void*;
+    using DomainShaderHandle = void*;
+    using HullShaderHandle = void*;
+    using GeometryShaderHandle = void*;
+    using ComputeShaderHandle = void*;
+    using ProgramHandle = void*;
+    using DepthStencilStateHandle = void*;
+    using RasterizerStateHandle = void*;
+    using BlendStateHandle = void*;
+
+    static const uint32_t kSwapChainBuffers = 3;
+
+    inline constexpr uint32_t getMaxViewportCount() { return 16; }
+    /*! @} */
+}
+
+#define DEFAULT_API_MAJOR_VERSION 11
+#define DEFAULT_API_MINOR_VERSION 1
+
+#define UNSUPPORTED_IN_NULL(msg_) {Falcor::logWarning(msg_ + std::string(" is not supported by the null backend. Ignoring call."));}
@@ -0,0 +1,78 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/LowLevel/RootSignature.h"
+
+namespace Falcor
+{
+    bool RootSignature::apiInit()
+    {
+        // Use the D3D12 layout rules, so that a signature which works with the null backend also works on a real device
+        mSizeInBytes = 0;
+        size_t rootParamsCount = mDesc.mConstants.size() + mDesc.mDescriptorTables.size() + mDesc.mRootDescriptors.size();
+        mElementByteOffset.resize(rootParamsCount);
+
+        uint32_t elementIndex = 0;
+
+        // Root descriptors
+        mDescriptorIndices.resize(mDesc.mRootDescriptors.size());
+        for (size_t i = 0; i < mDesc.mRootDescriptors.size(); i++, elementIndex++)
+        {
+            mDescriptorIndices[i] = elementIndex;
+            mElementByteOffset[elementIndex] = mSizeInBytes;
+            mSizeInBytes += 8;
+        }
+
+        // Constants
+        mConstantIndices.resize(mDesc.mConstants.size());
+        for (size_t i = 0; i < mDesc.mConstants.size(); i++, elementIndex++)
+        {
+            mConstantIndices[i] = elementIndex;
+            mElementByteOffset[elementIndex] = mSizeInBytes;
+            mSizeInBytes += 4;
+        }
+
+        // Descriptor tables
+        mDescTableIndices.resize(mDesc.mDescriptorTables.size());
+        for (size_t i = 0; i < mDesc.mDescriptorTables.size(); i++, elementIndex++)
+        {
+            mDescTableIndices[i] = elementIndex;
+            mElementByteOffset[elementIndex] = mSizeInBytes;
+            mSizeInBytes += 4;
+        }
+
+        if (mSizeInBytes > sizeof(uint32_t) * 64)
+        {
+            logError("Root-signature cost is too high. Root-signatures are limited to 64 DWORDs, trying to create a signature with " + std::to_string(mSizeInBytes / sizeof(uint32_t)) + " DWORDs");
+            return false;
+        }
+
+        mApiHandle = std::make_shared<NullApiObject>();
+        return true;
+    }
+}
@@ -0,0 +1,194 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/Buffer.h"
+#include "API/Device.h"
+#include "Api/LowLevel/ResourceAllocator.h"
+
+namespace Falcor
+{
+    // Same as D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT and D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, so that buffer sizes and offsets match the D3D12 backend
+    static const size_t kConstantBufferAlignment = 256;
+    static const size_t kUploadDataAlignment = 512;
+
+    struct BufferData
+    {
+        ResourceAllocator::AllocationData dynamicData;
+    };
+
+    ResourceHandle createBuffer(size_t size)
+    {
+        ResourceHandle pApiHandle = std::make_shared<NullResource>();
+        pApiHandle->data.resize(size);
+        return pApiHandle;
+    }
+
+    Buffer::~Buffer()
+    {
+        BufferData* pApiData = (BufferData*)mpApiData;
+        gpDevice->getResourceAllocator()->release(pApiData->dynamicData);
+        safe_delete(pApiData);
+        gpDevice->releaseResource(mApiHandle);
+    }
+
+    size_t getDataAlignmentFromUsage(Buffer::BindFlags flags)
+    {
+        switch (flags)
+        {
+        case Buffer::BindFlags::Constant:
+            return kConstantBufferAlignment;
+        case Buffer::BindFlags::None:
+            return kUploadDataAlignment;
+        default:
+            return 1;
+        }
+    }
+
+    Buffer::SharedPtr Buffer::create(size_t size, BindFlags usage, CpuAccess cpuAccess, const void* pInitData)
+    {
+        Buffer::SharedPtr pBuffer = SharedPtr(new Buffer(size, usage, cpuAccess));
+        return pBuffer->init(pInitData) ? pBuffer : nullptr;
+    }
+
+    bool Buffer::init(const void* pInitData)
+    {
+        if (mBindFlags == BindFlags::Constant)
+        {
+            mSize = align_to(kConstantBufferAlignment, mSize);
+        }
+
+        BufferData* pApiData = new BufferData;
+        mpApiData = pApiData;
+        if (mCpuAccess == CpuAccess::Write)
+        {
+            mState = Resource::State::GenericRead;
+            pApiData->dynamicData = gpDevice->getResourceAllocator()->allocate(mSize, getDataAlignmentFromUsage(mBindFlags));
+            mApiHandle = pApiData->dynamicData.pResourceHandle;
+        }
+        else
+        {
+            mState = (mCpuAccess == CpuAccess::Read && mBindFlags == BindFlags::None) ? Resource::State::CopyDest : Resource::State::Common;
+            mApiHandle = createBuffer(mSize);
+        }
+
+        if (pInitData)
+        {
+            updateData(pInitData, 0, mSize);
+        }
+
+        return true;
+    }
+
+    void Buffer::updateData(const void* pData, size_t offset, size_t size) const
+    {
+        // Clamp the offset and size
+        if (adjustSizeOffsetParams(size, offset) == false)
+        {
+            logWarning("Buffer::updateData() - size and offset are invalid. Nothing to update.");
+            return;
+        }
+
+        if (mCpuAccess == CpuAccess::Write)
+        {
+            uint8_t* pDst = (uint8_t*)map(MapType::WriteDiscard) + offset;
+            memcpy(pDst, pData, size);
+        }
+        else
+        {
+            gpDevice->getRenderContext()->updateBuffer(this, pData, offset, size);
+        }
+    }
+
+    void Buffer::readData(void* pData, size_t offset, size_t size) const
+    {
+        if (adjustSizeOffsetParams(size, offset) == false)
+        {
+            logWarning("Buffer::readData() - size and offset are invalid. Nothing to read.");
+            return;
+        }
+
+        // The data lives in system memory, no need to go through a staging resource
+        const uint8_t* pSrc = (const uint8_t*)map(MapType::Read);
+        memcpy(pData, pSrc + offset, size);
+    }
+
+    void* Buffer::map(MapType type) const
+    {
+        BufferData* pApiData = (BufferData*)mpApiData;
+
+        if(type == MapType::WriteDiscard)
+        {
+            if (mCpuAccess != CpuAccess::Write)
+            {
+                logError("Trying to map a buffer for write, but it wasn't created with the write permissions");
+                return nullptr;
+            }
+
+            // Allocate a new buffer
+            gpDevice->getResourceAllocator()->release(pApiData->dynamicData);
+            pApiData->dynamicData = gpDevice->getResourceAllocator()->allocate(mSize, getDataAlignmentFromUsage(mBindFlags));
+            const_cast<Buffer*>(this)->mApiHandle = pApiData->dynamicData.pResourceHandle;
+
+            invalidateViews();
+            return pApiData->dynamicData.pData;
+        }
+        else
+        {
+            assert(type == MapType::Read);
+            return (mCpuAccess == CpuAccess::Write) ? pApiData->dynamicData.pData : mApiHandle->data.data();
+        }
+    }
+
+    uint64_t Buffer::getGpuAddress() const
+    {
+        if (mCpuAccess == CpuAccess::Write)
+        {
+            BufferData* pApiData = (BufferData*)mpApiData;
+            return pApiData->dynamicData.gpuAddress;
+        }
+        else
+        {
+            return mApiHandle->getGpuAddress();
+        }
+    }
+
+    void Buffer::unmap() const
+    {
+    }
+
+    uint64_t Buffer::makeResident(Buffer::GpuAccessFlags flags) const
+    {
+        UNSUPPORTED_IN_NULL("Buffer::makeResident()");
+        return 0;
+    }
+
+    void Buffer::evict() const
+    {
+        UNSUPPORTED_IN_NULL("Buffer::evict()");
+    }
+}
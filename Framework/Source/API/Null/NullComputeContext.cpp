@@ -0,0 +1,155 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/ComputeContext.h"
+#include "API/Device.h"
+#include "API/DescriptorSet.h"
+
+namespace Falcor
+{
+    CommandSignatureHandle ComputeContext::spDispatchCommandSig = nullptr;
+
+    ComputeContext::~ComputeContext() = default;
+
+    ComputeContext::SharedPtr ComputeContext::create()
+    {
+        SharedPtr pCtx = SharedPtr(new ComputeContext());
+        pCtx->mpLowLevelData = LowLevelContextData::create(LowLevelContextData::CommandListType::Compute);
+        if (pCtx->mpLowLevelData == nullptr)
+        {
+            return nullptr;
+        }
+        pCtx->bindDescriptorHeaps();
+
+        if (spDispatchCommandSig == nullptr)
+        {
+            initDispatchCommandSignature();
+        }
+
+        return pCtx;
+    }
+
+    void ComputeContext::prepareForDispatch()
+    {
+        assert(mpComputeState);
+
+        // Bind the root signature and the root signature data
+        if (mpComputeVars)
+        {
+            mpComputeVars->apply(const_cast<ComputeContext*>(this));
+        }
+        else
+        {
+            mpLowLevelData->getCommandList()->record(NullCommand::SetRootSignature);
+            setBoundVarsId(false, 0);
+        }
+
+        mpComputeState->getCSO(mpComputeVars.get());
+        mpLowLevelData->getCommandList()->record(NullCommand::SetPipelineState);
+        mCommandsPending = true;
+    }
+
+    void ComputeContext::dispatch(uint32_t groupSizeX, uint32_t groupSizeY, uint32_t groupSizeZ)
+    {
+        prepareForDispatch();
+        mpLowLevelData->getCommandList()->record(NullCommand::Dispatch);
+    }
+
+    void ComputeContext::clearUAV(const UnorderedAccessView* pUav, const vec4& value)
+    {
+        resourceBarrier(pUav->getResource(), Resource::State::UnorderedAccess);
+        mpLowLevelData->getCommandList()->record(NullCommand::ClearUav);
+        mCommandsPending = true;
+    }
+
+    void ComputeContext::clearUAV(const UnorderedAccessView* pUav, const uvec4& value)
+    {
+        resourceBarrier(pUav->getResource(), Resource::State::UnorderedAccess);
+        mpLowLevelData->getCommandList()->record(NullCommand::ClearUav);
+        mCommandsPending = true;
+    }
+
+    void ComputeContext::clearUAVCounter(const StructuredBuffer::SharedPtr& pBuffer, uint32_t value)
+    {
+        if (pBuffer->hasUAVCounter())
+        {
+            clearUAV(pBuffer->getUAVCounter()->getUAV().get(), uvec4(value));
+        }
+    }
+
+    void ComputeContext::pushComputeVars(const ComputeVars::SharedPtr& pVars)
+    {
+        mpComputeVarsStack.push(mpComputeVars);
+        setComputeVars(pVars);
+    }
+
+    void ComputeContext::popComputeVars()
+    {
+        if (mpComputeVarsStack.empty())
+        {
+            logWarning("Can't pop from the compute vars stack. The stack is empty");
+            return;
+        }
+
+        setComputeVars(mpComputeVarsStack.top());
+        mpComputeVarsStack.pop();
+    }
+
+    void ComputeContext::pushComputeState(const ComputeState::SharedPtr& pState)
+    {
+        mpComputeStateStack.push(mpComputeState);
+        setComputeState(pState);
+    }
+
+    void ComputeContext::popComputeState()
+    {
+        if (mpComputeStateStack.empty())
+        {
+            logWarning("Can't pop from the compute state stack. The stack is empty");
+            return;
+        }
+
+        setComputeState(mpComputeStateStack.top());
+        mpComputeStateStack.pop();
+    }
+
+    void ComputeContext::initDispatchCommandSignature()
+    {
+        spDispatchCommandSig = std::make_shared<NullApiObject>();
+    }
+
+    void ComputeContext::dispatchIndirect(const Buffer* argBuffer, uint64_t argBufferOffset)
+    {
+        prepareForDispatch();
+        resourceBarrier(argBuffer, Resource::State::IndirectArg);
+        mpLowLevelData->getCommandList()->record(NullCommand::DispatchIndirect);
+    }
+
+    void ComputeContext::applyComputeVars() {}
+    void ComputeContext::applyComputeState() {}
+}
@@ -0,0 +1,207 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/CopyContext.h"
+#include "API/Device.h"
+#include "API/Buffer.h"
+#include "NullResource.h"
+
+namespace Falcor
+{
+    CopyContext::~CopyContext() = default;
+
+    CopyContext::SharedPtr CopyContext::create()
+    {
+        SharedPtr pCtx = SharedPtr(new CopyContext());
+        pCtx->mpLowLevelData = LowLevelContextData::create(LowLevelContextData::CommandListType::Copy);
+        return pCtx->mpLowLevelData ? pCtx : nullptr;
+    }
+
+    void CopyContext::bindDescriptorHeaps()
+    {
+        mpLowLevelData->getCommandList()->record(NullCommand::SetDescriptorHeaps);
+    }
+
+    void CopyContext::reset()
+    {
+        flush();
+        mpLowLevelData->reset();
+        invalidateBoundVars();
+        bindDescriptorHeaps();
+    }
+
+    void CopyContext::flush(bool wait)
+    {
+        if (mCommandsPending)
+        {
+            mpLowLevelData->flush();
+            mCommandsPending = false;
+            invalidateBoundVars();
+            bindDescriptorHeaps();
+        }
+
+        if (wait)
+        {
+            mpLowLevelData->getFence()->syncCpu();
+        }
+    }
+
+    // Copies are executed when they are recorded. Nothing else can observe the memory in-between, since all the work submitted to the null device completes immediately.
+    // Buffers are addressed through their GPU address, which is the system-memory address of the data (dynamic buffers are sub-allocated from a larger page).
+    static uint8_t* getResourceData(const Resource* pResource)
+    {
+        if (pResource->getType() == Resource::Type::Buffer)
+        {
+            return (uint8_t*)dynamic_cast<const Buffer*>(pResource)->getGpuAddress();
+        }
+        return pResource->getApiHandle()->data.data();
+    }
+
+    static void copyData(CommandListHandle pList, NullCommand command, uint8_t* pDst, const uint8_t* pSrc, size_t size)
+    {
+        memcpy(pDst, pSrc, size);
+        pList->record(command);
+        pList->getCounters()->bytesCopied += size;
+    }
+
+    void CopyContext::updateBuffer(const Buffer* pBuffer, const void* pData, size_t offset, size_t size)
+    {
+        if (size == 0)
+        {
+            size = pBuffer->getSize() - offset;
+        }
+
+        if (pBuffer->adjustSizeOffsetParams(size, offset) == false)
+        {
+            logWarning("CopyContext::updateBuffer() - size and offset are invalid. Nothing to update.");
+            return;
+        }
+
+        mCommandsPending = true;
+        resourceBarrier(pBuffer, Resource::State::CopyDest);
+        copyData(mpLowLevelData->getCommandList(), NullCommand::CopyBufferRegion, getResourceData(pBuffer) + offset, (const uint8_t*)pData, size);
+    }
+
+    void CopyContext::updateTextureSubresources(const Texture* pTexture, uint32_t firstSubresource, uint32_t subresourceCount, const void* pData)
+    {
+        mCommandsPending = true;
+        assert(firstSubresource + subresourceCount <= getSubresourceCount(pTexture));
+
+        resourceBarrier(pTexture, Resource::State::CopyDest);
+
+        // The source data uses the same tightly packed layout as the texture storage
+        uint8_t* pDst = getResourceData(pTexture);
+        const uint8_t* pSrc = (const uint8_t*)pData;
+        size_t offset = getSubresourceOffset(pTexture, firstSubresource);
+        for (uint32_t s = 0; s < subresourceCount; s++)
+        {
+            size_t size = getSubresourceSize(pTexture, firstSubresource + s);
+            copyData(mpLowLevelData->getCommandList(), NullCommand::CopyTextureRegion, pDst + offset, pSrc, size);
+            pSrc += size;
+            offset += size;
+        }
+    }
+
+    void CopyContext::updateTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex, const void* pData)
+    {
+        mCommandsPending = true;
+        updateTextureSubresources(pTexture, subresourceIndex, 1, pData);
+    }
+
+    std::vector<uint8> CopyContext::readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
+    {
+        RenderContext* pContext = gpDevice->getRenderContext().get();
+        pContext->resourceBarrier(pTexture, Resource::State::CopySource);
+
+        std::vector<uint8> result(getSubresourceSize(pTexture, subresourceIndex));
+        const uint8_t* pSrc = getResourceData(pTexture) + getSubresourceOffset(pTexture, subresourceIndex);
+        copyData(mpLowLevelData->getCommandList(), NullCommand::CopyTextureRegion, result.data(), pSrc, result.size());
+        mCommandsPending = true;
+        pContext->flush(true);
+        return result;
+    }
+
+    void CopyContext::updateTexture(const Texture* pTexture, const void* pData)
+    {
+        mCommandsPending = true;
+        updateTextureSubresources(pTexture, 0, getSubresourceCount(pTexture), pData);
+    }
+
+    void CopyContext::resourceBarrier(const Resource* pResource, Resource::State newState)
+    {
+        if (pResource->getState() != newState)
+        {
+            mpLowLevelData->getCommandList()->record(NullCommand::ResourceBarrier);
+            mCommandsPending = true;
+            pResource->mState = newState;
+        }
+    }
+
+    void CopyContext::copyResource(const Resource* pDst, const Resource* pSrc)
+    {
+        resourceBarrier(pDst, Resource::State::CopyDest);
+        resourceBarrier(pSrc, Resource::State::CopySource);
+
+        size_t size;
+        if (pDst->getType() == Resource::Type::Buffer)
+        {
+            size = dynamic_cast<const Buffer*>(pDst)->getSize();
+        }
+        else
+        {
+            size = pDst->getApiHandle()->data.size();
+        }
+        copyData(mpLowLevelData->getCommandList(), NullCommand::CopyResource, getResourceData(pDst), getResourceData(pSrc), size);
+        mCommandsPending = true;
+    }
+
+    void CopyContext::copySubresource(const Resource* pDst, uint32_t dstSubresourceIdx, const Resource* pSrc, uint32_t srcSubresourceIdx)
+    {
+        resourceBarrier(pDst, Resource::State::CopyDest);
+        resourceBarrier(pSrc, Resource::State::CopySource);
+
+        const Texture* pDstTexture = dynamic_cast<const Texture*>(pDst);
+        const Texture* pSrcTexture = dynamic_cast<const Texture*>(pSrc);
+        assert(pDstTexture && pSrcTexture);
+        size_t size = getSubresourceSize(pDstTexture, dstSubresourceIdx);
+        assert(size == getSubresourceSize(pSrcTexture, srcSubresourceIdx));
+
+        uint8_t* pDstData = getResourceData(pDst) + getSubresourceOffset(pDstTexture, dstSubresourceIdx);
+        const uint8_t* pSrcData = getResourceData(pSrc) + getSubresourceOffset(pSrcTexture, srcSubresourceIdx);
+        copyData(mpLowLevelData->getCommandList(), NullCommand::CopyTextureRegion, pDstData, pSrcData, size);
+        mCommandsPending = true;
+    }
+
+    void CopyContext::copyBufferRegion(const Resource* pDst, uint64_t dstOffset, const Resource* pSrc, uint64_t srcOffset, uint64_t numBytes)
+    {
+        resourceBarrier(pDst, Resource::State::CopyDest);
+        resourceBarrier(pSrc, Resource::State::CopySource);
+        copyData(mpLowLevelData->getCommandList(), NullCommand::CopyBufferRegion, getResourceData(pDst) + dstOffset, getResourceData(pSrc) + srcOffset, numBytes);
+        mCommandsPending = true;
+    }
+}
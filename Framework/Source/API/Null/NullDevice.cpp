@@ -0,0 +1,295 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Sample.h"
+#include "API/Device.h"
+#include "API/LowLevel/GpuFence.h"
+
+namespace Falcor
+{
+    Device::SharedPtr gpDevice;
+
+    /** The null device has no swap-chain. The back-buffers are plain textures, which are cycled through on present()
+    */
+    struct DeviceData
+    {
+        uint32_t currentBackBufferIndex = 0;
+
+        struct ResourceRelease
+        {
+            size_t frameID;
+            ApiObjectHandle pApiObject;
+        };
+
+        struct
+        {
+            Fbo::SharedPtr pFbo;
+        } frameData[kSwapChainBuffers];
+
+        std::queue<ResourceRelease> deferredReleases;
+        uint32_t syncInterval = 0;
+        GpuFence::SharedPtr pFrameFence;
+    };
+
+    void releaseFboData(DeviceData* pData)
+    {
+        // First, delete all FBOs
+        for (uint32_t i = 0; i < arraysize(pData->frameData); i++)
+        {
+            pData->frameData[i].pFbo->attachColorTarget(nullptr, 0);
+            pData->frameData[i].pFbo->attachDepthStencilTarget(nullptr);
+        }
+
+        // Now execute all deferred releases
+        decltype(pData->deferredReleases)().swap(pData->deferredReleases);
+    }
+
+    void d3dTraceHR(const std::string& msg, HRESULT hr)
+    {
+        char hr_msg[512];
+        FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM, nullptr, hr, 0, hr_msg, ARRAYSIZE(hr_msg), nullptr);
+
+        std::string error_msg = msg + ".\nError! " + hr_msg;
+        logError(error_msg);
+    }
+
+    D3D_FEATURE_LEVEL getD3DFeatureLevel(uint32_t majorVersion, uint32_t minorVersion)
+    {
+        if(majorVersion == 12)
+        {
+            switch(minorVersion)
+            {
+            case 0:
+                return D3D_FEATURE_LEVEL_12_0;
+            case 1:
+                return D3D_FEATURE_LEVEL_12_1;
+            }
+        }
+        else if(majorVersion == 11)
+        {
+            switch(minorVersion)
+            {
+            case 0:
+                return D3D_FEATURE_LEVEL_11_1;
+            case 1:
+                return D3D_FEATURE_LEVEL_11_0;
+            }
+        }
+        else if(majorVersion == 10)
+        {
+            switch(minorVersion)
+            {
+            case 0:
+                return D3D_FEATURE_LEVEL_10_0;
+            case 1:
+                return D3D_FEATURE_LEVEL_10_1;
+            }
+        }
+        else if(majorVersion == 9)
+        {
+            switch(minorVersion)
+            {
+            case 1:
+                return D3D_FEATURE_LEVEL_9_1;
+            case 2:
+                return D3D_FEATURE_LEVEL_9_2;
+            case 3:
+                return D3D_FEATURE_LEVEL_9_3;
+            }
+        }
+        return (D3D_FEATURE_LEVEL)0;
+    }
+
+    bool Device::updateDefaultFBO(uint32_t width, uint32_t height, ResourceFormat colorFormat, ResourceFormat depthFormat)
+    {
+        DeviceData* pData = (DeviceData*)mpPrivateData;
+
+        for (uint32_t i = 0; i < kSwapChainBuffers; i++)
+        {
+            // Create the FBO if it's required
+            if (pData->frameData[i].pFbo == nullptr)
+            {
+                pData->frameData[i].pFbo = Fbo::create();
+            }
+
+            auto pColorTex = Texture::create2D(width, height, colorFormat, 1, 1, nullptr, Texture::BindFlags::RenderTarget);
+            if (pColorTex == nullptr)
+            {
+                logError("Failed to create back-buffer " + std::to_string(i));
+                return false;
+            }
+            pData->frameData[i].pFbo->attachColorTarget(pColorTex, 0);
+
+            // Create a depth texture
+            if(depthFormat != ResourceFormat::Unknown)
+            {
+                auto pDepth = Texture::create2D(width, height, depthFormat, 1, 1, nullptr, Texture::BindFlags::DepthStencil);
+                pData->frameData[i].pFbo->attachDepthStencilTarget(pDepth);
+            }
+        }
+        pData->currentBackBufferIndex = 0;
+
+        return true;
+    }
+
+    void Device::cleanup()
+    {
+        mpRenderContext->flush(true);
+        // Release all the bound resources. Need to do that before deleting the RenderContext
+        mpRenderContext->setGraphicsState(nullptr);
+        mpRenderContext->setGraphicsVars(nullptr);
+        mpRenderContext->setComputeState(nullptr);
+        mpRenderContext->setComputeVars(nullptr);
+        DeviceData* pData = (DeviceData*)mpPrivateData;
+        releaseFboData(pData);
+        mpRenderContext.reset();
+        mpResourceAllocator.reset();
+        safe_delete(pData);
+        mpWindow.reset();
+    }
+
+    Device::SharedPtr Device::create(Window::SharedPtr& pWindow, const Device::Desc& desc)
+    {
+        if(gpDevice)
+        {
+            logError("Null backend only supports a single device");
+            return false;
+        }
+        gpDevice = SharedPtr(new Device(pWindow));
+        if(gpDevice->init(desc) == false)
+        {
+            gpDevice = nullptr;
+        }
+        return gpDevice;
+    }
+
+    Fbo::SharedPtr Device::getSwapChainFbo() const
+    {
+        DeviceData* pData = (DeviceData*)mpPrivateData;
+        return pData->frameData[pData->currentBackBufferIndex].pFbo;
+    }
+
+    void Device::present()
+    {
+        DeviceData* pData = (DeviceData*)mpPrivateData;
+
+        mpRenderContext->resourceBarrier(pData->frameData[pData->currentBackBufferIndex].pFbo->getColorTexture(0).get(), Resource::State::Present);
+        mpRenderContext->flush();
+        pData->pFrameFence->gpuSignal(mpRenderContext->getLowLevelData()->getCommandQueue());
+        executeDeferredReleases();
+        mpRenderContext->reset();
+        pData->currentBackBufferIndex = (pData->currentBackBufferIndex + 1) % kSwapChainBuffers;
+        mFrameID++;
+    }
+
+    bool Device::init(const Desc& desc)
+    {
+        DeviceData* pData = new DeviceData;
+        mpPrivateData = pData;
+        mApiHandle = std::make_shared<NullDevice>();
+
+        mpRenderContext = RenderContext::create();
+        // Create the descriptor heaps
+        DescriptorPool::Desc poolDesc;
+        poolDesc.setDescCount(DescriptorPool::Type::Srv, 16 * 1024).setDescCount(DescriptorPool::Type::Sampler, 2048).setShaderVisible(true);
+        mpGpuDescPool = DescriptorPool::create(poolDesc, mpRenderContext->getLowLevelData()->getFence());
+        poolDesc.setShaderVisible(false).setDescCount(DescriptorPool::Type::Rtv, 1024).setDescCount(DescriptorPool::Type::Dsv, 1024);
+        mpCpuDescPool = DescriptorPool::create(poolDesc, mpRenderContext->getLowLevelData()->getFence());
+
+        mpRenderContext->reset();
+
+        mpResourceAllocator = ResourceAllocator::create(1024 * 1024 * 2, mpRenderContext->getLowLevelData()->getFence());
+        mVsyncOn = desc.enableVsync;
+
+        // Create the back-buffers
+        if (updateDefaultFBO(mpWindow->getClientAreaWidth(), mpWindow->getClientAreaHeight(), desc.colorFormat, desc.depthFormat) == false)
+        {
+            return false;
+        }
+
+        pData->pFrameFence = GpuFence::create();
+        return true;
+    }
+
+    void Device::releaseResource(ApiObjectHandle pResource)
+    {
+        if(pResource)
+        {
+            DeviceData* pData = (DeviceData*)mpPrivateData;
+            pData->deferredReleases.push({ pData->pFrameFence->getCpuValue(), pResource });
+        }
+    }
+
+    void Device::executeDeferredReleases()
+    {
+        mpResourceAllocator->executeDeferredReleases();
+        DeviceData* pData = (DeviceData*)mpPrivateData;
+        uint64_t gpuVal = pData->pFrameFence->getGpuValue();
+        while (pData->deferredReleases.size() && pData->deferredReleases.front().frameID < gpuVal)
+        {
+            pData->deferredReleases.pop();
+        }
+        mpCpuDescPool->executeDeferredReleases();
+        mpGpuDescPool->executeDeferredReleases();
+    }
+
+    Fbo::SharedPtr Device::resizeSwapChain(uint32_t width, uint32_t height)
+    {
+        mpRenderContext->flush(true);
+
+        DeviceData* pData = (DeviceData*)mpPrivateData;
+
+        // Store the FBO parameters
+        ResourceFormat colorFormat = pData->frameData[0].pFbo->getColorTexture(0)->getFormat();
+        const auto& pDepth = pData->frameData[0].pFbo->getDepthStencilTexture();
+        ResourceFormat depthFormat = pDepth ? pDepth->getFormat() : ResourceFormat::Unknown;
+        assert(pData->frameData[0].pFbo->getSampleCount() == 1);
+
+        // Delete all the FBOs
+        releaseFboData(pData);
+        updateDefaultFBO(width, height, colorFormat, depthFormat);
+
+        return getSwapChainFbo();
+    }
+
+    void Device::setVSync(bool enable)
+    {
+        DeviceData* pData = (DeviceData*)mpPrivateData;
+        pData->syncInterval = enable ? 1 : 0;
+    }
+
+    bool Device::isWindowOccluded() const
+    {
+        return false;
+    }
+
+    bool Device::isExtensionSupported(const std::string& name)
+    {
+        return false;
+    }
+}
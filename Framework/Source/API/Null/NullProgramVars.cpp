@@ -0,0 +1,207 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/ProgramVars.h"
+#include "API/Buffer.h"
+#include "API/CopyContext.h"
+#include "API/RenderContext.h"
+#include "API/DescriptorSet.h"
+#include "API/Device.h"
+
+namespace Falcor
+{
+    static void copyDescriptor(HeapCpuHandle dst, HeapCpuHandle src)
+    {
+        *dst = *src;
+        gpDevice->getApiHandle()->counters.descriptorsCopied++;
+    }
+
+    static void transitionResource(CopyContext* pContext, const Resource* pResource, Resource::State state, ProgramVars::ApplyStats& stats)
+    {
+        if (pResource->getState() != state)
+        {
+            pContext->resourceBarrier(pResource, state);
+            stats.barriersEmitted++;
+        }
+    }
+
+    template<typename ViewType, bool isUav>
+    void bindUavSrvCommon(CopyContext* pContext, const ProgramVars::ResourceMap<ViewType>& resMap, bool bindAll, ProgramVars::ApplyStats& stats)
+    {
+        CommandListHandle pList = pContext->getLowLevelData()->getCommandList();
+        for (auto& resIt : resMap)
+        {
+            auto& resDesc = resIt.second;
+            const Resource* pResource = resDesc.pResource.get();
+
+            // The resource still has to be uploaded and transitioned, even if the descriptor is already bound
+            if (pResource)
+            {
+                // If it's a typed buffer, upload it to the GPU
+                const TypedBufferBase* pTypedBuffer = (resDesc.kind == ProgramVars::ResourceKind::TypedBuffer) ? static_cast<const TypedBufferBase*>(pResource) : nullptr;
+                if (pTypedBuffer)
+                {
+                    pTypedBuffer->uploadToGPU();
+                }
+                const StructuredBuffer* pStructured = (resDesc.kind == ProgramVars::ResourceKind::StructuredBuffer) ? static_cast<const StructuredBuffer*>(pResource) : nullptr;
+                if (pStructured)
+                {
+                    pStructured->uploadToGPU();
+
+                    if (isUav && pStructured->hasUAVCounter())
+                    {
+                        transitionResource(pContext, pStructured->getUAVCounter().get(), Resource::State::UnorderedAccess, stats);
+                    }
+                }
+
+                transitionResource(pContext, pResource, isUav ? Resource::State::UnorderedAccess : Resource::State::ShaderResource, stats);
+                if (isUav)
+                {
+                    if (pTypedBuffer)
+                    {
+                        pTypedBuffer->setGpuCopyDirty();
+                    }
+                    if (pStructured)
+                    {
+                        pStructured->setGpuCopyDirty();
+                    }
+                }
+            }
+
+            // Allocate a GPU descriptor. A new set means the root parameter is stale.
+            bool bind = bindAll;
+            if (resDesc.pDescSet == nullptr)
+            {
+                ViewType::ApiHandle handle = pResource ? resDesc.pView->getApiHandle() : (isUav ? UnorderedAccessView::getNullView()->getApiHandle() : ShaderResourceView::getNullView()->getApiHandle());
+                DescriptorSet::Layout layout;
+                layout.addRange(isUav ? DescriptorSet::Type::Uav : DescriptorSet::Type::Srv, 1);
+                resDesc.pDescSet = DescriptorSet::create(gpDevice->getGpuDescriptorPool(), layout);
+                auto srcHandle = handle->getCpuHandle(0);
+                auto dstHandle = resDesc.pDescSet->getCpuHandle(0);
+                copyDescriptor(dstHandle, srcHandle);
+                bind = true;
+            }
+
+            if (bind)
+            {
+                pList->record(NullCommand::SetRootDescriptorTable);
+                stats.bindingsEmitted++;
+            }
+            else
+            {
+                stats.bindingsSkipped++;
+            }
+        }
+    }
+
+    template<bool forGraphics, typename ContextType>
+    void ProgramVars::applyCommon(ContextType* pContext) const
+    {
+        CommandListHandle pList = pContext->getLowLevelData()->getCommandList();
+        ApplyStats stats;
+        stats.applyCount = 1;
+
+        // See D3D12ProgramVars.cpp. The null command list follows the same rules as a D3D12 command list.
+        bool bindAll = (pContext->getBoundVarsId(forGraphics) != mId) || (mpLastApplyContext != pContext);
+        if (bindAll)
+        {
+            pList->record(NullCommand::SetRootSignature);
+            pContext->setBoundVarsId(forGraphics, mId);
+            mpLastApplyContext = pContext;
+            stats.fullApplyCount = 1;
+        }
+
+        // Bind the constant-buffers
+        for (auto& bufIt : mAssignedCbs)
+        {
+            const ConstantBuffer* pCB = static_cast<const ConstantBuffer*>(bufIt.second.pResource.get());
+            pCB->uploadToGPU();
+            uint64_t gpuAddress = pCB->getGpuAddress();
+            if (bindAll || gpuAddress != bufIt.second.boundGpuAddress)
+            {
+                pList->record(NullCommand::SetRootConstantBuffer);
+                bufIt.second.boundGpuAddress = gpuAddress;
+                stats.bindingsEmitted++;
+            }
+            else
+            {
+                stats.bindingsSkipped++;
+            }
+        }
+
+        // Bind the SRVs and UAVs
+        bindUavSrvCommon<ShaderResourceView, false>(pContext, mAssignedSrvs, bindAll, stats);
+        bindUavSrvCommon<UnorderedAccessView, true>(pContext, mAssignedUavs, bindAll, stats);
+
+        // Bind the samplers
+        for (auto& samplerIt : mAssignedSamplers)
+        {
+            bool bind = bindAll;
+
+            // Allocate a GPU descriptor
+            if (samplerIt.second.pDescSet == nullptr)
+            {
+                const Sampler* pSampler = samplerIt.second.pSampler.get();
+                if (pSampler == nullptr)
+                {
+                    pSampler = Sampler::getDefault().get();
+                }
+
+                DescriptorSet::Layout layout;
+                layout.addRange(DescriptorSet::Type::Sampler, 1);
+                samplerIt.second.pDescSet = DescriptorSet::create(gpDevice->getGpuDescriptorPool(), layout);
+                auto srcHandle = pSampler->getApiHandle()->getCpuHandle(0);
+                auto dstHandle = samplerIt.second.pDescSet->getCpuHandle(0);
+                copyDescriptor(dstHandle, srcHandle);
+                bind = true;
+            }
+
+            if (bind)
+            {
+                pList->record(NullCommand::SetRootDescriptorTable);
+                stats.bindingsEmitted++;
+            }
+            else
+            {
+                stats.bindingsSkipped++;
+            }
+        }
+
+        recordApplyStats(stats);
+    }
+
+    void ComputeVars::apply(ComputeContext* pContext) const
+    {
+        applyCommon<false>(pContext);
+    }
+
+    void GraphicsVars::apply(RenderContext* pContext) const
+    {
+        applyCommon<true>(pContext);
+    }
+}
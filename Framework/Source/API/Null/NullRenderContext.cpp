@@ -0,0 +1,198 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/RenderContext.h"
+#include "API/Device.h"
+#include "API/DescriptorSet.h"
+
+namespace Falcor
+{
+    RenderContext::SharedPtr RenderContext::create()
+    {
+        SharedPtr pCtx = SharedPtr(new RenderContext());
+        pCtx->mpLowLevelData = LowLevelContextData::create(LowLevelContextData::CommandListType::Direct);
+        if (pCtx->mpLowLevelData == nullptr)
+        {
+            return nullptr;
+        }
+
+        if (spDrawCommandSig == nullptr)
+        {
+            initDrawCommandSignatures();
+        }
+
+        return pCtx;
+    }
+
+    void RenderContext::clearFbo(const Fbo* pFbo, const glm::vec4& color, float depth, uint8_t stencil, FboAttachmentType flags)
+    {
+        bool clearDepth = (flags & FboAttachmentType::Depth) != FboAttachmentType::None;
+        bool clearColor = (flags & FboAttachmentType::Color) != FboAttachmentType::None;
+        bool clearStencil = (flags & FboAttachmentType::Stencil) != FboAttachmentType::None;
+
+        if(clearColor)
+        {
+            for(uint32_t i = 0 ; i < Fbo::getMaxColorTargetCount() ; i++)
+            {
+                if(pFbo->getColorTexture(i))
+                {
+                    clearRtv(pFbo->getRenderTargetView(i).get(), color);
+                }
+            }
+        }
+
+        if(clearDepth | clearStencil)
+        {
+            clearDsv(pFbo->getDepthStencilView().get(), depth, stencil, clearDepth, clearStencil);
+        }
+    }
+
+    void RenderContext::clearRtv(const RenderTargetView* pRtv, const glm::vec4& color)
+    {
+        resourceBarrier(pRtv->getResource(), Resource::State::RenderTarget);
+        mpLowLevelData->getCommandList()->record(NullCommand::ClearRtv);
+        mCommandsPending = true;
+    }
+
+    void RenderContext::clearDsv(const DepthStencilView* pDsv, float depth, uint8_t stencil, bool clearDepth, bool clearStencil)
+    {
+        resourceBarrier(pDsv->getResource(), Resource::State::DepthStencil);
+        mpLowLevelData->getCommandList()->record(NullCommand::ClearDsv);
+        mCommandsPending = true;
+    }
+
+    static void NullSetVao(CommandListHandle pList, const Vao* pVao)
+    {
+        pList->record(NullCommand::SetVertexBuffers);
+        if (pVao && pVao->getIndexBuffer())
+        {
+            pList->record(NullCommand::SetIndexBuffer);
+        }
+    }
+
+    static void NullSetFbo(RenderContext* pCtx, const Fbo* pFbo)
+    {
+        if (pFbo)
+        {
+            for (uint32_t i = 0; i < Fbo::getMaxColorTargetCount(); i++)
+            {
+                auto& pTexture = pFbo->getColorTexture(i);
+                if (pTexture)
+                {
+                    pCtx->resourceBarrier(pTexture.get(), Resource::State::RenderTarget);
+                }
+            }
+
+            auto& pTexture = pFbo->getDepthStencilTexture();
+            if (pTexture)
+            {
+                pCtx->resourceBarrier(pTexture.get(), Resource::State::DepthStencil);
+            }
+        }
+
+        pCtx->getLowLevelData()->getCommandList()->record(NullCommand::SetRenderTargets);
+    }
+
+    void RenderContext::prepareForDraw()
+    {
+        assert(mpGraphicsState);
+        assert(mpGraphicsState->isSinglePassStereoEnabled() == false);
+
+        // Bind the root signature and the root signature data
+        if (mpGraphicsVars)
+        {
+            mpGraphicsVars->apply(const_cast<RenderContext*>(this));
+        }
+        else
+        {
+            mpLowLevelData->getCommandList()->record(NullCommand::SetRootSignature);
+            setBoundVarsId(true, 0);
+        }
+
+        CommandListHandle pList = mpLowLevelData->getCommandList();
+        NullSetVao(pList, mpGraphicsState->getVao().get());
+        NullSetFbo(this, mpGraphicsState->getFbo().get());
+        pList->record(NullCommand::SetViewportsAndScissors);
+
+        // Fetching the GSO goes through the same state-object cache as the GPU backends
+        mpGraphicsState->getGSO(mpGraphicsVars.get());
+        pList->record(NullCommand::SetPipelineState);
+        if (mpGraphicsState->getBlendState() != nullptr)
+        {
+            pList->record(NullCommand::SetBlendFactor);
+        }
+        pList->record(NullCommand::SetStencilRef);
+
+        mCommandsPending = true;
+    }
+
+    void RenderContext::drawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation)
+    {
+        prepareForDraw();
+        mpLowLevelData->getCommandList()->record(NullCommand::Draw);
+    }
+
+    void RenderContext::draw(uint32_t vertexCount, uint32_t startVertexLocation)
+    {
+        drawInstanced(vertexCount, 1, startVertexLocation, 0);
+    }
+
+    void RenderContext::drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int baseVertexLocation, uint32_t startInstanceLocation)
+    {
+        prepareForDraw();
+        mpLowLevelData->getCommandList()->record(NullCommand::DrawIndexed);
+    }
+
+    void RenderContext::drawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int baseVertexLocation)
+    {
+        drawIndexedInstanced(indexCount, 1, startIndexLocation, baseVertexLocation, 0);
+    }
+
+    void RenderContext::drawIndirect(const Buffer* argBuffer, uint64_t argBufferOffset)
+    {
+        prepareForDraw();
+        resourceBarrier(argBuffer, Resource::State::IndirectArg);
+        mpLowLevelData->getCommandList()->record(NullCommand::DrawIndirect);
+    }
+
+    void RenderContext::drawIndexedIndirect(const Buffer* argBuffer, uint64_t argBufferOffset)
+    {
+        prepareForDraw();
+        resourceBarrier(argBuffer, Resource::State::IndirectArg);
+        mpLowLevelData->getCommandList()->record(NullCommand::DrawIndirect);
+    }
+
+    void RenderContext::initDrawCommandSignatures()
+    {
+        spDrawCommandSig = std::make_shared<NullApiObject>();
+        spDrawIndexCommandSig = std::make_shared<NullApiObject>();
+    }
+
+    void RenderContext::applyProgramVars() {}
+    void RenderContext::applyGraphicsState() {}
+}
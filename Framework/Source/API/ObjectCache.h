@@ -0,0 +1,123 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+    /** Mix the hash of a value into a seed. Used to hash descs field by field.
+    */
+    template<typename T>
+    inline void hashCombine(size_t& seed, const T& value)
+    {
+        seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    /** Statistics of an ObjectCache
+    */
+    struct ObjectCacheStats
+    {
+        uint64_t requested = 0;     ///< Number of objects requested from the cache
+        uint64_t created = 0;       ///< Number of objects which had to be created, because no live object had an equal desc
+    };
+
+    /** Interns immutable objects created from a desc, so that equal descs share a single object. Sharing the objects lets the state-object caches compare them by pointer.
+        Lookups hash the desc and compare it to the desc of each cached object with the same hash.
+        Entries hold a weak reference to the object, so objects are still released once the application stops using them.
+        \tparam ObjectType The cached object. Must have a getDesc() function.
+        \tparam DescType The desc. Must have getHash() and operator==().
+    */
+    template<typename ObjectType, typename DescType>
+    class ObjectCache
+    {
+    public:
+        using ObjectPtr = std::shared_ptr<ObjectType>;
+
+        /** Get an object with an equal desc, creating it if the cache doesn't have a live one. This function is thread-safe.
+            \param[in] desc The object's desc
+            \param[in] createFunc Function with the signature ObjectPtr(const DescType& desc), called when the object is not found in the cache. If it returns nullptr, nothing is cached.
+        */
+        template<typename CreateFunc>
+        ObjectPtr get(const DescType& desc, CreateFunc createFunc)
+        {
+            size_t hash = desc.getHash();
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.requested++;
+
+            auto& entries = mEntries[hash];
+            for(const auto& pEntry : entries)
+            {
+                ObjectPtr pObject = pEntry.lock();
+                if(pObject && pObject->getDesc() == desc)
+                {
+                    return pObject;
+                }
+            }
+
+            ObjectPtr pObject = createFunc(desc);
+            if(pObject)
+            {
+                removeExpiredEntries(entries);
+                entries.push_back(pObject);
+                mStats.created++;
+            }
+            return pObject;
+        }
+
+        ObjectCacheStats getStats() const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mStats;
+        }
+
+    private:
+        static void removeExpiredEntries(std::vector<std::weak_ptr<ObjectType>>& entries)
+        {
+            size_t count = 0;
+            for(size_t i = 0; i < entries.size(); i++)
+            {
+                if(entries[i].expired() == false)
+                {
+                    if(count != i)
+                    {
+                        entries[count] = std::move(entries[i]);
+                    }
+                    count++;
+                }
+            }
+            entries.resize(count);
+        }
+
+        mutable std::mutex mMutex;
+        std::unordered_map<size_t, std::vector<std::weak_ptr<ObjectType>>> mEntries;
+        ObjectCacheStats mStats;
+    };
+}
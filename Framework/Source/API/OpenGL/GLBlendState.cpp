@@ -33,7 +33,7 @@ namespace Falcor
 {
     BlendState::~BlendState() = default;
     
-    BlendState::SharedPtr BlendState::create(const Desc& desc)
+    BlendState::SharedPtr BlendState::apiCreate(const Desc& desc)
     {
         return SharedPtr(new BlendState(desc));
     }
@@ -33,7 +33,7 @@ namespace Falcor
 {
     DepthStencilState::~DepthStencilState() = default;
 
-    DepthStencilState::SharedPtr DepthStencilState::create(const Desc& Desc)
+    DepthStencilState::SharedPtr DepthStencilState::apiCreate(const Desc& Desc)
     {
         return SharedPtr(new DepthStencilState(Desc));
     }
@@ -133,7 +133,7 @@ namespace Falcor
         return (uint32_t)f;
     }
 
-    Sampler::SharedPtr Sampler::create(const Desc& desc)
+    Sampler::SharedPtr Sampler::apiCreate(const Desc& desc)
     {
         auto pSampler = SharedPtr(new Sampler(desc));
         gl_call(glCreateSamplers(1, &pSampler->mApiHandle));
@@ -29,6 +29,7 @@
 #include "Framework.h"
 #include "ProgramReflection.h"
 #include "Utils/StringUtils.h"
+#include "Utils/BinaryFileStream.h"
 
 using namespace spire;
 
@@ -40,6 +41,188 @@ namespace Falcor
         return pReflection->init(pSpireReflector, log) ? pReflection : nullptr;
     }
 
+    /************************************************************************/
+    /*  Serialization                                                       */
+    /************************************************************************/
+    static void writeString(BinaryFileStream& stream, const std::string& str)
+    {
+        stream << (uint32_t)str.size();
+        stream.write(str.data(), str.size());
+    }
+
+    static bool readString(BinaryFileStream& stream, std::string& str)
+    {
+        uint32_t size = 0;
+        stream >> size;
+        if(stream.isGood() == false || size > stream.getRemainingStreamSize())
+        {
+            return false;
+        }
+        str.resize(size);
+        stream.read(&str[0], size);
+        return stream.isGood();
+    }
+
+    static void writeVariable(BinaryFileStream& stream, const ProgramReflection::Variable& var)
+    {
+        stream << (uint64_t)var.location << var.arraySize << var.arrayStride << var.isRowMajor << var.type;
+    }
+
+    static void readVariable(BinaryFileStream& stream, ProgramReflection::Variable& var)
+    {
+        uint64_t location;
+        stream >> location >> var.arraySize >> var.arrayStride >> var.isRowMajor >> var.type;
+        var.location = (size_t)location;
+    }
+
+    static void writeResource(BinaryFileStream& stream, const ProgramReflection::Resource& res)
+    {
+        stream << res.shaderAccess << res.type << res.dims << res.retType << res.regIndex << res.arraySize << res.shaderMask << res.registerSpace;
+    }
+
+    static void readResource(BinaryFileStream& stream, ProgramReflection::Resource& res)
+    {
+        stream >> res.shaderAccess >> res.type >> res.dims >> res.retType >> res.regIndex >> res.arraySize >> res.shaderMask >> res.registerSpace;
+    }
+
+    static void writeVariableMap(BinaryFileStream& stream, ProgramReflection::VariableMap::const_iterator begin, ProgramReflection::VariableMap::const_iterator end)
+    {
+        stream << (uint32_t)std::distance(begin, end);
+        for(auto it = begin; it != end; it++)
+        {
+            writeString(stream, it->first);
+            writeVariable(stream, it->second);
+        }
+    }
+
+    static bool readVariableMap(BinaryFileStream& stream, ProgramReflection::VariableMap& varMap)
+    {
+        uint32_t count = 0;
+        stream >> count;
+        for(uint32_t i = 0; i < count && stream.isGood(); i++)
+        {
+            std::string name;
+            if(readString(stream, name) == false)
+            {
+                return false;
+            }
+            readVariable(stream, varMap[name]);
+        }
+        return stream.isGood();
+    }
+
+    static void writeResourceMap(BinaryFileStream& stream, ProgramReflection::ResourceMap::const_iterator begin, ProgramReflection::ResourceMap::const_iterator end)
+    {
+        stream << (uint32_t)std::distance(begin, end);
+        for(auto it = begin; it != end; it++)
+        {
+            writeString(stream, it->first);
+            writeResource(stream, it->second);
+        }
+    }
+
+    static bool readResourceMap(BinaryFileStream& stream, ProgramReflection::ResourceMap& resourceMap)
+    {
+        uint32_t count = 0;
+        stream >> count;
+        for(uint32_t i = 0; i < count && stream.isGood(); i++)
+        {
+            std::string name;
+            if(readString(stream, name) == false)
+            {
+                return false;
+            }
+            readResource(stream, resourceMap[name]);
+        }
+        return stream.isGood();
+    }
+
+    void ProgramReflection::serialize(BinaryFileStream& stream) const
+    {
+        for(const auto& bufferData : mBuffers)
+        {
+            stream << (uint32_t)bufferData.descMap.size();
+            for(const auto& desc : bufferData.descMap)
+            {
+                const BufferReflection* pBuffer = desc.second.get();
+                stream << desc.first.u64;
+                writeString(stream, pBuffer->getName());
+                stream << pBuffer->getRegisterIndex() << pBuffer->getRegisterSpace() << pBuffer->getType() << pBuffer->getStructuredType();
+                stream << (uint64_t)pBuffer->getRequiredSize() << pBuffer->getShaderAccess() << pBuffer->getShaderMask();
+                writeVariableMap(stream, pBuffer->varBegin(), pBuffer->varEnd());
+                writeResourceMap(stream, pBuffer->resourceBegin(), pBuffer->resourceEnd());
+            }
+
+            stream << (uint32_t)bufferData.nameMap.size();
+            for(const auto& name : bufferData.nameMap)
+            {
+                writeString(stream, name.first);
+                stream << name.second.u64;
+            }
+        }
+
+        writeVariableMap(stream, mFragOut.begin(), mFragOut.end());
+        writeVariableMap(stream, mVertAttr.begin(), mVertAttr.end());
+        writeResourceMap(stream, mResources.begin(), mResources.end());
+        stream << mThreadGroupSizeX << mThreadGroupSizeY << mThreadGroupSizeZ;
+    }
+
+    ProgramReflection::SharedPtr ProgramReflection::deserialize(BinaryFileStream& stream)
+    {
+        SharedPtr pReflection = SharedPtr(new ProgramReflection);
+        for(auto& bufferData : pReflection->mBuffers)
+        {
+            uint32_t bufferCount = 0;
+            stream >> bufferCount;
+            for(uint32_t i = 0; i < bufferCount && stream.isGood(); i++)
+            {
+                BindLocation bindLocation;
+                std::string name;
+                uint32_t regIndex, regSpace, shaderMask;
+                BufferReflection::Type type;
+                BufferReflection::StructuredType structuredType;
+                uint64_t size;
+                ShaderAccess shaderAccess;
+                VariableMap varMap;
+                ResourceMap resourceMap;
+
+                stream >> bindLocation.u64;
+                if(readString(stream, name) == false)
+                {
+                    return nullptr;
+                }
+                stream >> regIndex >> regSpace >> type >> structuredType >> size >> shaderAccess >> shaderMask;
+                if(readVariableMap(stream, varMap) == false || readResourceMap(stream, resourceMap) == false)
+                {
+                    return nullptr;
+                }
+
+                auto pBuffer = BufferReflection::create(name, regIndex, regSpace, type, structuredType, (size_t)size, varMap, resourceMap, shaderAccess);
+                pBuffer->setShaderMask(shaderMask);
+                bufferData.descMap[bindLocation] = pBuffer;
+            }
+
+            uint32_t nameCount = 0;
+            stream >> nameCount;
+            for(uint32_t i = 0; i < nameCount && stream.isGood(); i++)
+            {
+                std::string name;
+                if(readString(stream, name) == false)
+                {
+                    return nullptr;
+                }
+                stream >> bufferData.nameMap[name].u64;
+            }
+        }
+
+        bool valid = readVariableMap(stream, pReflection->mFragOut);
+        valid = valid && readVariableMap(stream, pReflection->mVertAttr);
+        valid = valid && readResourceMap(stream, pReflection->mResources);
+        stream >> pReflection->mThreadGroupSizeX >> pReflection->mThreadGroupSizeY >> pReflection->mThreadGroupSizeZ;
+
+        return (valid && stream.isGood()) ? pReflection : nullptr;
+    }
+
     ProgramReflection::BindLocation ProgramReflection::getBufferBinding(const std::string& name) const
     {
         // Names are unique regardless of buffer type. Search in each map
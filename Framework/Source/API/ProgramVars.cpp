@@ -32,9 +32,45 @@
 #include "API/RenderContext.h"
 #include "API/DescriptorSet.h"
 #include "API/Device.h"
+#include "Utils/Profiler.h"
+#include <atomic>
 
 namespace Falcor
 {
+    ProgramVars::ApplyStats ProgramVars::sApplyStats;
+    static std::atomic<uint64_t> sVarsCounter(1);   // 0 is used by the contexts to mark unknown bindings
+
+    ProgramVars::ResourceKind ProgramVars::getResourceKind(const Resource* pResource)
+    {
+        if (dynamic_cast<const TypedBufferBase*>(pResource))
+        {
+            return ResourceKind::TypedBuffer;
+        }
+        if (dynamic_cast<const StructuredBuffer*>(pResource))
+        {
+            return ResourceKind::StructuredBuffer;
+        }
+        return ResourceKind::Other;
+    }
+
+    void ProgramVars::recordApplyStats(const ApplyStats& stats)
+    {
+        sApplyStats.applyCount += stats.applyCount;
+        sApplyStats.fullApplyCount += stats.fullApplyCount;
+        sApplyStats.bindingsEmitted += stats.bindingsEmitted;
+        sApplyStats.bindingsSkipped += stats.bindingsSkipped;
+        sApplyStats.barriersEmitted += stats.barriersEmitted;
+        if(gProfileEnabled)
+        {
+            static const HashedString kBindingsEmitted("ProgramVars bindings emitted");
+            static const HashedString kBindingsSkipped("ProgramVars bindings skipped");
+            static const HashedString kBarriersEmitted("ProgramVars barriers");
+            Profiler::addToCounter(kBindingsEmitted, stats.bindingsEmitted);
+            Profiler::addToCounter(kBindingsSkipped, stats.bindingsSkipped);
+            Profiler::addToCounter(kBarriersEmitted, stats.barriersEmitted);
+        }
+    }
+
     template<RootSignature::DescType descType>
     uint32_t findRootSignatureOffset(const RootSignature* pRootSig, uint32_t regIndex, uint32_t regSpace)
     {
@@ -86,6 +122,7 @@ namespace Falcor
                 {
                     data.pResource = BufferType::create(buf.second);
                     data.pView = viewInitFunc(data.pResource);
+                    data.kind = ProgramVars::getResourceKind(data.pResource.get());
                 }
 
                 data.rootSigOffset = findRootSignatureOffset<descType>(pRootSig, regIndex, regSpace);
@@ -101,7 +138,7 @@ namespace Falcor
         return true;
     }
 
-    ProgramVars::ProgramVars(const ProgramReflection::SharedConstPtr& pReflector, bool createBuffers, const RootSignature::SharedPtr& pRootSig) : mpReflector(pReflector)
+    ProgramVars::ProgramVars(const ProgramReflection::SharedConstPtr& pReflector, bool createBuffers, const RootSignature::SharedPtr& pRootSig) : mId(sVarsCounter++), mpReflector(pReflector)
     {
         // Initialize the CB and StructuredBuffer maps. We always do it, to mark which slots are used in the shader.
         mpRootSignature = pRootSig ? pRootSig : RootSignature::create(pReflector.get());
@@ -241,6 +278,7 @@ namespace Falcor
                 uavIt->second.pDescSet = nullptr;
                 uavIt->second.pResource = resource;
                 uavIt->second.pView = resUav;
+                uavIt->second.kind = ProgramVars::getResourceKind(resource.get());
             }
             break;
         }
@@ -257,6 +295,7 @@ namespace Falcor
                 srvIt->second.pDescSet = nullptr;
                 srvIt->second.pResource = resource;
                 srvIt->second.pView = resSrv;
+                srvIt->second.kind = ProgramVars::getResourceKind(resource.get());
             }
             break;
         }
@@ -559,6 +598,7 @@ namespace Falcor
                 it->second.pDescSet = nullptr;
                 it->second.pView = pSrv;
                 it->second.pResource = getResourceFromView(pSrv.get()); // TODO: Fix resource/view const-ness so we don't need to do this
+                it->second.kind = getResourceKind(it->second.pResource.get());
             }
         }
         else
@@ -580,6 +620,7 @@ namespace Falcor
                 it->second.pDescSet = nullptr;
                 it->second.pView = pUav;                
                 it->second.pResource = getResourceFromView(pUav.get()); // TODO: Fix resource/view const-ness so we don't need to do this
+                it->second.kind = getResourceKind(it->second.pResource.get());
             }
         }
         else
@@ -590,155 +631,4 @@ namespace Falcor
 
         return true;
     }
-
-    template<typename ViewType, bool isUav, bool forGraphics>
-    void bindUavSrvCommon(CopyContext* pContext, const ProgramVars::ResourceMap<ViewType>& resMap)
-    {
-        ID3D12GraphicsCommandList* pList = pContext->getLowLevelData()->getCommandList();
-        for (auto& resIt : resMap)
-        {
-            auto& resDesc = resIt.second;
-            uint32_t rootOffset = resDesc.rootSigOffset;
-            const Resource* pResource = resDesc.pResource.get();
-
-            ViewType::ApiHandle handle;
-            if (pResource)
-            {
-                // If it's a typed buffer, upload it to the GPU
-                const TypedBufferBase* pTypedBuffer = dynamic_cast<const TypedBufferBase*>(pResource);
-                if (pTypedBuffer)
-                {
-                    pTypedBuffer->uploadToGPU();
-                }
-                const StructuredBuffer* pStructured = dynamic_cast<const StructuredBuffer*>(pResource);
-                if (pStructured)
-                {
-                    pStructured->uploadToGPU();
-
-                    if (isUav && pStructured->hasUAVCounter())
-                    {
-                        pContext->resourceBarrier(pStructured->getUAVCounter().get(), Resource::State::UnorderedAccess);
-                    }
-                }
-
-                pContext->resourceBarrier(resDesc.pResource.get(), isUav ? Resource::State::UnorderedAccess : Resource::State::ShaderResource);
-                if (isUav)
-                {
-                    if (pTypedBuffer)
-                    {
-                        pTypedBuffer->setGpuCopyDirty();
-                    }
-                    if (pStructured)
-                    {
-                        pStructured->setGpuCopyDirty();
-                    }
-                }
-
-                handle = resDesc.pView->getApiHandle();
-            }
-            else
-            {
-                handle = isUav ? UnorderedAccessView::getNullView()->getApiHandle() : ShaderResourceView::getNullView()->getApiHandle();
-            }
-
-            // Allocate a GPU descriptor
-            if (resDesc.pDescSet == nullptr)
-            {
-                DescriptorSet::Layout layout;
-                layout.addRange(isUav ? DescriptorSet::Type::Uav : DescriptorSet::Type::Srv, 1);
-                resDesc.pDescSet = DescriptorSet::create(gpDevice->getGpuDescriptorPool(), layout);
-                auto srcHandle = handle->getCpuHandle(0);
-                auto dstHandle = resDesc.pDescSet->getCpuHandle(0);
-                gpDevice->getApiHandle()->CopyDescriptorsSimple(1, dstHandle, srcHandle, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-            }
-
-            auto viewHandle = resDesc.pDescSet->getGpuHandle(0);
-            if(forGraphics)
-            {
-                pList->SetGraphicsRootDescriptorTable(rootOffset, viewHandle);
-            }
-            else
-            {
-                pList->SetComputeRootDescriptorTable(rootOffset, viewHandle);
-            }
-        }
-    }
-
-    template<bool forGraphics>
-    void applyProgramVarsCommon(const ProgramVars* pVars, CopyContext* pContext)
-    {
-        ID3D12GraphicsCommandList* pList = pContext->getLowLevelData()->getCommandList();
-
-        if(forGraphics)
-        {
-            pList->SetGraphicsRootSignature(pVars->getRootSignature()->getApiHandle());
-        }
-        else
-        {
-            pList->SetComputeRootSignature(pVars->getRootSignature()->getApiHandle());
-        }
-
-        // Bind the constant-buffers
-        for (auto& bufIt : pVars->getAssignedCbs())
-        {
-            uint32_t rootOffset = bufIt.second.rootSigOffset;
-            const ConstantBuffer* pCB = dynamic_cast<const ConstantBuffer*>(bufIt.second.pResource.get());
-            pCB->uploadToGPU();
-            if(forGraphics)
-            {
-                pList->SetGraphicsRootConstantBufferView(rootOffset, pCB->getGpuAddress());
-            }
-            else
-            {
-                pList->SetComputeRootConstantBufferView(rootOffset, pCB->getGpuAddress());
-            }
-        }
-
-        // Bind the SRVs and UAVs
-        bindUavSrvCommon<ShaderResourceView, false, forGraphics>(pContext, pVars->getAssignedSrvs());
-        bindUavSrvCommon<UnorderedAccessView, true, forGraphics>(pContext, pVars->getAssignedUavs());
-
-        // Bind the samplers
-        for (auto& samplerIt : pVars->getAssignedSamplers())
-        {
-            uint32_t rootOffset = samplerIt.second.rootSigOffset;
-            const Sampler* pSampler = samplerIt.second.pSampler.get();
-            if (pSampler == nullptr)
-            {
-                pSampler = Sampler::getDefault().get();
-            }
-
-            // Allocate a GPU descriptor
-            if (samplerIt.second.pDescSet == nullptr)
-            {
-                DescriptorSet::Layout layout;
-                layout.addRange(DescriptorSet::Type::Sampler, 1);
-                samplerIt.second.pDescSet = DescriptorSet::create(gpDevice->getGpuDescriptorPool(), layout);
-                auto srcHandle = pSampler->getApiHandle()->getCpuHandle(0);
-                auto dstHandle = samplerIt.second.pDescSet->getCpuHandle(0);
-                gpDevice->getApiHandle()->CopyDescriptorsSimple(1, dstHandle, srcHandle, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
-            }
-
-            auto samplerHandler = samplerIt.second.pDescSet->getGpuHandle(0);
-
-            if (forGraphics)
-            {
-                pList->SetGraphicsRootDescriptorTable(rootOffset, samplerHandler);
-            }
-            else
-            {
-                pList->SetComputeRootDescriptorTable(rootOffset, samplerHandler);
-            }
-        }
-    }
-
-    void ComputeVars::apply(ComputeContext* pContext) const
-    {
-        applyProgramVarsCommon<false>(this, pContext);
-    }
-
-    void GraphicsVars::apply(RenderContext* pContext) const
-    {
-        applyProgramVarsCommon<true>(this, pContext);
-    }
 }
\ No newline at end of file
@@ -39,6 +39,7 @@ namespace Falcor
 {
     class ProgramVersion;
     class ComputeContext;
+    class CopyContext;
     class DescriptorSet;
 
     /** This class manages a program's reflection and variable assignment.
@@ -193,13 +194,24 @@ namespace Falcor
         */
         RootSignature::SharedPtr getRootSignature() const { return mpRootSignature; }
 
+        /** The type of a bound resource. Cached when the resource is bound, so that apply() doesn't need to cast every resource.
+        */
+        enum class ResourceKind
+        {
+            Other,
+            TypedBuffer,
+            StructuredBuffer,
+        };
+
         template<typename ViewType>
         struct ResourceData
         {
             typename ViewType::SharedPtr pView;
             Resource::SharedPtr pResource;
+            ResourceKind kind = ResourceKind::Other;
             uint32_t rootSigOffset = 0;
-            mutable std::shared_ptr<DescriptorSet> pDescSet;
+            mutable std::shared_ptr<DescriptorSet> pDescSet;    // Released when the binding changes. apply() only sets the root parameter again if it had to create a new set.
+            mutable uint64_t boundGpuAddress = 0;               // Constant buffers only. The address set by the last apply().
         };
 
         template<>
@@ -219,12 +231,42 @@ namespace Falcor
         const ResourceMap<UnorderedAccessView>& getAssignedUavs() const { return mAssignedUavs; }
         const ResourceMap<Sampler>& getAssignedSamplers() const { return mAssignedSamplers; }
 
+        /** Get a unique ID of the object. IDs are never reused.
+        */
+        uint64_t getId() const { return mId; }
+
+        /** Statistics of the work done by apply(), accumulated across all the vars until resetApplyStats() is called
+        */
+        struct ApplyStats
+        {
+            uint64_t applyCount = 0;        ///< Number of apply() calls
+            uint64_t fullApplyCount = 0;    ///< Number of apply() calls which had to set the root signature and all the root parameters
+            uint64_t bindingsEmitted = 0;   ///< Number of root parameters set
+            uint64_t bindingsSkipped = 0;   ///< Number of root parameters which were already set on the command list
+            uint64_t barriersEmitted = 0;   ///< Number of resource barriers issued for the bound resources
+        };
+
+        static const ApplyStats& getApplyStats() { return sApplyStats; }
+        static void resetApplyStats() { sApplyStats = ApplyStats(); }
+
+        /** Get the kind of a resource, to store in ResourceData::kind
+        */
+        static ResourceKind getResourceKind(const Resource* pResource);
+
     protected:
+        /** Set the root signature and the root parameters. If this object was the last one applied to the context, only the parameters which changed since then are set.
+        */
         template<bool forGraphics, typename ContextType>
         void applyCommon(ContextType* pContext) const;
 
         ProgramVars(const ProgramReflection::SharedConstPtr& pReflector, bool createBuffers, const RootSignature::SharedPtr& pRootSig);
 
+        static void recordApplyStats(const ApplyStats& stats);
+
+        static ApplyStats sApplyStats;
+        uint64_t mId;
+        mutable const CopyContext* mpLastApplyContext = nullptr;
+
         RootSignature::SharedPtr mpRootSignature;
         ProgramReflection::SharedConstPtr mpReflector;
 
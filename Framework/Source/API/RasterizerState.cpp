@@ -0,0 +1,72 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/RasterizerState.h"
+
+namespace Falcor
+{
+    bool RasterizerState::Desc::operator==(const Desc& other) const
+    {
+        return mCullMode == other.mCullMode && mFillMode == other.mFillMode && mIsFrontCcw == other.mIsFrontCcw &&
+            mSlopeScaledDepthBias == other.mSlopeScaledDepthBias && mDepthBias == other.mDepthBias && mClampDepth == other.mClampDepth &&
+            mScissorEnabled == other.mScissorEnabled && mEnableLinesAA == other.mEnableLinesAA && mForcedSampleCount == other.mForcedSampleCount &&
+            mConservativeRaster == other.mConservativeRaster;
+    }
+
+    size_t RasterizerState::Desc::getHash() const
+    {
+        size_t hash = 0;
+        hashCombine(hash, (uint32_t)mCullMode);
+        hashCombine(hash, (uint32_t)mFillMode);
+        hashCombine(hash, mIsFrontCcw);
+        hashCombine(hash, mSlopeScaledDepthBias);
+        hashCombine(hash, mDepthBias);
+        hashCombine(hash, mClampDepth);
+        hashCombine(hash, mScissorEnabled);
+        hashCombine(hash, mEnableLinesAA);
+        hashCombine(hash, mForcedSampleCount);
+        hashCombine(hash, mConservativeRaster);
+        return hash;
+    }
+
+    static ObjectCache<RasterizerState, RasterizerState::Desc>& getRasterizerStateCache()
+    {
+        static ObjectCache<RasterizerState, RasterizerState::Desc> sCache;
+        return sCache;
+    }
+
+    RasterizerState::SharedPtr RasterizerState::create(const Desc& desc)
+    {
+        return getRasterizerStateCache().get(desc, apiCreate);
+    }
+
+    ObjectCacheStats RasterizerState::getCacheStats()
+    {
+        return getRasterizerStateCache().getStats();
+    }
+}
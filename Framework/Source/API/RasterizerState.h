@@ -26,6 +26,7 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
+#include "API/ObjectCache.h"
 
 namespace Falcor
 {
@@ -95,6 +96,15 @@ namespace Falcor
             /** Set the forced sample count. Useful when using UAV
             */
             Desc& setForcedSampleCount(uint32_t samples) { mForcedSampleCount = samples; return *this; }
+
+            /** Compare all the fields of the descs
+            */
+            bool operator==(const Desc& other) const;
+            bool operator!=(const Desc& other) const { return !(*this == other); }
+
+            /** Get a hash of the desc. Equal descs have the same hash.
+            */
+            size_t getHash() const;
         protected:
             CullMode mCullMode = CullMode::Back;
             FillMode mFillMode = FillMode::Solid;
@@ -108,10 +118,18 @@ namespace Falcor
             bool     mConservativeRaster = false;
         };
 
-        /** create a new rasterizer state object
-            \return A new object, or nullptr if creation failed
+        /** Get a rasterizer state object. Rasterizer states are immutable, so equal descs return the same object.
+            \return The object, or nullptr if creation failed
         */
         static SharedPtr create(const Desc& desc);
+
+        /** Get the number of rasterizer state objects requested and created
+        */
+        static ObjectCacheStats getCacheStats();
+
+        /** Get the desc the object was created with
+        */
+        const Desc& getDesc() const { return mDesc; }
         ~RasterizerState();
 
         /** Get the cull mode
@@ -153,6 +171,7 @@ namespace Falcor
     private:
         RasterizerStateHandle mApiHandle;
         RasterizerState(const Desc& Desc) : mDesc(Desc) {}
+        static SharedPtr apiCreate(const Desc& desc);
         Desc mDesc;
     };
 }
\ No newline at end of file
@@ -97,4 +97,49 @@ namespace Falcor
         }
         return spDefaultSampler;
     }
+
+    bool Sampler::Desc::operator==(const Desc& other) const
+    {
+        return mMagFilter == other.mMagFilter && mMinFilter == other.mMinFilter && mMipFilter == other.mMipFilter &&
+            mMaxAnisotropy == other.mMaxAnisotropy && mMaxLod == other.mMaxLod && mMinLod == other.mMinLod && mLodBias == other.mLodBias &&
+            mComparisonMode == other.mComparisonMode && mModeU == other.mModeU && mModeV == other.mModeV && mModeW == other.mModeW &&
+            mBorderColor == other.mBorderColor;
+    }
+
+    size_t Sampler::Desc::getHash() const
+    {
+        size_t hash = 0;
+        hashCombine(hash, (uint32_t)mMagFilter);
+        hashCombine(hash, (uint32_t)mMinFilter);
+        hashCombine(hash, (uint32_t)mMipFilter);
+        hashCombine(hash, mMaxAnisotropy);
+        hashCombine(hash, mMaxLod);
+        hashCombine(hash, mMinLod);
+        hashCombine(hash, mLodBias);
+        hashCombine(hash, (uint32_t)mComparisonMode);
+        hashCombine(hash, (uint32_t)mModeU);
+        hashCombine(hash, (uint32_t)mModeV);
+        hashCombine(hash, (uint32_t)mModeW);
+        for(uint32_t i = 0; i < 4; i++)
+        {
+            hashCombine(hash, mBorderColor[i]);
+        }
+        return hash;
+    }
+
+    static ObjectCache<Sampler, Sampler::Desc>& getSamplerCache()
+    {
+        static ObjectCache<Sampler, Sampler::Desc> sCache;
+        return sCache;
+    }
+
+    Sampler::SharedPtr Sampler::create(const Desc& desc)
+    {
+        return getSamplerCache().get(desc, apiCreate);
+    }
+
+    ObjectCacheStats Sampler::getCacheStats()
+    {
+        return getSamplerCache().getStats();
+    }
 }
@@ -27,6 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include "glm/vec4.hpp"
+#include "API/ObjectCache.h"
 
 namespace Falcor
 {
@@ -107,6 +108,15 @@ namespace Falcor
             /** Set the border color. Only applies when the addressing mode is ClampToBorder
             */
             Desc& setBorderColor(const glm::vec4& borderColor);
+
+            /** Compare all the fields of the descs
+            */
+            bool operator==(const Desc& other) const;
+            bool operator!=(const Desc& other) const { return !(*this == other); }
+
+            /** Get a hash of the desc. Equal descs have the same hash.
+            */
+            size_t getHash() const;
         protected:
             Filter mMagFilter = Filter::Point;
             Filter mMinFilter = Filter::Point;
@@ -122,10 +132,18 @@ namespace Falcor
             glm::vec4 mBorderColor = glm::vec4(0, 0, 0, 0);
         };
 
-        /** create a new sampler object
-            \return A new object, or nullptr if an error occurred
+        /** Get a sampler object. Samplers are immutable, so equal descs return the same object.
+            \return The object, or nullptr if an error occurred
         */
         static SharedPtr create(const Desc& desc);
+
+        /** Get the number of samplers requested and created
+        */
+        static ObjectCacheStats getCacheStats();
+
+        /** Get the desc the sampler was created with
+        */
+        const Desc& getDesc() const { return mDesc; }
         ~Sampler();
 
         /** Get the API handle
@@ -180,6 +198,7 @@ namespace Falcor
         static Sampler::SharedPtr getDefault();
     private:
         Sampler(const Desc& desc);
+        static SharedPtr apiCreate(const Desc& desc);
         Desc mDesc;
         ApiHandle mApiHandle = { 0 };
         static uint32_t getApiMaxAnisotropy();
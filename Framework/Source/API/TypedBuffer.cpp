@@ -49,6 +49,17 @@ namespace Falcor
         mCpuDirty = false;
     }
 
+    void TypedBufferBase::setBlob(const void* pSrc, size_t offset, size_t size)
+    {
+        if (offset + size > mData.size())
+        {
+            logError("TypedBufferBase::setBlob() - blob is too large and will result in overflow. Ignoring call.");
+            return;
+        }
+        memcpy(mData.data() + offset, pSrc, size);
+        mCpuDirty = true;
+    }
+
     void TypedBufferBase::readFromGpu()
     {
         if (mGpuDirty)
@@ -41,6 +41,14 @@ namespace Falcor
         void uploadToGPU() const;
         uint32_t getElementCount() const { return mElementCount; }
         void setGpuCopyDirty() const { mGpuDirty = true; }
+
+        /** Set a block of data into the buffer. It will be uploaded to the GPU the next time the buffer is bound.
+            If offset + size will result in buffer overflow, the call will be ignored and log an error.
+            \param[in] pSrc Pointer to the source data.
+            \param[in] offset Destination offset inside the buffer, in bytes.
+            \param[in] size Number of bytes in the source data.
+        */
+        void setBlob(const void* pSrc, size_t offset, size_t size);
         ResourceFormat getResourceFormat() const { return mFormat; }
     protected:
         TypedBufferBase(uint32_t elementCount, ResourceFormat format, Resource::BindFlags bindFlags);
@@ -33,11 +33,31 @@
 #include "texture.h"
 #include "API/ProgramReflection.h"
 #include "API/Device.h"
+#include "Utils/Profiler.h"
+#include <algorithm>
 
 namespace Falcor
 {
+    VariablesBuffer::UploadCounters VariablesBuffer::sUploadCounters;     // Static storage is zero-initialized
+
     VariablesBuffer::~VariablesBuffer() = default;
 
+    VariablesBuffer::UploadStats VariablesBuffer::getUploadStats()
+    {
+        UploadStats stats;
+        stats.uploadCount = sUploadCounters.uploadCount.load();
+        stats.bytesUploaded = sUploadCounters.bytesUploaded.load();
+        stats.bytesSkipped = sUploadCounters.bytesSkipped.load();
+        return stats;
+    }
+
+    void VariablesBuffer::resetUploadStats()
+    {
+        sUploadCounters.uploadCount = 0;
+        sUploadCounters.bytesUploaded = 0;
+        sUploadCounters.bytesSkipped = 0;
+    }
+
     template<typename VarType>
     ProgramReflection::Variable::Type getReflectionTypeFromCType()
     {
@@ -85,6 +105,7 @@ namespace Falcor
     {
         Buffer::init(nullptr);
         mData.assign(mSize, 0);
+        markDirty(0, mSize);
     }
 
     size_t VariablesBuffer::getVariableOffset(const std::string& varName) const
@@ -94,9 +115,67 @@ namespace Falcor
         return offset;
     }
 
+    void VariablesBuffer::markDirty(size_t offset, size_t size)
+    {
+        if(size == 0)
+        {
+            return;
+        }
+
+        size_t begin = offset & ~(kDirtyRangeAlignment - 1);
+        size_t end = std::min(align_to(kDirtyRangeAlignment, offset + size), mSize);
+
+        // Find the first range which ends at or after the new range begins. It and the ones following it are merged with the new range as long as they overlap or touch it
+        auto first = std::lower_bound(mDirtyRanges.begin(), mDirtyRanges.end(), begin, [](const DirtyRange& r, size_t b) {return r.end < b; });
+        auto last = first;
+        while(last != mDirtyRanges.end() && last->begin <= end)
+        {
+            begin = std::min(begin, last->begin);
+            end = std::max(end, last->end);
+            last++;
+        }
+
+        if(first == last)
+        {
+            mDirtyRanges.insert(first, {begin, end});
+        }
+        else
+        {
+            first->begin = begin;
+            first->end = end;
+            mDirtyRanges.erase(first + 1, last);
+        }
+
+        if(mDirtyRanges.size() > kMaxDirtyRanges)
+        {
+            // Merge the two ranges with the smallest gap between them
+            size_t mergeIndex = 0;
+            for(size_t i = 1; i < mDirtyRanges.size() - 1; i++)
+            {
+                size_t gap = mDirtyRanges[i + 1].begin - mDirtyRanges[i].end;
+                if(gap < mDirtyRanges[mergeIndex + 1].begin - mDirtyRanges[mergeIndex].end)
+                {
+                    mergeIndex = i;
+                }
+            }
+            mDirtyRanges[mergeIndex].end = mDirtyRanges[mergeIndex + 1].end;
+            mDirtyRanges.erase(mDirtyRanges.begin() + mergeIndex + 1);
+        }
+    }
+
+    void VariablesBuffer::writeData(size_t offset, const void* pSrc, size_t size)
+    {
+        uint8_t* pDst = mData.data() + offset;
+        if(memcmp(pDst, pSrc, size) != 0)
+        {
+            memcpy(pDst, pSrc, size);
+            markDirty(offset, size);
+        }
+    }
+
     void VariablesBuffer::uploadToGPU(size_t offset, size_t size) const
     {
-        if(mDirty == false)
+        if(mDirtyRanges.empty())
         {
             return;
         }
@@ -112,8 +191,52 @@ namespace Falcor
             return;
         }
 
-        updateData(mData.data(), offset, size);
-        mDirty = false;
+        size_t uploaded = 0;
+        if(mCpuAccess == CpuAccess::Write)
+        {
+            // Updating a CPU-writable buffer maps it with WriteDiscard, which allocates a new copy of the buffer. The GPU may still be reading the previous copy, so the new one has to be filled entirely
+            updateData(mData.data() + offset, offset, size);
+            uploaded = size;
+            sUploadCounters.uploadCount++;
+            mDirtyRanges.clear();
+        }
+        else
+        {
+            const size_t end = offset + size;
+            std::vector<DirtyRange> remaining;
+            for(const auto& r : mDirtyRanges)
+            {
+                size_t rangeBegin = std::max(r.begin, offset);
+                size_t rangeEnd = std::min(r.end, end);
+                if(rangeBegin < rangeEnd)
+                {
+                    updateData(mData.data() + rangeBegin, rangeBegin, rangeEnd - rangeBegin);
+                    uploaded += rangeEnd - rangeBegin;
+                    sUploadCounters.uploadCount++;
+                }
+
+                // Keep the parts which are outside of the uploaded range
+                if(r.begin < offset)
+                {
+                    remaining.push_back({r.begin, std::min(r.end, offset)});
+                }
+                if(r.end > end)
+                {
+                    remaining.push_back({std::max(r.begin, end), r.end});
+                }
+            }
+            mDirtyRanges.swap(remaining);
+        }
+
+        sUploadCounters.bytesUploaded += uploaded;
+        sUploadCounters.bytesSkipped += size - uploaded;
+        if(gProfileEnabled)
+        {
+            static const HashedString kUploadedBytes("VariablesBuffer bytes uploaded");
+            static const HashedString kSkippedBytes("VariablesBuffer bytes skipped");
+            Profiler::addToCounter(kUploadedBytes, uploaded);
+            Profiler::addToCounter(kSkippedBytes, size - uploaded);
+        }
     }
 
     template<typename VarType>
@@ -200,9 +323,7 @@ namespace Falcor
         verify_element_index();
         if(checkVariableByOffset<VarType>(offset, 1, mpReflector.get()))
         {
-            const uint8_t* pVar = mData.data() + offset + elementIndex * mElementSize;
-            *(VarType*)pVar = value;
-            mDirty = true;
+            writeData(offset + elementIndex * mElementSize, &value, sizeof(VarType));
         }
     }
 
@@ -299,12 +420,8 @@ namespace Falcor
         if(checkVariableByOffset<VarType>(offset, count, mpReflector.get()))
         {
             const uint8_t* pVar = mData.data() + offset;
-            VarType* pData = (VarType*)pVar + elementIndex * mElementSize;
-            for(size_t i = 0; i < count; i++)
-            {
-                pData[i] = pValue[i];
-            }
-            mDirty = true;
+            const VarType* pData = (const VarType*)pVar + elementIndex * mElementSize;
+            writeData((const uint8_t*)pData - mData.data(), pValue, count * sizeof(VarType));
         }
     }
 
@@ -404,8 +521,7 @@ namespace Falcor
             logError(Msg);
             return;
         }
-        memcpy(mData.data() + offset, pSrc, size);
-        mDirty = true;
+        writeData(offset, pSrc, size);
     }
 
     bool checkResourceDimension(const Texture* pTexture, const ProgramReflection::Resource* pResourceDesc, const std::string& name, const std::string& bufferName)
@@ -560,7 +676,7 @@ namespace Falcor
 
         if(bOK)
         {
-            mDirty = true;
+            markDirty(offset, sizeof(uint64_t));
             setTextureInternal(offset, pTexture, pSampler);
         }
     }
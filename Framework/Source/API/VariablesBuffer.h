@@ -26,6 +26,7 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
+#include <atomic>
 #include <string>
 #include "ProgramReflection.h"
 #include "Texture.h"
@@ -51,7 +52,18 @@ namespace Falcor
 
         virtual ~VariablesBuffer() = 0;
 
-        /** Apply the changes to the actual GPU buffer.
+        /** Statistics of the data written by uploadToGPU(), accumulated across all buffers until resetUploadStats() is called.
+            Only buffers without CPU access (structured buffers) are uploaded partially, so only they contribute to bytesSkipped. Constant buffers are CPU-writable and are always written in full when any of their values changed.
+        */
+        struct UploadStats
+        {
+            uint64_t uploadCount = 0;       ///< Number of buffer updates issued
+            uint64_t bytesUploaded = 0;     ///< Number of bytes written to GPU buffers
+            uint64_t bytesSkipped = 0;      ///< Number of bytes which didn't need to be uploaded because they didn't change
+        };
+
+        /** Apply the changes to the actual GPU buffer. Nothing is written if no value changed since the last upload.
+        For buffers without CPU access, only the ranges which were modified since the last upload are written. CPU-writable buffers, which includes all constant buffers, are written entirely, since mapping them allocates a new copy of the buffer.
         Note that it is possible to use this function to update only part of the GPU copy of the buffer. This might lead to inconsistencies between the GPU and CPU buffer, so make sure you know what you are doing.
         \param[in] offset Offset into the buffer to write to
         \param[in] size   Number of bytes to upload. If this value is -1, will update the [Offset, EndOfBuffer] range.
@@ -80,6 +92,9 @@ namespace Falcor
 
         size_t getElementSize() const { return mElementSize; }
 
+        static UploadStats getUploadStats();
+        static void resetUploadStats();
+
     protected:
         template<typename T>
         void setVariable(const std::string& name, size_t elementIndex, const T& value);
@@ -101,9 +116,34 @@ namespace Falcor
 
         void setTextureInternal(size_t offset, const Texture* pTexture, const Sampler* pSampler);
 
+        /** Copy data into the CPU copy of the buffer. The range is only marked as dirty if the data changed.
+        */
+        void writeData(size_t offset, const void* pSrc, size_t size);
+        void markDirty(size_t offset, size_t size);
+
+        /** A half-open byte range [begin, end) which was modified since the last upload. Ranges are aligned to 16-byte registers.
+        */
+        struct DirtyRange
+        {
+            size_t begin;
+            size_t end;
+        };
+        static const size_t kMaxDirtyRanges = 16;   // When exceeded, the two closest ranges are merged
+        static const size_t kDirtyRangeAlignment = 16;
+
+        /** Storage of the upload statistics. Buffers are uploaded by every thread which records commands, so the counters are atomic.
+        */
+        struct UploadCounters
+        {
+            std::atomic<uint64_t> uploadCount;
+            std::atomic<uint64_t> bytesUploaded;
+            std::atomic<uint64_t> bytesSkipped;
+        };
+        static UploadCounters sUploadCounters;
+
         ProgramReflection::BufferReflection::SharedConstPtr mpReflector;
         std::vector<uint8_t> mData;
-        mutable bool mDirty = true;
+        mutable std::vector<DirtyRange> mDirtyRanges;   // Sorted and non-overlapping
         size_t mElementCount;
         size_t mElementSize;
     };
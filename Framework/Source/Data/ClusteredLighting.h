@@ -0,0 +1,70 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+
+/*******************************************************************
+                    Clustered lighting
+    Declares the resources set by ClusteredLightCulling::setIntoProgramVars().
+    Lights [0, gUnboundedLightCount) reach every pixel. The other lights are listed in the cluster which contains the pixel:
+
+        uint2 range = gClusterLightRanges[getLightClusterIndex(posW)];
+        for(uint i = 0; i < range.y; i++)
+        {
+            LightData light = gClusteredLights[gClusterLightIndices[range.x + i]];
+        }
+*******************************************************************/
+
+#ifndef _FALCOR_CLUSTERED_LIGHTING_H_
+#define _FALCOR_CLUSTERED_LIGHTING_H_
+
+#include "ShaderCommon.h"
+
+cbuffer InternalClusteredLightingCB : register(b13)
+{
+    uint3 gClusterGridSize;
+    uint32_t gUnboundedLightCount;
+    float gClusterDepthScale;       // slice = log(depth) * scale + bias
+    float gClusterDepthBias;
+};
+
+StructuredBuffer<LightData> gClusteredLights;
+Buffer<uint2> gClusterLightRanges;  // Offset and count in gClusterLightIndices
+Buffer<uint> gClusterLightIndices;
+
+uint getLightClusterIndex(float3 posW)
+{
+    float4 posV = mul(gCam.viewMat, float4(posW, 1));
+    float depth = max(-posV.z, gCam.nearZ);
+    float2 ndc = float2(gCam.projMat[0][0], gCam.projMat[1][1]) * posV.xy / depth - float2(gCam.projMat[0][2], gCam.projMat[1][2]);
+
+    uint3 cluster;
+    cluster.xy = uint2(clamp((ndc * 0.5 + 0.5) * gClusterGridSize.xy, 0, gClusterGridSize.xy - 1));
+    cluster.z = uint(clamp(log(depth) * gClusterDepthScale + gClusterDepthBias, 0, gClusterGridSize.z - 1));
+    return (cluster.z * gClusterGridSize.y + cluster.y) * gClusterGridSize.x + cluster.x;
+}
+
+#endif  // _FALCOR_CLUSTERED_LIGHTING_H_
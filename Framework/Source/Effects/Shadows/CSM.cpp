@@ -66,19 +66,34 @@ namespace Falcor
     {
     public:
         using UniquePtr = std::unique_ptr<CsmSceneRenderer>;
-        static UniquePtr create(const Scene::SharedConstPtr& pScene) { return UniquePtr(new CsmSceneRenderer(pScene)); }
+        static UniquePtr create(const Scene::SharedConstPtr& pScene, const CsmData& csmData) { return UniquePtr(new CsmSceneRenderer(pScene, csmData)); }
 
     protected:
-        CsmSceneRenderer(const Scene::SharedConstPtr& pScene) : SceneRenderer(std::const_pointer_cast<Scene>(pScene)) 
+        CsmSceneRenderer(const Scene::SharedConstPtr& pScene, const CsmData& csmData) : SceneRenderer(std::const_pointer_cast<Scene>(pScene)), mCsmData(csmData)
         { 
-            setObjectCullState(false); 
             Sampler::Desc desc;
             desc.setFilterMode(Sampler::Filter::Linear, Sampler::Filter::Linear, Sampler::Filter::Linear);
             mpAlphaSampler = Sampler::create(desc);
         }
 
+        const CsmData& mCsmData;
         bool mMaterialChanged = false;
         Sampler::SharedPtr mpAlphaSampler;
+
+        void getCullingFrusta(const Camera* pCamera, std::vector<CullingFrustum>& frusta) override
+        {
+            // All the cascades are rendered in a single pass, so keep whatever is inside any of the cascades' crop frusta.
+            // The near planes are dropped, since casters between the light and the cascade still need to be rendered.
+            for(int32_t c = 0; c < mCsmData.cascadeCount; c++)
+            {
+                glm::mat4 crop(1.0f);
+                crop[0][0] = mCsmData.cascadeScale[c].x;
+                crop[1][1] = mCsmData.cascadeScale[c].y;
+                crop[2][2] = mCsmData.cascadeScale[c].z;
+                crop[3] = glm::vec4(glm::vec3(mCsmData.cascadeOffset[c]), 1);
+                frusta.push_back(CullingFrustum::fromViewProjMatrix(crop * mCsmData.globalMat, false));
+            }
+        }
         bool setPerMaterialData(const CurrentWorkingData& currentData, const Material* pMaterial) override
         {
             mMaterialChanged = true;
@@ -282,7 +297,7 @@ namespace Falcor
         mShadowPass.pState->setFbo(mShadowPass.pFbo);
         mShadowPass.pGraphicsVars = GraphicsVars::create(pProg->getActiveVersion()->getReflector());
 
-        mpCsmSceneRenderer = CsmSceneRenderer::create(mpScene);
+        mpCsmSceneRenderer = CsmSceneRenderer::create(mpScene, mCsmData);
         mpSceneRenderer = SceneRenderer::create(std::const_pointer_cast<Scene>(mpScene));
         mpSceneRenderer->setObjectCullState(true);
 
@@ -64,22 +64,24 @@
 #include "API/CopyContext.h"
 #include "API/ComputeContext.h"
 
-#if defined FALCOR_D3D12 || defined FALCOR_VULKAN
+#if defined FALCOR_D3D12 || defined FALCOR_VULKAN || defined FALCOR_NULL
 #include "API/DescriptorSet.h"
 #include "API/LowLevel/DescriptorPool.h"
 #include "API/LowLevel/FencedPool.h"
 #include "API/LowLevel/GpuFence.h"
 #include "API/LowLevel/RootSignature.h"
-#endif //FALCOR_D3D12 || defined FALCOR_VULKAN
+#endif //FALCOR_D3D12 || defined FALCOR_VULKAN || defined FALCOR_NULL
 
 // Graphics
 #include "Graphics/Camera/Camera.h"
 #include "Graphics/Camera/CameraController.h"
 #include "Graphics/GraphicsState.h"
 #include "Graphics/FullScreenPass.h"
+#include "Graphics/TextureCache.h"
 #include "Graphics/TextureHelper.h"
 #include "Graphics/Light.h"
 #include "Graphics/Program.h"
+#include "Graphics/ShaderCache.h"
 #include "Graphics/GraphicsProgram.h"
 #include "Graphics/FboHelper.h"
 #include "Graphics/ComputeProgram.h"
@@ -121,10 +123,13 @@
 #include "Utils/Profiler.h"
 #include "Utils/StringUtils.h"
 #include "Utils/BinaryFileStream.h"
+#include "Utils/BinaryMemoryStream.h"
+#include "Utils/MemoryMappedFile.h"
 #include "Utils/Video/VideoEncoder.h"
 #include "Utils/Video/VideoEncoderUI.h"
 #include "Utils/Video/VideoDecoder.h"
 #include "Utils/ProgressBar.h"
+#include "Utils/ThreadPool.h"
 
 // VR
 #include "VR/OpenVR/VRSystem.h"
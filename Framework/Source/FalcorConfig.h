@@ -32,6 +32,7 @@
 #else
 #define _LOG_ENABLED 0  /*Set this to 1 to enable log messages in release builds*/
 #endif 
+#define _LOG_MIN_LEVEL 0    /*Messages with a lower level are compiled out. 0 - info, 1 - warning, 2 - error. Errors are always reported*/
 
 #define _PROFILING_ENABLED 1 /*Set this to 1 to enable CPU/GPU profiling*/
 #define _PROFILING_LOG 0     /*Set this to 1 to dump profiling data while profiler is active.*/
@@ -159,7 +159,7 @@ namespace Falcor
 
 #ifdef FALCOR_GL
 #include "API/OpenGL/FalcorGL.h"
-#elif defined(FALCOR_D3D11) || defined(FALCOR_D3D12)
+#elif defined(FALCOR_D3D11) || defined(FALCOR_D3D12) || defined(FALCOR_NULL)
 #include "API/D3D/FalcorD3D.h"
 #else
 #error Undefined falcor backend. Make sure that a backend is selected in "FalcorConfig.h"
@@ -167,7 +167,7 @@ namespace Falcor
 
 #include "Utils/OS.h"
 
-#if defined(FALCOR_D3D12) || defined(FALCOR_VULKAN)
+#if defined(FALCOR_D3D12) || defined(FALCOR_VULKAN) || defined(FALCOR_NULL)
 #define FALCOR_LOW_LEVEL_API
 #endif
 
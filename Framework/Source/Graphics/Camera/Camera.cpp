@@ -31,6 +31,9 @@
 #include "utils/AABB.h"
 #include "Utils/math/FalcorMath.h"
 #include "API/ConstantBuffer.h"
+#include "API/BindingLayoutCache.h"
+#include <emmintrin.h>
+#include <intrin.h>
 
 namespace Falcor
 {
@@ -194,6 +197,77 @@ namespace Falcor
         return !isInside;
     }
 
+    CullingFrustum Camera::getCullingFrustum() const
+    {
+        calculateCameraParameters();
+        return CullingFrustum::fromViewProjMatrix(mData.viewProjMat);
+    }
+
+    void Camera::cullBoundingBoxes(const BoundingBoxArray& boxes, std::vector<uint32_t>& visibleIndices) const
+    {
+        calculateCameraParameters();
+
+        // Same test as isObjectCulled(). dot(center + extent * sign(plane), plane) == dot(center, plane) + dot(extent, abs(plane))
+        struct SimdPlane
+        {
+            __m128 x, y, z;
+            __m128 absX, absY, absZ;
+            __m128 negW;
+        } planes[6];
+
+        for(uint32_t i = 0; i < 6; i++)
+        {
+            const glm::vec3& xyz = mFrustumPlanes[i].xyz;
+            const glm::vec3 absXyz = xyz * mFrustumPlanes[i].sign;
+            planes[i].x = _mm_set1_ps(xyz.x);
+            planes[i].y = _mm_set1_ps(xyz.y);
+            planes[i].z = _mm_set1_ps(xyz.z);
+            planes[i].absX = _mm_set1_ps(absXyz.x);
+            planes[i].absY = _mm_set1_ps(absXyz.y);
+            planes[i].absZ = _mm_set1_ps(absXyz.z);
+            planes[i].negW = _mm_set1_ps(mFrustumPlanes[i].negW);
+        }
+
+        const uint32_t count = boxes.size();
+        const uint32_t simdCount = count & ~3u;
+        for(uint32_t first = 0; first < simdCount; first += 4)
+        {
+            const __m128 cx = _mm_loadu_ps(&boxes.centerX[first]);
+            const __m128 cy = _mm_loadu_ps(&boxes.centerY[first]);
+            const __m128 cz = _mm_loadu_ps(&boxes.centerZ[first]);
+            const __m128 ex = _mm_loadu_ps(&boxes.extentX[first]);
+            const __m128 ey = _mm_loadu_ps(&boxes.extentY[first]);
+            const __m128 ez = _mm_loadu_ps(&boxes.extentZ[first]);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for(uint32_t i = 0; i < 6; i++)
+            {
+                const SimdPlane& p = planes[i];
+                __m128 d = _mm_add_ps(_mm_mul_ps(cx, p.x), _mm_mul_ps(ex, p.absX));
+                d = _mm_add_ps(d, _mm_add_ps(_mm_mul_ps(cy, p.y), _mm_mul_ps(ey, p.absY)));
+                d = _mm_add_ps(d, _mm_add_ps(_mm_mul_ps(cz, p.z), _mm_mul_ps(ez, p.absZ)));
+                inside = _mm_and_ps(inside, _mm_cmpgt_ps(d, p.negW));
+            }
+
+            int mask = _mm_movemask_ps(inside);
+            while(mask)
+            {
+                unsigned long bit;
+                _BitScanForward(&bit, (unsigned long)mask);
+                visibleIndices.push_back(first + bit);
+                mask &= mask - 1;
+            }
+        }
+
+        for(uint32_t i = simdCount; i < count; i++)
+        {
+            if(isObjectCulled(boxes.get(i)) == false)
+            {
+                visibleIndices.push_back(i);
+            }
+        }
+    }
+
     void Camera::setRightEyeMatrices(const glm::mat4& view, const glm::mat4& proj)
     {
         mData.rightEyeViewMat = view;
@@ -203,11 +277,20 @@ namespace Falcor
 
     void Camera::setIntoConstantBuffer(ConstantBuffer* pCB, const std::string& varName) const
     {
-        size_t offset = pCB->getVariableOffset(varName + ".viewMat");
+        // The offset is resolved once per buffer layout
+        static BindingLayoutCache<ProgramReflection::BufferReflection, size_t> sOffsets;
+        size_t offset = sOffsets.get(pCB->getBufferReflector(), varName, [pCB](const ProgramReflection::BufferReflection*, const std::string& name)
+        {
+            size_t offset = pCB->getVariableOffset(name + ".viewMat");
+            if (offset == ConstantBuffer::kInvalidOffset)
+            {
+                logWarning("Camera::setIntoConstantBuffer() - variable \"" + name + "\"not found in constant buffer\n");
+            }
+            return offset;
+        });
 
         if (offset == ConstantBuffer::kInvalidOffset)
         {
-            logWarning("Camera::setIntoConstantBuffer() - variable \"" + varName + "\"not found in constant buffer\n");
             return;
         }
 
@@ -36,6 +36,8 @@
 namespace Falcor
 {
     struct BoundingBox;
+    struct BoundingBoxArray;
+    struct CullingFrustum;
     class ConstantBuffer;
 
     /** Camera class
@@ -158,6 +160,16 @@ namespace Falcor
         */
         bool isObjectCulled(const BoundingBox& box) const;
 
+        /** Cull many bounding boxes against the camera frustum. Tests 4 boxes at a time.
+            \param[in] boxes The boxes to test
+            \param[out] visibleIndices The indices of the boxes which are not culled are appended to this vector, in increasing order
+        */
+        void cullBoundingBoxes(const BoundingBoxArray& boxes, std::vector<uint32_t>& visibleIndices) const;
+
+        /** Get the camera frustum, for culling with a BoundingVolumeHierarchy
+        */
+        CullingFrustum getCullingFrustum() const;
+
         void setIntoConstantBuffer(ConstantBuffer* pBuffer, const std::string& varName) const;
         void setIntoConstantBuffer(ConstantBuffer* pBuffer, const std::size_t& offset) const;
 
@@ -0,0 +1,449 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ClusteredLightCulling.h"
+#include "Graphics/Camera/Camera.h"
+#include "API/ProgramVars.h"
+#include "API/ConstantBuffer.h"
+#include "Utils/ThreadPool.h"
+#include <emmintrin.h>
+#include <intrin.h>
+#include <cfloat>
+
+namespace Falcor
+{
+    static const char* kLightBufferName = "gClusteredLights";
+    static const char* kClusterRangesName = "gClusterLightRanges";
+    static const char* kLightIndicesName = "gClusterLightIndices";
+    static const char* kClusterCbName = "InternalClusteredLightingCB";
+    static const uint32_t kLightsPerChunk = 256;
+
+    ClusteredLightCulling::UniquePtr ClusteredLightCulling::create(const glm::uvec3& gridSize)
+    {
+        if(gridSize.x == 0 || gridSize.y == 0 || gridSize.z == 0)
+        {
+            logError("ClusteredLightCulling::create() - the grid size can't be 0");
+            return nullptr;
+        }
+        return UniquePtr(new ClusteredLightCulling(gridSize));
+    }
+
+    ClusteredLightCulling::ClusteredLightCulling(const glm::uvec3& gridSize) : mGridSize(gridSize)
+    {
+        mPaddedGridX = (gridSize.x + 3) & ~3u;
+        mSliceBounds.resize(gridSize.z);
+        mSliceLights.resize(gridSize.z);
+        for(auto& bounds : mSliceBounds)
+        {
+            bounds.minX.resize(mPaddedGridX, FLT_MAX);
+            bounds.maxX.resize(mPaddedGridX, -FLT_MAX);
+            bounds.minY.resize(gridSize.y);
+            bounds.maxY.resize(gridSize.y);
+        }
+        for(auto& slice : mSliceLights)
+        {
+            slice.tileOffsets.resize(gridSize.x * gridSize.y + 1);
+        }
+    }
+
+    float ClusteredLightCulling::getLightBoundingSphere(const LightData& data, glm::vec3& center) const
+    {
+        float maxIntensity = glm::max(data.intensity.x, glm::max(data.intensity.y, data.intensity.z));
+        float range = (maxIntensity > 0) ? sqrt(maxIntensity / mIntensityThreshold) : 0.0f;
+
+        // Spot lights are bounded by the smallest sphere which contains the cone
+        float angle = data.openingAngle;
+        glm::vec3 dir = glm::normalize(data.worldDir);
+        if(angle >= (float)M_PI * 0.5f)
+        {
+            center = data.worldPos;
+            return range;
+        }
+        else if(angle > (float)M_PI * 0.25f)
+        {
+            center = data.worldPos + dir * (range * cos(angle));
+            return range * sin(angle);
+        }
+        else
+        {
+            float radius = range / (2 * cos(angle));
+            center = data.worldPos + dir * radius;
+            return radius;
+        }
+    }
+
+    void ClusteredLightCulling::updateClusterBounds(const Camera* pCamera)
+    {
+        const glm::mat4& proj = pCamera->getProjMatrix();
+        float nearZ = pCamera->getNearPlane();
+        float farZ = pCamera->getFarPlane();
+        mViewMat = pCamera->getViewMatrix();
+        if(proj == mProjMat && nearZ == mNearZ && farZ == mFarZ)
+        {
+            return;
+        }
+        mProjMat = proj;
+        mNearZ = nearZ;
+        mFarZ = farZ;
+
+        // Exponential slices, so that the clusters keep roughly the same proportions along the depth
+        float logRatio = log(farZ / nearZ);
+        mDepthSliceScale = float(mGridSize.z) / logRatio;
+        mDepthSliceBias = -log(nearZ) * mDepthSliceScale;
+
+        // A cluster's X bounds are the extremes of x = depth * (ndc + P20) / P00 at its corners. Same for Y.
+        for(uint32_t z = 0; z < mGridSize.z; z++)
+        {
+            SliceBounds& bounds = mSliceBounds[z];
+            bounds.minDepth = nearZ * exp(logRatio * float(z) / float(mGridSize.z));
+            bounds.maxDepth = nearZ * exp(logRatio * float(z + 1) / float(mGridSize.z));
+
+            auto calcTileBounds = [&bounds](uint32_t tile, uint32_t tileCount, float scale, float offset, float& minBound, float& maxBound)
+            {
+                float ndcMin = -1 + 2 * float(tile) / float(tileCount);
+                float ndcMax = -1 + 2 * float(tile + 1) / float(tileCount);
+                float a = (ndcMin + offset) / scale;
+                float b = (ndcMax + offset) / scale;
+                minBound = glm::min(glm::min(a * bounds.minDepth, a * bounds.maxDepth), glm::min(b * bounds.minDepth, b * bounds.maxDepth));
+                maxBound = glm::max(glm::max(a * bounds.minDepth, a * bounds.maxDepth), glm::max(b * bounds.minDepth, b * bounds.maxDepth));
+            };
+
+            for(uint32_t x = 0; x < mGridSize.x; x++)
+            {
+                calcTileBounds(x, mGridSize.x, proj[0][0], proj[2][0], bounds.minX[x], bounds.maxX[x]);
+            }
+            for(uint32_t y = 0; y < mGridSize.y; y++)
+            {
+                calcTileBounds(y, mGridSize.y, proj[1][1], proj[2][1], bounds.minY[y], bounds.maxY[y]);
+            }
+        }
+    }
+
+    static uint32_t ndcToTile(float ndc, uint32_t tileCount)
+    {
+        float tile = (ndc + 1) * 0.5f * float(tileCount);
+        return (uint32_t)glm::clamp(tile, 0.0f, float(tileCount - 1));
+    }
+
+    void ClusteredLightCulling::boundLights(uint32_t first, uint32_t count)
+    {
+        for(uint32_t i = first; i < first + count; i++)
+        {
+            LightBounds& bounds = mLightBounds[i];
+            const LightData& data = mLightData[mBoundedLights[i]];
+            glm::vec3 centerW;
+            float radius = getLightBoundingSphere(data, centerW);
+            glm::vec4 centerV = mViewMat * glm::vec4(centerW, 1);
+            float depth = -centerV.z;
+
+            bounds.centerV = glm::vec3(centerV.x, centerV.y, depth);
+            bounds.radius = radius;
+            bounds.visible = (radius > 0) && (depth + radius > mNearZ) && (depth - radius < mFarZ);
+            if(bounds.visible == false)
+            {
+                continue;
+            }
+
+            float minDepth = glm::max(depth - radius, mNearZ);
+            float maxDepth = glm::min(depth + radius, mFarZ);
+            bounds.minZ = (uint32_t)glm::clamp(log(minDepth) * mDepthSliceScale + mDepthSliceBias, 0.0f, float(mGridSize.z - 1));
+            bounds.maxZ = (uint32_t)glm::clamp(log(maxDepth) * mDepthSliceScale + mDepthSliceBias, 0.0f, float(mGridSize.z - 1));
+
+            if(depth - radius <= mNearZ)
+            {
+                // The sphere crosses the near plane, its projection is unbounded
+                bounds.minX = 0;
+                bounds.maxX = mGridSize.x - 1;
+                bounds.minY = 0;
+                bounds.maxY = mGridSize.y - 1;
+                continue;
+            }
+
+            // The sphere is inside the box [center - radius, center + radius]. x / depth is monotonic along each axis, so its extremes are at the box's corners.
+            glm::vec2 ndcMin(FLT_MAX);
+            glm::vec2 ndcMax(-FLT_MAX);
+            for(float d : { depth - radius, depth + radius })
+            {
+                for(float s : { -radius, radius })
+                {
+                    glm::vec2 ndc;
+                    ndc.x = mProjMat[0][0] * (centerV.x + s) / d - mProjMat[2][0];
+                    ndc.y = mProjMat[1][1] * (centerV.y + s) / d - mProjMat[2][1];
+                    ndcMin = glm::min(ndcMin, ndc);
+                    ndcMax = glm::max(ndcMax, ndc);
+                }
+            }
+
+            if(ndcMax.x < -1 || ndcMin.x > 1 || ndcMax.y < -1 || ndcMin.y > 1)
+            {
+                bounds.visible = false;
+                continue;
+            }
+            bounds.minX = ndcToTile(ndcMin.x, mGridSize.x);
+            bounds.maxX = ndcToTile(ndcMax.x, mGridSize.x);
+            bounds.minY = ndcToTile(ndcMin.y, mGridSize.y);
+            bounds.maxY = ndcToTile(ndcMax.y, mGridSize.y);
+        }
+    }
+
+    void ClusteredLightCulling::assignSlice(uint32_t z)
+    {
+        const SliceBounds& bounds = mSliceBounds[z];
+        SliceLights& slice = mSliceLights[z];
+        slice.pairs.clear();
+
+        const __m128 zero = _mm_setzero_ps();
+        for(uint32_t k : slice.lights)
+        {
+            const LightBounds& light = mLightBounds[k];
+            float radiusSq = light.radius * light.radius;
+            float dz = glm::max(0.0f, glm::max(bounds.minDepth - light.centerV.z, light.centerV.z - bounds.maxDepth));
+            float distSqZ = dz * dz;
+            if(distSqZ > radiusSq)
+            {
+                continue;
+            }
+
+            const __m128 centerX = _mm_set1_ps(light.centerV.x);
+            const __m128 radiusSq4 = _mm_set1_ps(radiusSq);
+            uint32_t lightIndex = mBoundedLights[k];
+
+            for(uint32_t y = light.minY; y <= light.maxY; y++)
+            {
+                float dy = glm::max(0.0f, glm::max(bounds.minY[y] - light.centerV.y, light.centerV.y - bounds.maxY[y]));
+                float distSqYZ = distSqZ + dy * dy;
+                if(distSqYZ > radiusSq)
+                {
+                    continue;
+                }
+
+                // Test 4 clusters of the row at a time. The padding clusters have inverted bounds and never pass.
+                const __m128 distSqYZ4 = _mm_set1_ps(distSqYZ);
+                for(uint32_t x = light.minX & ~3u; x <= light.maxX; x += 4)
+                {
+                    __m128 minX = _mm_loadu_ps(&bounds.minX[x]);
+                    __m128 maxX = _mm_loadu_ps(&bounds.maxX[x]);
+                    __m128 dx = _mm_max_ps(zero, _mm_max_ps(_mm_sub_ps(minX, centerX), _mm_sub_ps(centerX, maxX)));
+                    __m128 distSq = _mm_add_ps(_mm_mul_ps(dx, dx), distSqYZ4);
+                    int mask = _mm_movemask_ps(_mm_cmple_ps(distSq, radiusSq4));
+                    while(mask)
+                    {
+                        unsigned long bit;
+                        _BitScanForward(&bit, (unsigned long)mask);
+                        mask &= mask - 1;
+                        uint32_t tileX = x + bit;
+                        if(tileX >= light.minX && tileX <= light.maxX)
+                        {
+                            slice.pairs.push_back(glm::uvec2(y * mGridSize.x + tileX, lightIndex));
+                        }
+                    }
+                }
+            }
+        }
+
+        // Counting sort by tile. It's stable, so every cluster's lights stay sorted by index.
+        std::fill(slice.tileOffsets.begin(), slice.tileOffsets.end(), 0);
+        for(const auto& pair : slice.pairs)
+        {
+            slice.tileOffsets[pair.x + 1]++;
+        }
+        for(size_t t = 1; t < slice.tileOffsets.size(); t++)
+        {
+            slice.tileOffsets[t] += slice.tileOffsets[t - 1];
+        }
+        slice.indices.resize(slice.pairs.size());
+        for(const auto& pair : slice.pairs)
+        {
+            slice.indices[slice.tileOffsets[pair.x]++] = pair.y;
+        }
+
+        // The scatter advanced every offset to the start of the next tile
+        for(size_t t = slice.tileOffsets.size() - 1; t > 0; t--)
+        {
+            slice.tileOffsets[t] = slice.tileOffsets[t - 1];
+        }
+        slice.tileOffsets[0] = 0;
+    }
+
+    void ClusteredLightCulling::build(const Camera* pCamera, const std::vector<Light::SharedPtr>& lights, bool parallel)
+    {
+        updateClusterBounds(pCamera);
+
+        // Unbounded lights first, so that the shader can loop over them without an index list
+        mLightData.clear();
+        mBoundedLights.clear();
+        for(const auto& pLight : lights)
+        {
+            if(pLight->getType() == LightDirectional || pLight->getType() == LightArea)
+            {
+                mLightData.push_back(pLight->getData());
+            }
+        }
+        mUnboundedLightCount = (uint32_t)mLightData.size();
+        for(const auto& pLight : lights)
+        {
+            if(pLight->getType() == LightPoint)
+            {
+                mBoundedLights.push_back((uint32_t)mLightData.size());
+                mLightData.push_back(pLight->getData());
+            }
+        }
+
+        // Compute the view-space bounds of the lights
+        uint32_t boundedCount = (uint32_t)mBoundedLights.size();
+        mLightBounds.resize(boundedCount);
+        uint32_t chunkCount = (boundedCount + kLightsPerChunk - 1) / kLightsPerChunk;
+        auto boundChunk = [this, boundedCount](uint32_t chunk)
+        {
+            uint32_t first = chunk * kLightsPerChunk;
+            boundLights(first, glm::min(kLightsPerChunk, boundedCount - first));
+        };
+        if(parallel && chunkCount > 1)
+        {
+            ThreadPool::getGlobalPool().parallelFor(chunkCount, boundChunk);
+        }
+        else
+        {
+            for(uint32_t c = 0; c < chunkCount; c++)
+            {
+                boundChunk(c);
+            }
+        }
+
+        // Bin the lights into the depth slices they overlap, then assign every slice independently
+        for(auto& slice : mSliceLights)
+        {
+            slice.lights.clear();
+        }
+        for(uint32_t k = 0; k < boundedCount; k++)
+        {
+            const LightBounds& bounds = mLightBounds[k];
+            if(bounds.visible)
+            {
+                for(uint32_t z = bounds.minZ; z <= bounds.maxZ; z++)
+                {
+                    mSliceLights[z].lights.push_back(k);
+                }
+            }
+        }
+
+        auto assign = [this](uint32_t z) { assignSlice(z); };
+        if(parallel)
+        {
+            ThreadPool::getGlobalPool().parallelFor(mGridSize.z, assign);
+        }
+        else
+        {
+            for(uint32_t z = 0; z < mGridSize.z; z++)
+            {
+                assign(z);
+            }
+        }
+
+        // Concatenate the slices' lists
+        uint32_t tilesPerSlice = mGridSize.x * mGridSize.y;
+        mClusterRanges.resize(getClusterCount());
+        mLightIndices.clear();
+        for(uint32_t z = 0; z < mGridSize.z; z++)
+        {
+            const SliceLights& slice = mSliceLights[z];
+            uint32_t sliceOffset = (uint32_t)mLightIndices.size();
+            for(uint32_t t = 0; t < tilesPerSlice; t++)
+            {
+                mClusterRanges[z * tilesPerSlice + t] = glm::uvec2(sliceOffset + slice.tileOffsets[t], slice.tileOffsets[t + 1] - slice.tileOffsets[t]);
+            }
+            mLightIndices.insert(mLightIndices.end(), slice.indices.begin(), slice.indices.end());
+        }
+    }
+
+    uint32_t ClusteredLightCulling::getClusterIndex(const glm::vec3& posV) const
+    {
+        float depth = glm::max(-posV.z, mNearZ);
+        uint32_t z = (uint32_t)glm::clamp(log(depth) * mDepthSliceScale + mDepthSliceBias, 0.0f, float(mGridSize.z - 1));
+        uint32_t x = ndcToTile(mProjMat[0][0] * posV.x / depth - mProjMat[2][0], mGridSize.x);
+        uint32_t y = ndcToTile(mProjMat[1][1] * posV.y / depth - mProjMat[2][1], mGridSize.y);
+        return (z * mGridSize.y + y) * mGridSize.x + x;
+    }
+
+    bool ClusteredLightCulling::setIntoProgramVars(ProgramVars* pVars)
+    {
+        const auto& pReflector = pVars->getReflection();
+        const auto& pLightDesc = pReflector->getBufferDesc(kLightBufferName, ProgramReflection::BufferReflection::Type::Structured);
+        ConstantBuffer* pCB = pVars->getConstantBuffer(kClusterCbName).get();
+        if(pLightDesc == nullptr || pCB == nullptr)
+        {
+            // This is called every frame, so only warn once
+            if(mMissingResourcesReported == false)
+            {
+                logWarning("ClusteredLightCulling::setIntoProgramVars() - the program doesn't declare the clustered lighting resources. Make sure it includes 'ClusteredLighting.h'.");
+                mMissingResourcesReported = true;
+            }
+            return false;
+        }
+
+        // Grow the buffers when needed. Buffers can't be empty, so they always hold at least one element.
+        size_t lightCount = glm::max<size_t>(mLightData.size(), 1);
+        if(mpLightBuffer == nullptr || mpLightBuffer->getElementCount() < lightCount)
+        {
+            mpLightBuffer = StructuredBuffer::create(pLightDesc, lightCount);
+        }
+        if(mLightData.size())
+        {
+            mpLightBuffer->setBlob(mLightData.data(), 0, mLightData.size() * sizeof(LightData));
+        }
+
+        if(mpClusterRangeBuffer == nullptr || mpClusterRangeBuffer->getElementCount() < getClusterCount())
+        {
+            mpClusterRangeBuffer = TypedBuffer<glm::uvec2>::create(getClusterCount(), Resource::BindFlags::ShaderResource);
+        }
+        if(mClusterRanges.size())
+        {
+            mpClusterRangeBuffer->setBlob(mClusterRanges.data(), 0, mClusterRanges.size() * sizeof(glm::uvec2));
+        }
+
+        uint32_t indexCount = glm::max<uint32_t>((uint32_t)mLightIndices.size(), 1);
+        if(mpLightIndexBuffer == nullptr || mpLightIndexBuffer->getElementCount() < indexCount)
+        {
+            // Leave room for the lists to grow, so that the buffer isn't recreated every frame while lights move
+            mpLightIndexBuffer = TypedBuffer<uint32_t>::create(indexCount + indexCount / 2, Resource::BindFlags::ShaderResource);
+        }
+        if(mLightIndices.size())
+        {
+            mpLightIndexBuffer->setBlob(mLightIndices.data(), 0, mLightIndices.size() * sizeof(uint32_t));
+        }
+
+        pVars->setStructuredBuffer(kLightBufferName, mpLightBuffer);
+        pVars->setTypedBuffer(kClusterRangesName, mpClusterRangeBuffer);
+        pVars->setTypedBuffer(kLightIndicesName, mpLightIndexBuffer);
+        pCB->setVariable("gClusterGridSize", mGridSize);
+        pCB->setVariable("gUnboundedLightCount", mUnboundedLightCount);
+        pCB->setVariable("gClusterDepthScale", mDepthSliceScale);
+        pCB->setVariable("gClusterDepthBias", mDepthSliceBias);
+        return true;
+    }
+}
@@ -0,0 +1,164 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <memory>
+#include "Graphics/Light.h"
+#include "API/StructuredBuffer.h"
+#include "API/TypedBuffer.h"
+
+namespace Falcor
+{
+    class Camera;
+    class ProgramVars;
+
+    /** Assigns lights to the clusters (froxels) of the camera's view frustum, so that a pixel only evaluates the lights which can reach it.
+        The frustum is split uniformly in screen space and exponentially in depth. Clusters are stored slice by slice, row by row: index = (z * gridSize.y + y) * gridSize.x + x, where y = 0 is the bottom of the screen.
+        Point and spot lights are bounded by a sphere. Their range is where the intensity drops below a threshold, see setIntensityThreshold(). Directional and area lights reach every cluster. They are stored at the start of the light list and are not part of the cluster lists.
+        The build runs on the CPU. Lights are bounded in parallel, and each depth slice is assigned in parallel, testing 4 clusters of a row at a time with SSE.
+        To use the result in a shader, include 'ClusteredLighting.h' and call setIntoProgramVars().
+    */
+    class ClusteredLightCulling
+    {
+    public:
+        using UniquePtr = std::unique_ptr<ClusteredLightCulling>;
+
+        /** Create a new object.
+            \param[in] gridSize Number of clusters along the screen's width and height, and along the depth
+        */
+        static UniquePtr create(const glm::uvec3& gridSize = glm::uvec3(16, 9, 24));
+
+        /** Set the intensity below which a point or spot light is ignored. It determines the light's range, which is sqrt(maxIntensity / threshold).
+        */
+        void setIntensityThreshold(float threshold) { mIntensityThreshold = threshold; }
+        float getIntensityThreshold() const { return mIntensityThreshold; }
+
+        /** Assign the lights to the clusters of the camera's frustum
+            \param[in] pCamera The camera
+            \param[in] lights The lights
+            \param[in] parallel If false, the build runs on the calling thread
+        */
+        void build(const Camera* pCamera, const std::vector<Light::SharedPtr>& lights, bool parallel = true);
+
+        /** Upload the result of the last build() and bind it. The program needs to include 'ClusteredLighting.h'.
+            \return false if the program doesn't declare the clustered lighting resources, otherwise true. The first failure logs a warning.
+        */
+        bool setIntoProgramVars(ProgramVars* pVars);
+
+        const glm::uvec3& getGridSize() const { return mGridSize; }
+        uint32_t getClusterCount() const { return mGridSize.x * mGridSize.y * mGridSize.z; }
+
+        /** Get the lights of the last build. The lights which reach every cluster come first.
+        */
+        const std::vector<LightData>& getLightData() const { return mLightData; }
+        uint32_t getUnboundedLightCount() const { return mUnboundedLightCount; }
+
+        /** Get the offset and count of every cluster's entries in the light index list
+        */
+        const std::vector<glm::uvec2>& getClusterRanges() const { return mClusterRanges; }
+
+        /** Get the light index list. The indices refer to getLightData().
+        */
+        const std::vector<uint32_t>& getLightIndices() const { return mLightIndices; }
+
+        /** Get the index of the cluster which contains a view-space position, using the camera of the last build
+        */
+        uint32_t getClusterIndex(const glm::vec3& posV) const;
+
+        /** Get the bounding sphere of a point or spot light, in world space
+            \param[in] data The light
+            \param[out] center The sphere's center
+            \return The sphere's radius
+        */
+        float getLightBoundingSphere(const LightData& data, glm::vec3& center) const;
+
+    private:
+        ClusteredLightCulling(const glm::uvec3& gridSize);
+        void updateClusterBounds(const Camera* pCamera);
+        void boundLights(uint32_t first, uint32_t count);
+        void assignSlice(uint32_t slice);
+
+        glm::uvec3 mGridSize;
+        uint32_t mPaddedGridX;          // Row length in the SIMD arrays, a multiple of 4
+        float mIntensityThreshold = 1e-3f;
+
+        // Camera parameters the cluster bounds were computed for
+        glm::mat4 mViewMat;
+        glm::mat4 mProjMat;
+        float mNearZ = 0;
+        float mFarZ = 0;
+        float mDepthSliceScale = 0;     // slice = log(depth) * scale + bias
+        float mDepthSliceBias = 0;
+
+        /** View-space bounds of a depth slice's clusters. Depth is the distance along the view direction. X bounds are per column and Y bounds are per row, since the box of a cluster is separable.
+        */
+        struct SliceBounds
+        {
+            float minDepth;
+            float maxDepth;
+            std::vector<float> minX;    // mPaddedGridX entries, padding never intersects
+            std::vector<float> maxX;
+            std::vector<float> minY;
+            std::vector<float> maxY;
+        };
+        std::vector<SliceBounds> mSliceBounds;
+
+        /** View-space bounding sphere of a point or spot light, and the range of clusters it may touch
+        */
+        struct LightBounds
+        {
+            glm::vec3 centerV;          // X, Y and depth
+            float radius;
+            uint32_t minX, maxX, minY, maxY, minZ, maxZ;
+            bool visible;
+        };
+        std::vector<uint32_t> mBoundedLights;   // Index into mLightData of every point and spot light
+        std::vector<LightBounds> mLightBounds;
+
+        /** Per-slice assignment. Only the thread which assigns the slice writes into it.
+        */
+        struct SliceLights
+        {
+            std::vector<uint32_t> lights;       // Bounded lights which overlap the slice's depth range
+            std::vector<glm::uvec2> pairs;      // Tile in the slice and light index of every intersection
+            std::vector<uint32_t> tileOffsets;  // Start of each tile's entries in indices
+            std::vector<uint32_t> indices;      // Light indices, sorted by tile
+        };
+        std::vector<SliceLights> mSliceLights;
+
+        std::vector<LightData> mLightData;
+        uint32_t mUnboundedLightCount = 0;
+        std::vector<glm::uvec2> mClusterRanges;
+        std::vector<uint32_t> mLightIndices;
+
+        StructuredBuffer::SharedPtr mpLightBuffer;
+        TypedBuffer<glm::uvec2>::SharedPtr mpClusterRangeBuffer;
+        TypedBuffer<uint32_t>::SharedPtr mpLightIndexBuffer;
+        bool mMissingResourcesReported = false;
+    };
+}
@@ -35,6 +35,7 @@
 #include <math.h>
 #include "Data/VertexAttrib.h"
 #include "Graphics/Model/Model.h"
+#include "API/BindingLayoutCache.h"
 
 
 namespace Falcor
@@ -81,13 +82,13 @@ namespace Falcor
     }
 
 
-    void Light::setIntoConstantBuffer(ConstantBuffer* pBuffer, const std::string& varName)
+    static size_t getLightDataOffset(const ConstantBuffer* pBuffer, const std::string& varName)
     {
         size_t offset = pBuffer->getVariableOffset(varName + ".worldPos");
         if (offset == ConstantBuffer::kInvalidOffset)
         {
             logWarning("AreaLight::setIntoConstantBuffer() - variable \"" + varName + "\"not found in constant buffer\n");
-            return;
+            return offset;
         }
 
         check_offset(worldDir);
@@ -96,6 +97,18 @@ namespace Falcor
         check_offset(aabbMax);
         check_offset(transMat);
         check_offset(numIndices);
+        return offset;
+    }
+
+    void Light::setIntoConstantBuffer(ConstantBuffer* pBuffer, const std::string& varName)
+    {
+        // The offset is resolved once per buffer layout
+        static BindingLayoutCache<ProgramReflection::BufferReflection, size_t> sOffsets;
+        size_t offset = sOffsets.get(pBuffer->getBufferReflector(), varName, [pBuffer](const ProgramReflection::BufferReflection*, const std::string& name) { return getLightDataOffset(pBuffer, name); });
+        if (offset == ConstantBuffer::kInvalidOffset)
+        {
+            return;
+        }
 
         setIntoConstantBuffer(pBuffer, offset);
     }
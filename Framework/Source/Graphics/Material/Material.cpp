@@ -34,6 +34,7 @@
 #include "Utils/Math/FalcorMath.h"
 #include "MaterialSystem.h"
 #include "API/ProgramVars.h"
+#include "API/BindingLayoutCache.h"
 
 namespace Falcor
 {
@@ -297,63 +298,91 @@ namespace Falcor
     }
 
 #if _LOG_ENABLED
-#define check_offset(_a) assert(pCB->getVariableOffset(std::string(varName) + "." + #_a) == (offsetof(MaterialData, _a) + offset))
+#define check_offset(_a) assert(pCB->getVariableOffset(varName + "." + #_a) == (offsetof(MaterialData, _a) + offset))
 #else
 #define check_offset(_a)
 #endif
 
-    void Material::setIntoProgramVars(ProgramVars* pVars, ConstantBuffer* pCB, const char varName[]) const
+    Material::BindingLayout Material::createBindingLayout(const ProgramReflection* pReflector, const ConstantBuffer* pCB, const std::string& varName)
     {
-        // OPTME:
-        // We can specialize this function based on the API we are using. This might be worth the extra maintenance cost:
-        // - DX12 - we could create a descriptor-table with all of the SRVs. This will reduce the API overhead to a single call. Pitfall - the textures might be dirty, so we will need to verify it
-        // - Bindless GL - just copy a blob with the GPU pointers. This is actually similar to DX12, but instead of SRVs we store uint64_t
-        // - DX11 - Single call at a time.
-        // Actually, looks like if we will be smart in the way we design ProgramVars::setTextureArray(), we could get away with a unified code
-
-        // First set the desc and the values
-        finalize();
         static const size_t dataSize = sizeof(MaterialDesc) + sizeof(MaterialValues);
         static_assert(dataSize % sizeof(glm::vec4) == 0, "Material::MaterialData size should be a multiple of 16");
 
-        size_t offset = pCB->getVariableOffset(std::string(varName) + ".desc.layers[0].type");
+        BindingLayout layout;
+        layout.firstTextureRegIndex = ProgramReflection::kInvalidLocation;
+        layout.samplerRegIndex = ProgramReflection::kInvalidLocation;
 
+        size_t offset = pCB->getVariableOffset(varName + ".desc.layers[0].type");
+        layout.dataOffset = offset;
         if(offset == ConstantBuffer::kInvalidOffset)
         {
-            logError(std::string("Material::setIntoConstantBuffer() - variable \"") + varName + "\"not found in constant buffer\n");
-            return;
+            logError("Material::setIntoProgramVars() - variable \"" + varName + "\"not found in constant buffer\n");
+            return layout;
         }
 
         check_offset(values.layers[0].albedo);
         check_offset(values.id);
         assert(offset + dataSize <= pCB->getSize());
 
-        pCB->setBlob(&mData, offset, dataSize);
-
 #ifdef FALCOR_GL
 #pragma error Fix material texture bindings for OpenGL
 #endif
 
+        const auto pResourceDesc = pReflector->getResourceDesc(varName + ".textures.layers");
+        if(pResourceDesc == nullptr)
+        {
+            logWarning("Material::setIntoProgramVars() - can't find the first texture object");
+            return layout;
+        }
+        layout.firstTextureRegIndex = pResourceDesc->regIndex;
+
+        const auto pSamplerDesc = pReflector->getResourceDesc(varName + ".samplerState");
+        if(pSamplerDesc)
+        {
+            layout.samplerRegIndex = pSamplerDesc->regIndex;
+        }
+        return layout;
+    }
+
+    void Material::setIntoProgramVars(ProgramVars* pVars, ConstantBuffer* pCB, const char varName[]) const
+    {
+        // OPTME:
+        // We can specialize this function based on the API we are using. This might be worth the extra maintenance cost:
+        // - DX12 - we could create a descriptor-table with all of the SRVs. This will reduce the API overhead to a single call. Pitfall - the textures might be dirty, so we will need to verify it
+        // - Bindless GL - just copy a blob with the GPU pointers. This is actually similar to DX12, but instead of SRVs we store uint64_t
+        // - DX11 - Single call at a time.
+        // Actually, looks like if we will be smart in the way we design ProgramVars::setTextureArray(), we could get away with a unified code
+
+        static BindingLayoutCache<ProgramReflection, BindingLayout> sLayouts;
+        BindingLayout layout = sLayouts.get(pVars->getReflection(), varName, [pCB](const ProgramReflection* pReflector, const std::string& name) { return createBindingLayout(pReflector, pCB, name); });
+        if(layout.dataOffset == ConstantBuffer::kInvalidOffset)
+        {
+            return;
+        }
+
+        // First set the desc and the values
+        finalize();
+        pCB->setBlob(&mData, layout.dataOffset, sizeof(MaterialDesc) + sizeof(MaterialValues));
+
         // Now set the textures
-        std::string resourceName = std::string(varName) + ".textures.layers";
-        const auto pResourceDesc = pVars->getReflection()->getResourceDesc(resourceName);
-        if (pResourceDesc == nullptr)
+        if(layout.firstTextureRegIndex == ProgramReflection::kInvalidLocation)
         {
-            logWarning(std::string("Material::setIntoConstantBuffer() - can't find the first texture object"));
             return;
         }
 
         auto pTextures = (Texture::SharedPtr*)&mData.textures;
-
         for (uint32_t i = 0; i < kTexCount; i++)
         {
             if (pTextures[i] != nullptr)
             {
-                pVars->setSrv(pResourceDesc->regIndex + i, pTextures[i]->getSRV());
+                pVars->setSrv(layout.firstTextureRegIndex + i, pTextures[i]->getSRV());
             }
         }
 
-        pVars->setSampler("gMaterial.samplerState", mData.samplerState);
+        if(layout.samplerRegIndex != ProgramReflection::kInvalidLocation)
+        {
+            pVars->setSampler(layout.samplerRegIndex, mData.samplerState);
+        }
     }
 
     bool Material::operator==(const Material& other) const
@@ -41,6 +41,7 @@ namespace Falcor
     class Texture;
     class ProgramVars;
     class ConstantBuffer;
+    class ProgramReflection;
 
     /** A surface material object
         The core part of material is the 'SMaterial m_Material' data structure. It consists of multiple layers and modifiers.
@@ -270,6 +271,7 @@ namespace Falcor
         void setDoubleSided(bool doubleSided) { mDoubleSided = doubleSided; mDescDirty = true; }
 
         /** Set the material parameters into a constant buffer. To use this you need to include 'Falcor.h' inside your shader.
+            The location of the variable inside the program is resolved on the first call for each program and reused afterwards.
             \param[in] pVars The graphics vars of the shader to set material into.
             \param[in] pCB The constant buffer to set the parameters into.
             \param[in] varName The name of the material variable in the buffer
@@ -305,6 +307,16 @@ namespace Falcor
         void normalize() const;
         void updateTextureCount() const;
 
+        /** Location of a material variable inside a program
+        */
+        struct BindingLayout
+        {
+            size_t dataOffset;              ///< Offset of the desc and values inside the constant buffer, or ConstantBuffer::kInvalidOffset if the variable wasn't found
+            uint32_t firstTextureRegIndex;  ///< SRV register of the first texture, or ProgramReflection::kInvalidLocation
+            uint32_t samplerRegIndex;       ///< Sampler register, or ProgramReflection::kInvalidLocation
+        };
+        static BindingLayout createBindingLayout(const ProgramReflection* pReflector, const ConstantBuffer* pCB, const std::string& varName);
+
         static const uint32_t kTexCount = MatMaxLayers + 4;
         static_assert(sizeof(MaterialTextures) == (sizeof(Texture::SharedPtr) * kTexCount), "Wrong number of textures in Material::mTextures");
 
@@ -28,8 +28,8 @@
 #include "Framework.h"
 #include "Animation.h"
 #include "AnimationController.h"
-#include "glm/gtc/matrix_transform.hpp"
-#include "glm/gtx/transform.hpp"
+#include <algorithm>
+#include <xmmintrin.h>
 
 namespace Falcor
 {
@@ -38,93 +38,225 @@ namespace Falcor
         return UniquePtr(new Animation(name, animationSets, duration, ticksPerSecond));
     }
 
-    Animation::Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond) : mName(name), mAnimationSets(animationSets), mDuration(duration), mTicksPerSecond(ticksPerSecond)
+    Animation::Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond) : mName(name), mDuration(duration), mTicksPerSecond(ticksPerSecond)
     {
+        for(const auto& set : animationSets)
+        {
+            if(set.boneID == AnimationController::kInvalidBoneID)
+            {
+                continue;
+            }
+            mBoneIDs.push_back(set.boneID);
+            mTranslations.addChannel(set.translation);
+            mScalings.addChannel(set.scaling);
+            mRotations.addChannel(set.rotation);
+        }
+
+        // Precompute the slerp angles
+        mRotationSegments.resize(mRotations.values.size());
+        for(size_t set = 0; set < mBoneIDs.size(); set++)
+        {
+            uint32_t first = mRotations.firstKey[set];
+            uint32_t keyCount = mRotations.firstKey[set + 1] - first;
+            for(uint32_t k = 0; k < keyCount; k++)
+            {
+                const glm::quat& start = mRotations.values[first + k];
+                const glm::quat& end = mRotations.values[first + ((k + 1 < keyCount) ? k + 1 : 0)];
+                float cosAngle = glm::dot(start, end);
+
+                RotationSegment& segment = mRotationSegments[first + k];
+                segment.endSign = (cosAngle < 0) ? -1.0f : 1.0f;
+                segment.angle = std::acos(std::min(std::abs(cosAngle), 1.0f));
+                segment.invSinAngle = (segment.angle > 1e-4f) ? 1 / std::sin(segment.angle) : 0;
+            }
+        }
 
+        size_t setCount = mBoneIDs.size();
+        mCurrentTranslations.resize(setCount);
+        mCurrentScalings.resize(setCount);
+        mRotationStarts.resize(setCount);
+        mRotationEnds.resize(setCount);
+        mRotationRatios.resize(setCount);
+        mRotationAngles.resize(setCount);
+        mRotationInvSinAngles.resize(setCount);
+        mCurrentRotations.resize(setCount);
     }
 
     Animation::~Animation() = default;
 
     template<typename T>
-    uint32_t findCurrentFrame(T channel, float ticks)
+    void Animation::ChannelArray<T>::addChannel(const AnimationChannel<T>& channel)
+    {
+        if(firstKey.empty())
+        {
+            firstKey.push_back(0);
+        }
+
+        for(const auto& key : channel.keys)
+        {
+            times.push_back(key.time);
+            values.push_back(key.value);
+        }
+        firstKey.push_back((uint32_t)times.size());
+        cursors.push_back(0);
+    }
+
+    /** Find the key to interpolate from. Check the cached cursor and the key after it before falling back to a binary search.
+    */
+    static inline uint32_t findKey(const float* times, uint32_t keyCount, uint32_t cursor, float ticks)
     {
-        uint32_t curKeyID = channel.lastKeyUsed;
-        while(curKeyID < channel.keys.size() - 1)
+        if(cursor < keyCount && times[cursor] <= ticks)
         {
-            if(channel.keys[curKeyID + 1].time > ticks)
+            if((cursor + 1 == keyCount) || (ticks < times[cursor + 1]))
             {
-                break;
+                return cursor;
+            }
+            if((cursor + 2 >= keyCount) || (ticks < times[cursor + 2]))
+            {
+                return cursor + 1;
             }
-            curKeyID++;
         }
-        return curKeyID;
+
+        const float* pNext = std::upper_bound(times, times + keyCount, ticks);
+        return (pNext == times) ? 0 : uint32_t(pNext - times) - 1;
     }
 
-    glm::vec3 interpolate(const glm::vec3& start, const glm::vec3& end, float ratio)
+    template<typename T>
+    uint32_t Animation::ChannelArray<T>::sample(uint32_t set, float ticks, float duration, const T& defaultValue, T& start, T& end, float& ratio)
     {
-        return start + ((end - start) * ratio);
+        uint32_t first = firstKey[set];
+        uint32_t keyCount = firstKey[set + 1] - first;
+        ratio = 0;
+        if(keyCount == 0)
+        {
+            start = defaultValue;
+            end = defaultValue;
+            return uint32_t(-1);
+        }
+
+        const float* pTimes = times.data() + first;
+        uint32_t curKey = findKey(pTimes, keyCount, cursors[set], ticks);
+        uint32_t nextKey = (curKey + 1 < keyCount) ? curKey + 1 : 0;
+        cursors[set] = curKey;
+        start = values[first + curKey];
+        end = values[first + nextKey];
+
+        // The last key interpolates towards the first one, wrapping around the end of the animation
+        float diff = pTimes[nextKey] - pTimes[curKey];
+        if(diff < 0)
+        {
+            diff += duration;
+        }
+        if(diff > 0)
+        {
+            ratio = glm::clamp((ticks - pTimes[curKey]) / diff, 0.0f, 1.0f);
+        }
+        return first + curKey;
     }
 
-    glm::quat interpolate(const glm::quat& start, const glm::quat& end, float ratio)
+    static const float kPi = 3.14159265358979f;
+
+    /** sin(x) for x in [0, pi]. Uses sin(x) = sin(pi - x) to fold the range to [0, pi/2], then a Taylor polynomial. The error is below 1e-7.
+    */
+    static inline __m128 sinZeroToPi(__m128 x)
     {
-        return glm::slerp(start, end, ratio);
+        __m128 y = _mm_min_ps(x, _mm_sub_ps(_mm_set1_ps(kPi), x));
+        __m128 y2 = _mm_mul_ps(y, y);
+        __m128 p = _mm_set1_ps(-1.0f / 39916800.0f);
+        p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(1.0f / 362880.0f));
+        p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(-1.0f / 5040.0f));
+        p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(1.0f / 120.0f));
+        p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(-1.0f / 6.0f));
+        p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(1.0f));
+        return _mm_mul_ps(p, y);
     }
 
-    template<typename KeyType>
-    KeyType Animation::calcCurrentKey(AnimationChannel<KeyType>& channel, float ticks, float lastUpdateTime)
+    /** Spherical interpolation of a batch of quaternions, using the precomputed angles. The weights of 4 rotations are calculated at once.
+        The end rotations are expected to be on the same hemisphere as the start rotations.
+    */
+    static void slerpBatch(const glm::quat* pStart, const glm::quat* pEnd, const float* pRatio, const float* pAngle, const float* pInvSinAngle, glm::quat* pResult, uint32_t count)
     {
-        KeyType curValue;
-        if(channel.keys.size() > 0)
+        uint32_t i = 0;
+        for(; i + 4 <= count; i += 4)
         {
-            if(ticks < lastUpdateTime)
-            {
-                channel.lastKeyUsed = 0;
-            }
+            __m128 t = _mm_loadu_ps(pRatio + i);
+            __m128 oneMinusT = _mm_sub_ps(_mm_set1_ps(1.0f), t);
+            __m128 angle = _mm_loadu_ps(pAngle + i);
+            __m128 invSinAngle = _mm_loadu_ps(pInvSinAngle + i);
+            __m128 wa = _mm_mul_ps(sinZeroToPi(_mm_mul_ps(oneMinusT, angle)), invSinAngle);
+            __m128 wb = _mm_mul_ps(sinZeroToPi(_mm_mul_ps(t, angle)), invSinAngle);
 
-            // search for the next keyframe
-            uint32_t curKeyIndex = findCurrentFrame(channel, ticks);
-            uint32_t nextKeyIndex = (curKeyIndex + 1) % channel.keys.size();
-            const AnimationKey<KeyType>& curKey = channel.keys[curKeyIndex];
-            const AnimationKey<KeyType>& nextKey = channel.keys[nextKeyIndex];
+            // Keys which are too close for slerp are interpolated linearly
+            __m128 linear = _mm_cmpeq_ps(invSinAngle, _mm_setzero_ps());
+            wa = _mm_or_ps(_mm_and_ps(linear, oneMinusT), _mm_andnot_ps(linear, wa));
+            wb = _mm_or_ps(_mm_and_ps(linear, t), _mm_andnot_ps(linear, wb));
 
-            assert(ticks >= curKey.time);
-            // Interpolate between them
-            float diff = nextKey.time - curKey.time;
-            if(diff < 0)
+            float startWeights[4], endWeights[4];
+            _mm_storeu_ps(startWeights, wa);
+            _mm_storeu_ps(endWeights, wb);
+            for(uint32_t lane = 0; lane < 4; lane++)
             {
-                diff += mDuration;
-            }
-            else if(diff == 0)
-            {
-                curValue = curKey.value;
+                __m128 a = _mm_mul_ps(_mm_loadu_ps(&pStart[i + lane].x), _mm_set1_ps(startWeights[lane]));
+                __m128 b = _mm_mul_ps(_mm_loadu_ps(&pEnd[i + lane].x), _mm_set1_ps(endWeights[lane]));
+                __m128 q = _mm_add_ps(a, b);
+
+                // Normalize. The linear interpolation doesn't preserve the length.
+                __m128 lengthSquared = _mm_mul_ps(q, q);
+                lengthSquared = _mm_add_ps(lengthSquared, _mm_shuffle_ps(lengthSquared, lengthSquared, _MM_SHUFFLE(2, 3, 0, 1)));
+                lengthSquared = _mm_add_ps(lengthSquared, _mm_shuffle_ps(lengthSquared, lengthSquared, _MM_SHUFFLE(1, 0, 3, 2)));
+                _mm_storeu_ps(&pResult[i + lane].x, _mm_div_ps(q, _mm_sqrt_ps(lengthSquared)));
             }
-            else
+        }
+
+        for(; i < count; i++)
+        {
+            float t = pRatio[i];
+            float wa = 1 - t;
+            float wb = t;
+            if(pInvSinAngle[i] != 0)
             {
-                float ratio = (ticks - curKey.time) / diff;
-                curValue = interpolate(curKey.value, nextKey.value, ratio);
+                wa = std::sin(wa * pAngle[i]) * pInvSinAngle[i];
+                wb = std::sin(wb * pAngle[i]) * pInvSinAngle[i];
             }
-            channel.lastKeyUsed = curKeyIndex;
+            pResult[i] = glm::normalize(pStart[i] * wa + pEnd[i] * wb);
         }
-        return curValue;
     }
 
     void Animation::animate(double totalTime, AnimationController* pAnimationController)
     {
         // Calculate the relative time
         float ticks = (float)fmod(totalTime * mTicksPerSecond, mDuration);
+        uint32_t setCount = (uint32_t)mBoneIDs.size();
 
-        for(auto& Key : mAnimationSets)
+        // Find the keys of all the channels first, then interpolate the rotations in a single batch
+        for(uint32_t i = 0; i < setCount; i++)
         {
-            glm::mat4 translation;
-            translation[3] = glm::vec4(calcCurrentKey(Key.translation, ticks, Key.lastUpdateTime), 1);
-            glm::mat4 scaling = glm::scale(calcCurrentKey(Key.scaling, ticks, Key.lastUpdateTime));
-            glm::quat q = calcCurrentKey(Key.rotation, ticks, Key.lastUpdateTime);
-            glm::mat4 rotation = glm::mat4_cast(q);
+            glm::vec3 start, end;
+            float ratio;
+            mTranslations.sample(i, ticks, mDuration, glm::vec3(0), start, end, ratio);
+            mCurrentTranslations[i] = start + (end - start) * ratio;
+            mScalings.sample(i, ticks, mDuration, glm::vec3(1), start, end, ratio);
+            mCurrentScalings[i] = start + (end - start) * ratio;
+            uint32_t key = mRotations.sample(i, ticks, mDuration, glm::quat(1, 0, 0, 0), mRotationStarts[i], mRotationEnds[i], mRotationRatios[i]);
+            if(key == uint32_t(-1))
+            {
+                mRotationAngles[i] = 0;
+                mRotationInvSinAngles[i] = 0;
+            }
+            else
+            {
+                const RotationSegment& segment = mRotationSegments[key];
+                mRotationEnds[i] *= segment.endSign;
+                mRotationAngles[i] = segment.angle;
+                mRotationInvSinAngles[i] = segment.invSinAngle;
+            }
+        }
 
-            Key.lastUpdateTime = ticks;
+        slerpBatch(mRotationStarts.data(), mRotationEnds.data(), mRotationRatios.data(), mRotationAngles.data(), mRotationInvSinAngles.data(), mCurrentRotations.data(), setCount);
 
-            glm::mat4 T = translation * rotation * scaling;
-            pAnimationController->setBoneLocalTransform(Key.boneID, T);
+        for(uint32_t i = 0; i < setCount; i++)
+        {
+            pAnimationController->setBoneLocalTransform(mBoneIDs[i], mCurrentTranslations[i], mCurrentRotations[i], mCurrentScalings[i]);
         }
     }
-}
+}
\ No newline at end of file
@@ -51,16 +51,14 @@ namespace Falcor
         struct AnimationChannel
         {
             std::vector<AnimationKey<T>> keys;
-            uint32_t lastKeyUsed = 0;
         };
 
         struct AnimationSet
         {
-            uint32_t boneID;
+            uint32_t boneID = uint32_t(-1);     ///< Sets without a valid bone ID are ignored
             AnimationChannel<glm::vec3> translation;
             AnimationChannel<glm::vec3> scaling;
             AnimationChannel<glm::quat> rotation;
-            float lastUpdateTime = 0;
         };
 
         static UniquePtr create(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond);
@@ -70,14 +68,48 @@ namespace Falcor
 
     private:
         Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond);
-        
+
+        /** The keys of all the channels of one type, in structure-of-arrays layout. The keys of set i are in the range [firstKey[i], firstKey[i + 1]).
+        */
+        template<typename T>
+        struct ChannelArray
+        {
+            std::vector<float> times;
+            std::vector<T> values;
+            std::vector<uint32_t> firstKey;
+            std::vector<uint32_t> cursors;      // Key used by the last update of every set, relative to the set's first key. Consecutive updates usually reuse it or move one key forward.
+
+            void addChannel(const AnimationChannel<T>& channel);
+            uint32_t sample(uint32_t set, float ticks, float duration, const T& defaultValue, T& start, T& end, float& ratio);
+        };
+
+        /** Precomputed for the interpolation from every rotation key to the next one, so that slerp doesn't need to call acos() every frame
+        */
+        struct RotationSegment
+        {
+            float angle;            // Angle between the keys
+            float invSinAngle;      // 1 / sin(angle). Zero if the angle is too small for slerp, in which case the keys are interpolated linearly.
+            float endSign;          // -1 if the next key has to be negated to take the shortest path
+        };
+
         const std::string mName;
         float mDuration;
         float mTicksPerSecond;
 
-        std::vector<AnimationSet> mAnimationSets;
+        std::vector<uint32_t> mBoneIDs;
+        ChannelArray<glm::vec3> mTranslations;
+        ChannelArray<glm::vec3> mScalings;
+        ChannelArray<glm::quat> mRotations;
+        std::vector<RotationSegment> mRotationSegments;    // One for every rotation key
 
-        template<typename _KeyType>
-        _KeyType calcCurrentKey(AnimationChannel<_KeyType>& channel, float ticks, float lastUpdateTime);
+        // Scratch buffers for the batched interpolation
+        std::vector<glm::vec3> mCurrentTranslations;
+        std::vector<glm::vec3> mCurrentScalings;
+        std::vector<glm::quat> mRotationStarts;
+        std::vector<glm::quat> mRotationEnds;
+        std::vector<float> mRotationRatios;
+        std::vector<float> mRotationAngles;
+        std::vector<float> mRotationInvSinAngles;
+        std::vector<glm::quat> mCurrentRotations;
     };
 }
\ No newline at end of file
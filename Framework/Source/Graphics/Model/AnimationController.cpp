@@ -31,6 +31,7 @@
 #include <fstream>
 #include "Animation.h"
 #include <algorithm>
+#include <xmmintrin.h>
 
 namespace Falcor
 {
@@ -75,9 +76,94 @@ namespace Falcor
     {
         mBones = Bones;
         mBoneTransforms.resize(mBones.size());
+        initHierarchy();
         setActiveAnimation(kBindPoseAnimationId);
     }
 
+    void AnimationController::TransformArray::resize(size_t count)
+    {
+        for(auto& component : m)
+        {
+            component.resize(count);
+        }
+    }
+
+    void AnimationController::TransformArray::set(uint32_t index, const glm::mat4& mat)
+    {
+        for(uint32_t r = 0; r < 3; r++)
+        {
+            for(uint32_t c = 0; c < 4; c++)
+            {
+                m[r * 4 + c][index] = mat[c][r];
+            }
+        }
+    }
+
+    void AnimationController::initHierarchy()
+    {
+        uint32_t boneCount = (uint32_t)mBones.size();
+
+        // Find the depth of every bone
+        std::vector<uint32_t> depth(boneCount, kInvalidBoneID);
+        uint32_t levelCount = 0;
+        for(uint32_t i = 0; i < boneCount; i++)
+        {
+            uint32_t ancestors = 0;
+            uint32_t bone = i;
+            while(depth[bone] == kInvalidBoneID && mBones[bone].parentID != kInvalidBoneID)
+            {
+                bone = mBones[bone].parentID;
+                ancestors++;
+            }
+            uint32_t d = ((depth[bone] == kInvalidBoneID) ? 0 : depth[bone]) + ancestors;
+
+            // Fill in the depth of the bones on the path
+            bone = i;
+            for(uint32_t a = 0; a <= ancestors && depth[bone] == kInvalidBoneID; a++)
+            {
+                depth[bone] = d - a;
+                bone = mBones[bone].parentID;
+                if(bone == kInvalidBoneID)
+                {
+                    break;
+                }
+            }
+            levelCount = std::max(levelCount, depth[i] + 1);
+        }
+
+        // Counting-sort the bones by depth
+        mLevelStart.assign(levelCount + 1, 0);
+        for(uint32_t i = 0; i < boneCount; i++)
+        {
+            mLevelStart[depth[i] + 1]++;
+        }
+        for(uint32_t l = 0; l < levelCount; l++)
+        {
+            mLevelStart[l + 1] += mLevelStart[l];
+        }
+
+        std::vector<uint32_t> nextIndex(mLevelStart.begin(), mLevelStart.end() - 1);
+        mSortedBoneIDs.resize(boneCount);
+        mSortedIndices.resize(boneCount);
+        for(uint32_t i = 0; i < boneCount; i++)
+        {
+            uint32_t sorted = nextIndex[depth[i]]++;
+            mSortedBoneIDs[sorted] = i;
+            mSortedIndices[i] = sorted;
+        }
+
+        mSortedParents.resize(boneCount);
+        mLocalTransforms.resize(boneCount);
+        mGlobalTransforms.resize(boneCount);
+        mOffsets.resize(boneCount);
+        for(uint32_t sorted = 0; sorted < boneCount; sorted++)
+        {
+            const Bone& bone = mBones[mSortedBoneIDs[sorted]];
+            mSortedParents[sorted] = (bone.parentID == kInvalidBoneID) ? kInvalidBoneID : mSortedIndices[bone.parentID];
+            mOffsets.set(sorted, bone.offset);
+        }
+    }
+
     void AnimationController::addAnimation(Animation::UniquePtr pAnimation)
     {
         mAnimations.push_back(std::move(pAnimation));
@@ -88,25 +174,162 @@ namespace Falcor
     void AnimationController::setBoneLocalTransform(uint32_t boneID, const glm::mat4& transform)
     {
         assert(boneID < mBones.size());
-        mBones[boneID].localTransform = transform;
+        mLocalTransforms.set(mSortedIndices[boneID], transform);
     }
 
-    void AnimationController::animate(double currentTime)
+    void AnimationController::setBoneLocalTransform(uint32_t boneID, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scaling)
     {
-        if(mActiveAnimation != kBindPoseAnimationId)
+        assert(boneID < mBones.size());
+        glm::mat3 r = glm::mat3_cast(rotation);
+        uint32_t index = mSortedIndices[boneID];
+        auto& m = mLocalTransforms.m;
+        for(uint32_t row = 0; row < 3; row++)
         {
-            mAnimations[mActiveAnimation]->animate(currentTime, this);
+            m[row * 4 + 0][index] = r[0][row] * scaling.x;
+            m[row * 4 + 1][index] = r[1][row] * scaling.y;
+            m[row * 4 + 2][index] = r[2][row] * scaling.z;
+            m[row * 4 + 3][index] = translation[row];
+        }
+    }
+
+    /** Multiply two affine transforms, for 4 bones at once. The 4th row of both matrices is implicitly (0, 0, 0, 1).
+    */
+    static void multiplyAffine(const __m128 a[12], const __m128 b[12], __m128 result[12])
+    {
+        for(uint32_t r = 0; r < 3; r++)
+        {
+            for(uint32_t c = 0; c < 4; c++)
+            {
+                __m128 v = _mm_mul_ps(a[r * 4 + 0], b[0 * 4 + c]);
+                v = _mm_add_ps(v, _mm_mul_ps(a[r * 4 + 1], b[1 * 4 + c]));
+                v = _mm_add_ps(v, _mm_mul_ps(a[r * 4 + 2], b[2 * 4 + c]));
+                if(c == 3)
+                {
+                    v = _mm_add_ps(v, a[r * 4 + 3]);
+                }
+                result[r * 4 + c] = v;
+            }
+        }
+    }
+
+    static void multiplyAffine(const float a[12], const float b[12], float result[12])
+    {
+        for(uint32_t r = 0; r < 3; r++)
+        {
+            for(uint32_t c = 0; c < 4; c++)
+            {
+                float v = a[r * 4 + 0] * b[0 * 4 + c] + a[r * 4 + 1] * b[1 * 4 + c] + a[r * 4 + 2] * b[2 * 4 + c];
+                result[r * 4 + c] = (c == 3) ? v + a[r * 4 + 3] : v;
+            }
+        }
+    }
+
+    void AnimationController::calculateBoneTransforms()
+    {
+        auto& local = mLocalTransforms.m;
+        auto& global = mGlobalTransforms.m;
+        auto& offset = mOffsets.m;
+        uint32_t boneCount = (uint32_t)mBones.size();
+        if(boneCount == 0)
+        {
+            return;
+        }
+
+        // The roots are the first level
+        for(uint32_t e = 0; e < 12; e++)
+        {
+            std::copy(local[e].begin(), local[e].begin() + mLevelStart[1], global[e].begin());
+        }
+
+        // Every other level only depends on the levels before it, so the bones of a level are evaluated 4 at a time
+        for(size_t l = 1; l + 1 < mLevelStart.size(); l++)
+        {
+            uint32_t i = mLevelStart[l];
+            uint32_t levelEnd = mLevelStart[l + 1];
+            for(; i + 4 <= levelEnd; i += 4)
+            {
+                const uint32_t* p = &mSortedParents[i];
+                __m128 parent[12], child[12], result[12];
+                for(uint32_t e = 0; e < 12; e++)
+                {
+                    parent[e] = _mm_set_ps(global[e][p[3]], global[e][p[2]], global[e][p[1]], global[e][p[0]]);
+                    child[e] = _mm_loadu_ps(&local[e][i]);
+                }
+                multiplyAffine(parent, child, result);
+                for(uint32_t e = 0; e < 12; e++)
+                {
+                    _mm_storeu_ps(&global[e][i], result[e]);
+                }
+            }
+
+            for(; i < levelEnd; i++)
+            {
+                float parent[12], child[12], result[12];
+                for(uint32_t e = 0; e < 12; e++)
+                {
+                    parent[e] = global[e][mSortedParents[i]];
+                    child[e] = local[e][i];
+                }
+                multiplyAffine(parent, child, result);
+                for(uint32_t e = 0; e < 12; e++)
+                {
+                    global[e][i] = result[e];
+                }
+            }
         }
 
-        for(uint32_t i = 0; i < mBones.size(); i++)
+        // Skinning matrices. Bones are independent here, so the whole array is processed in groups of 4.
+        auto storeBoneMatrix = [this](uint32_t sorted, const float* pElements, uint32_t stride)
         {
-            mBones[i].globalTransform = mBones[i].localTransform;
-            if(mBones[i].parentID != kInvalidBoneID)
+            glm::mat4& mat = mBoneTransforms[mSortedBoneIDs[sorted]];
+            for(uint32_t c = 0; c < 4; c++)
             {
-                mBones[i].globalTransform = mBones[mBones[i].parentID].globalTransform * mBones[i].globalTransform;
+                mat[c] = glm::vec4(pElements[(0 * 4 + c) * stride], pElements[(1 * 4 + c) * stride], pElements[(2 * 4 + c) * stride], (c == 3) ? 1.0f : 0.0f);
             }
-            mBoneTransforms[i] = mBones[i].globalTransform * mBones[i].offset;
+        };
+
+        uint32_t i = 0;
+        for(; i + 4 <= boneCount; i += 4)
+        {
+            __m128 g[12], o[12], result[12];
+            for(uint32_t e = 0; e < 12; e++)
+            {
+                g[e] = _mm_loadu_ps(&global[e][i]);
+                o[e] = _mm_loadu_ps(&offset[e][i]);
+            }
+            multiplyAffine(g, o, result);
+
+            float elements[12][4];
+            for(uint32_t e = 0; e < 12; e++)
+            {
+                _mm_storeu_ps(elements[e], result[e]);
+            }
+            for(uint32_t lane = 0; lane < 4; lane++)
+            {
+                storeBoneMatrix(i + lane, &elements[0][lane], 4);
+            }
+        }
+
+        for(; i < boneCount; i++)
+        {
+            float g[12], o[12], result[12];
+            for(uint32_t e = 0; e < 12; e++)
+            {
+                g[e] = global[e][i];
+                o[e] = offset[e][i];
+            }
+            multiplyAffine(g, o, result);
+            storeBoneMatrix(i, result, 1);
+        }
+    }
+
+    void AnimationController::animate(double currentTime)
+    {
+        if(mActiveAnimation != kBindPoseAnimationId)
+        {
+            mAnimations[mActiveAnimation]->animate(currentTime, this);
         }
+        calculateBoneTransforms();
     }
 
     void AnimationController::setActiveAnimation(uint32_t id)
@@ -115,9 +338,9 @@ namespace Falcor
         mActiveAnimation = id;
         if(id == kBindPoseAnimationId)
         {
-            for(auto& bone : mBones)
+            for(uint32_t i = 0; i < mBones.size(); i++)
             {
-                bone.localTransform = bone.originalLocalTransform;
+                setBoneLocalTransform(i, mBones[i].originalLocalTransform);
             }
         }
         animate(0);
@@ -73,15 +73,40 @@ namespace Falcor
         uint32_t getBoneIdFromName(const std::string& name) const;
         void setBoneLocalTransform(uint32_t boneID, const glm::mat4& transform);
 
+        /** Set a bone's local transform from its components. Equivalent to translation * rotation * scaling, without building the intermediate matrices.
+        */
+        void setBoneLocalTransform(uint32_t boneID, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scaling);
+
     private:
         AnimationController(const std::vector<Bone>& bones);
 
+        /** Affine transforms in structure-of-arrays layout, so that consecutive bones can be processed in SIMD lanes.
+            m[r * 4 + c] holds row r, column c of the upper 3x4 part of every bone's matrix.
+        */
+        struct TransformArray
+        {
+            std::vector<float> m[12];
+
+            void resize(size_t count);
+            void set(uint32_t index, const glm::mat4& mat);
+        };
+
         std::vector<Bone> mBones;
         std::vector<glm::mat4> mBoneTransforms;
         std::vector<Animation::UniquePtr> mAnimations;
 
+        // The transforms are stored in topological order. Bones are grouped by their depth in the hierarchy, so all the parents of a level are in earlier levels.
+        std::vector<uint32_t> mSortedBoneIDs;       // Bone ID of every sorted index
+        std::vector<uint32_t> mSortedIndices;       // Sorted index of every bone ID
+        std::vector<uint32_t> mSortedParents;       // Sorted index of the parent of every sorted bone
+        std::vector<uint32_t> mLevelStart;          // First sorted index of every level. The last element is the bone count.
+        TransformArray mLocalTransforms;
+        TransformArray mGlobalTransforms;
+        TransformArray mOffsets;
+
         uint32_t mActiveAnimation = kBindPoseAnimationId;
 
+        void initHierarchy();
         void calculateBoneTransforms();
     };
 }
\ No newline at end of file
@@ -285,22 +285,9 @@ namespace Falcor
                     continue;
                 }
 
-                // Check if the texture was already loaded
-                const auto& a = mTextureCache.find(s);
-                if (a != mTextureCache.end())
-                {
-                    pTex = a->second;
-                }
-                else
-                {
-                    // create a new texture
-                    std::string fullpath = folder + '\\' + s;
-                    pTex = createTextureFromFile(fullpath, true, isSrgbRequired(aiType, useSrgb));
-                    if (pTex)
-                    {
-                        mTextureCache[s] = pTex;
-                    }
-                }
+                // The texture cache shares the texture with other materials and models, and picks up the decoding started by requestTextures()
+                std::string fullpath = folder + '\\' + s;
+                pTex = createTextureFromFile(fullpath, true, isSrgbRequired(aiType, useSrgb));
 
                 assert(pTex != nullptr);
                 BasicMaterial::MapType texSlot = getFalcorTexTypeFromAi(aiType, isObjFile);
@@ -408,10 +395,41 @@ namespace Falcor
         return b;
     }
 
-    AssimpModelImporter::AssimpModelImporter(Model& model, Model::LoadFlags flags) : mFlags(flags), mModel(model)
+    AssimpModelImporter::AssimpModelImporter(const std::string& filename, Model::LoadFlags flags) : ModelImporter(filename), mFlags(flags)
     {
     }
 
+    AssimpModelImporter::~AssimpModelImporter() = default;
+
+    void AssimpModelImporter::requestTextures(const aiScene* pScene)
+    {
+        // Same path and sRGB logic as loadTextures(), so that the requests match the cache entries createModel() will look for
+        auto last = mFullpath.find_last_of("/\\");
+        std::string folder = mFullpath.substr(0, last);
+        bool useSrgb = !is_set(mFlags, Model::LoadFlags::AssumeLinearSpaceTextures);
+
+        for(uint32_t m = 0; m < pScene->mNumMaterials; m++)
+        {
+            const aiMaterial* pAiMaterial = pScene->mMaterials[m];
+            for(int i = 0; i < AI_TEXTURE_TYPE_MAX; ++i)
+            {
+                aiTextureType aiType = (aiTextureType)i;
+                if(pAiMaterial->GetTextureCount(aiType) != 1)
+                {
+                    continue;
+                }
+
+                aiString path;
+                pAiMaterial->GetTexture(aiType, 0, &path);
+                std::string s(path.data);
+                if(s.size())
+                {
+                    mRequestedTextures.push_back(TextureCache::requestTexture(folder + '\\' + s, true, isSrgbRequired(aiType, useSrgb)));
+                }
+            }
+        }
+    }
+
     bool AssimpModelImporter::createAllMaterials(const aiScene* pScene, const std::string& modelFolder, bool isObjFile, bool useSrgb)
     {
         for (uint32_t i = 0; i < pScene->mNumMaterials; i++)
@@ -460,7 +478,7 @@ namespace Falcor
                     aiToFalcorMesh[aiId] = createMesh(pScene->mMeshes[aiId]);
                 }
 
-                mModel.addMeshInstance(aiToFalcorMesh[aiId], aiMatToGLM(transform));
+                mpModel->addMeshInstance(aiToFalcorMesh[aiId], aiMatToGLM(transform));
             }
         }
 
@@ -481,13 +499,14 @@ namespace Falcor
         return parseAiSceneNode(pRoot, pScene, aiToFalcorMeshId);
     }
 
-    bool AssimpModelImporter::initModel(const std::string& filename)
+    bool AssimpModelImporter::readFile()
     {
-        std::string fullpath;
+        const std::string& filename = mFilename;
+        std::string& fullpath = mFullpath;
         if (findFileInDataDirectories(filename, fullpath) == false)
         {
             logError(std::string("Can't find model file ") + filename, true);
-            return nullptr;
+            return false;
         }
 
         uint32_t AssimpFlags = aiProcessPreset_TargetRealtime_MaxQuality |
@@ -511,17 +530,30 @@ namespace Falcor
         // Never use Assimp's tangent gen code
         AssimpFlags &= ~(aiProcess_CalcTangentSpace);
 
-        Assimp::Importer importer;
-        const aiScene* pScene = importer.ReadFile(fullpath, AssimpFlags);
+        mpAiImporter = std::make_unique<Assimp::Importer>();
+        mpAiScene = mpAiImporter->ReadFile(fullpath, AssimpFlags);
 
-        if((pScene == nullptr) || (verifyScene(pScene) == false))
+        if((mpAiScene == nullptr) || (verifyScene(mpAiScene) == false))
         {
             std::string str("Can't open model file '");
-            str = str + std::string(filename) + "'\n" + importer.GetErrorString();
+            str = str + std::string(filename) + "'\n" + mpAiImporter->GetErrorString();
             logError(str, true);
             return false;
         }
 
+        // Start decoding the textures while the rest of the file is processed
+        requestTextures(mpAiScene);
+        return true;
+    }
+
+    bool AssimpModelImporter::createModel(Model& model)
+    {
+        assert(mpAiScene);
+        mpModel = &model;
+        const aiScene* pScene = mpAiScene;
+        const std::string& filename = mFilename;
+        const std::string& fullpath = mFullpath;
+
         // Extract the folder name
         auto last = fullpath.find_last_of("/\\");
         std::string modelFolder = fullpath.substr(0, last);
@@ -534,6 +566,7 @@ namespace Falcor
             logError(std::string("Can't create materials for model ") + filename, true);
             return false;
         }
+        mRequestedTextures.clear();
 
         if (createDrawList(pScene) == false)
         {
@@ -541,13 +574,23 @@ namespace Falcor
             return false;
         }
 
+        // Release the ASSIMP scene
+        mpAiScene = nullptr;
+        mpAiImporter = nullptr;
+        mpModel = nullptr;
         return true;
     }
 
+    ModelImporter::SharedPtr AssimpModelImporter::prepare(const std::string& filename, Model::LoadFlags flags)
+    {
+        std::shared_ptr<AssimpModelImporter> pImporter = std::shared_ptr<AssimpModelImporter>(new AssimpModelImporter(filename, flags));
+        return pImporter->readFile() ? pImporter : nullptr;
+    }
+
     bool AssimpModelImporter::import(Model& model, const std::string& filename, Model::LoadFlags flags)
     {
-        AssimpModelImporter loader(model, flags);
-        return loader.initModel(filename);
+        auto pImporter = prepare(filename, flags);
+        return pImporter ? pImporter->createModel(model) : false;
     }
 
     uint32_t AssimpModelImporter::initBone(const aiNode* pCurNode, uint32_t parentID, uint32_t boneID)
@@ -653,7 +696,7 @@ namespace Falcor
                 pAnimCtrl->addAnimation(std::move(pAnimation));
             }
 
-            mModel.setAnimationController(std::move(pAnimCtrl));
+            mpModel->setAnimationController(std::move(pAnimCtrl));
         }
     }
 
@@ -32,6 +32,7 @@
 #include "../AnimationController.h"
 #include "../Mesh.h"
 #include "../Model.h"
+#include "Graphics/TextureCache.h"
 
 struct aiScene;
 struct aiNode;
@@ -39,6 +40,11 @@ struct aiAnimation;
 struct aiMesh;
 struct aiMaterial;
 
+namespace Assimp
+{
+    class Importer;
+}
+
 namespace Falcor
 {
     class Animation;
@@ -56,15 +62,27 @@ namespace Falcor
         */
         static bool import(Model& model, const std::string& filename, Model::LoadFlags flags);
 
+        /** Parse a model file using ASSIMP without creating any API objects. Can be called from any thread.
+            \param[in] filename Model's filename. Loader will look for it in the data directories.
+            \param[in] flags Flags controlling model creation
+            \return nullptr if parsing the file failed, otherwise an importer which is ready for createModel()
+        */
+        static SharedPtr prepare(const std::string& filename, Model::LoadFlags flags);
+
+        ~AssimpModelImporter();
+
+        bool createModel(Model& model) override;
+
     private:
 
         using IdToMesh = std::unordered_map<uint32_t, Mesh::SharedPtr>;
 
-        AssimpModelImporter(Model& model, Model::LoadFlags flags);
+        AssimpModelImporter(const std::string& filename, Model::LoadFlags flags);
         AssimpModelImporter(const AssimpModelImporter&) = delete;
         void operator=(const AssimpModelImporter&) = delete;
 
-        bool initModel(const std::string& filename);
+        bool readFile();
+        void requestTextures(const aiScene* pScene);
         bool createDrawList(const aiScene* pScene);
         bool parseAiSceneNode(const aiNode* pCurrent, const aiScene* pScene, IdToMesh& aiToFalcorMesh);
         bool createAllMaterials(const aiScene* pScene, const std::string& modelFolder, bool isObjFile, bool useSrgb);
@@ -86,10 +104,13 @@ namespace Falcor
         std::map<std::string, uint32_t> mBoneNameToIdMap;
         std::map<uint32_t, Material::SharedPtr> mAiMaterialToFalcor;
 
-        Model& mModel;
+        Model* mpModel = nullptr;
+        std::unique_ptr<Assimp::Importer> mpAiImporter;
+        const aiScene* mpAiScene = nullptr;
+        std::string mFullpath;
 
         std::vector<Bone> mBones;
         Model::LoadFlags mFlags;
-        std::map<const std::string, Texture::SharedPtr> mTextureCache;
+        std::vector<TextureCache::PendingTexture> mRequestedTextures;   // Keeps the textures decoding in the background until createModel() uses them
     };
 }
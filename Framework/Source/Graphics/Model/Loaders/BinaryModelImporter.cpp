@@ -40,6 +40,11 @@
 #include "API/Texture.h"
 #include "Graphics/Material/Material.h"
 #include "glm/geometric.hpp"
+#include "Utils/CpuTimer.h"
+#include "Utils/ThreadPool.h"
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -341,7 +346,7 @@ namespace Falcor
         }
     }
 
-    std::string readString(BinaryFileStream& stream)
+    std::string readString(BinaryMemoryStream& stream)
     {
         int32_t length;
         stream >> length;
@@ -351,7 +356,7 @@ namespace Falcor
         return std::string(charVec.data());
     }
 
-    bool loadBinaryTextureData(BinaryFileStream& stream, const std::string& modelName, TextureData& data)
+    bool loadBinaryTextureData(BinaryMemoryStream& stream, const std::string& modelName, TextureData& data)
     {
         // ImageHeader.
         char tag[9];
@@ -459,7 +464,7 @@ namespace Falcor
         return true;
     }
 
-    bool importTextures(std::vector<TextureData>& textures, uint32_t textureCount, BinaryFileStream& stream, const std::string& modelName)
+    bool importTextures(std::vector<TextureData>& textures, uint32_t textureCount, BinaryMemoryStream& stream, const std::string& modelName)
     {
         textures.assign(textureCount, TextureData());
 
@@ -475,21 +480,65 @@ namespace Falcor
         return true;
     }
 
-    BinaryModelImporter::BinaryModelImporter(const std::string& fullpath) : mModelName(fullpath), mStream(fullpath.c_str(), BinaryFileStream::Mode::Read)
+    // Copies one attribute out of an interleaved vertex block. Using a compile-time element size lets the compiler turn the copy into plain vector loads/stores.
+    template<uint32_t kElementSize>
+    static void copyStridedElements(const uint8_t* pSrc, size_t srcStride, uint32_t count, uint8_t* pDst)
     {
+        for(uint32_t i = 0; i < count; i++)
+        {
+            std::memcpy(pDst + size_t(i) * kElementSize, pSrc + size_t(i) * srcStride, kElementSize);
+        }
     }
 
-    bool BinaryModelImporter::import(Model& model, const std::string& filename, Model::LoadFlags flags)
+    static void copyStridedElements(const uint8_t* pSrc, size_t srcStride, uint32_t elementSize, uint32_t count, uint8_t* pDst)
     {
-        std::string fullpath;
-        if(findFileInDataDirectories(filename, fullpath) == false)
+        switch(elementSize)
         {
-            logError(std::string("Can't find model file ") + filename);
-            return false;
+        case 4:
+            copyStridedElements<4>(pSrc, srcStride, count, pDst);
+            break;
+        case 8:
+            copyStridedElements<8>(pSrc, srcStride, count, pDst);
+            break;
+        case 12:
+            copyStridedElements<12>(pSrc, srcStride, count, pDst);
+            break;
+        case 16:
+            copyStridedElements<16>(pSrc, srcStride, count, pDst);
+            break;
+        default:
+            for(uint32_t i = 0; i < count; i++)
+            {
+                std::memcpy(pDst + size_t(i) * elementSize, pSrc + size_t(i) * srcStride, elementSize);
+            }
         }
+    }
 
-        BinaryModelImporter loader(fullpath);
-        return loader.importModel(model, flags);
+    struct VertexStream
+    {
+        uint32_t srcOffset;     // Offset of the attribute inside the interleaved vertex
+        uint32_t elementSize;
+        uint8_t* pDst;          // nullptr if the attribute is skipped
+    };
+
+    /** Split an interleaved vertex block into separate per-attribute streams.
+        The block is processed in chunks which fit in the cache, so the source is read from memory once no matter how many attributes there are.
+    */
+    static void deinterleaveVertexBlock(const uint8_t* pSrc, uint32_t vertexStride, uint32_t vertexCount, const std::vector<VertexStream>& streams)
+    {
+        const uint32_t kChunkSize = 1024;
+        for(uint32_t first = 0; first < vertexCount; first += kChunkSize)
+        {
+            const uint32_t count = std::min(kChunkSize, vertexCount - first);
+            const uint8_t* pChunk = pSrc + size_t(first) * vertexStride;
+            for(const auto& stream : streams)
+            {
+                if(stream.pDst)
+                {
+                    copyStridedElements(pChunk + stream.srcOffset, vertexStride, stream.elementSize, count, stream.pDst + size_t(first) * stream.elementSize);
+                }
+            }
+        }
     }
 
     static bool checkVersion(const std::string& formatID, uint32_t version, const std::string& modelName)
@@ -544,8 +593,184 @@ namespace Falcor
         }
     }
     
-    bool BinaryModelImporter::importModel(Model& model, Model::LoadFlags flags)
+    // Everything needed to decode a submesh. Filled by the scan pass, pointers reference the mapped file.
+    struct SubmeshRecord
+    {
+        BasicMaterial material;                 // Material constants. Textures are resolved during the merge.
+        std::vector<int32_t> textureIDs;        // Texture ID per BasicMaterial::MapType, -1 if the slot is empty
+        const uint8_t* pMaterialRecord = nullptr;
+        size_t materialRecordSize = 0;
+        const uint8_t* pIndexData = nullptr;
+        uint32_t numIndices = 0;
+
+        // Filled by the decode pass
+        std::vector<uint32_t> indices;
+        BoundingBox boundingBox;
+        uint64_t materialHash = 0;
+    };
+
+    struct MeshRecord
+    {
+        uint32_t numVertices = 0;
+        VertexLayout::SharedPtr pLayout;
+        const uint8_t* pVertexData = nullptr;
+        uint32_t vertexStride = 0;
+        std::vector<VertexStream> streams;
+        std::vector<uint32_t> elementSizes;     // Per VB. 0 means the attribute is skipped.
+        uint32_t positionBufferIndex = kInvalidBufferIndex;
+        uint32_t normalBufferIndex = kInvalidBufferIndex;
+        uint32_t bitangentBufferIndex = kInvalidBufferIndex;
+        uint32_t texCoordBufferIndex = kInvalidBufferIndex;
+        bool genTangents = false;
+        std::vector<SubmeshRecord> submeshes;
+
+        // Filled by the decode pass
+        std::vector<std::vector<uint8_t>> buffers;
+        float vertexDecodeTime = 0;
+        float indexDecodeTime = 0;
+        float tangentTime = 0;
+
+        static const uint32_t kInvalidBufferIndex = (uint32_t)-1;
+    };
+
+    static uint64_t hashBytes(const uint8_t* pData, size_t size)
+    {
+        // 64-bit FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        for(size_t i = 0; i < size; i++)
+        {
+            hash ^= pData[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    /** Decode the vertex and index data of a mesh and generate its tangent space. Only touches the mesh record, so different meshes can be decoded concurrently.
+    */
+    static void decodeMesh(MeshRecord& mesh)
+    {
+        // De-interleave the vertex block
+        auto vertexStart = CpuTimer::getCurrentTimePoint();
+        mesh.buffers.resize(mesh.elementSizes.size());
+        for(size_t i = 0; i < mesh.elementSizes.size(); i++)
+        {
+            mesh.buffers[i].resize(size_t(mesh.elementSizes[i]) * mesh.numVertices);
+        }
+        for(size_t i = 0; i < mesh.streams.size(); i++)
+        {
+            mesh.streams[i].pDst = mesh.elementSizes[i] ? mesh.buffers[i].data() : nullptr;
+        }
+        deinterleaveVertexBlock(mesh.pVertexData, mesh.vertexStride, mesh.numVertices, mesh.streams);
+        mesh.vertexDecodeTime = CpuTimer::calcDuration(vertexStart, CpuTimer::getCurrentTimePoint());
+
+        const uint32_t posStride = mesh.elementSizes[mesh.positionBufferIndex];
+        const uint8_t* pPositions = mesh.buffers[mesh.positionBufferIndex].data();
+
+        // Submeshes of the same mesh share the bitangent buffer, so they are processed in file order
+        for(auto& submesh : mesh.submeshes)
+        {
+            auto indexStart = CpuTimer::getCurrentTimePoint();
+            submesh.materialHash = hashBytes(submesh.pMaterialRecord, submesh.materialRecordSize);
+            submesh.indices.resize(submesh.numIndices);
+            std::memcpy(submesh.indices.data(), submesh.pIndexData, submesh.numIndices * sizeof(uint32_t));
+
+            // Calculate the bounding-box
+            glm::vec3 max, min;
+            for(uint32_t vertexID : submesh.indices)
+            {
+                const float* pPosition = (const float*)(pPositions + size_t(posStride) * vertexID);
+                glm::vec3 xyz(pPosition[0], pPosition[1], pPosition[2]);
+                min = glm::min(min, xyz);
+                max = glm::max(max, xyz);
+            }
+            submesh.boundingBox = BoundingBox::fromMinMax(min, max);
+            mesh.indexDecodeTime += CpuTimer::calcDuration(indexStart, CpuTimer::getCurrentTimePoint());
+
+            // Generate tangent space data if needed
+            if(mesh.genTangents)
+            {
+                auto tangentStart = CpuTimer::getCurrentTimePoint();
+                uint32_t texCrdCount = 0;
+                glm::vec2* texCrd = nullptr;
+                if(mesh.texCoordBufferIndex != MeshRecord::kInvalidBufferIndex)
+                {
+                    texCrdCount = mesh.elementSizes[mesh.texCoordBufferIndex] / sizeof(glm::vec2);
+                    texCrd = (glm::vec2*)mesh.buffers[mesh.texCoordBufferIndex].data();
+                }
+
+                glm::vec3* pNormals = (glm::vec3*)mesh.buffers[mesh.normalBufferIndex].data();
+                glm::vec3* pBitangents = (glm::vec3*)mesh.buffers[mesh.bitangentBufferIndex].data();
+                if(posStride == sizeof(glm::vec3))
+                {
+                    generateSubmeshTangentData<glm::vec3>(submesh.indices, (glm::vec3*)pPositions, pNormals, texCrd, texCrdCount, pBitangents);
+                }
+                else if(posStride == sizeof(glm::vec4))
+                {
+                    generateSubmeshTangentData<glm::vec4>(submesh.indices, (glm::vec4*)pPositions, pNormals, texCrd, texCrdCount, pBitangents);
+                }
+                mesh.tangentTime += CpuTimer::calcDuration(tangentStart, CpuTimer::getCurrentTimePoint());
+            }
+        }
+    }
+
+    struct BinaryModelImporter::FileData
+    {
+        uint32_t version = 0;
+        int32_t numInstances = 0;
+        std::vector<TextureData> texData;
+        std::vector<MeshRecord> meshes;
+    };
+
+    BinaryModelImporter::BinaryModelImporter(const std::string& filename, const std::string& fullpath, Model::LoadFlags flags) : ModelImporter(filename), mModelName(fullpath), mFlags(flags), mpData(new FileData)
+    {
+    }
+
+    BinaryModelImporter::~BinaryModelImporter() = default;
+
+    ModelImporter::SharedPtr BinaryModelImporter::prepare(const std::string& filename, Model::LoadFlags flags)
     {
+        std::string fullpath;
+        if(findFileInDataDirectories(filename, fullpath) == false)
+        {
+            logError(std::string("Can't find model file ") + filename);
+            return nullptr;
+        }
+
+        auto start = CpuTimer::getCurrentTimePoint();
+        std::shared_ptr<BinaryModelImporter> pImporter = std::shared_ptr<BinaryModelImporter>(new BinaryModelImporter(filename, fullpath, flags));
+        if(pImporter->mFile.open(fullpath) == false)
+        {
+            return nullptr;
+        }
+        pImporter->mStream = BinaryMemoryStream(pImporter->mFile.getData(), pImporter->mFile.getSize());
+        pImporter->mTimings.fileMapping = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        bool res = pImporter->readFile();
+        pImporter->mTimings.total = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        return res ? pImporter : nullptr;
+    }
+
+    bool BinaryModelImporter::import(Model& model, const std::string& filename, Model::LoadFlags flags, ImportTimings* pTimings)
+    {
+        auto pImporter = prepare(filename, flags);
+        if(pImporter == nullptr)
+        {
+            return false;
+        }
+
+        BinaryModelImporter* pBinaryImporter = static_cast<BinaryModelImporter*>(pImporter.get());
+        bool res = pBinaryImporter->createModel(model);
+        if(pTimings)
+        {
+            *pTimings = pBinaryImporter->getTimings();
+        }
+        return res;
+    }
+
+    bool BinaryModelImporter::readFile()
+    {
+        auto scanStart = CpuTimer::getCurrentTimePoint();
+
         // Format ID and version.
         char formatID[9];
         mStream.read(formatID, 8);
@@ -610,40 +835,26 @@ namespace Falcor
         }
 
         // create objects
-        bool shouldGenerateTangents = is_set(flags, Model::LoadFlags::DontGenerateTangentSpace) == false;
-
-        std::vector<TextureData> texData;
+        bool shouldGenerateTangents = is_set(mFlags, Model::LoadFlags::DontGenerateTangentSpace) == false;
+        std::vector<TextureData>& texData = mpData->texData;
+        std::vector<MeshRecord>& meshes = mpData->meshes;
 
         if(version >= 6)
         {
+            auto texStart = CpuTimer::getCurrentTimePoint();
             importTextures(texData, numTextures, mStream, mModelName);
+            mTimings.textures += CpuTimer::calcDuration(texStart, CpuTimer::getCurrentTimePoint());
         }
 
-        // This file format has a concept of sub-meshes, which Falcor model doesn't have - Falcor creates a new mesh for each sub-mesh
-        // When creating instances of meshes, it means we need to translate the original mesh index to all it's submeshes Falcor IDs. This is what the next 2 variables are for.
-        std::vector<std::vector<uint32_t>> meshToSubmeshesID(numMeshes);
-
-        // This importer loads mesh/submesh data before instance data, so the meshes are cached here.
-        std::vector<Mesh::SharedPtr> falcorMeshCache;
-        
-        struct TexSignature
-        {
-            const uint8_t* pData;
-            ResourceFormat format;
-            bool operator<(const TexSignature& other) const 
-            { 
-                if(pData < other.pData) return true;
-                if(pData == other.pData) return format < other.format;
-                return false;
-            }
-            bool operator==(const TexSignature& other) const { return pData == other.pData || format == other.format; }
-        };
-        std::map<TexSignature, Texture::SharedPtr> textures;
-        bool loadTexAsSrgb = !is_set(flags, Model::LoadFlags::AssumeLinearSpaceTextures);
+        mpData->version = version;
+        mpData->numInstances = numInstances;
 
-        // Load the meshes
+        // Scan pass. Validate the headers and record where the vertex/index data of each mesh is, without decoding it.
+        meshes.resize(numMeshes);
         for(int meshIdx = 0; meshIdx < numMeshes; meshIdx++)
         {
+            MeshRecord& mesh = meshes[meshIdx];
+
             // Mesh header
             int32_t numAttribs = 0;
             int32_t numVertices = 0;
@@ -667,30 +878,15 @@ namespace Falcor
                 return false;
             }
 
-            Vao::BufferVec pVBs;
-            VertexLayout::SharedPtr pLayout = VertexLayout::create();
-            
-            struct BufferData
-            {
-                std::vector<uint8_t> vec;
-                bool shouldSkip = false;
-                uint32_t elementSize = 0;
-            };
-
-            std::vector<BufferData> buffers;
-            pVBs.resize(numAttribs);
-            buffers.resize(numAttribs);
-
-            const uint32_t kInvalidBufferIndex = (uint32_t)-1;
-            uint32_t positionBufferIndex = kInvalidBufferIndex;
-            uint32_t normalBufferIndex = kInvalidBufferIndex;
-            uint32_t bitangentBufferIndex = kInvalidBufferIndex;
-            uint32_t texCoordBufferIndex = kInvalidBufferIndex;
+            mesh.numVertices = numVertices;
+            mesh.pLayout = VertexLayout::create();
+            mesh.streams.resize(numAttribs);
+            mesh.elementSizes.resize(numAttribs);
 
             for(int i = 0; i < numAttribs; i++)
             {
                 VertexBufferLayout::SharedPtr pBufferLayout = VertexBufferLayout::create();
-                pLayout->addBufferLayout(i, pBufferLayout);
+                mesh.pLayout->addBufferLayout(i, pBufferLayout);
                 int32_t type, format, length;
                 mStream >> type >> format >> length;
 
@@ -709,99 +905,88 @@ namespace Falcor
                     switch (shaderLocation)
                     {
                     case VERTEX_POSITION_LOC:
-                        positionBufferIndex = i;
+                        mesh.positionBufferIndex = i;
                         assert(falcorFormat == ResourceFormat::RGB32Float || falcorFormat == ResourceFormat::RGBA32Float);
                         break;
                     case VERTEX_NORMAL_LOC:
-                        normalBufferIndex = i;
+                        mesh.normalBufferIndex = i;
                         assert(falcorFormat == ResourceFormat::RGB32Float);
                         break;
                     case VERTEX_BITANGENT_LOC:
-                        bitangentBufferIndex = i;
+                        mesh.bitangentBufferIndex = i;
                         assert(falcorFormat == ResourceFormat::RGB32Float);
                         break;
                     case VERTEX_TEXCOORD_LOC:
-                        texCoordBufferIndex = i;
+                        mesh.texCoordBufferIndex = i;
                         break;
                     }
 
-                    buffers[i].elementSize = getFormatBytesPerBlock(falcorFormat);
+                    uint32_t elementSize = getFormatBytesPerBlock(falcorFormat);
+                    mesh.streams[i].srcOffset = mesh.vertexStride;
+                    mesh.streams[i].elementSize = elementSize;
+                    mesh.vertexStride += elementSize;
                     if(shaderLocation != kUnusedShaderElement)
                     {
                         pBufferLayout->addElement(falcorName, 0, falcorFormat, 1, shaderLocation);
-                        buffers[i].vec.resize(buffers[i].elementSize * numVertices);
-                    }
-                    else
-                    {
-                        buffers[i].shouldSkip = true;
+                        mesh.elementSizes[i] = elementSize;
                     }
                 }
             }
 
-            
-            // Check if we need to generate tangents  
-            bool genTangentForMesh = false;
-            if(shouldGenerateTangents && (bitangentBufferIndex == kInvalidBufferIndex))
+            if(mesh.positionBufferIndex == MeshRecord::kInvalidBufferIndex)
             {
-                if(normalBufferIndex == kInvalidBufferIndex)
+                std::string msg = "Error when loading model " + mModelName + ".\nMesh " + std::to_string(meshIdx) + " doesn't contain positions.";
+                logError(msg);
+                return false;
+            }
+
+            // Check if we need to generate tangents
+            if(shouldGenerateTangents && (mesh.bitangentBufferIndex == MeshRecord::kInvalidBufferIndex))
+            {
+                if(mesh.normalBufferIndex == MeshRecord::kInvalidBufferIndex)
                 {
                     logWarning("Can't generate tangent space for mesh " + std::to_string(meshIdx) + " when loading model " + mModelName + ".\nMesh doesn't contain normals coordinates\n");
-                    genTangentForMesh = false;
                 }
                 else
                 {
                     // Set the offsets
-                    genTangentForMesh = true;
-                    bitangentBufferIndex = (uint32_t)pVBs.size();
-                    pVBs.resize(bitangentBufferIndex + 1);
-                    buffers.resize(bitangentBufferIndex + 1);
-                   
+                    mesh.genTangents = true;
+                    mesh.bitangentBufferIndex = (uint32_t)mesh.elementSizes.size();
+                    mesh.elementSizes.push_back(sizeof(glm::vec3));
+
                     auto pBitangentLayout = VertexBufferLayout::create();
-                    pLayout->addBufferLayout(bitangentBufferIndex, pBitangentLayout);
+                    mesh.pLayout->addBufferLayout(mesh.bitangentBufferIndex, pBitangentLayout);
                     pBitangentLayout->addElement(VERTEX_BITANGENT_NAME, 0, ResourceFormat::RGB32Float, 1, VERTEX_BITANGENT_LOC);
-                    buffers[bitangentBufferIndex].vec.resize(sizeof(glm::vec3) * numVertices);
                 }
             }
-            
 
-            // Read the data, one vertex at a time
-            for(int32_t i = 0; i < numVertices; i++)
+            // Skip over the interleaved vertex block. It's decoded later, directly from the mapped file.
+            const size_t vertexBlockSize = size_t(mesh.vertexStride) * numVertices;
+            if(vertexBlockSize > mStream.getRemainingStreamSize())
             {
-                for (int32_t attributes = 0; attributes < numAttribs; ++attributes)
-                {
-                    if (buffers[attributes].shouldSkip)
-                    {
-                        mStream.skip(buffers[attributes].elementSize);
-                    }
-                    else
-                    {
-                        uint32_t stride = pLayout->getBufferLayout(attributes)->getStride();
-                        uint8_t* pDest = buffers[attributes].vec.data() + stride * i;
-                        mStream.read(pDest, stride);
-                    }
-                }
-            }
-
-            for (int32_t i = 0; i < numAttribs; ++i)
-            {
-                if(buffers[i].shouldSkip == false)
-                {
-                    pVBs[i] = Buffer::create(buffers[i].vec.size(), Buffer::BindFlags::Vertex, Buffer::CpuAccess::None, buffers[i].vec.data());
-                }
+                std::string msg = "Error when loading model " + mModelName + ".\nVertex data is truncated.";
+                logError(msg);
+                return false;
             }
+            mesh.pVertexData = mStream.getCurrentPointer();
+            mStream.skip(vertexBlockSize);
 
             if(version <= 5)
             {
+                auto texStart = CpuTimer::getCurrentTimePoint();
                 importTextures(texData, numTextures, mStream, mModelName);
-                textures.clear();
+                mTimings.textures += CpuTimer::calcDuration(texStart, CpuTimer::getCurrentTimePoint());
             }
 
             // Array of Submesh.
             // Falcor doesn't have a concept of submeshes, just create a new mesh for each submesh
-            for(int submesh = 0; submesh < numSubmeshes; submesh++)
+            mesh.submeshes.resize(numSubmeshes);
+            for(int submeshIdx = 0; submeshIdx < numSubmeshes; submeshIdx++)
             {
-                // create the material
-                BasicMaterial basicMaterial;
+                SubmeshRecord& submesh = mesh.submeshes[submeshIdx];
+                BasicMaterial& basicMaterial = submesh.material;
+                submesh.pMaterialRecord = mStream.getCurrentPointer();
+                submesh.textureIDs.assign(BasicMaterial::MapType::Count, -1);
 
                 glm::vec3 ambient;
                 glm::vec4 diffuse;
@@ -841,29 +1026,10 @@ namespace Falcor
                             logWarning("Texture of Type " + std::to_string(i) + " is not supported by the material system (model " + mModelName + ")");
                             continue;
                         }
-
-                        // Load the texture
-                        TexSignature texSig;
-                        texSig.format = getFormatFromMapType(loadTexAsSrgb, texData[texID].format, falcorType);
-                        texSig.pData = texData[texID].data.data();
-                        // Check if we already created a matching texture
-                        auto existingTex = textures.find(texSig);
-                        if(existingTex != textures.end())
-                        {
-                            basicMaterial.pTextures[falcorType] = existingTex->second;
-                        }
-                        else
-                        {
-                            auto pTexture = Texture::create2D(texData[texID].width, texData[texID].height, texSig.format, 1, Texture::kMaxPossible, texSig.pData);
-                            pTexture->setSourceFilename(texData[texID].name);
-                            textures[texSig] = pTexture;
-                            basicMaterial.pTextures[falcorType] = pTexture;
-                        }
+                        submesh.textureIDs[falcorType] = texID;
                     }
                 }
-
-                // Create material and check if it already exists
-                auto pMaterial = checkForExistingMaterial(basicMaterial.convertToMaterial());
+                submesh.materialRecordSize = mStream.getCurrentPointer() - submesh.pMaterialRecord;
 
                 int32_t numTriangles;
                 mStream >> numTriangles;
@@ -874,58 +1040,155 @@ namespace Falcor
                     return false;
                 }
 
-                // create the index buffer
-                uint32_t numIndices = numTriangles * 3;
-                std::vector<uint32_t> indices(numIndices);
-                uint32_t ibSize = 3 * numTriangles * sizeof(uint32_t);
-                mStream.read(&indices[0], ibSize);
+                submesh.numIndices = numTriangles * 3;
+                const size_t ibSize = submesh.numIndices * sizeof(uint32_t);
+                if(ibSize > mStream.getRemainingStreamSize())
+                {
+                    std::string msg = "Error when loading model " + mModelName + ".\nIndex data is truncated.";
+                    logError(msg);
+                    return false;
+                }
+                submesh.pIndexData = mStream.getCurrentPointer();
+                mStream.skip(ibSize);
+            }
+        }
+        mTimings.scan = CpuTimer::calcDuration(scanStart, CpuTimer::getCurrentTimePoint()) - mTimings.textures;
 
-                auto pIB = Buffer::create(ibSize, Buffer::BindFlags::Index, Buffer::CpuAccess::None, indices.data());
+        // Decode pass. Meshes are independent of each other, so they are decoded on the thread pool.
+        auto decodeStart = CpuTimer::getCurrentTimePoint();
+        if(is_set(mFlags, Model::LoadFlags::SerialImport))
+        {
+            for(auto& mesh : meshes)
+            {
+                decodeMesh(mesh);
+            }
+        }
+        else
+        {
+            ThreadPool::getGlobalPool().parallelFor((uint32_t)meshes.size(), [&meshes](uint32_t i) { decodeMesh(meshes[i]); });
+        }
+        mTimings.decode = CpuTimer::calcDuration(decodeStart, CpuTimer::getCurrentTimePoint());
 
-                // Generate tangent space data if needed
-                if(genTangentForMesh)
-                {
-                    uint32_t texCrdCount = 0;
-                    glm::vec2* texCrd = nullptr;
-                    if(texCoordBufferIndex != kInvalidBufferIndex)
-                    {
-                        texCrdCount = pLayout->getBufferLayout(texCoordBufferIndex)->getStride() / sizeof(glm::vec2);
-                        texCrd = (glm::vec2*)buffers[texCoordBufferIndex].vec.data();
-                    }
+        for(const auto& mesh : meshes)
+        {
+            mTimings.vertexDecode += mesh.vertexDecodeTime;
+            mTimings.indexDecode += mesh.indexDecodeTime;
+            mTimings.tangentGeneration += mesh.tangentTime;
+        }
+        return true;
+    }
 
-                    ResourceFormat posFormat = pLayout->getBufferLayout(positionBufferIndex)->getElementFormat(0);
+    bool BinaryModelImporter::createModel(Model& model)
+    {
+        assert(mpData);
+        auto createStart = CpuTimer::getCurrentTimePoint();
+        const uint32_t version = mpData->version;
+        const int32_t numMeshes = (int32_t)mpData->meshes.size();
+        const int32_t numInstances = mpData->numInstances;
+        std::vector<TextureData>& texData = mpData->texData;
+        std::vector<MeshRecord>& meshes = mpData->meshes;
 
-                    if (posFormat == ResourceFormat::RGB32Float)
-                    {
-                        generateSubmeshTangentData<glm::vec3>(indices, (glm::vec3*)buffers[positionBufferIndex].vec.data(), (glm::vec3*)buffers[normalBufferIndex].vec.data(), texCrd, texCrdCount, (glm::vec3*)buffers[bitangentBufferIndex].vec.data());
-                    }
-                    else if (posFormat == ResourceFormat::RGBA32Float)
+        // Merge pass. API objects are created on the loading thread, in file order, so the result doesn't depend on the decode scheduling.
+        auto mergeStart = CpuTimer::getCurrentTimePoint();
+
+        // This file format has a concept of sub-meshes, which Falcor model doesn't have - Falcor creates a new mesh for each sub-mesh
+        // When creating instances of meshes, it means we need to translate the original mesh index to all it's submeshes Falcor IDs. This is what the next 2 variables are for.
+        std::vector<std::vector<uint32_t>> meshToSubmeshesID(numMeshes);
+
+        // This importer loads mesh/submesh data before instance data, so the meshes are cached here.
+        std::vector<Mesh::SharedPtr> falcorMeshCache;
+        
+        struct TexSignature
+        {
+            const uint8_t* pData;
+            ResourceFormat format;
+            bool operator<(const TexSignature& other) const 
+            { 
+                if(pData < other.pData) return true;
+                if(pData == other.pData) return format < other.format;
+                return false;
+            }
+            bool operator==(const TexSignature& other) const { return pData == other.pData || format == other.format; }
+        };
+        std::map<TexSignature, Texture::SharedPtr> textures;
+        bool loadTexAsSrgb = !is_set(mFlags, Model::LoadFlags::AssumeLinearSpaceTextures);
+
+        // Submeshes with byte-identical material records share a material. The hashes were computed during the decode pass.
+        std::unordered_map<uint64_t, std::vector<std::pair<const SubmeshRecord*, Material::SharedPtr>>> materialCache;
+
+        for(uint32_t meshIdx = 0; meshIdx < (uint32_t)meshes.size(); meshIdx++)
+        {
+            MeshRecord& mesh = meshes[meshIdx];
+
+            auto bufferStart = CpuTimer::getCurrentTimePoint();
+            Vao::BufferVec pVBs(mesh.buffers.size());
+            for(size_t i = 0; i < mesh.buffers.size(); i++)
+            {
+                if(mesh.elementSizes[i])
+                {
+                    pVBs[i] = Buffer::create(mesh.buffers[i].size(), Buffer::BindFlags::Vertex, Buffer::CpuAccess::None, mesh.buffers[i].data());
+                }
+            }
+            mTimings.bufferCreation += CpuTimer::calcDuration(bufferStart, CpuTimer::getCurrentTimePoint());
+
+            for(auto& submesh : mesh.submeshes)
+            {
+                // Find or create the material
+                Material::SharedPtr pMaterial;
+                auto& candidates = materialCache[submesh.materialHash];
+                for(const auto& c : candidates)
+                {
+                    if(c.first->materialRecordSize == submesh.materialRecordSize && std::memcmp(c.first->pMaterialRecord, submesh.pMaterialRecord, submesh.materialRecordSize) == 0)
                     {
-                        generateSubmeshTangentData<glm::vec4>(indices, (glm::vec4*)buffers[positionBufferIndex].vec.data(), (glm::vec3*)buffers[normalBufferIndex].vec.data(), texCrd, texCrdCount, (glm::vec3*)buffers[bitangentBufferIndex].vec.data());
+                        pMaterial = c.second;
+                        break;
                     }
-
-                    pVBs[bitangentBufferIndex] = Buffer::create(buffers[bitangentBufferIndex].vec.size(), Buffer::BindFlags::Vertex, Buffer::CpuAccess::None, buffers[bitangentBufferIndex].vec.data());
                 }
-                
 
-                // Calculate the bounding-box
-                glm::vec3 max, min;
-                for(uint32_t i = 0; i < numIndices; i++)
+                if(pMaterial == nullptr)
                 {
-                    uint32_t vertexID = indices[i];
-                    uint8_t* pVertex = (pLayout->getBufferLayout(positionBufferIndex)->getStride() * vertexID) + buffers[positionBufferIndex].vec.data();
+                    BasicMaterial basicMaterial = submesh.material;
+                    for(uint32_t mapType = 0; mapType < BasicMaterial::MapType::Count; mapType++)
+                    {
+                        int32_t texID = submesh.textureIDs[mapType];
+                        if(texID == -1)
+                        {
+                            continue;
+                        }
 
-                    float* pPosition = (float*)pVertex;
+                        // Load the texture
+                        BasicMaterial::MapType falcorType = BasicMaterial::MapType(mapType);
+                        TexSignature texSig;
+                        texSig.format = getFormatFromMapType(loadTexAsSrgb, texData[texID].format, falcorType);
+                        texSig.pData = texData[texID].data.data();
+                        // Check if we already created a matching texture
+                        auto existingTex = textures.find(texSig);
+                        if(existingTex != textures.end())
+                        {
+                            basicMaterial.pTextures[falcorType] = existingTex->second;
+                        }
+                        else
+                        {
+                            auto pTexture = Texture::create2D(texData[texID].width, texData[texID].height, texSig.format, 1, Texture::kMaxPossible, texSig.pData);
+                            pTexture->setSourceFilename(texData[texID].name);
+                            textures[texSig] = pTexture;
+                            basicMaterial.pTextures[falcorType] = pTexture;
+                        }
+                    }
 
-                    glm::vec3 xyz(pPosition[0], pPosition[1], pPosition[2]);
-                    min = glm::min(min, xyz);
-                    max = glm::max(max, xyz);
+                    // Create material and check if it already exists
+                    pMaterial = checkForExistingMaterial(basicMaterial.convertToMaterial());
+                    candidates.push_back(std::make_pair(&submesh, pMaterial));
                 }
 
-                BoundingBox box = BoundingBox::fromMinMax(min, max);
+                // create the index buffer
+                bufferStart = CpuTimer::getCurrentTimePoint();
+                uint32_t ibSize = submesh.numIndices * sizeof(uint32_t);
+                auto pIB = Buffer::create(ibSize, Buffer::BindFlags::Index, Buffer::CpuAccess::None, submesh.indices.data());
+                mTimings.bufferCreation += CpuTimer::calcDuration(bufferStart, CpuTimer::getCurrentTimePoint());
 
                 // create the mesh
-                auto pMesh = Mesh::create(pVBs, numVertices, pIB, numIndices, pLayout, Vao::Topology::TriangleList, pMaterial, box, false);
+                auto pMesh = Mesh::create(pVBs, mesh.numVertices, pIB, submesh.numIndices, mesh.pLayout, Vao::Topology::TriangleList, pMaterial, submesh.boundingBox, false);
 
                 if (version >= 6)
                 {
@@ -937,10 +1200,16 @@ namespace Falcor
                     model.addMeshInstance(pMesh, glm::mat4());
                 }
             }
+
+            // Release the decoded data as soon as it was uploaded
+            mesh.buffers.clear();
+            mesh.buffers.shrink_to_fit();
         }
+        mTimings.merge = CpuTimer::calcDuration(mergeStart, CpuTimer::getCurrentTimePoint());
 
         if(version >= 6)
         {
+            auto instanceStart = CpuTimer::getCurrentTimePoint();
             for(int32_t instanceID = 0; instanceID < numInstances; instanceID++)
             {
                 int32_t meshIdx = 0;
@@ -952,6 +1221,13 @@ namespace Falcor
                 readString(mStream);   // Name
                 readString(mStream);   // Meta-data
 
+                if(meshIdx < 0 || meshIdx >= numMeshes)
+                {
+                    std::string msg = "Error when loading model " + mModelName + ".\nInstance " + std::to_string(instanceID) + " references an invalid mesh.";
+                    logError(msg);
+                    return false;
+                }
+
                 if(enabled)
                 {
                     for(uint32_t i : meshToSubmeshesID[meshIdx])
@@ -960,8 +1236,19 @@ namespace Falcor
                     }
                 }
             }
+            mTimings.instances = CpuTimer::calcDuration(instanceStart, CpuTimer::getCurrentTimePoint());
         }
-        
+
+        // The decoded data isn't needed anymore
+        mpData.reset();
+        mFile.close();
+
+        mTimings.total += CpuTimer::calcDuration(createStart, CpuTimer::getCurrentTimePoint());
+        const ImportTimings& t = mTimings;
+        logInfo("Loaded model " + mModelName + " in " + std::to_string(t.total) + " ms (mapping " + std::to_string(t.fileMapping) + " ms, textures " + std::to_string(t.textures) +
+            " ms, scan " + std::to_string(t.scan) + " ms, decode " + std::to_string(t.decode) + " ms [vertices " + std::to_string(t.vertexDecode) + " ms, indices " + std::to_string(t.indexDecode) +
+            " ms, tangents " + std::to_string(t.tangentGeneration) + " ms], merge " + std::to_string(t.merge) + " ms [buffers " + std::to_string(t.bufferCreation) + " ms], instances " + std::to_string(t.instances) + " ms)");
+
         return true;
     }
 }
@@ -27,7 +27,8 @@
 ***************************************************************************/
 #pragma once
 #include <string>
-#include "Utils/BinaryFileStream.h"
+#include "Utils/MemoryMappedFile.h"
+#include "Utils/BinaryMemoryStream.h"
 #include "glm/vec3.hpp"
 #include "../Model.h"
 #include "Graphics/Model/Loaders/ModelImporter.h"
@@ -39,26 +40,58 @@ namespace Falcor
     class BinaryModelImporter : public ModelImporter
     {
     public:
+        /** Time spent in each phase of the import, in milliseconds.
+            The import runs in 3 passes - a serial scan of the file headers, a decode pass which runs on the thread pool, and a serial merge which creates the API objects.
+            vertexDecode, indexDecode and tangentGeneration are summed across the worker threads, so they can be larger than the decode wall-clock time.
+        */
+        struct ImportTimings
+        {
+            float fileMapping = 0;          ///< Opening and mapping the file
+            float textures = 0;             ///< Decoding the texture block
+            float scan = 0;                 ///< Scanning the mesh and submesh headers, excluding textures
+            float decode = 0;               ///< Wall-clock time of the decode pass
+            float vertexDecode = 0;         ///< De-interleaving the vertex streams
+            float indexDecode = 0;          ///< Reading the index buffers and computing the submesh bounds
+            float tangentGeneration = 0;    ///< Generating bitangents for meshes which don't have them
+            float merge = 0;                ///< Wall-clock time of the merge pass, including buffer creation
+            float bufferCreation = 0;       ///< Creating the vertex and index buffers
+            float instances = 0;            ///< Reading the instance block
+            float total = 0;                ///< Total import time
+        };
+
         /** import a new model from internal binary format
             \param[in] filename Model's filename. Loader will look for it in the data directories.
             \param[in] flags Flags controlling model creation
+            \param[out] pTimings Optional. If not nullptr, on return will hold the time spent in each phase of the import
             returns nullptr if loading failed, otherwise a new Model object
         */
-        static bool import(Model& model, const std::string& filename, Model::LoadFlags flags);
+        static bool import(Model& model, const std::string& filename, Model::LoadFlags flags, ImportTimings* pTimings = nullptr);
 
-    private:
-        BinaryModelImporter(const std::string& fullpath);
-        bool importModel(Model& model, Model::LoadFlags flags);
+        /** Read and decode a model file without creating any API objects. Can be called from any thread.
+            \param[in] filename Model's filename. Loader will look for it in the data directories.
+            \param[in] flags Flags controlling model creation
+            \return nullptr if reading the file failed, otherwise an importer which is ready for createModel()
+        */
+        static SharedPtr prepare(const std::string& filename, Model::LoadFlags flags);
 
-        std::string mModelName;
-        BinaryFileStream mStream;
+        ~BinaryModelImporter();
 
-        struct TangentSpace
-        {
-            glm::vec3 tangent;
-            glm::vec3 bitangent;
-        };
+        bool createModel(Model& model) override;
+
+        /** Get the time spent in each phase of the import so far
+        */
+        const ImportTimings& getTimings() const { return mTimings; }
+
+    private:
+        BinaryModelImporter(const std::string& filename, const std::string& fullpath, Model::LoadFlags flags);
+        bool readFile();
 
-        static const uint32_t kInvalidOffset = uint32_t(-1);
+        struct FileData;
+        std::string mModelName;
+        Model::LoadFlags mFlags;
+        MemoryMappedFile mFile;
+        BinaryMemoryStream mStream;
+        std::unique_ptr<FileData> mpData;
+        ImportTimings mTimings;
     };
 }
@@ -33,13 +33,33 @@
 
 namespace Falcor
 {
+    class Model;
+
+    /** Base class for the model importers.
+        Importing is split into 2 steps. The importer is created by its prepare() function, which reads the file and decodes it on the CPU. This step doesn't touch the device, so it can run on any thread.
+        createModel() then creates the API objects and fills the model. It must be called on the thread which owns the device.
+    */
     class ModelImporter
     {
+    public:
+        using SharedPtr = std::shared_ptr<ModelImporter>;
+        virtual ~ModelImporter() = default;
+
+        /** Create the API objects and fill the model with the data read by the importer. Can only be called once.
+        */
+        virtual bool createModel(Model& model) = 0;
+
+        /** Get the filename the importer was created with
+        */
+        const std::string& getFilename() const { return mFilename; }
+
     protected:
+        ModelImporter(const std::string& filename) : mFilename(filename) {}
 
         // If a similar material already exists, will return the existing one. Otherwise, will cache the material in pMaterial and return it
         Material::SharedPtr checkForExistingMaterial(const Material::SharedPtr& pMaterial);
 
         std::vector<Material::SharedPtr> mLoadedMaterials; // vector because we make use of operator==, and it's only for the importers
+        std::string mFilename;
     };
 }
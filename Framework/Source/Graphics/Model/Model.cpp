@@ -88,19 +88,32 @@ namespace Falcor
 
     Model::SharedPtr Model::createFromFile(const char* filename, LoadFlags flags)
     {
-        SharedPtr pModel = SharedPtr(new Model());
-        bool res;
+        return createFromPrepared(prepareFromFile(filename, flags));
+    }
+
+    ModelImporter::SharedPtr Model::prepareFromFile(const char* filename, LoadFlags flags)
+    {
         if(hasSuffix(filename, ".bin", false))
         {
-            res = BinaryModelImporter::import(*pModel, filename, flags);
+            return BinaryModelImporter::prepare(filename, flags);
         }
         else
         {
-            res = AssimpModelImporter::import(*pModel, filename, flags);
+            return AssimpModelImporter::prepare(filename, flags);
+        }
+    }
+
+    Model::SharedPtr Model::createFromPrepared(const ModelImporter::SharedPtr& pImporter)
+    {
+        if(pImporter == nullptr)
+        {
+            return nullptr;
         }
 
-        if(res)
+        SharedPtr pModel = SharedPtr(new Model());
+        if(pImporter->createModel(*pModel))
         {
+            const std::string& filename = pImporter->getFilename();
             pModel->calculateModelProperties();
             pModel->setFilename(filename);
 
@@ -41,6 +41,7 @@ namespace Falcor
     class AssimpModelImporter;
     class BinaryModelImporter;
     class SimpleModelImporter;
+    class ModelImporter;
     class BinaryModelExporter;
     class Buffer;
     class Camera;
@@ -65,12 +66,22 @@ namespace Falcor
             AssumeLinearSpaceTextures   = 0x4,    ///< By default, textures representing colors (diffuse/specular) are interpreted as sRGB data. Use this flag to force linear space for color textures.
             DontMergeMeshes             = 0x8,    ///< Preserve the original list of meshes in the scene, don't merge meshes with the same material
             BuffersAsShaderResource     = 0x10,   ///< Generate the VBs and IB with the shader-resource-view bind flag
+            SerialImport                = 0x20,   ///< Decode the model on the loading thread only. By default, importers which support it decode meshes on the global thread pool.
         };
 
         /** create a new model from file
         */
         static SharedPtr createFromFile(const char* filename, LoadFlags flags = LoadFlags::None);
 
+        /** Read and decode a model file without creating any API objects. This function is thread-safe, and can be used to load multiple models concurrently.
+            \return nullptr if reading the file failed, otherwise an importer which should be passed to createFromPrepared()
+        */
+        static std::shared_ptr<ModelImporter> prepareFromFile(const char* filename, LoadFlags flags = LoadFlags::None);
+
+        /** Create a model from an importer returned by prepareFromFile(). Must be called from the thread which owns the device.
+        */
+        static SharedPtr createFromPrepared(const std::shared_ptr<ModelImporter>& pImporter);
+
         static SharedPtr create();
 
         static const char* kSupportedFileFormatsStr;
@@ -238,7 +249,7 @@ namespace Falcor
         void deleteCulledMeshInstances(MeshInstanceList& meshInstances, const Camera *pCamera);
 
         BoundingBox mBoundingBox;
-        float mRadius;
+        float mRadius = 0;
 
         uint32_t mVertexCount;
         uint32_t mIndexCount;
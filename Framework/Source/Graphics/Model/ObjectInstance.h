@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <atomic>
 #include "Graphics/Paths/MovableObject.h"
 #include "Utils/AABB.h"
 #include "glm/mat4x4.hpp"
@@ -124,7 +125,7 @@ namespace Falcor
             }
 
             mBase.translation = translation;
-            mBase.matrixDirty = true;
+            setBaseDirty();
         };
 
         /** Gets the position/translation of the instance
@@ -135,7 +136,7 @@ namespace Falcor
         /** Sets scale of the instance
             \param[in] scaling Instance scale
         */
-        void setScaling(const glm::vec3& scaling) { mBase.scale = scaling; mBase.matrixDirty = true; }
+        void setScaling(const glm::vec3& scaling) { mBase.scale = scaling; setBaseDirty(); }
 
         /** Gets scale of the instance
             \return Scale of the instance
@@ -154,7 +155,7 @@ namespace Falcor
             mBase.up = rotMtx[1];
             mBase.target = mBase.translation + rotMtx[2]; // position + forward
 
-            mBase.matrixDirty = true;
+            setBaseDirty();
         }
 
         /** Gets rotation for the instance
@@ -171,9 +172,9 @@ namespace Falcor
         }
 
 // #toodo comments
-        void setUpVector(const glm::vec3& up) { mBase.up = glm::normalize(up); mBase.matrixDirty = true; }
+        void setUpVector(const glm::vec3& up) { mBase.up = glm::normalize(up); setBaseDirty(); }
 
-        void setTarget(const glm::vec3& target) { mBase.target = target; mBase.matrixDirty = true; }
+        void setTarget(const glm::vec3& target) { mBase.target = target; setBaseDirty(); }
 
         /** Gets the up vector of the instance
             \return Up vector
@@ -203,6 +204,21 @@ namespace Falcor
             return mBoundingBox;
         }
 
+        /** Gets a counter which changes every time the transform matrix changes. Can be used to keep data derived from the transform up to date.
+            Versions are drawn from a counter shared by all instances of this type, so two different instances never report the same version, even if one reuses the address of a deleted one.
+            \return The transform version
+        */
+        uint64_t getTransformVersion() const
+        {
+            updateInstanceProperties();
+            return mTransformVersion;
+        }
+
+        /** Gets a counter which is incremented whenever the transform of any instance of this type is changed. An owner of many instances can compare it with the value it last saw to skip refreshing its instances when none of them moved.
+            \return The number of transform changes so far
+        */
+        static uint64_t getTransformChangeCount() { return sTransformChangeCount.load(); }
+
         /** IMovableObject interface
         */
         virtual void move(const glm::vec3& position, const glm::vec3& target, const glm::vec3& up) override
@@ -212,6 +228,7 @@ namespace Falcor
             mMovable.up = up;
             mMovable.scale = glm::vec3(1.0f);
             mMovable.matrixDirty = true;
+            sTransformChangeCount++;
         }
 
         SharedPtr shared_from_this()
@@ -225,6 +242,12 @@ namespace Falcor
         }
     private:
 
+        void setBaseDirty()
+        {
+            mBase.matrixDirty = true;
+            sTransformChangeCount++;
+        }
+
         void updateInstanceProperties() const
         {
             if (mBase.matrixDirty || mMovable.matrixDirty)
@@ -243,6 +266,7 @@ namespace Falcor
 
                 mFinalTransformMatrix = mMovable.matrix * mBase.matrix;
                 mBoundingBox = mpObject->getBoundingBox().transform(mFinalTransformMatrix);
+                mTransformVersion = ++sTransformVersionCounter;
             }
         }
 
@@ -317,5 +341,15 @@ namespace Falcor
 
         mutable glm::mat4 mFinalTransformMatrix;
         mutable BoundingBox mBoundingBox;
+        mutable uint64_t mTransformVersion = 0;
+
+        static std::atomic<uint64_t> sTransformChangeCount;
+        static std::atomic<uint64_t> sTransformVersionCounter;
     };
+
+    template<typename ObjectType>
+    std::atomic<uint64_t> ObjectInstance<ObjectType>::sTransformChangeCount(0);
+
+    template<typename ObjectType>
+    std::atomic<uint64_t> ObjectInstance<ObjectType>::sTransformVersionCounter(0);
 }
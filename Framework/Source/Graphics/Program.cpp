@@ -39,6 +39,10 @@
 #include "Utils/ShaderUtils.h"
 #include "API/RenderContext.h"
 #include "Utils/StringUtils.h"
+#include "Graphics/ShaderCache.h"
+#include "Utils/ThreadPool.h"
+#include <mutex>
+#include <algorithm>
 
 namespace Falcor
 {
@@ -84,40 +88,120 @@ namespace Falcor
         mOriginalShaderStrings[(uint32_t)ShaderType::Hull] = HS;
         mOriginalShaderStrings[(uint32_t)ShaderType::Domain] = DS;
         mCreatedFromFile = createdFromFile;
-        mDefineList = programDefines;
+        replaceAllDefines(programDefines);
     }
 
     void Program::init(const std::string& cs, const DefineList& programDefines, bool createdFromFile)
     {
         mOriginalShaderStrings[(uint32_t)ShaderType::Compute] = cs;
         mCreatedFromFile = createdFromFile;
-        mDefineList = programDefines;
+        replaceAllDefines(programDefines);
+    }
+
+    Program::DefineId Program::getDefineId(const std::string& name, const std::string& value)
+    {
+        // Every (name, value) pair gets an ID the first time it's used. Define names can't contain '=', so the string is unique for each pair.
+        static std::mutex sMutex;
+        static std::unordered_map<std::string, DefineId> sDefineIds;
+
+        // The key buffer is reused, so looking up a known define doesn't allocate
+        static thread_local std::string key;
+        key.assign(name);
+        key += '=';
+        key += value;
+
+        std::lock_guard<std::mutex> lock(sMutex);
+        auto it = sDefineIds.find(key);
+        if(it == sDefineIds.end())
+        {
+            it = sDefineIds.emplace(key, (DefineId)sDefineIds.size()).first;
+        }
+        return it->second;
+    }
+
+    Program::DefineIdList Program::getDefineIdList(const DefineList& defines)
+    {
+        DefineIdList ids;
+        ids.reserve(defines.size());
+        for(const auto& define : defines)
+        {
+            ids.push_back(getDefineId(define.first, define.second));
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    size_t Program::DefineIdListHash::operator()(const DefineIdList& ids) const
+    {
+        size_t hash = ids.size();
+        for(DefineId id : ids)
+        {
+            hash ^= id + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
+    void Program::insertDefineId(DefineId id)
+    {
+        mDefineIds.insert(std::lower_bound(mDefineIds.begin(), mDefineIds.end(), id), id);
+    }
+
+    void Program::eraseDefineId(DefineId id)
+    {
+        auto it = std::lower_bound(mDefineIds.begin(), mDefineIds.end(), id);
+        assert(it != mDefineIds.end() && *it == id);
+        mDefineIds.erase(it);
     }
 
     void Program::addDefine(const std::string& name, const std::string& value)
     {
-        // Make sure that it doesn't exist already
-        if(mDefineList.find(name) != mDefineList.end())
+        auto it = mDefineList.find(name);
+        if(it != mDefineList.end())
         {
-            if(mDefineList[name] == value)
+            if(it->second == value)
             {
                 // Same define
                 return;
             }
+            eraseDefineId(getDefineId(name, it->second));
+            it->second = value;
         }
+        else
+        {
+            mDefineList.emplace(name, value);
+        }
+        insertDefineId(getDefineId(name, value));
         mLinkRequired = true;
-        mDefineList[name] = value;
     }
 
     void Program::removeDefine(const std::string& name)
     {
-        if(mDefineList.find(name) != mDefineList.end())
+        auto it = mDefineList.find(name);
+        if(it != mDefineList.end())
+        {
+            eraseDefineId(getDefineId(name, it->second));
+            mDefineList.erase(it);
+            mLinkRequired = true;
+        }
+    }
+
+    void Program::clearDefines()
+    {
+        if(mDefineList.empty() == false)
         {
+            mDefineList.clear();
+            mDefineIds.clear();
             mLinkRequired = true;
-            mDefineList.erase(name);
         }
     }
 
+    void Program::replaceAllDefines(const DefineList& dl)
+    {
+        mDefineList = dl;
+        mDefineIds = getDefineIdList(dl);
+        mLinkRequired = true;
+    }
+
     bool Program::checkIfFilesChanged()
     {
         if(mpActiveProgram == nullptr)
@@ -144,8 +228,7 @@ namespace Falcor
     {
         if(mLinkRequired)
         {
-            const auto& it = mProgramVersions.find(mDefineList);
-            ProgramVersion::SharedConstPtr pVersion = nullptr;
+            const auto& it = mProgramVersions.find(mDefineIds);
             if(it == mProgramVersions.end())
             {
                 if(link() == false)
@@ -154,29 +237,79 @@ namespace Falcor
                 }
                 else
                 {
-                    mProgramVersions[mDefineList] = mpActiveProgram;
+                    mProgramVersions[mDefineIds] = mpActiveProgram;
                 }
             }
             else
             {
-                mpActiveProgram = mProgramVersions[mDefineList];
+                mpActiveProgram = it->second;
             }
+            mLinkRequired = false;
         }
 
         return mpActiveProgram;
     }
 
+    // Spire stores the preprocessed stdlib and builtin modules in the cache directory, so later runs skip lexing and preprocessing them
+    static SpireSession* createSpireSession()
+    {
+        if(ShaderCache::isEnabled())
+        {
+            const std::string dir = ShaderCache::getDirectory();
+            if(isDirectoryExists(dir) || createDirectory(dir))
+            {
+                return spCreateSession(dir.c_str());
+            }
+        }
+        return spCreateSession(NULL);
+    }
+
+    /** Builtin sources added with loadSpireBuiltins(). Every thread's session adds the ones it hasn't seen before it compiles.
+    */
+    struct SpireBuiltins
+    {
+        std::mutex mutex;
+        std::vector<std::pair<std::string, std::string>> sources;
+    };
+
+    static SpireBuiltins& getSpireBuiltins()
+    {
+        static SpireBuiltins builtins;
+        return builtins;
+    }
+
+    struct ThreadSpireSession
+    {
+        SpireSession* pSession = nullptr;
+        size_t builtinCount = 0;
+    };
+
+    // Spire keeps the builtin types of the stdlib in thread-local storage, and its ASTs use non-atomic reference counts. Every thread compiles with a session of its own, so the Spire front end runs concurrently.
+    // The sessions are never destroyed, the thread pool's threads live as long as the process.
+    static thread_local ThreadSpireSession tSpireSession;
+
     SpireSession* getSpireSession()
     {
-        // TODO: figure out a strategy for finalizing the Spire session, if desired
+        if(tSpireSession.pSession == nullptr)
+        {
+            tSpireSession.pSession = createSpireSession();
+        }
 
-        static SpireSession* spireSession = spCreateSession(NULL);
-        return spireSession;
+        SpireBuiltins& builtins = getSpireBuiltins();
+        std::lock_guard<std::mutex> lock(builtins.mutex);
+        for(; tSpireSession.builtinCount < builtins.sources.size(); tSpireSession.builtinCount++)
+        {
+            const auto& source = builtins.sources[tSpireSession.builtinCount];
+            spAddBuiltins(tSpireSession.pSession, source.first.c_str(), source.second.c_str());
+        }
+        return tSpireSession.pSession;
     }
 
     void loadSpireBuiltins(char const* name, char const* text)
     {
-        spAddBuiltins(getSpireSession(), name, text);
+        SpireBuiltins& builtins = getSpireBuiltins();
+        std::lock_guard<std::mutex> lock(builtins.mutex);
+        builtins.sources.emplace_back(name, text);
     }
 
     static const char* getSpireTargetString(ShaderType type)
@@ -203,9 +336,85 @@ namespace Falcor
         }
     }
 
-    ProgramVersion::SharedPtr Program::preprocessAndCreateProgramVersion(std::string& log) const
+    std::string Program::getShaderCacheKey(const DefineList& defines) const
     {
-        mFileTimeMap.clear();
+#if defined(FALCOR_GL)
+        std::string key = "GLSL\n";
+#elif defined(FALCOR_D3D)
+        std::string key = "HLSL\n";
+#else
+#error unknown shader compilation target
+#endif
+        // The search paths change the way includes are resolved
+        for(const auto& path : getDataDirectoriesList())
+        {
+            key += "dir " + path + '\n';
+        }
+
+        for(const auto& shaderDefine : defines)
+        {
+            key += "define " + shaderDefine.first + '=' + shaderDefine.second + '\n';
+        }
+
+        for(uint32_t i = 0; i < kShaderCount; i++)
+        {
+            if(mOriginalShaderStrings[i].size())
+            {
+                key += std::string(getSpireTargetString(ShaderType(i))) + ' ';
+                if(mCreatedFromFile)
+                {
+                    std::string fullpath;
+                    if(findFileInDataDirectories(mOriginalShaderStrings[i], fullpath))
+                    {
+                        key += fullpath + ' ' + std::to_string(ShaderCache::getFileHash(fullpath));
+                    }
+                    key += '\n';
+                }
+                else
+                {
+                    key += std::to_string(ShaderCache::getStringHash(mOriginalShaderStrings[i])) + '\n';
+                }
+            }
+        }
+        return key;
+    }
+
+    ProgramVersion::SharedPtr Program::preprocessAndCreateProgramVersion(const DefineList& defines, string_time_map& fileTimeMap, std::string& log) const
+    {
+        PreprocessedProgram program;
+        if(preprocess(defines, program, log) == false)
+        {
+            return nullptr;
+        }
+        fileTimeMap = program.fileTimeMap;
+
+        // Now that we've preprocessed things, dispatch to the actual program creation logic,
+        // which may vary in subclasses of `Program`
+        return createProgramVersion(program, log);
+    }
+
+    bool Program::preprocess(const DefineList& defines, PreprocessedProgram& program, std::string& log) const
+    {
+        // Check if the output of a previous Spire compilation was cached
+        std::string cacheKey;
+        if(ShaderCache::isEnabled())
+        {
+            cacheKey = getShaderCacheKey(defines);
+            ShaderCache::Entry entry;
+            if(ShaderCache::load(cacheKey, entry))
+            {
+                for(uint32_t i = 0; i < kShaderCount; i++)
+                {
+                    program.shaderStrings[i] = std::move(entry.shaders[i]);
+                }
+                program.pReflector = entry.pReflector;
+                for(const auto& depFilePath : entry.dependencies)
+                {
+                    program.fileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+                }
+                return true;
+            }
+        }
 
         // Run all of the shaders through Spire, so that we can get final code,
         // reflection data, etc.
@@ -229,7 +438,7 @@ namespace Falcor
 
         // Pass any `#define` flags along to Spire, since we aren't doing our
         // own preprocessing any more.
-        for(auto shaderDefine : mDefineList)
+        for(auto shaderDefine : defines)
         {
             spAddPreprocessorDefine(spireRequest, shaderDefine.first.c_str(), shaderDefine.second.c_str());
         }
@@ -239,7 +448,7 @@ namespace Falcor
         spSetCodeGenTarget(spireRequest, SPIRE_GLSL);
         spAddPreprocessorDefine(spireRequest, "FALCOR_GLSL", "1");
         SpireSourceLanguage sourceLanguage = SPIRE_SOURCE_LANGUAGE_GLSL;
-#elif defined(FALCOR_D3D11) || defined(FALCOR_D3D12)
+#elif defined(FALCOR_D3D)
         // Note: we could compile Spire directly to DXBC (by having Spire invoke the MS compiler for us,
         // but that path seems to have more issues at present, so let's just go to HLSL instead...)
         spSetCodeGenTarget(spireRequest, SPIRE_HLSL);
@@ -290,7 +499,7 @@ namespace Falcor
         if(anySpireErrors)
         {
             spDestroyCompileRequest(spireRequest);
-            return nullptr;
+            return false;
         }
 
         // Extract the generated code for each stage
@@ -303,50 +512,62 @@ namespace Falcor
             int translationUnitIndex = translationUnitsExtracted++;
             assert(translationUnitIndex < translationUnitsAdded);
 
-            mPreprocessedShaderStrings[i] = spGetTranslationUnitSource(spireRequest, translationUnitIndex);
+            program.shaderStrings[i] = spGetTranslationUnitSource(spireRequest, translationUnitIndex);
         }
         assert(translationUnitsExtracted == translationUnitsAdded);
 
         // Extract the reflection data
-        mPreprocessedReflector = ProgramReflection::create(spire::ShaderReflection::get(spireRequest), log);
+        program.pReflector = ProgramReflection::create(spire::ShaderReflection::get(spireRequest), log);
 
         // Extract list of files referenced, for dependency-tracking purposes
         int depFileCount = spGetDependencyFileCount(spireRequest);
         for(int ii = 0; ii < depFileCount; ++ii)
         {
             std::string depFilePath = spGetDependencyFilePath(spireRequest, ii);
-            mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            program.fileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
         }
 
         spDestroyCompileRequest(spireRequest);
 
-        // Now that we've preprocessed things, dispatch to the actual program creation logic,
-        // which may vary in subclasses of `Program`
-        return createProgramVersion(log);
+        if(cacheKey.size() && program.pReflector)
+        {
+            ShaderCache::Entry entry;
+            for(uint32_t i = 0; i < kShaderCount; i++)
+            {
+                entry.shaders[i] = program.shaderStrings[i];
+            }
+            entry.pReflector = program.pReflector;
+            for(const auto& dep : program.fileTimeMap)
+            {
+                entry.dependencies.push_back(dep.first);
+            }
+            ShaderCache::store(cacheKey, entry);
+        }
+        return true;
     }
 
-    ProgramVersion::SharedPtr Program::createProgramVersion(std::string& log) const
+    ProgramVersion::SharedPtr Program::createProgramVersion(const PreprocessedProgram& program, std::string& log) const
     {
         // create the shaders
         Shader::SharedPtr shaders[kShaderCount] = {};
         for (uint32_t i = 0; i < kShaderCount; i++)
         {
-            if (mPreprocessedShaderStrings[i].size())
+            if (program.shaderStrings[i].size())
             { 
-                shaders[i] = createShaderFromString(mPreprocessedShaderStrings[i], ShaderType(i));
+                shaders[i] = createShaderFromString(program.shaderStrings[i], ShaderType(i));
             }           
         }
 
         if (shaders[(uint32_t)ShaderType::Compute])
         {
             return ProgramVersion::create(
-                mPreprocessedReflector,
+                program.pReflector,
                 shaders[(uint32_t)ShaderType::Compute], log, getProgramDescString());
         }
         else
         {
             return ProgramVersion::create(
-                mPreprocessedReflector,
+                program.pReflector,
                 shaders[(uint32_t)ShaderType::Vertex],
                 shaders[(uint32_t)ShaderType::Pixel],
                 shaders[(uint32_t)ShaderType::Geometry],
@@ -364,7 +585,8 @@ namespace Falcor
         {
             // create the program
             std::string log;
-            ProgramVersion::SharedConstPtr pProgram = preprocessAndCreateProgramVersion(log);
+            string_time_map fileTimeMap;
+            ProgramVersion::SharedConstPtr pProgram = preprocessAndCreateProgramVersion(mDefineList, fileTimeMap, log);
 
             if(pProgram == nullptr)
             {
@@ -380,12 +602,67 @@ namespace Falcor
             }
             else
             {
+                for(const auto& file : fileTimeMap)
+                {
+                    mFileTimeMap[file.first] = file.second;
+                }
                 mpActiveProgram = pProgram;
                 return true;
             }
         }
     }
 
+    bool Program::compileVersions(const std::vector<DefineList>& defineLists) const
+    {
+        // Skip versions we already have
+        std::vector<const DefineList*> pending;
+        std::vector<DefineIdList> pendingIds;
+        for(const auto& defines : defineLists)
+        {
+            DefineIdList ids = getDefineIdList(defines);
+            if((mProgramVersions.find(ids) == mProgramVersions.end()) && (std::find(pendingIds.begin(), pendingIds.end(), ids) == pendingIds.end()))
+            {
+                pending.push_back(&defines);
+                pendingIds.push_back(std::move(ids));
+            }
+        }
+
+        struct CompileResult
+        {
+            ProgramVersion::SharedConstPtr pVersion;
+            string_time_map fileTimeMap;
+            std::string log;
+        };
+        std::vector<CompileResult> results(pending.size());
+
+        ThreadPool::getGlobalPool().parallelFor((uint32_t)pending.size(), [&](uint32_t i)
+        {
+            results[i].pVersion = preprocessAndCreateProgramVersion(*pending[i], results[i].fileTimeMap, results[i].log);
+        });
+
+        bool success = true;
+        for(size_t i = 0; i < pending.size(); i++)
+        {
+            if(results[i].pVersion)
+            {
+                mProgramVersions[pendingIds[i]] = results[i].pVersion;
+                for(const auto& file : results[i].fileTimeMap)
+                {
+                    mFileTimeMap[file.first] = file.second;
+                }
+            }
+            else
+            {
+                logError("Program Linkage failed.\n\n" + getProgramDescString() + "\n" + results[i].log);
+                success = false;
+            }
+        }
+
+        // The active version might be one of the versions we just compiled
+        mLinkRequired = true;
+        return success;
+    }
+
     void Program::reset()
     {
         mpActiveProgram = nullptr;
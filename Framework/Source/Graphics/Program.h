@@ -28,6 +28,7 @@
 #pragma once
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include "API/ProgramVersion.h"
 
@@ -67,7 +68,7 @@ namespace Falcor
 
         /** Clear the macro definition list
         */
-        void clearDefines() { mDefineList.clear(); }
+        void clearDefines();
     
         /** Get the macro definition string of the active program version
         */
@@ -79,34 +80,67 @@ namespace Falcor
 
         /** update define list
         */
-        void replaceAllDefines(const DefineList& dl) { mDefineList = dl; }
+        void replaceAllDefines(const DefineList& dl);
+
+        /** Compile program versions for a set of define lists, without changing the active define list. Later calls to getActiveVersion() with one of these define lists will not need to link.
+            The versions are compiled in parallel on the global thread pool. Versions which were already compiled are skipped.
+            \param[in] defineLists The define lists to compile
+            \return true if all the versions compiled successfully, otherwise false. Errors are logged, no message box is shown.
+        */
+        bool compileVersions(const std::vector<DefineList>& defineLists) const;
     protected:
         static const uint32_t kShaderCount = (uint32_t)ShaderType::Count;
+        using string_time_map = std::unordered_map<std::string, time_t>;
+
+        /** Program versions are looked up by the IDs of their defines. Every (name, value) pair is interned to a small integer ID the first time it's used, and the active defines are kept as a sorted list of IDs next to the define list.
+            The ID list doesn't depend on the order the defines were added in, and two define lists are equal exactly when their ID lists are, so a lookup compares a few integers instead of strings.
+        */
+        using DefineId = uint32_t;
+        using DefineIdList = std::vector<DefineId>;
+        struct DefineIdListHash
+        {
+            size_t operator()(const DefineIdList& ids) const;
+        };
+        static DefineId getDefineId(const std::string& name, const std::string& value);
+        static DefineIdList getDefineIdList(const DefineList& defines);
+
+        /** The output of Spire for a single program version
+        */
+        struct PreprocessedProgram
+        {
+            std::string shaderStrings[kShaderCount];
+            ProgramReflection::SharedPtr pReflector;
+            string_time_map fileTimeMap;            ///< The files the program depends on
+        };
 
         Program();
         void init(const std::string& vs, const std::string& fs, const std::string& gs, const std::string& hs, const std::string& ds, const DefineList& programDefines, bool createdFromFile);
         void init(const std::string& cs, const DefineList& programDefines, bool createdFromFile);
 
         bool link() const;
-        ProgramVersion::SharedPtr preprocessAndCreateProgramVersion(std::string& log) const;
-        virtual ProgramVersion::SharedPtr createProgramVersion(std::string& log) const;
+
+        // These functions don't change the program's state, and can be called concurrently
+        ProgramVersion::SharedPtr preprocessAndCreateProgramVersion(const DefineList& defines, string_time_map& fileTimeMap, std::string& log) const;
+        bool preprocess(const DefineList& defines, PreprocessedProgram& program, std::string& log) const;
+        virtual ProgramVersion::SharedPtr createProgramVersion(const PreprocessedProgram& program, std::string& log) const;
+        std::string getShaderCacheKey(const DefineList& defines) const;
 
         std::string mOriginalShaderStrings[kShaderCount]; // Either a filename or a string, depending on the value of mCreatedFromFile
-        mutable std::string mPreprocessedShaderStrings[kShaderCount]; // always strings that have been preprocessed
-        mutable ProgramReflection::SharedPtr mPreprocessedReflector;
 
         DefineList mDefineList;
+        DefineIdList mDefineIds;            ///< Always equal to getDefineIdList(mDefineList)
+        void insertDefineId(DefineId id);
+        void eraseDefineId(DefineId id);
 
         // We are doing lazy compilation, so these are mutable
         mutable bool mLinkRequired = true;
-        mutable std::map<const DefineList, ProgramVersion::SharedConstPtr> mProgramVersions;
+        mutable std::unordered_map<DefineIdList, ProgramVersion::SharedConstPtr, DefineIdListHash> mProgramVersions;
         mutable ProgramVersion::SharedConstPtr mpActiveProgram = nullptr;
 
         std::string getProgramDescString() const;
         static std::vector<Program*> sPrograms;
 
         bool mCreatedFromFile = false;
-        using string_time_map = std::unordered_map<std::string, time_t>;
         mutable string_time_map mFileTimeMap;
 
         bool checkIfFilesChanged();
@@ -0,0 +1,113 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "DrawList.h"
+#include "Utils/ThreadPool.h"
+
+namespace Falcor
+{
+    static const uint32_t kConstantsAlignment = 16;
+
+    DrawList::UniquePtr DrawList::create(uint32_t pageSize)
+    {
+        return UniquePtr(new DrawList(pageSize));
+    }
+
+    void DrawList::reset()
+    {
+        mDraws.clear();
+        mCurrentPage = 0;
+        mPageOffset = 0;
+    }
+
+    uint8_t* DrawList::allocateConstants(uint32_t size)
+    {
+        size = (size + kConstantsAlignment - 1) & ~(kConstantsAlignment - 1);
+        while(mCurrentPage < mPages.size())
+        {
+            Page& page = mPages[mCurrentPage];
+            if(mPageOffset + size <= page.size)
+            {
+                uint8_t* pData = page.pData.get() + mPageOffset;
+                mPageOffset += size;
+                return pData;
+            }
+            mCurrentPage++;
+            mPageOffset = 0;
+        }
+
+        // Out of pages. new[] returns memory aligned for any fundamental type, which is at least 16 bytes on x64.
+        Page page;
+        page.size = std::max(size, mPageSize);
+        page.pData = std::unique_ptr<uint8_t[]>(new uint8_t[page.size]);
+        mPages.push_back(std::move(page));
+        mCurrentPage = (uint32_t)mPages.size() - 1;
+        mPageOffset = size;
+        return mPages.back().pData.get();
+    }
+
+    size_t DrawList::getPageMemorySize() const
+    {
+        size_t size = 0;
+        for(const auto& page : mPages)
+        {
+            size += page.size;
+        }
+        return size;
+    }
+
+    void ParallelDrawListBuilder::build(uint32_t batchCount, uint32_t batchesPerChunk, const BuildFunc& func, bool parallel)
+    {
+        batchesPerChunk = std::max(batchesPerChunk, 1u);
+        mListCount = (batchCount + batchesPerChunk - 1) / batchesPerChunk;
+        while(mLists.size() < mListCount)
+        {
+            mLists.push_back(DrawList::create());
+        }
+
+        auto buildChunk = [&](uint32_t chunk)
+        {
+            DrawList* pList = mLists[chunk].get();
+            pList->reset();
+            uint32_t firstBatch = chunk * batchesPerChunk;
+            func(pList, firstBatch, std::min(batchesPerChunk, batchCount - firstBatch));
+        };
+
+        if(parallel && mListCount > 1)
+        {
+            ThreadPool::getGlobalPool().parallelFor(mListCount, buildChunk);
+        }
+        else
+        {
+            for(uint32_t chunk = 0; chunk < mListCount; chunk++)
+            {
+                buildChunk(chunk);
+            }
+        }
+    }
+}
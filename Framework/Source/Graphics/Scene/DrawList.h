@@ -0,0 +1,135 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <memory>
+#include <functional>
+
+namespace Falcor
+{
+    /** A CPU-side list of draws and their per-draw constants. It doesn't hold any graphics API commands - the caller issues the draws by walking the list.
+        A draw references a range of items in the caller's draw list and a block of per-draw constants. The constants are stored in pages owned by the list, which are reused after reset(), so building a frame doesn't allocate once the pages are warm.
+        A list must only be built by one thread at a time. Build different lists to prepare draws in parallel.
+    */
+    class DrawList
+    {
+    public:
+        using UniquePtr = std::unique_ptr<DrawList>;
+
+        static const uint32_t kDefaultPageSize = 64 * 1024;
+
+        struct Draw
+        {
+            uint32_t firstItem;             ///< Index of the draw's first item in the caller's draw list
+            uint32_t itemCount;             ///< Number of consecutive items the draw covers, for example its instance count
+            const uint8_t* pConstants;      ///< Per-draw constants, stored in the list's pages
+            uint32_t constantsSize;         ///< Size of the constants in bytes
+        };
+
+        /** Create a new command list.
+            \param[in] pageSize Size of the pages the constants are allocated from. Larger allocations get a page of their own.
+        */
+        static UniquePtr create(uint32_t pageSize = kDefaultPageSize);
+
+        /** Remove the draws. The pages are kept for the next build.
+        */
+        void reset();
+
+        /** Allocate per-draw constants. The memory is 16-byte aligned and stays valid until reset() is called.
+        */
+        uint8_t* allocateConstants(uint32_t size);
+
+        /** Add a draw
+        */
+        void addDraw(uint32_t firstItem, uint32_t itemCount, const uint8_t* pConstants, uint32_t constantsSize) { mDraws.push_back({ firstItem, itemCount, pConstants, constantsSize }); }
+
+        const std::vector<Draw>& getDraws() const { return mDraws; }
+
+        /** Get the total size of the list's pages in bytes
+        */
+        size_t getPageMemorySize() const;
+
+    private:
+        DrawList(uint32_t pageSize) : mPageSize(pageSize) {}
+
+        struct Page
+        {
+            std::unique_ptr<uint8_t[]> pData;
+            uint32_t size;
+        };
+
+        std::vector<Draw> mDraws;
+        std::vector<Page> mPages;
+        uint32_t mCurrentPage = 0;
+        uint32_t mPageOffset = 0;
+        uint32_t mPageSize;
+    };
+
+    /** Builds draw lists on the global thread pool. Only the draw lists and their constants are built in parallel - the graphics API calls are still issued on one thread, by walking the lists with forEachDraw().
+        The batches are split into chunks of consecutive batches, and every chunk is built into a list of its own. Whichever worker builds a chunk, the lists are returned in chunk order, so walking them in order reproduces the serial draw order.
+        The lists are kept between calls to build(), so their pages are reused.
+    */
+    class ParallelDrawListBuilder
+    {
+    public:
+        /** Function which adds the batches [firstBatch, firstBatch + batchCount) to pList
+        */
+        using BuildFunc = std::function<void(DrawList* pList, uint32_t firstBatch, uint32_t batchCount)>;
+
+        /** Build the lists. The lists of the previous call are reset.
+            \param[in] batchCount Number of batches to add
+            \param[in] batchesPerChunk Number of batches added to each list
+            \param[in] func Function which builds a chunk. It's called concurrently for different chunks.
+            \param[in] parallel If false, all the chunks are built on the calling thread
+        */
+        void build(uint32_t batchCount, uint32_t batchesPerChunk, const BuildFunc& func, bool parallel = true);
+
+        /** Get the number of lists built by the last call to build()
+        */
+        uint32_t getListCount() const { return mListCount; }
+        const DrawList* getList(uint32_t index) const { return mLists[index].get(); }
+
+        /** Call func(const DrawList::Draw&) for every draw, in submission order
+        */
+        template<typename Func>
+        void forEachDraw(Func func) const
+        {
+            for(uint32_t i = 0; i < mListCount; i++)
+            {
+                for(const auto& draw : mLists[i]->getDraws())
+                {
+                    func(draw);
+                }
+            }
+        }
+
+    private:
+        std::vector<DrawList::UniquePtr> mLists;
+        uint32_t mListCount = 0;
+    };
+}
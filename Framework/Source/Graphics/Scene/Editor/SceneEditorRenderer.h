@@ -52,6 +52,7 @@ namespace Falcor
 
         virtual void setPerFrameData(const CurrentWorkingData& currentData) override;
         virtual bool setPerModelInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t instanceID);
+        virtual bool supportsRenderQueue() const override { return false; }
         Gizmo::Gizmos mGizmos;
 
         GraphicsProgram::SharedPtr mpProgram;
@@ -28,6 +28,8 @@
 #include "Framework.h"
 #include "Scene.h"
 #include "SceneImporter.h"
+#include "Utils/ThreadPool.h"
+#include <algorithm>
 #include "glm/gtx/euler_angles.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 
@@ -49,6 +51,50 @@ namespace Falcor
         return pScene;
     }
 
+    Scene::AsyncLoad::SharedPtr Scene::loadFromFileAsync(const std::string& filename, Model::LoadFlags modelLoadFlags, Scene::LoadFlags sceneLoadFlags)
+    {
+        AsyncLoad::SharedPtr pLoad = AsyncLoad::SharedPtr(new AsyncLoad());
+        pLoad->mpScene = create();
+        pLoad->mpImporter = SceneImporter::beginLoadScene(*pLoad->mpScene, filename, modelLoadFlags, sceneLoadFlags);
+        if(pLoad->mpImporter == nullptr)
+        {
+            return nullptr;
+        }
+        pLoad->mFuture = pLoad->mpImporter->getPreparedFuture();
+        return pLoad;
+    }
+
+    Scene::AsyncLoad::~AsyncLoad() = default;
+
+    float Scene::AsyncLoad::getProgress() const
+    {
+        return mpImporter ? mpImporter->getProgress() : 1.0f;
+    }
+
+    bool Scene::AsyncLoad::isReady() const
+    {
+        return mFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    const std::shared_future<void>& Scene::AsyncLoad::getFuture() const
+    {
+        return mFuture;
+    }
+
+    Scene::SharedPtr Scene::AsyncLoad::getScene()
+    {
+        if(mpImporter)
+        {
+            mFuture.wait();
+            if(mpImporter->finishLoad() == false)
+            {
+                mpScene = nullptr;
+            }
+            mpImporter = nullptr;
+        }
+        return mpScene;
+    }
+
     Scene::SharedPtr Scene::create()
     {
         return SharedPtr(new Scene());
@@ -66,45 +112,90 @@ namespace Falcor
 
     Scene::~Scene() = default;
 
+    static const uint32_t kInstancesPerUpdateItem = 64;
+
+    void Scene::forEachUpdateItem(uint32_t count, const std::function<void(uint32_t)>& func) const
+    {
+        if(mParallelUpdate && count > 1)
+        {
+            ThreadPool::getGlobalPool().parallelFor(count, func);
+        }
+        else
+        {
+            for(uint32_t i = 0; i < count; i++)
+            {
+                func(i);
+            }
+        }
+    }
+
+    void Scene::updateInstances(bool calcBounds)
+    {
+        mUpdateInstances.clear();
+        for(const auto& instances : mModels)
+        {
+            for(const auto& pInstance : instances)
+            {
+                mUpdateInstances.push_back(pInstance.get());
+            }
+        }
+        mInstanceBounds.resize(calcBounds ? mUpdateInstances.size() : 0);
+
+        // Every item updates a range of instances. Instances don't share any state, so they can be updated concurrently.
+        uint32_t instanceCount = (uint32_t)mUpdateInstances.size();
+        uint32_t itemCount = (instanceCount + kInstancesPerUpdateItem - 1) / kInstancesPerUpdateItem;
+        forEachUpdateItem(itemCount, [this, calcBounds, instanceCount](uint32_t item)
+        {
+            uint32_t end = std::min((item + 1) * kInstancesPerUpdateItem, instanceCount);
+            for(uint32_t i = item * kInstancesPerUpdateItem; i < end; i++)
+            {
+                const ModelInstance* pInstance = mUpdateInstances[i];
+                const glm::mat4& transform = pInstance->getTransformMatrix();
+                if(calcBounds)
+                {
+                    const Model* pModel = pInstance->getObject().get();
+                    const vec3 instC = vec3(vec4(pModel->getCenter(), 1.f) * transform);
+                    const vec3 scaling = pInstance->getScaling();
+                    const float instR = pModel->getRadius() * max(scaling.x, max(scaling.y, scaling.z));
+                    mInstanceBounds[i] = vec4(instC, instR);
+                }
+            }
+        });
+    }
+
     void Scene::updateExtents()
     {
         if (mExtentsDirty)
         {
             mExtentsDirty = false;
+            updateInstances(true);
 
+            // The spheres are merged serially, in instance order, so the result doesn't depend on how the instances were distributed across threads
             mRadius = 0.f;
             float k = 0.f;
             mCenter = vec3(0, 0, 0);
-            for (uint32_t i = 0; i < getModelCount(); ++i)
+            for (const vec4& bounds : mInstanceBounds)
             {
-                const auto& model = getModel(i);
-                const float r = model->getRadius();
-                const vec3 c = model->getCenter();
-                for (uint32_t j = 0; j < getModelInstanceCount(i); ++j)
+                const vec3 instC = vec3(bounds);
+                const float instR = bounds.w;
+
+                if (k == 0.f)
                 {
-                    const auto& inst = getModelInstance(i, j);
-                    const vec3 instC = vec3(vec4(c, 1.f) * inst->getTransformMatrix());
-                    const vec3 scaling = inst->getScaling();
-                    const float instR = r * max(scaling.x, max(scaling.y, scaling.z));
-
-                    if (k == 0.f)
-                    {
-                        mCenter = instC;
-                        mRadius = instR;
-                    }
-                    else
-                    {
-                        vec3 dir = instC - mCenter;
-                        if (length(dir) > 1e-6f)
-                            dir = normalize(dir);
-                        vec3 a = mCenter - dir * mRadius;
-                        vec3 b = instC + dir * instR;
-
-                        mCenter = (a + b) * 0.5f;
-                        mRadius = length(a - b);
-                    }
-                    k++;
+                    mCenter = instC;
+                    mRadius = instR;
                 }
+                else
+                {
+                    vec3 dir = instC - mCenter;
+                    if (length(dir) > 1e-6f)
+                        dir = normalize(dir);
+                    vec3 a = mCenter - dir * mRadius;
+                    vec3 b = instC + dir * instR;
+
+                    mCenter = (a + b) * 0.5f;
+                    mRadius = length(a - b);
+                }
+                k++;
             }
 
             // Update light extents
@@ -119,19 +210,83 @@ namespace Falcor
         }
     }
 
-    bool Scene::update(double currentTime, CameraController* cameraController)
+    bool Scene::arePathsIndependent()
     {
-        bool changed = false;
-        for (auto& path : mpPaths)
+        mPathObjects.clear();
+        for (const auto& pPath : mpPaths)
+        {
+            for (uint32_t i = 0; i < pPath->getAttachedObjectCount(); i++)
+            {
+                mPathObjects.push_back(pPath->getAttachedObject(i).get());
+            }
+        }
+        std::sort(mPathObjects.begin(), mPathObjects.end());
+        return std::adjacent_find(mPathObjects.begin(), mPathObjects.end()) == mPathObjects.end();
+    }
+
+    bool Scene::animatePathsAndModels(double currentTime)
+    {
+        mAnimatedModels.clear();
+        for (uint32_t i = 0; i < getModelCount(); i++)
+        {
+            Model* pModel = getModel(i).get();
+            if (pModel->hasAnimations() && pModel->getActiveAnimation() != AnimationController::kBindPoseAnimationId)
+            {
+                mAnimatedModels.push_back(pModel);
+            }
+        }
+
+        // If an object is attached to several paths, the last path has to win, so all the paths are animated by a single item
+        uint32_t pathCount = (uint32_t)mpPaths.size();
+        bool serialPaths = (mParallelUpdate == false) || (arePathsIndependent() == false);
+        uint32_t pathItems = (serialPaths && pathCount) ? 1 : pathCount;
+        mPathChanged.assign(pathCount, 0);
+
+        forEachUpdateItem(pathItems + (uint32_t)mAnimatedModels.size(), [&](uint32_t item)
         {
-            if (path->animate(currentTime))
+            if (item >= pathItems)
+            {
+                mAnimatedModels[item - pathItems]->animate(currentTime);
+            }
+            else if (serialPaths)
             {
-                changed = true;
+                for (uint32_t i = 0; i < pathCount; i++)
+                {
+                    mPathChanged[i] = mpPaths[i]->animate(currentTime) ? 1 : 0;
+                }
             }
+            else
+            {
+                mPathChanged[item] = mpPaths[item]->animate(currentTime) ? 1 : 0;
+            }
+        });
+
+        bool changed = false;
+        for (uint8_t pathChanged : mPathChanged)
+        {
+            changed = changed || (pathChanged != 0);
         }
+        return changed;
+    }
 
+    bool Scene::update(double currentTime, CameraController* cameraController)
+    {
+        bool changed = animatePathsAndModels(currentTime);
         mExtentsDirty = mExtentsDirty || changed;
 
+        // Refresh the instance transforms which the paths or the user invalidated, so that the renderer doesn't update them one by one.
+        // The count is read first, so a change made while the instances are refreshed is picked up by the next update.
+        uint64_t transformChangeCount = ModelInstance::getTransformChangeCount();
+        if (mExtentsDirty)
+        {
+            updateExtents();
+        }
+        else if (transformChangeCount != mTransformChangeCount)
+        {
+            updateInstances(false);
+        }
+        mTransformChangeCount = transformChangeCount;
+
         // Ignore the elapsed time we got from the user. This will allow camera movement in cases where the time is frozen
         if (cameraController)
         {
@@ -29,6 +29,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <future>
+#include <functional>
 #include "Graphics/Model/Model.h"
 #include "Graphics/Light.h"
 #include "Graphics/Material/Material.h"
@@ -40,6 +42,8 @@
 
 namespace Falcor
 {
+    class SceneImporter;
+
     class Scene : public std::enable_shared_from_this<Scene>
     {
     public:
@@ -103,6 +107,45 @@ namespace Falcor
         };
 
         static Scene::SharedPtr loadFromFile(const std::string& filename, Model::LoadFlags modelLoadFlags = Model::LoadFlags::None, Scene::LoadFlags sceneLoadFlags = LoadFlags::None);
+
+        /** A scene which is being loaded in the background. Returned by loadFromFileAsync().
+            The models are read and decoded on the global thread pool. The API objects are created when getScene() is called.
+        */
+        class AsyncLoad
+        {
+        public:
+            using SharedPtr = std::shared_ptr<AsyncLoad>;
+            ~AsyncLoad();
+
+            /** Get the fraction of the models which finished loading, in the range [0, 1]
+            */
+            float getProgress() const;
+
+            /** Check if all the models finished loading. If this returns true, getScene() will not block.
+            */
+            bool isReady() const;
+
+            /** Get a future which becomes ready once all the models finished loading
+            */
+            const std::shared_future<void>& getFuture() const;
+
+            /** Wait for the models to finish loading and create the scene. Must be called from the thread which owns the device.
+                \return The scene, or nullptr if loading failed. Subsequent calls return the same result.
+            */
+            Scene::SharedPtr getScene();
+
+        private:
+            friend class Scene;
+            AsyncLoad() = default;
+            Scene::SharedPtr mpScene;
+            std::unique_ptr<SceneImporter> mpImporter;
+            std::shared_future<void> mFuture;
+        };
+
+        /** Start loading a scene in the background. The scene file is parsed on the calling thread.
+            \return nullptr if the scene file couldn't be parsed, otherwise an object which can be polled for progress and which creates the scene once loading finished.
+        */
+        static AsyncLoad::SharedPtr loadFromFileAsync(const std::string& filename, Model::LoadFlags modelLoadFlags = Model::LoadFlags::None, Scene::LoadFlags sceneLoadFlags = LoadFlags::None);
         static Scene::SharedPtr create();
 
         virtual ~Scene();
@@ -166,6 +209,11 @@ namespace Falcor
         // Camera update
         virtual bool update(double currentTime, CameraController* cameraController = nullptr);
 
+        /** Control whether update() and the extents calculation are distributed across the global thread pool. The results are identical to the serial update.
+        */
+        void setParallelUpdate(bool enable) { mParallelUpdate = enable; }
+        bool isParallelUpdateEnabled() const { return mParallelUpdate; }
+
         // User variables
         uint32_t getVersion() const { return mVersion; }
         void setVersion(uint32_t version) { mVersion = version; }
@@ -236,6 +284,15 @@ namespace Falcor
         vec3 mCenter = vec3(0, 0, 0);
 
         bool mExtentsDirty = true;
+        bool mParallelUpdate = true;
+        uint64_t mTransformChangeCount = 0;         // ModelInstance::getTransformChangeCount() when the instances were last refreshed
+
+        // Scratch data for update(). Kept around to avoid allocating it every frame.
+        std::vector<const ModelInstance*> mUpdateInstances;
+        std::vector<vec4> mInstanceBounds;          // xyz - center, w - radius. In the same order as mUpdateInstances.
+        std::vector<Model*> mAnimatedModels;
+        std::vector<uint8_t> mPathChanged;
+        std::vector<const IMovableObject*> mPathObjects;
 
         using string_uservar_map = std::map<const std::string, UserVariable>;
         string_uservar_map mUserVars;
@@ -36,6 +36,7 @@
 #include "glm/detail/func_trigonometric.hpp"
 #include "SceneExportImportCommon.h"
 #include "glm/gtx/euler_angles.hpp"
+#include "Utils/ThreadPool.h"
 
 namespace Falcor
 {
@@ -98,8 +99,101 @@ namespace Falcor
 
     bool SceneImporter::loadScene(Scene& scene, const std::string& filename, Model::LoadFlags modelLoadFlags, Scene::LoadFlags sceneLoadFlags)
     {
-        SceneImporter importer(scene);
-        return importer.load(filename, modelLoadFlags, sceneLoadFlags);
+        auto pImporter = beginLoadScene(scene, filename, modelLoadFlags, sceneLoadFlags);
+        return pImporter ? pImporter->finishLoad() : false;
+    }
+
+    std::unique_ptr<SceneImporter> SceneImporter::beginLoadScene(Scene& scene, const std::string& filename, Model::LoadFlags modelLoadFlags, Scene::LoadFlags sceneLoadFlags)
+    {
+        std::unique_ptr<SceneImporter> pImporter(new SceneImporter(scene));
+        if(pImporter->beginLoad(filename, modelLoadFlags, sceneLoadFlags) == false)
+        {
+            pImporter = nullptr;
+        }
+        return pImporter;
+    }
+
+    float SceneImporter::getProgress() const
+    {
+        if(mpPrepareState->total == 0)
+        {
+            return 1.0f;
+        }
+        return float(mpPrepareState->completed.load()) / float(mpPrepareState->total);
+    }
+
+    std::string SceneImporter::getModelPath(const rapidjson::Value& jsonModel) const
+    {
+        const std::string modelFile = jsonModel[SceneKeys::kFilename].GetString();
+        std::string file = mDirectory + '\\' + modelFile;
+        if(doesFileExist(file) == false)
+        {
+            file = modelFile;
+        }
+        return file;
+    }
+
+    void SceneImporter::prepareModels()
+    {
+        mpPrepareState = std::make_shared<PrepareState>();
+        mPreparedFuture = mpPrepareState->allPrepared.get_future().share();
+
+        const auto& jsonModels = mJDoc.FindMember(SceneKeys::kModels);
+        if(jsonModels != mJDoc.MemberEnd() && jsonModels->value.IsArray())
+        {
+            const rapidjson::Value& jsonVal = jsonModels->value;
+            mPreparedModels.resize(jsonVal.Size());
+
+            // Count the models first, so that the last task to finish knows it's the last one
+            for(uint32_t i = 0; i < jsonVal.Size(); i++)
+            {
+                const rapidjson::Value& jsonModel = jsonVal[i];
+                if(jsonModel.IsObject() && jsonModel.HasMember(SceneKeys::kFilename) && jsonModel[SceneKeys::kFilename].IsString())
+                {
+                    mpPrepareState->total++;
+                }
+            }
+
+            // Invalid entries are left without a future. createModel() will report the error when it reaches them.
+            for(uint32_t i = 0; i < jsonVal.Size(); i++)
+            {
+                const rapidjson::Value& jsonModel = jsonVal[i];
+                if(jsonModel.IsObject() && jsonModel.HasMember(SceneKeys::kFilename) && jsonModel[SceneKeys::kFilename].IsString())
+                {
+                    std::string file = getModelPath(jsonModel);
+                    Model::LoadFlags flags = mModelLoadFlags;
+                    auto pState = mpPrepareState;
+                    mPreparedModels[i] = ThreadPool::getGlobalPool().submit([pState, file, flags]()
+                    {
+                        // The task must always count itself as completed, otherwise the load would never finish. A failed prepare is reported by createModel() as a model which can't be loaded.
+                        ModelImporter::SharedPtr pImporter;
+                        try
+                        {
+                            pImporter = Model::prepareFromFile(file.c_str(), flags);
+                        }
+                        catch(const std::exception& e)
+                        {
+                            logError("Can't load model '" + file + "'. " + e.what());
+                        }
+                        catch(...)
+                        {
+                            logError("Can't load model '" + file + "'.");
+                        }
+
+                        if(++pState->completed == pState->total)
+                        {
+                            pState->allPrepared.set_value();
+                        }
+                        return pImporter;
+                    });
+                }
+            }
+        }
+
+        if(mpPrepareState->total == 0)
+        {
+            mpPrepareState->allPrepared.set_value();
+        }
     }
 
     bool SceneImporter::createModelInstances(const rapidjson::Value& jsonVal, const Model::SharedPtr& pModel)
@@ -172,7 +266,7 @@ namespace Falcor
         return true;
     }
 
-    bool SceneImporter::createModel(const rapidjson::Value& jsonModel)
+    bool SceneImporter::createModel(const rapidjson::Value& jsonModel, uint32_t modelIndex)
     {
         // Model must have at least a filename
         if(jsonModel.HasMember(SceneKeys::kFilename) == false)
@@ -185,13 +279,17 @@ namespace Falcor
             return error("Model filename must be a string");
         }
 
-        // Load the model
-        std::string file =  mDirectory + '\\' + modelFile.GetString();
-        if (doesFileExist(file) == false)
+        // Create the model. The file was read and decoded on the thread pool when the load began.
+        ModelImporter::SharedPtr pImporter;
+        if(modelIndex < mPreparedModels.size() && mPreparedModels[modelIndex].valid())
         {
-            file = modelFile.GetString();
+            pImporter = mPreparedModels[modelIndex].get();
         }
-        auto pModel = Model::createFromFile(file.c_str(), mModelLoadFlags);
+        else
+        {
+            pImporter = Model::prepareFromFile(getModelPath(jsonModel).c_str(), mModelLoadFlags);
+        }
+        auto pModel = Model::createFromPrepared(pImporter);
         if(pModel == nullptr)
         {
             return false;
@@ -323,7 +421,7 @@ namespace Falcor
         // Loop over the array
         for(uint32_t i = 0; i < jsonVal.Size(); i++)
         {
-            if(createModel(jsonVal[i]) == false)
+            if(createModel(jsonVal[i], i) == false)
             {
                 return false;
             }
@@ -1156,7 +1254,7 @@ namespace Falcor
         return true;
     }
 
-    bool SceneImporter::load(const std::string& filename, Model::LoadFlags modelLoadFlags, Scene::LoadFlags sceneLoadFlags)
+    bool SceneImporter::beginLoad(const std::string& filename, Model::LoadFlags modelLoadFlags, Scene::LoadFlags sceneLoadFlags)
     {
         std::string fullpath;
         mFilename = filename;
@@ -1186,21 +1284,12 @@ namespace Falcor
                 return error(std::string("JSON Parse error in line ") + std::to_string(line) + ". " + rapidjson::GetParseError_En(mJDoc.GetParseError()));
             }
 
-            if(topLevelLoop() == false)
+            if(validateSceneFile() == false)
             {
                 return false;
             }
 
-            if(is_set(mSceneLoadFlags, Scene::LoadFlags::GenerateAreaLights))
-            {
-                mScene.createAreaLights();
-            }
-
-            if (is_set(mSceneLoadFlags, Scene::LoadFlags::StoreMaterialHistory) == false)
-            {
-                mScene.deleteMaterialHistory();
-            }
-
+            prepareModels();
             return true;
         }
         else
@@ -1209,6 +1298,26 @@ namespace Falcor
         }
     }
 
+    bool SceneImporter::finishLoad()
+    {
+        if(topLevelLoop() == false)
+        {
+            return false;
+        }
+
+        if(is_set(mSceneLoadFlags, Scene::LoadFlags::GenerateAreaLights))
+        {
+            mScene.createAreaLights();
+        }
+
+        if (is_set(mSceneLoadFlags, Scene::LoadFlags::StoreMaterialHistory) == false)
+        {
+            mScene.deleteMaterialHistory();
+        }
+
+        return true;
+    }
+
     bool SceneImporter::parseAmbientIntensity(const rapidjson::Value& jsonVal)
     {
         glm::vec3 ambient;
@@ -1501,11 +1610,6 @@ namespace Falcor
 
     bool SceneImporter::topLevelLoop()
     {
-        if(validateSceneFile() == false)
-        {
-            return false;
-        }
-
         for(uint32_t i = 0; i < arraysize(kFunctionTable); i++)
         {
             const auto& jsonMember = mJDoc.FindMember(kFunctionTable[i].token.c_str());
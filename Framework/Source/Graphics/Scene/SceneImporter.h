@@ -27,12 +27,15 @@
 ***************************************************************************/
 #pragma once
 #include <string>
+#include <future>
+#include <atomic>
 #include "Externals/RapidJson/include/rapidjson/document.h"
 #include "Graphics/Material/Material.h"
 #include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
 #include "glm/vec4.hpp"
 #include "Scene.h"
+#include "Graphics/Model/Loaders/ModelImporter.h"
 
 namespace Falcor
 {
@@ -41,10 +44,29 @@ namespace Falcor
     public:
         static bool loadScene(Scene& scene, const std::string& filename, Model::LoadFlags modelLoadFlags, Scene::LoadFlags sceneLoadFlags);
 
+        /** Start loading a scene. Parses the scene file and queues the models on the global thread pool, where they are read and decoded concurrently.
+            \return nullptr if the scene file couldn't be parsed, otherwise an importer. Call finishLoad() on it to create the scene objects.
+        */
+        static std::unique_ptr<SceneImporter> beginLoadScene(Scene& scene, const std::string& filename, Model::LoadFlags modelLoadFlags, Scene::LoadFlags sceneLoadFlags);
+
+        /** Create the models and the rest of the scene objects. Waits for models which are still being prepared. Must be called from the thread which owns the device.
+        */
+        bool finishLoad();
+
+        /** Get the fraction of the scene's models which finished reading and decoding, in the range [0, 1]
+        */
+        float getProgress() const;
+
+        /** Get a future which becomes ready once all the models finished reading and decoding
+        */
+        const std::shared_future<void>& getPreparedFuture() const { return mPreparedFuture; }
+
     private:
 
         SceneImporter(Scene& scene) : mScene(scene) {}
-        bool load(const std::string& filename, Model::LoadFlags modelLoadFlags, Scene::LoadFlags sceneLoadFlags);
+        bool beginLoad(const std::string& filename, Model::LoadFlags modelLoadFlags, Scene::LoadFlags sceneLoadFlags);
+        void prepareModels();
+        std::string getModelPath(const rapidjson::Value& jsonModel) const;
 
         bool parseVersion(const rapidjson::Value& jsonVal);
         bool parseModels(const rapidjson::Value& jsonVal);
@@ -64,7 +86,7 @@ namespace Falcor
 
         bool loadIncludeFile(const std::string& Include);
 
-        bool createModel(const rapidjson::Value& jsonModel);
+        bool createModel(const rapidjson::Value& jsonModel, uint32_t modelIndex);
         bool setMaterialOverrides(const rapidjson::Value& jsonVal, const Model::SharedPtr& pModel);
         bool createModelInstances(const rapidjson::Value& jsonVal, const Model::SharedPtr& pModel);
         bool createPointLight(const rapidjson::Value& jsonLight);
@@ -103,6 +125,17 @@ namespace Falcor
         ObjectMap mCameraMap;
         ObjectMap mLightMap;
 
+        // Shared with the prepare tasks, which may outlive the importer
+        struct PrepareState
+        {
+            std::atomic<uint32_t> completed = { 0 };
+            uint32_t total = 0;
+            std::promise<void> allPrepared;
+        };
+        std::shared_ptr<PrepareState> mpPrepareState;
+        std::shared_future<void> mPreparedFuture;
+        std::vector<std::future<ModelImporter::SharedPtr>> mPreparedModels;     ///< Indexed by the model's position in the models array
+
         struct FuncValue
         {
             const std::string token;
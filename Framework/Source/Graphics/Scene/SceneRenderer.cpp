@@ -37,6 +37,8 @@
 #include "API/Device.h"
 #include "glm/matrix.hpp"
 #include "Graphics/Material/MaterialSystem.h"
+#include "Utils/ThreadPool.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -51,6 +53,19 @@ namespace Falcor
     size_t SceneRenderer::sLightArrayOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sAmbientLightOffset = ConstantBuffer::kInvalidOffset;
 
+    // Below this many mesh instances a linear SIMD scan is cheaper than traversing the BVH
+    static const uint32_t kLinearCullThreshold = 1024;
+
+    // Render-queue sort key layout. Each field gets 16 bits, IDs which don't fit wrap around. That only makes the grouping less optimal, since draws are merged by comparing the mesh pointers.
+    static const uint32_t kSortKeyFieldBits = 16;
+    static const uint64_t kSortKeyFieldMask = (1ull << kSortKeyFieldBits) - 1;
+    static const float kDepthBucketCount = float(kSortKeyFieldMask + 1);
+
+    static uint64_t makeSortKey(uint64_t descId, uint32_t materialId, uint32_t meshId)
+    {
+        return ((descId & kSortKeyFieldMask) << (3 * kSortKeyFieldBits)) | ((materialId & kSortKeyFieldMask) << (2 * kSortKeyFieldBits)) | ((meshId & kSortKeyFieldMask) << kSortKeyFieldBits);
+    }
+
     const char* SceneRenderer::kPerMaterialCbName = "InternalPerMaterialCB";
     const char* SceneRenderer::kPerFrameCbName = "InternalPerFrameCB";
     const char* SceneRenderer::kPerMeshCbName = "InternalPerMeshCB";
@@ -63,6 +78,12 @@ namespace Falcor
     SceneRenderer::SceneRenderer(const Scene::SharedPtr& pScene) : mpScene(pScene)
     {
         setCameraControllerType(CameraControllerType::SixDof);
+
+        // Build the BVH with the scene, so that the first frame only needs to refit it
+        if (mpScene)
+        {
+            updateCullingBounds();
+        }
     }
 
     void SceneRenderer::updateVariableOffsets(const ProgramReflection* pReflector)
@@ -114,7 +135,15 @@ namespace Falcor
             }
 
             // Set lights
-            if (sLightArrayOffset != ConstantBuffer::kInvalidOffset)
+            if (mpLightCulling)
+            {
+                if (currentData.pCamera)
+                {
+                    mpLightCulling->build(currentData.pCamera, mpScene->getLights());
+                    mpLightCulling->setIntoProgramVars(currentData.pVars);
+                }
+            }
+            else if (sLightArrayOffset != ConstantBuffer::kInvalidOffset)
             {
                 assert(mpScene->getLightCount() < 16);  // Max array size in the shader
                 for (uint_t i = 0; i < mpScene->getLightCount(); i++)
@@ -124,7 +153,7 @@ namespace Falcor
             }
             if (sLightCountOffset != ConstantBuffer::kInvalidOffset)
             {
-                pCB->setVariable(sLightCountOffset, mpScene->getLightCount());
+                pCB->setVariable(sLightCountOffset, mpLightCulling ? 0u : mpScene->getLightCount());
             }
             if (sAmbientLightOffset != ConstantBuffer::kInvalidOffset)
             {
@@ -204,26 +233,33 @@ namespace Falcor
         currentData.pContext->drawIndexedInstanced(indexCount, instanceCount, 0, 0, 0);
     }
 
-    void SceneRenderer::draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount)
+    void SceneRenderer::bindMaterial(CurrentWorkingData& currentData, const Material* pMaterial)
     {
-        currentData.pMaterial = pMesh->getMaterial().get();
-        // Bind material
-        if(mpLastMaterial != pMesh->getMaterial().get())
+        currentData.pMaterial = pMaterial;
+        if(mpLastMaterial != pMaterial)
         {
             if(mUnloadTexturesOnMaterialChange && mpLastMaterial)
             {
                 mpLastMaterial->evictTextures();
             }
             setPerMaterialData(currentData, currentData.pMaterial);
-            mpLastMaterial = pMesh->getMaterial().get();
+            mpLastMaterial = pMaterial;
+            mStats.materialSwitches++;
 
             if(mCompileMaterialWithProgram)
             {
                 MaterialSystem::patchProgram(currentData.pState->getProgram().get(), mpLastMaterial);
             }
         }
+    }
+
+    void SceneRenderer::draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount)
+    {
+        // Bind material
+        bindMaterial(currentData, pMesh->getMaterial().get());
 
         executeDraw(currentData, pMesh->getIndexCount(), instanceCount);
+        mStats.drawCount++;
         postFlushDraw(currentData);
         currentData.pState->getProgram()->removeDefine("_MS_STATIC_MATERIAL_DESC");
     }
@@ -233,48 +269,83 @@ namespace Falcor
 
     }
 
+    void SceneRenderer::getCullingFrusta(const Camera* pCamera, std::vector<CullingFrustum>& frusta)
+    {
+        frusta.push_back(pCamera->getCullingFrustum());
+    }
+
+    template<typename Func>
+    void SceneRenderer::forEachVisibleMeshInstance(CurrentWorkingData& currentData, uint32_t meshID, Func func)
+    {
+        const Model* pModel = currentData.pModel;
+        const uint32_t instanceCount = pModel->getMeshInstanceCount(meshID);
+        const uint32_t firstMeshInstance = currentData.meshInstanceIndex;
+        currentData.meshInstanceIndex += instanceCount;
+
+        // When culling, only visit the instances in the visible list. The list is sorted, so this mesh's instances are the next entries in it.
+        const std::vector<uint32_t>& visible = mCullingData.visibleMeshInstances;
+        if (mCullEnabled)
+        {
+            currentData.visibleCursor = (uint32_t)(std::lower_bound(visible.begin() + currentData.visibleCursor, visible.end(), firstMeshInstance) - visible.begin());
+        }
+        const uint32_t visibleCount = (uint32_t)visible.size();
+
+        for (uint32_t i = 0; i < instanceCount; i++)
+        {
+            uint32_t instanceID = i;
+            if (mCullEnabled)
+            {
+                if ((currentData.visibleCursor == visibleCount) || (visible[currentData.visibleCursor] >= firstMeshInstance + instanceCount))
+                {
+                    break;
+                }
+                instanceID = visible[currentData.visibleCursor++] - firstMeshInstance;
+            }
+
+            const Model::MeshInstance* pMeshInstance = pModel->getMeshInstance(meshID, instanceID).get();
+            if (pMeshInstance->isVisible())
+            {
+                func(pMeshInstance);
+            }
+        }
+    }
+
     void SceneRenderer::renderMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID)
     {
         const Model* pModel = currentData.pModel;
         const Mesh* pMesh = pModel->getMesh(meshID).get();
 
-        if (setPerMeshData(currentData, pMesh))
+        if (setPerMeshData(currentData, pMesh) == false)
         {
-            // Bind VAO and set topology
-            currentData.pState->setVao(pMesh->getVao());
+            currentData.meshInstanceIndex += pModel->getMeshInstanceCount(meshID);
+            return;
+        }
 
-            uint32_t activeInstances = 0;
+        // Bind VAO and set topology
+        currentData.pState->setVao(pMesh->getVao());
+        mStats.vaoSwitches++;
 
-            const uint32_t instanceCount = pModel->getMeshInstanceCount(meshID);
-            for (uint32_t instanceID = 0; instanceID < instanceCount; instanceID++)
+        uint32_t activeInstances = 0;
+        forEachVisibleMeshInstance(currentData, meshID, [&](const Model::MeshInstance* pMeshInstance)
+        {
+            if (setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, activeInstances))
             {
-                const Model::MeshInstance* pMeshInstance = pModel->getMeshInstance(meshID, instanceID).get();
-                BoundingBox box = pMeshInstance->getBoundingBox().transform(pModelInstance->getTransformMatrix());
+                currentData.drawID++;
+                activeInstances++;
 
-                if ((mCullEnabled == false) || (currentData.pCamera->isObjectCulled(box) == false))
+                if (activeInstances == mMaxInstanceCount)
                 {
-                    if (pMeshInstance->isVisible())
-                    {
-                        if (setPerMeshInstanceData(currentData, pModelInstance, pMeshInstance, activeInstances))
-                        {
-                            currentData.drawID++;
-                            activeInstances++;
-
-                            if (activeInstances == mMaxInstanceCount)
-                            {
-                                // DISABLED_FOR_D3D12
-                                //pContext->setProgram(currentData.pProgram->getActiveProgramVersion());
-                                draw(currentData, pMesh, activeInstances);
-                                activeInstances = 0;
-                            }
-                        }
-                    }
+                    // DISABLED_FOR_D3D12
+                    //pContext->setProgram(currentData.pProgram->getActiveProgramVersion());
+                    draw(currentData, pMesh, activeInstances);
+                    activeInstances = 0;
                 }
             }
-            if(activeInstances != 0)
-            {
-                draw(currentData, pMesh, activeInstances);
-            }
+        });
+
+        if(activeInstances != 0)
+        {
+            draw(currentData, pMesh, activeInstances);
         }
     }
 
@@ -333,27 +404,383 @@ namespace Falcor
         }
     }
 
+    void SceneRenderer::updateCullingBounds()
+    {
+        CullingData& data = mCullingData;
+        uint32_t modelInstanceIndex = 0;
+        uint32_t meshInstanceIndex = 0;
+        bool layoutChanged = false;     // Instances were added, removed or reordered, so the BVH topology is stale
+        bool boundsChanged = false;     // Only transforms changed, so the BVH can be refit
+
+        for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        {
+            const Model* pModel = mpScene->getModel(modelID).get();
+
+            for (uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++)
+            {
+                const Scene::ModelInstance* pInstance = mpScene->getModelInstance(modelID, instanceID).get();
+                if (modelInstanceIndex == data.modelInstances.size())
+                {
+                    data.modelInstances.emplace_back();
+                }
+
+                // If the model instance moved, or the scene changed, all of its mesh instances need new bounds
+                CullingData::ModelInstanceEntry& entry = data.modelInstances[modelInstanceIndex++];
+                const uint64_t version = pInstance->getTransformVersion();
+                const bool instanceReplaced = (entry.pInstance != pInstance) || (entry.firstMeshInstance != meshInstanceIndex);
+                const bool instanceChanged = instanceReplaced || (entry.transformVersion != version);
+                layoutChanged = layoutChanged || instanceReplaced;
+                entry.pInstance = pInstance;
+                entry.transformVersion = version;
+                entry.firstMeshInstance = meshInstanceIndex;
+
+                for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+                {
+                    const uint32_t instanceCount = pModel->getMeshInstanceCount(meshID);
+                    if (meshInstanceIndex + instanceCount > data.meshInstances.size())
+                    {
+                        data.meshInstances.resize(meshInstanceIndex + instanceCount, nullptr);
+                        data.meshInstanceVersions.resize(meshInstanceIndex + instanceCount, 0);
+                        data.worldBounds.resize(meshInstanceIndex + instanceCount);
+                    }
+
+                    for (uint32_t meshInstanceID = 0; meshInstanceID < instanceCount; meshInstanceID++)
+                    {
+                        const Model::MeshInstance* pMeshInstance = pModel->getMeshInstance(meshID, meshInstanceID).get();
+                        const uint64_t meshVersion = pMeshInstance->getTransformVersion();
+                        const bool meshReplaced = (data.meshInstances[meshInstanceIndex] != pMeshInstance);
+                        if (instanceChanged || meshReplaced || (data.meshInstanceVersions[meshInstanceIndex] != meshVersion))
+                        {
+                            data.meshInstances[meshInstanceIndex] = pMeshInstance;
+                            data.meshInstanceVersions[meshInstanceIndex] = meshVersion;
+                            data.worldBounds.set(meshInstanceIndex, pMeshInstance->getBoundingBox().transform(pInstance->getTransformMatrix()));
+                            layoutChanged = layoutChanged || meshReplaced;
+                            boundsChanged = true;
+                        }
+                        meshInstanceIndex++;
+                    }
+                }
+            }
+        }
+
+        layoutChanged = layoutChanged || (data.modelInstances.size() != modelInstanceIndex) || (data.meshInstances.size() != meshInstanceIndex);
+        data.modelInstances.resize(modelInstanceIndex);
+        data.meshInstances.resize(meshInstanceIndex);
+        data.meshInstanceVersions.resize(meshInstanceIndex);
+        data.worldBounds.resize(meshInstanceIndex);
+
+        if (layoutChanged || (data.bvh.getPrimitiveCount() != meshInstanceIndex))
+        {
+            data.bvh.build(data.worldBounds);
+        }
+        else if (boundsChanged)
+        {
+            data.bvh.refit(data.worldBounds);
+        }
+    }
+
+    void SceneRenderer::updateCullingData(const Camera* pCamera)
+    {
+        updateCullingBounds();
+
+        CullingData& data = mCullingData;
+        const uint32_t meshInstanceCount = (uint32_t)data.meshInstances.size();
+        data.frusta.clear();
+        getCullingFrusta(pCamera, data.frusta);
+
+        data.visibleMeshInstances.clear();
+        if (data.frusta.empty())
+        {
+            return;
+        }
+
+        // Small scenes culled against the camera alone use the camera's SIMD scan, which keeps the visible list sorted
+        const CullingFrustum cameraFrustum = pCamera->getCullingFrustum();
+        if ((data.frusta.size() == 1) && (meshInstanceCount < kLinearCullThreshold) && (memcmp(&data.frusta[0], &cameraFrustum, sizeof(CullingFrustum)) == 0))
+        {
+            pCamera->cullBoundingBoxes(data.worldBounds, data.visibleMeshInstances);
+        }
+        else
+        {
+            data.bvh.cull(data.worldBounds, data.frusta.data(), (uint32_t)data.frusta.size(), data.visibleMeshInstances);
+            std::sort(data.visibleMeshInstances.begin(), data.visibleMeshInstances.end());
+        }
+    }
+
+    void SceneRenderer::gatherRenderQueue(CurrentWorkingData& currentData)
+    {
+        mRenderQueue.clear();
+
+        // Depth is the distance of the mesh instance's center from the camera, quantized to the sort key's lowest field
+        const glm::vec3 cameraPos = currentData.pCamera ? currentData.pCamera->getPosition() : glm::vec3(0);
+        const float farPlane = currentData.pCamera ? currentData.pCamera->getFarPlane() : 0;
+        const float depthScale = (farPlane > 0) ? (kDepthBucketCount - 1) / farPlane : 0;
+
+        uint32_t modelInstanceIndex = 0;
+        for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        {
+            currentData.pModel = mpScene->getModel(modelID).get();
+
+            for (uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++, modelInstanceIndex++)
+            {
+                const auto pInstance = mpScene->getModelInstance(modelID, instanceID).get();
+                if ((pInstance->isVisible() == false) || (setPerModelInstanceData(currentData, pInstance, instanceID) == false))
+                {
+                    continue;
+                }
+
+                if (mCullEnabled)
+                {
+                    currentData.meshInstanceIndex = mCullingData.modelInstances[modelInstanceIndex].firstMeshInstance;
+                }
+
+                // Skinned meshes share the instance matrix array with the bones, so they can't be instanced
+                if (currentData.pModel->hasBones())
+                {
+                    renderModelInstance(currentData, pInstance);
+                    continue;
+                }
+
+                const glm::mat4 instanceMat = pInstance->getTransformMatrix();
+                const Material* pLastMaterial = nullptr;
+                for (uint32_t meshID = 0; meshID < currentData.pModel->getMeshCount(); meshID++)
+                {
+                    const Mesh* pMesh = currentData.pModel->getMesh(meshID).get();
+                    const Material* pMaterial = pMesh->getMaterial().get();
+                    const uint64_t meshKey = makeSortKey(pMaterial->getDescIdentifier(), (uint32_t)pMaterial->getId(), pMesh->getId());
+
+                    uint32_t visibleCount = 0;
+                    forEachVisibleMeshInstance(currentData, meshID, [&](const Model::MeshInstance* pMeshInstance)
+                    {
+                        glm::vec3 center = glm::vec3(instanceMat * glm::vec4(pMeshInstance->getBoundingBox().center, 1));
+                        float depthBucket = glm::clamp(glm::length(center - cameraPos) * depthScale, 0.0f, kDepthBucketCount - 1);
+                        mRenderQueue.push_back({ meshKey | (uint64_t)depthBucket, currentData.pModel, pInstance, pMeshInstance, pMesh });
+                        visibleCount++;
+                    });
+
+                    // Count what rendering the model instance on its own would have submitted
+                    mUnsortedStats.vaoSwitches++;
+                    if (visibleCount)
+                    {
+                        mUnsortedStats.drawCount += (visibleCount + mMaxInstanceCount - 1) / mMaxInstanceCount;
+                        if (pMaterial != pLastMaterial)
+                        {
+                            mUnsortedStats.materialSwitches++;
+                            pLastMaterial = pMaterial;
+                        }
+                    }
+                }
+            }
+        }
+
+        std::sort(mRenderQueue.begin(), mRenderQueue.end(), [](const QueueItem& a, const QueueItem& b) { return a.sortKey < b.sortKey; });
+    }
+
+    void SceneRenderer::renderQueue(CurrentWorkingData& currentData)
+    {
+        // Skinned models may have been rendered while gathering
+        mpLastMaterial = nullptr;
+
+        size_t runStart = 0;
+        while (runStart < mRenderQueue.size())
+        {
+            // Instances of the same mesh are next to each other, regardless of the model instance they belong to
+            const Mesh* pMesh = mRenderQueue[runStart].pMesh;
+            size_t runEnd = runStart + 1;
+            while ((runEnd < mRenderQueue.size()) && (mRenderQueue[runEnd].pMesh == pMesh))
+            {
+                runEnd++;
+            }
+
+            currentData.pModel = mRenderQueue[runStart].pModel;
+            if (setPerMeshData(currentData, pMesh))
+            {
+                currentData.pState->setVao(pMesh->getVao());
+                mStats.vaoSwitches++;
+
+                uint32_t activeInstances = 0;
+                for (size_t i = runStart; i < runEnd; i++)
+                {
+                    const QueueItem& item = mRenderQueue[i];
+                    currentData.pModel = item.pModel;
+                    if (setPerMeshInstanceData(currentData, item.pModelInstance, item.pMeshInstance, activeInstances))
+                    {
+                        currentData.drawID++;
+                        activeInstances++;
+                    }
+
+                    if ((activeInstances == mMaxInstanceCount) || ((i + 1 == runEnd) && activeInstances))
+                    {
+                        // The material stays bound across draws, unlike in draw()
+                        bindMaterial(currentData, pMesh->getMaterial().get());
+                        executeDraw(currentData, pMesh->getIndexCount(), activeInstances);
+                        mStats.drawCount++;
+                        postFlushDraw(currentData);
+                        activeInstances = 0;
+                    }
+                }
+            }
+            runStart = runEnd;
+        }
+
+        if (mCompileMaterialWithProgram)
+        {
+            currentData.pState->getProgram()->removeDefine("_MS_STATIC_MATERIAL_DESC");
+        }
+    }
+
+    void SceneRenderer::buildQueueDrawLists()
+    {
+        // Split the runs of the same mesh into instanced draws, so that the data of every draw can be computed on its own
+        mQueueBatches.clear();
+        size_t runStart = 0;
+        while (runStart < mRenderQueue.size())
+        {
+            size_t runEnd = runStart + 1;
+            while ((runEnd < mRenderQueue.size()) && (mRenderQueue[runEnd].pMesh == mRenderQueue[runStart].pMesh))
+            {
+                runEnd++;
+            }
+            for (size_t i = runStart; i < runEnd; i += mMaxInstanceCount)
+            {
+                mQueueBatches.push_back((uint32_t)i);
+            }
+            runStart = runEnd;
+        }
+        const uint32_t batchCount = (uint32_t)mQueueBatches.size();
+        mQueueBatches.push_back((uint32_t)mRenderQueue.size());
+
+        // A few chunks per thread, so that the pool can balance chunks with different instance counts
+        const uint32_t chunkCount = 4 * (ThreadPool::getGlobalPool().getThreadCount() + 1);
+        const uint32_t batchesPerChunk = std::max(4u, (batchCount + chunkCount - 1) / chunkCount);
+
+        // The transforms were updated while gathering, so the workers only read them
+        mDrawListBuilder.build(batchCount, batchesPerChunk, [this](DrawList* pList, uint32_t firstBatch, uint32_t chunkBatchCount)
+        {
+            for (uint32_t batch = firstBatch; batch < firstBatch + chunkBatchCount; batch++)
+            {
+                const uint32_t firstItem = mQueueBatches[batch];
+                const uint32_t instanceCount = mQueueBatches[batch + 1] - firstItem;
+
+                // The world matrices, followed by the inverse-transpose matrices
+                const uint32_t constantsSize = (uint32_t)(instanceCount * (sizeof(glm::mat4) + sizeof(glm::mat3x4)));
+                uint8_t* pConstants = pList->allocateConstants(constantsSize);
+                glm::mat4* pWorldMats = (glm::mat4*)pConstants;
+                glm::mat3x4* pWorldInvTransposeMats = (glm::mat3x4*)(pConstants + instanceCount * sizeof(glm::mat4));
+                for (uint32_t i = 0; i < instanceCount; i++)
+                {
+                    const QueueItem& item = mRenderQueue[firstItem + i];
+                    pWorldMats[i] = item.pModelInstance->getTransformMatrix() * item.pMeshInstance->getTransformMatrix();
+                    pWorldInvTransposeMats[i] = transpose(inverse(glm::mat3(pWorldMats[i])));
+                }
+                pList->addDraw(firstItem, instanceCount, pConstants, constantsSize);
+            }
+        }, ThreadPool::getGlobalPool().getThreadCount() > 0);
+    }
+
+    void SceneRenderer::submitQueueDrawLists(CurrentWorkingData& currentData)
+    {
+        ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(kPerMeshCbName).get();
+        const Mesh* pCurrentMesh = nullptr;
+        bool meshEnabled = false;
+
+        // Skinned models may have been rendered while gathering
+        mpLastMaterial = nullptr;
+
+        mDrawListBuilder.forEachDraw([&](const DrawList::Draw& draw)
+        {
+            const QueueItem& item = mRenderQueue[draw.firstItem];
+            currentData.pModel = item.pModel;
+            if (item.pMesh != pCurrentMesh)
+            {
+                pCurrentMesh = item.pMesh;
+                meshEnabled = setPerMeshData(currentData, pCurrentMesh);
+                if (meshEnabled)
+                {
+                    currentData.pState->setVao(pCurrentMesh->getVao());
+                    mStats.vaoSwitches++;
+                }
+            }
+
+            if (meshEnabled)
+            {
+                if (pCB)
+                {
+                    assert(draw.itemCount <= sWorldMatArraySize);
+                    pCB->setBlob(draw.pConstants, sWorldMatOffset, draw.itemCount * sizeof(glm::mat4));
+                    pCB->setBlob(draw.pConstants + draw.itemCount * sizeof(glm::mat4), sWorldInvTransposeMatOffset, draw.itemCount * sizeof(glm::mat3x4));
+                    pCB->setVariable(sMeshIdOffset, pCurrentMesh->getId());
+                }
+                currentData.drawID += draw.itemCount;
+
+                bindMaterial(currentData, pCurrentMesh->getMaterial().get());
+                executeDraw(currentData, pCurrentMesh->getIndexCount(), draw.itemCount);
+                mStats.drawCount++;
+                postFlushDraw(currentData);
+            }
+        });
+
+        if (mCompileMaterialWithProgram)
+        {
+            currentData.pState->getProgram()->removeDefine("_MS_STATIC_MATERIAL_DESC");
+        }
+    }
+
     void SceneRenderer::renderScene(CurrentWorkingData& currentData)
     {
         setupVR();
         setPerFrameData(currentData);
+        mStats = RenderStats();
+        mUnsortedStats = RenderStats();
+
+        if (mCullEnabled)
+        {
+            updateCullingData(currentData.pCamera);
+        }
+
+        if (mRenderQueueEnabled && supportsRenderQueue())
+        {
+            gatherRenderQueue(currentData);
 
+            // Skinned models were rendered while gathering, the same way in both paths
+            mUnsortedStats.drawCount += mStats.drawCount;
+            mUnsortedStats.materialSwitches += mStats.materialSwitches;
+            mUnsortedStats.vaoSwitches += mStats.vaoSwitches;
+
+            if (mParallelInstanceDataEnabled && supportsParallelInstanceData())
+            {
+                buildQueueDrawLists();
+                submitQueueDrawLists(currentData);
+            }
+            else
+            {
+                renderQueue(currentData);
+            }
+            return;
+        }
+
+        uint32_t modelInstanceIndex = 0;
         for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
         {
             currentData.pModel = mpScene->getModel(modelID).get();
 
-            for (uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++)
+            for (uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++, modelInstanceIndex++)
             {
                 const auto pInstance = mpScene->getModelInstance(modelID, instanceID).get();
                 if (pInstance->isVisible())
                 {
                     if (setPerModelInstanceData(currentData, pInstance, instanceID))
                     {
+                        if (mCullEnabled)
+                        {
+                            currentData.meshInstanceIndex = mCullingData.modelInstances[modelInstanceIndex].firstMeshInstance;
+                        }
                         renderModelInstance(currentData, pInstance);
                     }
                 }
             }
         }
+        mUnsortedStats = mStats;
     }
 
     void SceneRenderer::renderScene(RenderContext* pContext, Camera* pCamera)
@@ -371,6 +798,45 @@ namespace Falcor
         renderScene(currentData);
     }
 
+    void SceneRenderer::setClusteredLightingEnabled(bool enable)
+    {
+        if (enable && mpLightCulling == nullptr)
+        {
+            mpLightCulling = ClusteredLightCulling::create();
+        }
+        else if (enable == false)
+        {
+            mpLightCulling = nullptr;
+        }
+    }
+
+    void SceneRenderer::renderUI(Gui* pGui, const char* uiGroup)
+    {
+        if (uiGroup == nullptr || pGui->beginGroup(uiGroup))
+        {
+            pGui->addCheckBox("Render Queue", mRenderQueueEnabled);
+            if (mRenderQueueEnabled)
+            {
+                pGui->addCheckBox("Parallel Instance Data", mParallelInstanceDataEnabled);
+            }
+            pGui->addCheckBox("Culling", mCullEnabled);
+
+            std::string stats = "               Per-Model   Sorted\n";
+            auto addRow = [&stats, this](const char* name, uint32_t unsorted, uint32_t sorted)
+            {
+                char row[128];
+                snprintf(row, sizeof(row), "%-15s%9u%9s\n", name, unsorted, mRenderQueueEnabled ? std::to_string(sorted).c_str() : "-");
+                stats += row;
+            };
+            addRow("Draws", mUnsortedStats.drawCount, mStats.drawCount);
+            addRow("Material Binds", mUnsortedStats.materialSwitches, mStats.materialSwitches);
+            addRow("VAO Binds", mUnsortedStats.vaoSwitches, mStats.vaoSwitches);
+            pGui->addText(stats.c_str());
+
+            if (uiGroup) pGui->endGroup();
+        }
+    }
+
     void SceneRenderer::setCameraControllerType(CameraControllerType type)
     {
         switch(type)
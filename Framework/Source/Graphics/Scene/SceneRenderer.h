@@ -33,6 +33,9 @@
 #include "utils/CpuTimer.h"
 #include "API/ConstantBuffer.h"
 #include "Utils/DebugDrawer.h"
+#include "Utils/Math/BoundingVolumeHierarchy.h"
+#include "Graphics/Scene/DrawList.h"
+#include "Graphics/ClusteredLightCulling.h"
 
 namespace Falcor
 {
@@ -104,6 +107,49 @@ namespace Falcor
         void setRenderMode(RenderMode mode);
         void toggleStaticMaterialCompilation(bool on) { mCompileMaterialWithProgram = on; }
 
+        /** Enable/disable the render-queue mode. Instead of rendering model instance by model instance, the visible mesh instances of the whole scene are gathered and sorted by material desc, material, mesh and depth.
+            Instances of the same mesh are merged into instanced draws even when they belong to different model instances, and materials are only rebound when they change.
+            setPerModelInstanceData() is called while gathering, before any mesh instance is drawn. Renderers which change the state per model instance override supportsRenderQueue(), and are then rendered model instance by model instance even if this is enabled.
+            Skinned models are still rendered model instance by model instance.
+        */
+        void setRenderQueueEnabled(bool enable) { mRenderQueueEnabled = enable; }
+        bool isRenderQueueEnabled() const { return mRenderQueueEnabled; }
+
+        /** Enable/disable computing the per-instance data of the render queue on the thread pool. Only used when the render queue is enabled.
+            The sorted queue is split into chunks of instanced draws, and the thread pool computes the instance matrices of each chunk into a draw list of its own. The draws themselves are still recorded on the calling thread, which walks the lists in order and issues the API calls.
+            setPerMeshInstanceData() is not called in this mode, the workers write the instance matrices directly. Renderers which override it should also override supportsParallelInstanceData(), the queue is then rendered on the calling thread.
+        */
+        void setParallelInstanceDataEnabled(bool enable) { mParallelInstanceDataEnabled = enable; }
+        bool isParallelInstanceDataEnabled() const { return mParallelInstanceDataEnabled; }
+
+        /** Enable/disable clustered lighting. Instead of copying the scene's lights into gLights, which is limited to 16 lights, the lights are assigned to the clusters of the camera's frustum every frame and bound as buffers.
+            The program needs to include 'ClusteredLighting.h' and loop over the lights of the pixel's cluster. gLightsCount is set to 0 in this mode.
+        */
+        void setClusteredLightingEnabled(bool enable);
+        bool isClusteredLightingEnabled() const { return mpLightCulling != nullptr; }
+        ClusteredLightCulling* getClusteredLightCulling() const { return mpLightCulling.get(); }
+
+        /** Work submitted by the last renderScene() call
+        */
+        struct RenderStats
+        {
+            uint32_t drawCount = 0;             ///< Number of draw calls
+            uint32_t materialSwitches = 0;      ///< Number of times a material was bound
+            uint32_t vaoSwitches = 0;           ///< Number of times a VAO was bound
+        };
+
+        /** Get the stats of the last renderScene() call
+        */
+        const RenderStats& getRenderStats() const { return mStats; }
+
+        /** Get the stats the model instance by model instance path would have produced for the same mesh instances. Same as getRenderStats() when the render queue is disabled.
+        */
+        const RenderStats& getUnsortedRenderStats() const { return mUnsortedStats; }
+
+        /** Render the renderer's settings and the stats of the last frame
+        */
+        void renderUI(Gui* pGui, const char* uiGroup = nullptr);
+
     protected:
 
         struct CurrentWorkingData
@@ -116,6 +162,29 @@ namespace Falcor
             const Material* pMaterial = nullptr;
 
             uint32_t drawID; // Zero-based mesh instance draw order/ID. Resets at the beginning of renderScene, and increments per mesh instance drawn.
+            uint32_t meshInstanceIndex = 0; // Index into the culling data of the next mesh instance to render
+            uint32_t visibleCursor = 0;     // Position in the culling data's visible list
+        };
+
+        /** World-space bounds of every mesh instance in the scene, stored in the order renderScene() visits them.
+            A box is only recomputed when the transform of its model instance or mesh instance changes.
+        */
+        struct CullingData
+        {
+            struct ModelInstanceEntry
+            {
+                const Scene::ModelInstance* pInstance = nullptr;
+                uint64_t transformVersion = 0;
+                uint32_t firstMeshInstance = 0;     // Index of the model instance's first mesh instance
+            };
+
+            std::vector<ModelInstanceEntry> modelInstances;
+            std::vector<const Model::MeshInstance*> meshInstances;
+            std::vector<uint64_t> meshInstanceVersions;
+            BoundingBoxArray worldBounds;
+            BoundingVolumeHierarchy bvh;                    // Built over worldBounds when the renderer is created. Rebuilt when instances are added or removed, refit when they move
+            std::vector<CullingFrustum> frusta;
+            std::vector<uint32_t> visibleMeshInstances;     // Sorted indices of the mesh instances inside the frustum
         };
 
         SceneRenderer(const Scene::SharedPtr& pScene);
@@ -147,12 +216,48 @@ namespace Falcor
         virtual void executeDraw(const CurrentWorkingData& currentData, uint32_t indexCount, uint32_t instanceCount);
         virtual void postFlushDraw(const CurrentWorkingData& currentData);
 
+        /** Check if the scene can be rendered through the render queue. The queue calls setPerModelInstanceData() for all the instances before drawing any of them, so renderers which change the state per model instance have to return false.
+        */
+        virtual bool supportsRenderQueue() const { return true; }
+
+        /** Check if the per-instance data of the render queue can be computed by the thread pool. The workers don't call setPerMeshInstanceData(), so renderers which override it have to return false.
+        */
+        virtual bool supportsParallelInstanceData() const { return true; }
+
+        /** Get the frusta used to cull the scene. A mesh instance is rendered if it intersects any of them. The default is the camera's frustum.
+        */
+        virtual void getCullingFrusta(const Camera* pCamera, std::vector<CullingFrustum>& frusta);
+
         void renderModelInstance(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance);
         void renderMeshInstances(CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t meshID);
         void draw(CurrentWorkingData& currentData, const Mesh* pMesh, uint32_t instanceCount);
+        void bindMaterial(CurrentWorkingData& currentData, const Material* pMaterial);
+
+        /** Call func(const Model::MeshInstance*) for each visible instance of a mesh of currentData.pModel, and advance currentData's culling cursors past the mesh's instances
+        */
+        template<typename Func>
+        void forEachVisibleMeshInstance(CurrentWorkingData& currentData, uint32_t meshID, Func func);
+
+        /** A mesh instance in the render queue
+        */
+        struct QueueItem
+        {
+            uint64_t sortKey;   // Material desc ID, material ID, mesh ID and depth bucket, from the high bits to the low bits
+            const Model* pModel;
+            const Scene::ModelInstance* pModelInstance;
+            const Model::MeshInstance* pMeshInstance;
+            const Mesh* pMesh;
+        };
+
+        void gatherRenderQueue(CurrentWorkingData& currentData);
+        void renderQueue(CurrentWorkingData& currentData);
+        void buildQueueDrawLists();
+        void submitQueueDrawLists(CurrentWorkingData& currentData);
 
         void setupVR();
         void renderScene(CurrentWorkingData& currentData);
+        void updateCullingBounds();
+        void updateCullingData(const Camera* pCamera);
 
         CameraControllerType mCamControllerType = CameraControllerType::SixDof;
         CameraController::SharedPtr mpCameraController;
@@ -163,5 +268,15 @@ namespace Falcor
         bool mUnloadTexturesOnMaterialChange = false;
         RenderMode mRenderMode = RenderMode::Mono;
         bool mCompileMaterialWithProgram = true;
+        CullingData mCullingData;
+
+        bool mRenderQueueEnabled = false;
+        std::vector<QueueItem> mRenderQueue;
+        bool mParallelInstanceDataEnabled = false;
+        std::vector<uint32_t> mQueueBatches;        // First queue item of every instanced draw, followed by the queue size
+        ParallelDrawListBuilder mDrawListBuilder;
+        ClusteredLightCulling::UniquePtr mpLightCulling;
+        RenderStats mStats;
+        RenderStats mUnsortedStats;
     };
 }
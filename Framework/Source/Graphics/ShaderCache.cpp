@@ -0,0 +1,444 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ShaderCache.h"
+#include "Utils/OS.h"
+#include "Utils/BinaryFileStream.h"
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace Falcor
+{
+    const std::string& getSpireBuildId();
+
+    std::atomic<bool> ShaderCache::sEnabled(false);
+    uint64_t ShaderCache::sMaxSize = 256 * 1024 * 1024;
+
+    static const uint32_t kFileMagic = 0x48435346; // 'FSCH'
+    static const uint32_t kFileVersion = 1;
+    static const char* kFileExtension = ".shader";
+
+    struct CacheFile
+    {
+        uint64_t size = 0;
+        time_t lastUse = 0;
+    };
+
+    struct FileHash
+    {
+        time_t modifiedTime = 0;
+        uint64_t hash = 0;
+    };
+
+    // All the cache state is protected by the mutex. Entries are read and written without holding it - an entry is written to a temporary file and then renamed, so readers never see a partial file.
+    struct CacheState
+    {
+        std::mutex mutex;
+        std::string directory;
+        bool indexed = false;
+        std::unordered_map<std::string, CacheFile> files;
+        uint64_t totalSize = 0;
+        ShaderCache::Stats stats;
+        std::unordered_map<std::string, FileHash> fileHashes;
+    };
+
+    static CacheState& getState()
+    {
+        static CacheState state;
+        return state;
+    }
+
+    static uint64_t fnv1a(const void* pData, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+    {
+        const uint8_t* pBytes = (const uint8_t*)pData;
+        for(size_t i = 0; i < size; i++)
+        {
+            hash ^= pBytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    static uint64_t getFileSize(const std::string& filename)
+    {
+        struct stat s;
+        return (stat(filename.c_str(), &s) == 0) ? (uint64_t)s.st_size : 0;
+    }
+
+    static const std::string& getDirectoryInternal(CacheState& state)
+    {
+        if(state.directory.empty())
+        {
+            state.directory = getExecutableDirectory() + "\\ShaderCache";
+        }
+        return state.directory;
+    }
+
+    // Must be called with the mutex held
+    static void buildIndex(CacheState& state)
+    {
+        if(state.indexed)
+        {
+            return;
+        }
+        state.indexed = true;
+
+        if(getSpireBuildId().empty())
+        {
+            logWarning("Can't identify the Spire compiler binary. Shader cache is disabled.");
+            ShaderCache::setEnabled(false);
+            return;
+        }
+
+        const std::string& dir = getDirectoryInternal(state);
+        if(isDirectoryExists(dir) == false)
+        {
+            if(createDirectory(dir) == false)
+            {
+                logWarning("Can't create shader cache directory '" + dir + "'. Shader cache is disabled.");
+                ShaderCache::setEnabled(false);
+            }
+            return;
+        }
+
+        std::vector<std::string> filenames;
+        enumerateFiles(dir + "\\*" + kFileExtension, filenames);
+        for(const auto& name : filenames)
+        {
+            const std::string path = dir + '\\' + name;
+            CacheFile file;
+            file.size = getFileSize(path);
+            file.lastUse = getFileModifiedTime(path);
+            state.files[name] = file;
+            state.totalSize += file.size;
+        }
+    }
+
+    // Must be called with the mutex held
+    static void evict(CacheState& state, const std::string& keep)
+    {
+        while(state.totalSize > ShaderCache::getMaxSize() && state.files.size() > 1)
+        {
+            auto oldest = state.files.end();
+            for(auto it = state.files.begin(); it != state.files.end(); it++)
+            {
+                if(it->first != keep && (oldest == state.files.end() || it->second.lastUse < oldest->second.lastUse))
+                {
+                    oldest = it;
+                }
+            }
+            assert(oldest != state.files.end());
+
+            std::remove((state.directory + '\\' + oldest->first).c_str());
+            state.totalSize -= oldest->second.size;
+            state.files.erase(oldest);
+            state.stats.evictions++;
+        }
+    }
+
+    static std::string getEntryName(const std::string& key)
+    {
+        char name[32];
+        snprintf(name, arraysize(name), "%016llx", (unsigned long long)ShaderCache::getStringHash(key));
+        return std::string(name) + kFileExtension;
+    }
+
+    static void writeString(BinaryFileStream& stream, const std::string& str)
+    {
+        stream << (uint32_t)str.size();
+        stream.write(str.data(), str.size());
+    }
+
+    static bool readString(BinaryFileStream& stream, std::string& str)
+    {
+        uint32_t size = 0;
+        stream >> size;
+        if(stream.isGood() == false || size > stream.getRemainingStreamSize())
+        {
+            return false;
+        }
+        str.resize(size);
+        stream.read(&str[0], size);
+        return stream.isGood();
+    }
+
+    static bool readEntry(const std::string& path, const std::string& key, ShaderCache::Entry& entry)
+    {
+        BinaryFileStream stream(path, BinaryFileStream::Mode::Read);
+        uint32_t magic = 0, version = 0;
+        stream >> magic >> version;
+        if(stream.isGood() == false || magic != kFileMagic || version != kFileVersion)
+        {
+            return false;
+        }
+
+        std::string storedKey;
+        if(readString(stream, storedKey) == false || storedKey != key)
+        {
+            return false;
+        }
+
+        // Make sure none of the dependencies changed since the entry was written
+        uint32_t dependencyCount = 0;
+        stream >> dependencyCount;
+        for(uint32_t i = 0; i < dependencyCount; i++)
+        {
+            std::string dependency;
+            uint64_t hash = 0;
+            if(readString(stream, dependency) == false)
+            {
+                return false;
+            }
+            stream >> hash;
+            if(doesFileExist(dependency) == false || ShaderCache::getFileHash(dependency) != hash)
+            {
+                return false;
+            }
+            entry.dependencies.push_back(dependency);
+        }
+
+        uint32_t stageMask = 0;
+        stream >> stageMask;
+        for(uint32_t i = 0; i < ShaderCache::kShaderCount; i++)
+        {
+            if((stageMask & (1 << i)) && readString(stream, entry.shaders[i]) == false)
+            {
+                return false;
+            }
+        }
+
+        entry.pReflector = ProgramReflection::deserialize(stream);
+        return entry.pReflector != nullptr;
+    }
+
+    static bool writeEntry(const std::string& path, const std::string& key, const ShaderCache::Entry& entry)
+    {
+        BinaryFileStream stream(path, BinaryFileStream::Mode::Write);
+        stream << kFileMagic << kFileVersion;
+        writeString(stream, key);
+
+        stream << (uint32_t)entry.dependencies.size();
+        for(const auto& dependency : entry.dependencies)
+        {
+            writeString(stream, dependency);
+            stream << ShaderCache::getFileHash(dependency);
+        }
+
+        uint32_t stageMask = 0;
+        for(uint32_t i = 0; i < ShaderCache::kShaderCount; i++)
+        {
+            stageMask |= entry.shaders[i].size() ? (1 << i) : 0;
+        }
+        stream << stageMask;
+        for(uint32_t i = 0; i < ShaderCache::kShaderCount; i++)
+        {
+            if(entry.shaders[i].size())
+            {
+                writeString(stream, entry.shaders[i]);
+            }
+        }
+
+        entry.pReflector->serialize(stream);
+        bool good = stream.isGood();
+        stream.close();
+        return good;
+    }
+
+    // The key stored in the file. Includes the hash of the Spire binary, so that entries are invalidated when Spire changes.
+    static std::string getFullKey(const std::string& key)
+    {
+        return getSpireBuildId() + '\n' + key;
+    }
+
+    bool ShaderCache::load(const std::string& key, Entry& entry)
+    {
+        CacheState& state = getState();
+        const std::string fullKey = getFullKey(key);
+        const std::string name = getEntryName(fullKey);
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            buildIndex(state);
+            if(isEnabled() == false)
+            {
+                return false;
+            }
+            if(state.files.find(name) == state.files.end())
+            {
+                state.stats.misses++;
+                return false;
+            }
+            path = state.directory + '\\' + name;
+        }
+
+        bool found = readEntry(path, fullKey, entry);
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if(found)
+        {
+            state.stats.hits++;
+            auto it = state.files.find(name);
+            if(it != state.files.end())
+            {
+                it->second.lastUse = time(nullptr);
+            }
+        }
+        else
+        {
+            state.stats.misses++;
+            entry = Entry();
+        }
+        return found;
+    }
+
+    void ShaderCache::store(const std::string& key, const Entry& entry)
+    {
+        assert(entry.pReflector);
+        CacheState& state = getState();
+        const std::string fullKey = getFullKey(key);
+        const std::string name = getEntryName(fullKey);
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            buildIndex(state);
+            if(isEnabled() == false)
+            {
+                return;
+            }
+            path = state.directory + '\\' + name;
+        }
+
+        // Write into a temporary file first, so that concurrent readers never see a partial entry
+        const std::string tempPath = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        if(writeEntry(tempPath, fullKey, entry) == false)
+        {
+            logWarning("Can't write shader cache entry '" + path + "'");
+            std::remove(tempPath.c_str());
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        std::remove(path.c_str());
+        if(std::rename(tempPath.c_str(), path.c_str()) != 0)
+        {
+            std::remove(tempPath.c_str());
+            return;
+        }
+
+        CacheFile& file = state.files[name];
+        state.totalSize -= file.size;
+        file.size = getFileSize(path);
+        file.lastUse = time(nullptr);
+        state.totalSize += file.size;
+        state.stats.writes++;
+        evict(state, name);
+    }
+
+    uint64_t ShaderCache::getStringHash(const std::string& str)
+    {
+        return fnv1a(str.data(), str.size());
+    }
+
+    uint64_t ShaderCache::getFileHash(const std::string& filename)
+    {
+        CacheState& state = getState();
+        time_t modifiedTime = getFileModifiedTime(filename);
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            const auto& it = state.fileHashes.find(filename);
+            if(it != state.fileHashes.end() && it->second.modifiedTime == modifiedTime)
+            {
+                return it->second.hash;
+            }
+        }
+
+        std::ifstream file(filename, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        FileHash fileHash;
+        fileHash.modifiedTime = modifiedTime;
+        fileHash.hash = fnv1a(data.data(), data.size());
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.fileHashes[filename] = fileHash;
+        return fileHash.hash;
+    }
+
+    void ShaderCache::setDirectory(const std::string& directory)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.directory = directory;
+        state.indexed = false;
+        state.files.clear();
+        state.totalSize = 0;
+    }
+
+    std::string ShaderCache::getDirectory()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return getDirectoryInternal(state);
+    }
+
+    void ShaderCache::setMaxSize(uint64_t maxSize)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        sMaxSize = maxSize;
+        if(state.indexed)
+        {
+            evict(state, "");
+        }
+    }
+
+    ShaderCache::Stats ShaderCache::getStats()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        Stats stats = state.stats;
+        stats.entryCount = (uint32_t)state.files.size();
+        stats.sizeInBytes = state.totalSize;
+        return stats;
+    }
+
+    void ShaderCache::clear()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        buildIndex(state);
+        for(const auto& file : state.files)
+        {
+            std::remove((state.directory + '\\' + file.first).c_str());
+        }
+        state.files.clear();
+        state.totalSize = 0;
+    }
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include "API/ProgramReflection.h"
+#include "API/Shader.h"
+
+namespace Falcor
+{
+    /** Persistent on-disk cache for the output of the Spire shader compiler.
+        Programs look up the cache before running Spire. An entry holds the preprocessed code of each shader stage and the program reflection data, so that a hit skips Spire completely.
+        Entries are addressed by a hash of the program's key - the source strings or files, the define list, the code-gen target and the Spire version. Each entry also records the content hash of every file Spire read while compiling it, and is only used if none of those files changed.
+        When the total size of the entries exceeds the size limit, the least recently used entries are deleted.
+        The cache is disabled by default. Its default directory is inside the executable directory, which may not be writable - applications which enable the cache should call setDirectory() with a user-writable location first.
+    */
+    class ShaderCache
+    {
+    public:
+        static const uint32_t kShaderCount = (uint32_t)ShaderType::Count;
+
+        /** The data stored for a single program
+        */
+        struct Entry
+        {
+            std::string shaders[kShaderCount];          ///< Preprocessed code for each stage. Empty if the program doesn't use the stage
+            ProgramReflection::SharedPtr pReflector;    ///< The program's reflection data
+            std::vector<std::string> dependencies;      ///< The files Spire read when compiling the program
+        };
+
+        /** Cache statistics, accumulated since the application started
+        */
+        struct Stats
+        {
+            uint32_t hits = 0;          ///< Number of lookups which found a valid entry
+            uint32_t misses = 0;        ///< Number of lookups which didn't find an entry, or found a stale one
+            uint32_t writes = 0;        ///< Number of entries written
+            uint32_t evictions = 0;     ///< Number of entries deleted to keep the cache under the size limit
+            uint32_t entryCount = 0;    ///< Number of entries currently in the cache
+            uint64_t sizeInBytes = 0;   ///< Total size of the entries currently in the cache
+        };
+
+        /** Look up an entry.
+            \param[in] key The program's key. The same key has to be passed to store()
+            \param[out] entry On success, holds the data stored for the key
+            \return true if a valid entry was found, otherwise false
+        */
+        static bool load(const std::string& key, Entry& entry);
+
+        /** Store an entry. If an entry with the same key exists, it will be replaced.
+        */
+        static void store(const std::string& key, const Entry& entry);
+
+        /** Get a 64-bit hash of a file's content. Hashes are cached per-file and recomputed when the file's modification time changes.
+        */
+        static uint64_t getFileHash(const std::string& filename);
+
+        /** Get a 64-bit hash of a string
+        */
+        static uint64_t getStringHash(const std::string& str);
+
+        /** Enable or disable the cache. The cache is disabled by default. Can be called from any thread.
+        */
+        static void setEnabled(bool enabled) { sEnabled.store(enabled); }
+
+        /** Check if the cache is enabled. Can be called from any thread.
+        */
+        static bool isEnabled() { return sEnabled.load(); }
+
+        /** Set the directory the cache is stored in. By default, the cache is stored in the 'ShaderCache' folder in the executable directory. Call this before enabling the cache if that directory isn't writable.
+        */
+        static void setDirectory(const std::string& directory);
+
+        /** Get the directory the cache is stored in
+        */
+        static std::string getDirectory();
+
+        /** Set the maximum size of the cache in bytes. Default is 256MB.
+        */
+        static void setMaxSize(uint64_t maxSize);
+
+        /** Get the maximum size of the cache in bytes
+        */
+        static uint64_t getMaxSize() { return sMaxSize; }
+
+        /** Get the cache statistics
+        */
+        static Stats getStats();
+
+        /** Delete all the entries in the cache
+        */
+        static void clear();
+
+    private:
+        ShaderCache() = delete;
+        static std::atomic<bool> sEnabled;
+        static uint64_t sMaxSize;
+    };
+}
@@ -0,0 +1,232 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Graphics/TextureCache.h"
+#include "Graphics/TextureHelper.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/CpuTimer.h"
+#include "Utils/OS.h"
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <algorithm>
+
+namespace Falcor
+{
+    struct TextureCache::PendingDecode
+    {
+        std::string key;
+        std::string filename;
+        bool generateMipLevels;
+        bool loadAsSrgb;
+        Texture::BindFlags bindFlags;
+
+        std::atomic_bool started{ false };
+        std::promise<void> decodedPromise;
+        std::shared_future<void> decoded;
+        std::shared_ptr<DecodedTextureFile> pData;
+
+        std::mutex createMutex;
+        bool created = false;
+        Texture::SharedPtr pTexture;
+    };
+
+    struct CacheEntry
+    {
+        std::weak_ptr<Texture> pTexture;
+        std::weak_ptr<TextureCache::PendingDecode> pPending;
+    };
+
+    static std::mutex sMutex;
+    static std::unordered_map<std::string, CacheEntry> sEntries;
+    static size_t sPruneThreshold = 64;
+    static TextureCache::Stats sStats;
+
+    // Remove the entries of textures which were released. Called with sMutex locked, whenever the map doubled in size since the last prune, so the cost is amortized over the requests.
+    static void pruneExpiredEntries()
+    {
+        for(auto it = sEntries.begin(); it != sEntries.end();)
+        {
+            if(it->second.pTexture.expired() && it->second.pPending.expired())
+            {
+                it = sEntries.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        sPruneThreshold = std::max<size_t>(64, sEntries.size() * 2);
+    }
+
+    static std::string createKey(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags)
+    {
+        std::string fullpath;
+        if(findFileInDataDirectories(filename, fullpath) == false)
+        {
+            fullpath = filename;
+        }
+
+        // The file system is case insensitive
+        std::string key = canonicalizeFilename(fullpath);
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+        key += generateMipLevels ? "|mips" : "|nomips";
+        key += loadAsSrgb ? "|srgb" : "|linear";
+        key += "|" + std::to_string((uint32_t)bindFlags);
+        return key;
+    }
+
+    // Called by the worker task and by get(). Whoever gets here first decodes the file, so get() never waits for a task which is still in the queue
+    static void decode(TextureCache::PendingDecode* pPending)
+    {
+        if(pPending->started.exchange(true))
+        {
+            return;
+        }
+
+        // The promise must be completed even if the decoder throws, otherwise get() would wait forever. A failed decode results in a null texture.
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+        try
+        {
+            pPending->pData = decodeTextureFile(pPending->filename);
+        }
+        catch(const std::exception& e)
+        {
+            logError("TextureCache - failed to decode '" + pPending->filename + "'. " + e.what());
+            pPending->pData = nullptr;
+        }
+        catch(...)
+        {
+            logError("TextureCache - failed to decode '" + pPending->filename + "'.");
+            pPending->pData = nullptr;
+        }
+        float duration = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        {
+            std::lock_guard<std::mutex> lock(sMutex);
+            sStats.decodeCount++;
+            sStats.decodeTime += duration;
+        }
+        pPending->decodedPromise.set_value();
+    }
+
+    bool TextureCache::PendingTexture::isReady() const
+    {
+        if(mpPending == nullptr)
+        {
+            return true;
+        }
+        return mpPending->decoded.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    Texture::SharedPtr TextureCache::PendingTexture::get() const
+    {
+        if(mpPending == nullptr)
+        {
+            return mpTexture;
+        }
+
+        PendingDecode* pPending = mpPending.get();
+        decode(pPending);
+        pPending->decoded.wait();
+
+        std::lock_guard<std::mutex> createLock(pPending->createMutex);
+        if(pPending->created == false)
+        {
+            if(pPending->pData)
+            {
+                pPending->pTexture = createTextureFromDecodedFile(pPending->pData.get(), pPending->generateMipLevels, pPending->loadAsSrgb, pPending->bindFlags);
+            }
+            pPending->pData = nullptr;
+            pPending->created = true;
+
+            std::lock_guard<std::mutex> lock(sMutex);
+            sEntries[pPending->key].pTexture = pPending->pTexture;
+        }
+        return pPending->pTexture;
+    }
+
+    TextureCache::PendingTexture TextureCache::requestTexture(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags)
+    {
+        std::string key = createKey(filename, generateMipLevels, loadAsSrgb, bindFlags);
+        PendingTexture result;
+
+        std::lock_guard<std::mutex> lock(sMutex);
+        if(sEntries.size() >= sPruneThreshold)
+        {
+            pruneExpiredEntries();
+        }
+
+        CacheEntry& entry = sEntries[key];
+        result.mpTexture = entry.pTexture.lock();
+        if(result.mpTexture == nullptr)
+        {
+            result.mpPending = entry.pPending.lock();
+        }
+
+        if(result.isValid())
+        {
+            sStats.hitCount++;
+            return result;
+        }
+
+        // Both the texture and the request expired, so start over with a new entry
+        sStats.missCount++;
+        entry = CacheEntry();
+        auto pPending = std::make_shared<PendingDecode>();
+        pPending->key = key;
+        pPending->filename = filename;
+        pPending->generateMipLevels = generateMipLevels;
+        pPending->loadAsSrgb = loadAsSrgb;
+        pPending->bindFlags = bindFlags;
+        pPending->decoded = pPending->decodedPromise.get_future().share();
+        entry.pPending = pPending;
+        result.mpPending = pPending;
+
+        // The task keeps the request alive until it's done, even if the user released it
+        ThreadPool::getGlobalPool().submit([pPending]() { decode(pPending.get()); });
+        return result;
+    }
+
+    Texture::SharedPtr TextureCache::getTexture(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags)
+    {
+        return requestTexture(filename, generateMipLevels, loadAsSrgb, bindFlags).get();
+    }
+
+    TextureCache::Stats TextureCache::getStats()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        return sStats;
+    }
+
+    void TextureCache::resetStats()
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        sStats = Stats();
+    }
+}
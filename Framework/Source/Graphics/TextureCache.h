@@ -0,0 +1,99 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include <memory>
+#include "API/Texture.h"
+
+namespace Falcor
+{
+    /*!
+    *  \addtogroup Falcor
+    *  @{
+    */
+
+    /** Process-wide cache of the textures loaded from files.
+        Textures are identified by their canonical path and the flags they were created with. The cache only holds weak references, so a texture is released once the last user releases it.
+        Files are decoded on the global thread pool. Creating the texture itself uploads data to the GPU, so it happens when the texture is retrieved, on the thread which owns the device.
+    */
+    class TextureCache
+    {
+    public:
+        struct Stats
+        {
+            uint64_t hitCount = 0;      ///< Requests which found the texture, or a pending decode of it, in the cache
+            uint64_t missCount = 0;     ///< Requests which had to decode the file
+            uint64_t decodeCount = 0;   ///< Number of files decoded
+            double decodeTime = 0;      ///< Total time spent decoding files in milliseconds, summed over all of the worker threads
+
+            float getHitRate() const { uint64_t total = hitCount + missCount; return total ? float(hitCount) / float(total) : 0.0f; }
+        };
+
+        struct PendingDecode;
+
+        /** A texture which might still be decoding. Similar to a std::shared_future, the object can be copied and all copies return the same texture.
+        */
+        class PendingTexture
+        {
+        public:
+            PendingTexture() = default;
+
+            /** Check if get() can return without waiting for the decoding to finish
+            */
+            bool isReady() const;
+
+            /** Get the texture. Waits for the file to be decoded, and creates the texture on the first call. Must be called on the thread which owns the device.
+                \return The texture, or nullptr if the file couldn't be loaded
+            */
+            Texture::SharedPtr get() const;
+
+            bool isValid() const { return mpPending != nullptr || mpTexture != nullptr; }
+
+        private:
+            friend class TextureCache;
+            std::shared_ptr<PendingDecode> mpPending;
+            Texture::SharedPtr mpTexture;
+        };
+
+        /** Start loading a texture. Doesn't access the device and never blocks on decoding, so it can be called from any thread.
+            The decoded data is kept alive until the texture is created, or until all of the copies of the returned object are released.
+        */
+        static PendingTexture requestTexture(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags = Texture::BindFlags::ShaderResource);
+
+        /** Load a texture and wait for it. Equivalent to requestTexture().get()
+        */
+        static Texture::SharedPtr getTexture(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags = Texture::BindFlags::ShaderResource);
+
+        /** Get the statistics accumulated since the last call to resetStats()
+        */
+        static Stats getStats();
+        static void resetStats();
+    };
+
+    /*! @} */
+}
@@ -32,6 +32,10 @@
 #include "Utils/DDSHeader.h"
 #include "Utils/BinaryFileStream.h"
 #include "Utils/StringUtils.h"
+#include "Graphics/TextureCache.h"
+#include "Utils/BlockCompression.h"
+#include "Utils/ThreadPool.h"
+#include <cmath>
 
 #ifdef FALCOR_GL
 static const bool kTopDown = false;
@@ -543,14 +547,14 @@ namespace Falcor
 		}
 	}
 
-	void loadDDSDataFromFile(const std::string filename, DdsData& ddsData)
+	bool loadDDSDataFromFile(const std::string filename, DdsData& ddsData)
 	{
         std::string fullpath;
 		if (findFileInDataDirectories(filename, fullpath) == false)
 		{
 			logError(std::string("Can't find texture file ") + filename);
 			//could not find file
-			return;
+			return false;
 		}
 
 		BinaryFileStream stream(fullpath, BinaryFileStream::Mode::Read);
@@ -562,7 +566,7 @@ namespace Falcor
 		{
 			//not valid dds file apparently
 			logError(std::string("The dds file ") + filename + std::string(" is not a valid dds file"));
-			return;
+			return false;
 		}
 
         stream >> ddsData.header;
@@ -580,6 +584,7 @@ namespace Falcor
         uint32_t dataSize = stream.getRemainingStreamSize();
         ddsData.data.resize(dataSize);
         stream.read(ddsData.data.data(), dataSize);
+        return true;
 	}
 
     Texture::SharedPtr createTextureFromDx10Dds(DdsData& ddsData, const std::string& filename, ResourceFormat format, uint32_t mipLevels, Texture::BindFlags bindFlags)
@@ -639,22 +644,16 @@ namespace Falcor
         return nullptr;
     }
 
-	Texture::SharedPtr createTextureFromDDSFile(const std::string filename, bool generateMips, Texture::BindFlags bindFlags)
+	Texture::SharedPtr createTextureFromDdsData(DdsData& ddsData, const std::string& filename, bool generateMips, Texture::BindFlags bindFlags)
 	{
-		DdsData ddsData;
-		loadDDSDataFromFile(filename, ddsData);
-		
 		ResourceFormat format = getDdsResourceFormat(ddsData);
 		assert(format != ResourceFormat::Unknown);
 
-		uint32_t mipLevels;
-		if (generateMips)
+		// Use the mip-chain stored in the file if there is one. Compressed formats can't be rendered into, so their mips can't be generated
+		uint32_t mipLevels = (ddsData.header.flags & DdsHeader::kMipCountMask) ? max(ddsData.header.mipCount, 1U) : 1;
+		if (generateMips && mipLevels == 1 && isCompressedFormat(format) == false)
 		{
 			mipLevels = Texture::kMaxPossible;
-		} 
-		else
-		{
-			mipLevels = (ddsData.header.flags & DdsHeader::kMipCountMask) ? max(ddsData.header.mipCount, 1U) : 1;
 		}
 	
 		if (ddsData.hasDX10Header)
@@ -669,34 +668,369 @@ namespace Falcor
 		return nullptr;
 	}
 
-	Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags)
+    struct DecodedTextureFile
+    {
+        std::string filename;
+        bool isDds = false;
+        bool isValid = false;
+        DdsData ddsData;                    // Used for DDS files
+        Bitmap::UniqueConstPtr pBitmap;     // Used for all other formats
+    };
+
+    std::shared_ptr<DecodedTextureFile> decodeTextureFile(const std::string& filename)
+    {
+        auto pData = std::make_shared<DecodedTextureFile>();
+        pData->filename = filename;
+        if(hasSuffix(filename, ".dds"))
+        {
+            pData->isDds = true;
+            pData->isValid = loadDDSDataFromFile(filename, pData->ddsData);
+        }
+        else
+        {
+            pData->pBitmap = Bitmap::createFromFile(filename, kTopDown);
+            pData->isValid = (pData->pBitmap != nullptr);
+        }
+        return pData;
+    }
+
+	Texture::SharedPtr createTextureFromDecodedFile(DecodedTextureFile* pData, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags)
     {
 #define no_srgb()   \
     if(loadAsSrgb)  \
     {               \
         logWarning("createTexture2DFromFile() warning. " + std::to_string(pBitmap->getBytesPerPixel()) + " channel images doesn't have a matching sRGB format. Loading in linear space.");  \
     }
-			
-		if (hasSuffix(filename, ".dds"))
+
+        if(pData->isValid == false)
+        {
+            return nullptr;
+        }
+
+		if (pData->isDds)
 		{
-			return createTextureFromDDSFile(filename, generateMipLevels, bindFlags);
+			return createTextureFromDdsData(pData->ddsData, pData->filename, generateMipLevels, bindFlags);
 		}
 
-        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, kTopDown);
-        Texture::SharedPtr pTex;
+        const Bitmap* pBitmap = pData->pBitmap.get();
+        ResourceFormat texFormat = pBitmap->getFormat();
+        if(loadAsSrgb)
+        {
+            texFormat = linearToSrgbFormat(texFormat);
+        }
+
+        Texture::SharedPtr pTex = Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, pBitmap->getData(), bindFlags);
+        pTex->setSourceFilename(stripDataDirectories(pData->filename));
+        return pTex;
+    }
+
+	Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags)
+    {
+        return TextureCache::getTexture(filename, generateMipLevels, loadAsSrgb, bindFlags);
+    }
+#undef no_srgb
+
+    // An image with 32-bit float RGBA texels, used while filtering the mips
+    struct FloatImage
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<glm::vec4> texels;
+    };
 
-        if(pBitmap)
+    static float srgbToLinear(float c)
+    {
+        return (c <= 0.04045f) ? (c / 12.92f) : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    static float linearToSrgb(float c)
+    {
+        return (c <= 0.0031308f) ? (c * 12.92f) : (1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f);
+    }
+
+    static bool bitmapToFloatImage(const Bitmap* pBitmap, bool isSrgb, FloatImage& image)
+    {
+        image.width = pBitmap->getWidth();
+        image.height = pBitmap->getHeight();
+        image.texels.resize(size_t(image.width) * image.height);
+        const uint8_t* pData = pBitmap->getData();
+
+        for(size_t i = 0; i < image.texels.size(); i++)
         {
-            ResourceFormat texFormat = pBitmap->getFormat();
-            if(loadAsSrgb)
+            glm::vec4& t = image.texels[i];
+            switch(pBitmap->getFormat())
+            {
+            case ResourceFormat::BGRA8Unorm:
+                t = glm::vec4(pData[i * 4 + 2], pData[i * 4 + 1], pData[i * 4 + 0], pData[i * 4 + 3]) / 255.0f;
+                break;
+            case ResourceFormat::BGRX8Unorm:
+                t = glm::vec4(pData[i * 4 + 2], pData[i * 4 + 1], pData[i * 4 + 0], 255) / 255.0f;
+                break;
+            case ResourceFormat::RG8Unorm:
+                t = glm::vec4(pData[i * 2 + 0], pData[i * 2 + 1], 0, 255) / 255.0f;
+                break;
+            case ResourceFormat::R8Unorm:
+                t = glm::vec4(pData[i], 0, 0, 255) / 255.0f;
+                break;
+            default:
+                logError("bakeTextureToDds() - only 8-bit images are supported. Format is " + to_string(pBitmap->getFormat()));
+                return false;
+            }
+
+            if(isSrgb)
             {
-                texFormat = linearToSrgbFormat(texFormat);
+                t.r = srgbToLinear(t.r);
+                t.g = srgbToLinear(t.g);
+                t.b = srgbToLinear(t.b);
             }
+        }
+        return true;
+    }
 
-            pTex = Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, pBitmap->getData(), bindFlags);
-            pTex->setSourceFilename(stripDataDirectories(filename));
+    static float besselI0(float x)
+    {
+        float sum = 1;
+        float term = 1;
+        for(uint32_t k = 1; k < 20; k++)
+        {
+            float f = x / (2.0f * k);
+            term *= f * f;
+            sum += term;
         }
-        return pTex;
+        return sum;
+    }
+
+    static float sinc(float x)
+    {
+        const float kPi = 3.14159265358979f;
+        return (std::abs(x) < 1e-5f) ? 1.0f : std::sin(kPi * x) / (kPi * x);
+    }
+
+    // Weights of the source texels contributing to each destination texel along one axis
+    struct FilterTaps
+    {
+        int32_t first;
+        std::vector<float> weights;
+    };
+
+    static std::vector<FilterTaps> createFilterTaps(uint32_t srcSize, uint32_t dstSize, TextureBakeDesc::MipFilter filter)
+    {
+        static const float kKaiserWidth = 3.0f;     // In destination texels
+        static const float kKaiserAlpha = 4.0f;
+
+        std::vector<FilterTaps> taps(dstSize);
+        const float scale = float(srcSize) / float(dstSize);
+        const float radius = (filter == TextureBakeDesc::MipFilter::Kaiser) ? kKaiserWidth * scale : 0.5f * scale;
+
+        for(uint32_t x = 0; x < dstSize; x++)
+        {
+            float center = (x + 0.5f) * scale;
+            int32_t first = (int32_t)std::floor(center - radius);
+            int32_t last = (int32_t)std::ceil(center + radius);
+            taps[x].first = first;
+
+            float total = 0;
+            for(int32_t i = first; i <= last; i++)
+            {
+                // Distance from the center in destination texels
+                float t = ((i + 0.5f) - center) / scale;
+                float w = 0;
+                if(filter == TextureBakeDesc::MipFilter::Kaiser)
+                {
+                    float u = t / kKaiserWidth;
+                    w = (std::abs(u) < 1) ? sinc(t) * besselI0(kKaiserAlpha * std::sqrt(1 - u * u)) / besselI0(kKaiserAlpha) : 0;
+                }
+                else
+                {
+                    // Coverage of the source texel by the destination texel's footprint
+                    float lo = std::max(float(i), center - radius);
+                    float hi = std::min(float(i + 1), center + radius);
+                    w = std::max(hi - lo, 0.0f);
+                }
+                taps[x].weights.push_back(w);
+                total += w;
+            }
+
+            for(auto& w : taps[x].weights)
+            {
+                w /= total;
+            }
+        }
+        return taps;
+    }
+
+    // Separable downsampling to half the size. Texels outside of the image are clamped to the edge
+    static void downsample(const FloatImage& src, FloatImage& dst, TextureBakeDesc::MipFilter filter)
+    {
+        dst.width = max(src.width / 2, 1U);
+        dst.height = max(src.height / 2, 1U);
+        dst.texels.resize(size_t(dst.width) * dst.height);
+
+        std::vector<FilterTaps> tapsX = createFilterTaps(src.width, dst.width, filter);
+        std::vector<FilterTaps> tapsY = createFilterTaps(src.height, dst.height, filter);
+
+        // Horizontal pass into a dst.width x src.height image, then the vertical pass
+        std::vector<glm::vec4> temp(size_t(dst.width) * src.height);
+        ThreadPool& pool = ThreadPool::getGlobalPool();
+        pool.parallelFor(src.height, [&](uint32_t y)
+        {
+            const glm::vec4* pRow = src.texels.data() + size_t(y) * src.width;
+            for(uint32_t x = 0; x < dst.width; x++)
+            {
+                glm::vec4 sum(0);
+                const FilterTaps& taps = tapsX[x];
+                for(size_t i = 0; i < taps.weights.size(); i++)
+                {
+                    int32_t sx = glm::clamp(taps.first + (int32_t)i, 0, (int32_t)src.width - 1);
+                    sum += pRow[sx] * taps.weights[i];
+                }
+                temp[size_t(y) * dst.width + x] = sum;
+            }
+        });
+
+        pool.parallelFor(dst.height, [&](uint32_t y)
+        {
+            const FilterTaps& taps = tapsY[y];
+            for(uint32_t x = 0; x < dst.width; x++)
+            {
+                glm::vec4 sum(0);
+                for(size_t i = 0; i < taps.weights.size(); i++)
+                {
+                    int32_t sy = glm::clamp(taps.first + (int32_t)i, 0, (int32_t)src.height - 1);
+                    sum += temp[size_t(sy) * dst.width + x] * taps.weights[i];
+                }
+                // The negative lobes of the Kaiser filter can overshoot
+                dst.texels[size_t(y) * dst.width + x] = glm::clamp(sum, glm::vec4(0), glm::vec4(1));
+            }
+        });
+    }
+
+    static void floatImageToRgba8(const FloatImage& image, bool isSrgb, std::vector<uint8_t>& rgba)
+    {
+        rgba.resize(image.texels.size() * 4);
+        for(size_t i = 0; i < image.texels.size(); i++)
+        {
+            glm::vec4 t = glm::clamp(image.texels[i], glm::vec4(0), glm::vec4(1));
+            if(isSrgb)
+            {
+                t.r = linearToSrgb(t.r);
+                t.g = linearToSrgb(t.g);
+                t.b = linearToSrgb(t.b);
+            }
+
+            for(uint32_t c = 0; c < 4; c++)
+            {
+                rgba[i * 4 + c] = (uint8_t)(t[c] * 255.0f + 0.5f);
+            }
+        }
+    }
+
+    static ResourceFormat getBakeFormat(const TextureBakeDesc& desc)
+    {
+        switch(desc.compression)
+        {
+        case TextureBakeDesc::Compression::None:
+            return desc.isSrgb ? ResourceFormat::RGBA8UnormSrgb : ResourceFormat::RGBA8Unorm;
+        case TextureBakeDesc::Compression::BC1:
+            return desc.isSrgb ? ResourceFormat::BC1UnormSrgb : ResourceFormat::BC1Unorm;
+        case TextureBakeDesc::Compression::BC3:
+            return desc.isSrgb ? ResourceFormat::BC3UnormSrgb : ResourceFormat::BC3Unorm;
+        case TextureBakeDesc::Compression::BC5:
+            return ResourceFormat::BC5Unorm;
+        case TextureBakeDesc::Compression::BC7:
+            return desc.isSrgb ? ResourceFormat::BC7UnormSrgb : ResourceFormat::BC7Unorm;
+        default:
+            should_not_get_here();
+            return ResourceFormat::Unknown;
+        }
+    }
+
+    bool bakeTextureToDds(const std::string& srcFilename, const std::string& dstFilename, const TextureBakeDesc& desc)
+    {
+        // DDS files are always stored top-down
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(srcFilename, true);
+        if(pBitmap == nullptr)
+        {
+            return false;
+        }
+
+        const ResourceFormat format = getBakeFormat(desc);
+        const bool isCompressed = isCompressedFormat(format);
+        const bool isSrgb = desc.isSrgb && (desc.compression != TextureBakeDesc::Compression::BC5);
+        if(isCompressed && ((pBitmap->getWidth() % 4) || (pBitmap->getHeight() % 4)))
+        {
+            logError("bakeTextureToDds() - can't compress " + srcFilename + ". The width and height of the image must be multiples of 4.");
+            return false;
+        }
+
+        FloatImage level;
+        if(bitmapToFloatImage(pBitmap.get(), isSrgb, level) == false)
+        {
+            return false;
+        }
+
+        const uint32_t width = level.width;
+        const uint32_t height = level.height;
+        uint32_t mipCount = 1;
+        if(desc.mipFilter != TextureBakeDesc::MipFilter::None)
+        {
+            mipCount = 1 + (uint32_t)std::floor(std::log2((float)max(width, height)));
+        }
+
+        // The mip-levels are stored one after the other, starting with the largest
+        std::vector<uint8_t> data;
+        std::vector<uint8_t> rgba;
+        for(uint32_t mip = 0; mip < mipCount; mip++)
+        {
+            if(mip > 0)
+            {
+                FloatImage next;
+                downsample(level, next, desc.mipFilter);
+                level = std::move(next);
+            }
+
+            floatImageToRgba8(level, isSrgb, rgba);
+            if(isCompressed)
+            {
+                size_t offset = data.size();
+                data.resize(offset + BlockCompression::getCompressedSize(format, level.width, level.height));
+                BlockCompression::compressImage(format, rgba.data(), level.width, level.height, data.data() + offset);
+            }
+            else
+            {
+                data.insert(data.end(), rgba.begin(), rgba.end());
+            }
+        }
+
+        DdsHeader header = {};
+        header.headerSize = sizeof(DdsHeader);
+        header.flags = DdsHeader::kCapsMask | DdsHeader::kHeightMask | DdsHeader::kWidthMask | DdsHeader::kPixelFormatMask | DdsHeader::kMipCountMask;
+        header.flags |= isCompressed ? DdsHeader::kLinearSizeMask : DdsHeader::kPitchMask;
+        header.width = width;
+        header.height = height;
+        header.linearSize = isCompressed ? (uint32_t)BlockCompression::getCompressedSize(format, width, height) : width * 4;
+        header.mipCount = mipCount;
+        header.pixelFormat.structSize = sizeof(DdsHeader::PixelFormat);
+        header.pixelFormat.flags = DdsHeader::PixelFormat::kFourCCFlag;
+        header.pixelFormat.fourCC = makeFourCC("DX10");
+        header.caps[0] = DdsHeader::kCapsTextureMask | ((mipCount > 1) ? (DdsHeader::kCapsComplexMask | DdsHeader::kCapsMipMapMask) : 0);
+
+        DdsHeaderDX10 dx10Header = {};
+        dx10Header.dxgiFormat = getDxgiFormat(format);
+        dx10Header.resourceDimension = D3D10_RESOURCE_DIMENSION_TEXTURE2D;
+        dx10Header.arraySize = 1;
+
+        BinaryFileStream stream(dstFilename, BinaryFileStream::Mode::Write);
+        if(stream.isGood() == false)
+        {
+            logError("bakeTextureToDds() - can't open " + dstFilename + " for writing");
+            return false;
+        }
+
+        stream << kDdsMagicNumber;
+        stream << header;
+        stream << dx10Header;
+        stream.write(data.data(), data.size());
+        return true;
     }
-#undef no_srgb
 }
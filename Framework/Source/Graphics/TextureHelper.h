@@ -36,12 +36,60 @@ namespace Falcor
     */
 
     /** create a new texture from an a file
+        Textures are shared through the TextureCache. If the file was already loaded with the same flags and the texture is still alive, the existing texture is returned.
         \param[in] Filename Filename
         \param[in] generateMipLevels true is mip-chain should be generated, otherwise false
         \param[in] loadAsSrgb Load the texture using sRGB format. Only valid for 3/4 component textures.
         \param[in] bindFlags The bind flags to create the texture with
     */
 	Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags = Texture::BindFlags::ShaderResource);
+
+    /** The content of a texture file, decoded on the CPU
+    */
+    struct DecodedTextureFile;
+
+    /** Read and decode a texture file. Doesn't access the device, so it can be called from any thread.
+        \return The decoded data. If the file can't be loaded, the error is logged and createTextureFromDecodedFile() will return nullptr.
+    */
+    std::shared_ptr<DecodedTextureFile> decodeTextureFile(const std::string& filename);
+
+    /** Create a texture from data decoded by decodeTextureFile(). Must be called on the thread which owns the device. The decoded data can only be used once.
+    */
+    Texture::SharedPtr createTextureFromDecodedFile(DecodedTextureFile* pData, bool generateMipLevels, bool loadAsSrgb, Texture::BindFlags bindFlags);
     
+    /** Options for bakeTextureToDds()
+    */
+    struct TextureBakeDesc
+    {
+        enum class Compression
+        {
+            None,       ///< RGBA8
+            BC1,        ///< Opaque color
+            BC3,        ///< Color and alpha
+            BC5,        ///< Two channels, used for normal maps
+            BC7,        ///< High quality color and alpha
+        };
+
+        enum class MipFilter
+        {
+            None,       ///< Only store the top level
+            Box,        ///< Average 2x2 texels
+            Kaiser,     ///< Kaiser-windowed sinc. Sharper than the box filter
+        };
+
+        Compression compression = Compression::BC7;
+        MipFilter mipFilter = MipFilter::Kaiser;
+        bool isSrgb = true;     ///< The color channels are stored in sRGB space. Mips are filtered in linear space, and the output uses the sRGB format. Ignored for BC5.
+    };
+
+    /** Convert an image file into a DDS file which can be loaded without any processing. Mip-levels are generated and compressed on the CPU.
+        Only 8-bit images are supported. Compressed formats require the image width and height to be multiples of 4.
+        \param[in] srcFilename The source image. Loaded using the data directories
+        \param[in] dstFilename The DDS file to write
+        \param[in] desc The output options
+        \return true if the file was written, otherwise false
+    */
+    bool bakeTextureToDds(const std::string& srcFilename, const std::string& dstFilename, const TextureBakeDesc& desc);
+
     /*! @} */
 }
\ No newline at end of file
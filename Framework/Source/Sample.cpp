@@ -87,6 +87,12 @@ namespace Falcor
             {
                 initVideoCapture();
             }
+#if _PROFILING_ENABLED
+            else if (keyEvent.mods.isShiftDown && keyEvent.key == KeyboardEvent::Key::P)
+            {
+                toggleTraceCapture();
+            }
+#endif
             else if (!keyEvent.mods.isAltDown && !keyEvent.mods.isCtrlDown && !keyEvent.mods.isShiftDown)
             {
                 switch (keyEvent.key)
@@ -269,7 +275,8 @@ namespace Falcor
             "  'Z'       - Zoom in on a pixel\n"
             "  'MouseWheel' - Change level of zoom\n"
 #if _PROFILING_ENABLED
-            "  'P'       - Enable profiling\n";
+            "  'P'       - Enable profiling\n"
+            "  'Shift+P' - Start CPU trace capture\\dump trace\n";
 #else
             ;
 #endif
@@ -436,9 +443,27 @@ namespace Falcor
         }
     }
 
+    void Sample::toggleTraceCapture()
+    {
+        if (Profiler::isTraceCaptureEnabled())
+        {
+            std::string filename;
+            if (findAvailableFilename("Trace", getExecutableDirectory(), "json", filename) && Profiler::dumpTrace(filename))
+            {
+                logInfo("CPU trace written to " + filename);
+            }
+            Profiler::stopTraceCapture();
+        }
+        else
+        {
+            Profiler::startTraceCapture();
+        }
+    }
+
     void Sample::printProfileData()
     {
 #if _PROFILING_ENABLED
+        Profiler::endTraceFrame();
         if (gProfileEnabled)
         {
             std::string profileMsg;
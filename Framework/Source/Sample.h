@@ -178,6 +178,7 @@ namespace Falcor
         // Private functions
         void initUI();
         void printProfileData();
+        void toggleTraceCapture();
         void calculateTime();
 
         void startVideoCapture();
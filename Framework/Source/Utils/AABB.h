@@ -29,6 +29,9 @@
 #include "glm/vec3.hpp"
 #include "glm/mat4x4.hpp"
 #include "glm/common.hpp"
+#include "glm/geometric.hpp"
+#include "glm/matrix.hpp"
+#include <vector>
 
 namespace Falcor
 {
@@ -99,4 +102,93 @@ namespace Falcor
             return BoundingBox::fromMinMax( min(bb0.getMinPos(), bb1.getMinPos()), max(bb0.getMaxPos(), bb1.getMaxPos()) );
         }
     };
+
+    /** A convex volume bounded by up to 6 planes, used for culling.
+        A point p is inside the volume when dot(p, plane.xyz) + plane.w > 0 for all the planes.
+    */
+    struct CullingFrustum
+    {
+        enum class Result
+        {
+            Outside,
+            Intersecting,
+            Inside,
+        };
+
+        glm::vec4 planes[6];
+        uint32_t planeCount = 0;
+
+        /** Extract the frustum planes from a view-projection matrix
+            \param[in] viewProj The view-projection matrix
+            \param[in] includeNearPlane If false, objects between the eye and the near plane are not culled. Useful for shadow casters.
+        */
+        static CullingFrustum fromViewProjMatrix(const glm::mat4& viewProj, bool includeNearPlane = true)
+        {
+            // See: https://fgiesen.wordpress.com/2012/08/31/frustum-planes-from-the-projection-matrix/
+            CullingFrustum frustum;
+            glm::mat4 tempMat = glm::transpose(viewProj);
+            for(int i = 0; i < 6; i++)
+            {
+                if((i == 5) && (includeNearPlane == false))
+                {
+                    continue;
+                }
+                glm::vec4 plane = (i & 1) ? tempMat[i >> 1] : -tempMat[i >> 1];
+                frustum.planes[frustum.planeCount++] = plane + tempMat[3];
+            }
+            return frustum;
+        }
+
+        /** Test a box against the frustum
+        */
+        Result test(const BoundingBox& box) const
+        {
+            Result result = Result::Inside;
+            for(uint32_t i = 0; i < planeCount; i++)
+            {
+                const glm::vec3 normal(planes[i]);
+                const float centerDist = glm::dot(box.center, normal) + planes[i].w;
+                const float radius = glm::dot(box.extent, glm::abs(normal));
+                if(centerDist + radius <= 0)
+                {
+                    return Result::Outside;
+                }
+                if(centerDist - radius <= 0)
+                {
+                    result = Result::Intersecting;
+                }
+            }
+            return result;
+        }
+    };
+
+    /** Structure-of-arrays storage for many bounding boxes, so that SIMD code can test several boxes at once
+    */
+    struct BoundingBoxArray
+    {
+        std::vector<float> centerX, centerY, centerZ;
+        std::vector<float> extentX, extentY, extentZ;
+
+        uint32_t size() const { return (uint32_t)centerX.size(); }
+
+        void resize(uint32_t count)
+        {
+            centerX.resize(count); centerY.resize(count); centerZ.resize(count);
+            extentX.resize(count); extentY.resize(count); extentZ.resize(count);
+        }
+
+        void set(uint32_t index, const BoundingBox& box)
+        {
+            centerX[index] = box.center.x; centerY[index] = box.center.y; centerZ[index] = box.center.z;
+            extentX[index] = box.extent.x; extentY[index] = box.extent.y; extentZ[index] = box.extent.z;
+        }
+
+        BoundingBox get(uint32_t index) const
+        {
+            BoundingBox box;
+            box.center = glm::vec3(centerX[index], centerY[index], centerZ[index]);
+            box.extent = glm::vec3(extentX[index], extentY[index], extentZ[index]);
+            return box;
+        }
+    };
 }
\ No newline at end of file
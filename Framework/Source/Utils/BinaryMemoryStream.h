@@ -0,0 +1,92 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <cstring>
+
+namespace Falcor
+{
+    /** Reads binary data out of a memory block, using the same interface as BinaryFileStream.
+        Reading past the end of the block zero-fills the destination and puts the stream into a failed state.
+    */
+    class BinaryMemoryStream
+    {
+    public:
+        BinaryMemoryStream() = default;
+        BinaryMemoryStream(const void* pData, size_t size) : mpData((const uint8_t*)pData), mSize(size) {}
+
+        void skip(size_t count)
+        {
+            if(count > getRemainingStreamSize())
+            {
+                mFail = true;
+                mOffset = mSize;
+            }
+            else
+            {
+                mOffset += count;
+            }
+        }
+
+        size_t getRemainingStreamSize() const { return mSize - mOffset; }
+
+        /** Get a pointer to the current read position. Useful for decoding large blocks in place.
+        */
+        const uint8_t* getCurrentPointer() const { return mpData + mOffset; }
+
+        size_t getPosition() const { return mOffset; }
+
+        bool isGood() const { return mFail == false; }
+        bool isFail() const { return mFail; }
+        bool isEof() const { return mOffset == mSize; }
+
+        BinaryMemoryStream& read(void* pData, size_t count)
+        {
+            if(count > getRemainingStreamSize())
+            {
+                std::memset(pData, 0, count);
+                mFail = true;
+                mOffset = mSize;
+            }
+            else
+            {
+                std::memcpy(pData, mpData + mOffset, count);
+                mOffset += count;
+            }
+            return *this;
+        }
+
+        template<typename T>
+        BinaryMemoryStream& operator>>(T& val) { return read(&val, sizeof(T)); }
+
+    private:
+        const uint8_t* mpData = nullptr;
+        size_t mSize = 0;
+        size_t mOffset = 0;
+        bool mFail = false;
+    };
+}
@@ -0,0 +1,471 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Utils/BlockCompression.h"
+#include "Utils/ThreadPool.h"
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor
+{
+    namespace BlockCompression
+    {
+        static const uint32_t kBlockPixels = 16;
+
+        // Squared distance between two RGBA colors
+        static inline float distanceSquared(__m128 a, __m128 b)
+        {
+            __m128 d = _mm_sub_ps(a, b);
+            d = _mm_mul_ps(d, d);
+            __m128 shuf = _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 3, 0, 1));
+            __m128 sums = _mm_add_ps(d, shuf);
+            shuf = _mm_movehl_ps(shuf, sums);
+            sums = _mm_add_ss(sums, shuf);
+            return _mm_cvtss_f32(sums);
+        }
+
+        static inline uint32_t findClosestEntry(__m128 pixel, const __m128* pPalette, uint32_t paletteSize)
+        {
+            uint32_t best = 0;
+            float bestDistance = distanceSquared(pixel, pPalette[0]);
+            for(uint32_t i = 1; i < paletteSize; i++)
+            {
+                float d = distanceSquared(pixel, pPalette[i]);
+                if(d < bestDistance)
+                {
+                    bestDistance = d;
+                    best = i;
+                }
+            }
+            return best;
+        }
+
+        // Load the block into floats. Channels which are not part of the mask are set to zero, so they don't affect the distances.
+        static void loadBlock(const uint8_t* pBlock, const float mask[4], __m128 pixels[kBlockPixels])
+        {
+            __m128 m = _mm_loadu_ps(mask);
+            for(uint32_t i = 0; i < kBlockPixels; i++)
+            {
+                const uint8_t* p = pBlock + i * 4;
+                pixels[i] = _mm_mul_ps(_mm_setr_ps(p[0], p[1], p[2], p[3]), m);
+            }
+        }
+
+        // Find the two endpoints of the line which best fits the block's colors. Uses the principal axis of the colors, found with power iterations over their covariance matrix.
+        static void findEndpoints(const __m128 pixels[kBlockPixels], float e0[4], float e1[4])
+        {
+            __m128 sum = _mm_setzero_ps();
+            for(uint32_t i = 0; i < kBlockPixels; i++)
+            {
+                sum = _mm_add_ps(sum, pixels[i]);
+            }
+            float mean[4];
+            _mm_storeu_ps(mean, _mm_mul_ps(sum, _mm_set1_ps(1.0f / kBlockPixels)));
+
+            float cov[4][4] = {};
+            float centered[kBlockPixels][4];
+            for(uint32_t i = 0; i < kBlockPixels; i++)
+            {
+                _mm_storeu_ps(centered[i], _mm_sub_ps(pixels[i], _mm_loadu_ps(mean)));
+                for(uint32_t r = 0; r < 4; r++)
+                {
+                    for(uint32_t c = 0; c < 4; c++)
+                    {
+                        cov[r][c] += centered[i][r] * centered[i][c];
+                    }
+                }
+            }
+
+            float axis[4] = { 1, 1, 1, 1 };
+            for(uint32_t iteration = 0; iteration < 8; iteration++)
+            {
+                float next[4] = {};
+                for(uint32_t r = 0; r < 4; r++)
+                {
+                    for(uint32_t c = 0; c < 4; c++)
+                    {
+                        next[r] += cov[r][c] * axis[c];
+                    }
+                }
+
+                float maxComponent = std::max(std::max(std::abs(next[0]), std::abs(next[1])), std::max(std::abs(next[2]), std::abs(next[3])));
+                if(maxComponent < 1e-6f)
+                {
+                    // All of the pixels have the same color
+                    for(uint32_t c = 0; c < 4; c++)
+                    {
+                        e0[c] = e1[c] = mean[c];
+                    }
+                    return;
+                }
+
+                for(uint32_t c = 0; c < 4; c++)
+                {
+                    axis[c] = next[c] / maxComponent;
+                }
+            }
+
+            float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3]);
+            float minT = FLT_MAX;
+            float maxT = -FLT_MAX;
+            for(uint32_t i = 0; i < kBlockPixels; i++)
+            {
+                float t = (centered[i][0] * axis[0] + centered[i][1] * axis[1] + centered[i][2] * axis[2] + centered[i][3] * axis[3]) / length;
+                minT = std::min(minT, t);
+                maxT = std::max(maxT, t);
+            }
+
+            // Move the endpoints slightly inwards. The extremes are rarely the best choice once the palette is interpolated.
+            float inset = (maxT - minT) / 32.0f;
+            minT += inset;
+            maxT -= inset;
+
+            for(uint32_t c = 0; c < 4; c++)
+            {
+                e0[c] = glm::clamp(mean[c] + axis[c] / length * minT, 0.0f, 255.0f);
+                e1[c] = glm::clamp(mean[c] + axis[c] / length * maxT, 0.0f, 255.0f);
+            }
+        }
+
+        static uint16_t packColor565(const float color[4])
+        {
+            uint32_t r = (uint32_t)(color[0] * 31.0f / 255.0f + 0.5f);
+            uint32_t g = (uint32_t)(color[1] * 63.0f / 255.0f + 0.5f);
+            uint32_t b = (uint32_t)(color[2] * 31.0f / 255.0f + 0.5f);
+            return (uint16_t)((r << 11) | (g << 5) | b);
+        }
+
+        static __m128 unpackColor565(uint16_t color)
+        {
+            uint32_t r = (color >> 11) & 0x1F;
+            uint32_t g = (color >> 5) & 0x3F;
+            uint32_t b = color & 0x1F;
+            return _mm_setr_ps(float((r << 3) | (r >> 2)), float((g << 2) | (g >> 4)), float((b << 3) | (b >> 2)), 0);
+        }
+
+        static void write16(uint8_t* pDst, uint16_t value)
+        {
+            pDst[0] = (uint8_t)(value & 0xFF);
+            pDst[1] = (uint8_t)(value >> 8);
+        }
+
+        void encodeBC1(const uint8_t* pBlock, uint8_t* pDst)
+        {
+            static const float kColorMask[4] = { 1, 1, 1, 0 };
+            __m128 pixels[kBlockPixels];
+            loadBlock(pBlock, kColorMask, pixels);
+
+            float e0[4], e1[4];
+            findEndpoints(pixels, e0, e1);
+            uint16_t c0 = packColor565(e1);
+            uint16_t c1 = packColor565(e0);
+
+            // The 4-color mode requires c0 > c1. If the endpoints are equal all of the indices are 0, which selects c0 in both modes
+            if(c0 < c1)
+            {
+                std::swap(c0, c1);
+            }
+
+            uint32_t indices = 0;
+            if(c0 != c1)
+            {
+                __m128 palette[4];
+                palette[0] = unpackColor565(c0);
+                palette[1] = unpackColor565(c1);
+                palette[2] = _mm_mul_ps(_mm_add_ps(_mm_add_ps(palette[0], palette[0]), palette[1]), _mm_set1_ps(1.0f / 3.0f));
+                palette[3] = _mm_mul_ps(_mm_add_ps(_mm_add_ps(palette[1], palette[1]), palette[0]), _mm_set1_ps(1.0f / 3.0f));
+
+                for(uint32_t i = 0; i < kBlockPixels; i++)
+                {
+                    indices |= findClosestEntry(pixels[i], palette, 4) << (i * 2);
+                }
+            }
+
+            write16(pDst, c0);
+            write16(pDst + 2, c1);
+            write16(pDst + 4, (uint16_t)(indices & 0xFFFF));
+            write16(pDst + 6, (uint16_t)(indices >> 16));
+        }
+
+        void encodeBC4(const uint8_t* pBlock, uint32_t channel, uint8_t* pDst)
+        {
+            uint8_t minValue = 255;
+            uint8_t maxValue = 0;
+            for(uint32_t i = 0; i < kBlockPixels; i++)
+            {
+                uint8_t v = pBlock[i * 4 + channel];
+                minValue = std::min(minValue, v);
+                maxValue = std::max(maxValue, v);
+            }
+
+            // a0 > a1 selects the 8-value mode. If they are equal all of the indices are 0, which selects a0 in both modes
+            uint8_t a0 = maxValue;
+            uint8_t a1 = minValue;
+            uint64_t indices = 0;
+            if(a0 != a1)
+            {
+                float palette[8];
+                palette[0] = a0;
+                palette[1] = a1;
+                for(uint32_t i = 1; i < 7; i++)
+                {
+                    palette[i + 1] = ((7 - i) * a0 + i * a1) / 7.0f;
+                }
+
+                for(uint32_t i = 0; i < kBlockPixels; i++)
+                {
+                    float v = pBlock[i * 4 + channel];
+                    uint32_t best = 0;
+                    float bestDistance = std::abs(v - palette[0]);
+                    for(uint32_t j = 1; j < 8; j++)
+                    {
+                        float d = std::abs(v - palette[j]);
+                        if(d < bestDistance)
+                        {
+                            bestDistance = d;
+                            best = j;
+                        }
+                    }
+                    indices |= uint64_t(best) << (i * 3);
+                }
+            }
+
+            pDst[0] = a0;
+            pDst[1] = a1;
+            for(uint32_t i = 0; i < 6; i++)
+            {
+                pDst[2 + i] = (uint8_t)((indices >> (i * 8)) & 0xFF);
+            }
+        }
+
+        void encodeBC3(const uint8_t* pBlock, uint8_t* pDst)
+        {
+            encodeBC4(pBlock, 3, pDst);
+            encodeBC1(pBlock, pDst + 8);
+        }
+
+        void encodeBC5(const uint8_t* pBlock, uint8_t* pDst)
+        {
+            encodeBC4(pBlock, 0, pDst);
+            encodeBC4(pBlock, 1, pDst + 8);
+        }
+
+        // Writes a BC7 block, least significant bit first
+        class BitWriter
+        {
+        public:
+            void write(uint32_t value, uint32_t bitCount)
+            {
+                for(uint32_t i = 0; i < bitCount; i++)
+                {
+                    if(value & (1 << i))
+                    {
+                        mBits[mPosition / 64] |= uint64_t(1) << (mPosition % 64);
+                    }
+                    mPosition++;
+                }
+            }
+
+            void store(uint8_t* pDst) const
+            {
+                for(uint32_t i = 0; i < 16; i++)
+                {
+                    pDst[i] = (uint8_t)((mBits[i / 8] >> ((i % 8) * 8)) & 0xFF);
+                }
+            }
+
+        private:
+            uint64_t mBits[2] = { 0, 0 };
+            uint32_t mPosition = 0;
+        };
+
+        // Quantize an endpoint to 7 bits per channel plus a shared P-bit, picking the P-bit with the smaller error
+        static void quantizeEndpointMode6(const float endpoint[4], uint32_t quantized[4], uint32_t& pBit)
+        {
+            float bestError = FLT_MAX;
+            for(uint32_t p = 0; p < 2; p++)
+            {
+                uint32_t q[4];
+                float error = 0;
+                for(uint32_t c = 0; c < 4; c++)
+                {
+                    float v = (endpoint[c] - p) / 2.0f;
+                    q[c] = (uint32_t)glm::clamp(v + 0.5f, 0.0f, 127.0f);
+                    float d = float((q[c] << 1) | p) - endpoint[c];
+                    error += d * d;
+                }
+
+                if(error < bestError)
+                {
+                    bestError = error;
+                    pBit = p;
+                    for(uint32_t c = 0; c < 4; c++)
+                    {
+                        quantized[c] = q[c];
+                    }
+                }
+            }
+        }
+
+        void encodeBC7(const uint8_t* pBlock, uint8_t* pDst)
+        {
+            static const float kRgbaMask[4] = { 1, 1, 1, 1 };
+            static const uint32_t kWeights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+            __m128 pixels[kBlockPixels];
+            loadBlock(pBlock, kRgbaMask, pixels);
+
+            float e[2][4];
+            findEndpoints(pixels, e[0], e[1]);
+
+            uint32_t q[2][4];
+            uint32_t p[2];
+            quantizeEndpointMode6(e[0], q[0], p[0]);
+            quantizeEndpointMode6(e[1], q[1], p[1]);
+
+            // Build the palette the decoder will reconstruct
+            uint32_t endpoints[2][4];
+            for(uint32_t i = 0; i < 2; i++)
+            {
+                for(uint32_t c = 0; c < 4; c++)
+                {
+                    endpoints[i][c] = (q[i][c] << 1) | p[i];
+                }
+            }
+
+            __m128 palette[16];
+            for(uint32_t w = 0; w < 16; w++)
+            {
+                float entry[4];
+                for(uint32_t c = 0; c < 4; c++)
+                {
+                    entry[c] = float(((64 - kWeights[w]) * endpoints[0][c] + kWeights[w] * endpoints[1][c] + 32) >> 6);
+                }
+                palette[w] = _mm_loadu_ps(entry);
+            }
+
+            uint32_t indices[kBlockPixels];
+            for(uint32_t i = 0; i < kBlockPixels; i++)
+            {
+                indices[i] = findClosestEntry(pixels[i], palette, 16);
+            }
+
+            // The most significant bit of the first index is implicitly 0. Swap the endpoints if needed.
+            if(indices[0] & 0x8)
+            {
+                for(uint32_t c = 0; c < 4; c++)
+                {
+                    std::swap(q[0][c], q[1][c]);
+                }
+                std::swap(p[0], p[1]);
+                for(uint32_t i = 0; i < kBlockPixels; i++)
+                {
+                    indices[i] = 15 - indices[i];
+                }
+            }
+
+            BitWriter writer;
+            writer.write(1 << 6, 7);    // Mode 6
+            for(uint32_t c = 0; c < 4; c++)
+            {
+                writer.write(q[0][c], 7);
+                writer.write(q[1][c], 7);
+            }
+            writer.write(p[0], 1);
+            writer.write(p[1], 1);
+            writer.write(indices[0], 3);
+            for(uint32_t i = 1; i < kBlockPixels; i++)
+            {
+                writer.write(indices[i], 4);
+            }
+            writer.store(pDst);
+        }
+
+        using EncodeFunc = void(*)(const uint8_t*, uint8_t*);
+
+        static EncodeFunc getEncodeFunc(ResourceFormat format)
+        {
+            switch(format)
+            {
+            case ResourceFormat::BC1Unorm:
+            case ResourceFormat::BC1UnormSrgb:
+                return encodeBC1;
+            case ResourceFormat::BC3Unorm:
+            case ResourceFormat::BC3UnormSrgb:
+                return encodeBC3;
+            case ResourceFormat::BC5Unorm:
+                return encodeBC5;
+            case ResourceFormat::BC7Unorm:
+            case ResourceFormat::BC7UnormSrgb:
+                return encodeBC7;
+            default:
+                return nullptr;
+            }
+        }
+
+        size_t getCompressedSize(ResourceFormat format, uint32_t width, uint32_t height)
+        {
+            size_t blockCount = size_t((width + 3) / 4) * ((height + 3) / 4);
+            return blockCount * getFormatBytesPerBlock(format);
+        }
+
+        bool compressImage(ResourceFormat format, const uint8_t* pSrc, uint32_t width, uint32_t height, uint8_t* pDst)
+        {
+            EncodeFunc encode = getEncodeFunc(format);
+            if(encode == nullptr)
+            {
+                logError("BlockCompression::compressImage() - unsupported format " + to_string(format));
+                return false;
+            }
+
+            const uint32_t blocksX = (width + 3) / 4;
+            const uint32_t blocksY = (height + 3) / 4;
+            const uint32_t blockSize = getFormatBytesPerBlock(format);
+
+            ThreadPool::getGlobalPool().parallelFor(blocksY, [=](uint32_t by)
+            {
+                uint8_t block[kBlockPixels * 4];
+                for(uint32_t bx = 0; bx < blocksX; bx++)
+                {
+                    for(uint32_t y = 0; y < 4; y++)
+                    {
+                        uint32_t srcY = std::min(by * 4 + y, height - 1);
+                        for(uint32_t x = 0; x < 4; x++)
+                        {
+                            uint32_t srcX = std::min(bx * 4 + x, width - 1);
+                            memcpy(block + (y * 4 + x) * 4, pSrc + (srcY * width + srcX) * 4, 4);
+                        }
+                    }
+                    encode(block, pDst + (size_t(by) * blocksX + bx) * blockSize);
+                }
+            });
+            return true;
+        }
+    }
+}
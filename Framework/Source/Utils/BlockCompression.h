@@ -0,0 +1,74 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "API/Formats.h"
+
+namespace Falcor
+{
+    /** CPU encoders for the BC texture formats.
+        Source blocks are 4x4 pixels, stored row-major with 4 bytes per pixel in RGBA order. The encoders don't convert between color spaces, so sRGB data should be passed as-is for the sRGB formats.
+    */
+    namespace BlockCompression
+    {
+        /** Encode an opaque color block into 8 bytes of BC1
+        */
+        void encodeBC1(const uint8_t* pBlock, uint8_t* pDst);
+
+        /** Encode a color and alpha block into 16 bytes of BC3
+        */
+        void encodeBC3(const uint8_t* pBlock, uint8_t* pDst);
+
+        /** Encode a single channel of the block into 8 bytes of BC4
+            \param[in] channel The index of the channel to encode (0 for red, 3 for alpha)
+        */
+        void encodeBC4(const uint8_t* pBlock, uint32_t channel, uint8_t* pDst);
+
+        /** Encode the red and green channels into 16 bytes of BC5
+        */
+        void encodeBC5(const uint8_t* pBlock, uint8_t* pDst);
+
+        /** Encode a color and alpha block into 16 bytes of BC7. Only mode 6 (single subset, 4-bit indices, RGBA endpoints with unique P-bits) is used.
+        */
+        void encodeBC7(const uint8_t* pBlock, uint8_t* pDst);
+
+        /** Compress an RGBA8 image. Rows of blocks are encoded in parallel on the global thread pool.
+            The image size doesn't have to be a multiple of 4. Blocks which cross the edge of the image replicate the last row and column.
+            \param[in] format One of the BC1, BC3, BC5 or BC7 formats
+            \param[in] pSrc The image data, tightly packed
+            \param[in] width The width of the image
+            \param[in] height The height of the image
+            \param[out] pDst The destination buffer. Must be large enough to hold getCompressedSize() bytes
+            \return false if the format is not supported, otherwise true
+        */
+        bool compressImage(ResourceFormat format, const uint8_t* pSrc, uint32_t width, uint32_t height, uint8_t* pDst);
+
+        /** Get the number of bytes compressImage() writes for an image
+        */
+        size_t getCompressedSize(ResourceFormat format, uint32_t width, uint32_t height);
+    }
+}
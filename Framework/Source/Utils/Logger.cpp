@@ -28,6 +28,11 @@
 #include "Framework.h"
 #include "Logger.h"
 #include "Utils/OS.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 namespace Falcor
 {
@@ -38,10 +43,55 @@ namespace Falcor
 #endif
 
     bool Logger::sInit = false;
-    FILE* Logger::sLogFile = nullptr;
     Logger::Level Logger::sVerbosity = Logger::Level::Warning;
+    Logger::Format Logger::sFormat = Logger::Format::Text;
 
-    static FILE* openLogFile()
+    static const uint64_t kQueueSize = 1024;        // Has to be a power of 2
+    static const uint32_t kInlineTextSize = 220;    // Longer messages are stored in a heap allocated string
+    static const auto kWriterInterval = std::chrono::milliseconds(5);
+
+    /** A message slot in the queue. The sequence number tells whether the slot is owned by a producer or by the writer thread.
+    */
+    struct LogSlot
+    {
+        std::atomic<uint64_t> sequence;
+        Logger::Level level;
+        uint32_t threadIndex;
+        uint64_t timestamp;
+        uint32_t length;
+        char text[kInlineTextSize];
+        std::string longText;
+
+        const char* getText() const { return (length <= kInlineTextSize) ? text : longText.c_str(); }
+    };
+
+    /** Bounded multi-producer/single-consumer queue, based on Dmitry Vyukov's bounded MPMC queue. Producers claim a ticket with a CAS and never wait for each other.
+        The writer thread drains the queue into the log file.
+    */
+    struct LogQueue
+    {
+        LogSlot slots[kQueueSize];
+        std::atomic<uint64_t> enqueuePos;
+        std::atomic<uint64_t> writtenCount;     // All messages with a lower ticket were written to the file
+        uint64_t dequeuePos = 0;
+
+        FILE* pFile = nullptr;
+        Logger::Format format;
+        std::chrono::steady_clock::time_point startTime;
+
+        std::thread writerThread;
+        std::mutex wakeMutex;
+        std::condition_variable wakeWriter;
+        std::atomic<bool> terminate;
+    };
+
+    // Allocated in init() and released in shutdown(). It's intentionally a pointer, so that an application which exits without calling shutdown() won't destroy a running thread.
+    static std::atomic<LogQueue*> spQueue(nullptr);
+    static std::atomic<uint32_t> sQueueUsers(0);
+    static std::atomic<uint32_t> sThreadCount(0);
+    static thread_local uint32_t tThreadIndex = sThreadCount++;
+
+    static FILE* openLogFile(Logger::Format format)
     {
         FILE* pFile = nullptr;
 
@@ -52,9 +102,10 @@ namespace Falcor
         std::string prefix = std::string(filename);
         std::string executableDir = getExecutableDirectory();
         std::string logFile;
-        if(findAvailableFilename(prefix, executableDir, "log", logFile))
+        bool binary = (format == Logger::Format::Binary);
+        if(findAvailableFilename(prefix, executableDir, binary ? "binlog" : "log", logFile))
         {
-            if(fopen_s(&pFile, logFile.c_str(), "w") == 0)
+            if(fopen_s(&pFile, logFile.c_str(), binary ? "wb" : "w") == 0)
             {
                 // Success
                 return pFile;
@@ -65,14 +116,161 @@ namespace Falcor
         return pFile;
     }
 
+    const char* getLogLevelString(Logger::Level L)
+    {
+        const char* c = nullptr;
+#define create_level_case(_l) case _l: c = "(" #_l ")" ;break;
+        switch(L)
+        {
+            create_level_case(Logger::Level::Info);
+            create_level_case(Logger::Level::Warning);
+            create_level_case(Logger::Level::Error);
+        default:
+            should_not_get_here();
+        }
+#undef create_level_case
+        return c;
+    }
+
+    static void writeMessage(LogQueue* pQueue, const LogSlot& slot, bool debuggerPresent)
+    {
+        const char* text = slot.getText();
+        if(pQueue->format == Logger::Format::Binary)
+        {
+            Logger::BinaryRecord record = {};
+            record.timestamp = slot.timestamp;
+            record.threadIndex = slot.threadIndex;
+            record.level = (uint32_t)slot.level;
+            record.length = slot.length;
+            fwrite(&record, sizeof(record), 1, pQueue->pFile);
+            fwrite(text, 1, slot.length, pQueue->pFile);
+        }
+        else
+        {
+            fprintf_s(pQueue->pFile, "%s\t%.*s\n", getLogLevelString(slot.level), (int)slot.length, text);
+        }
+
+        if(debuggerPresent)
+        {
+            printToDebugWindow(getLogLevelString(slot.level) + std::string("\t") + std::string(text, slot.length) + "\n");
+        }
+    }
+
+    /** Write all the messages which are ready. Returns false if the queue was empty.
+    */
+    static bool drainQueue(LogQueue* pQueue)
+    {
+        bool debuggerPresent = isDebuggerPresent();
+        bool wroteMessages = false;
+        while(true)
+        {
+            LogSlot& slot = pQueue->slots[pQueue->dequeuePos & (kQueueSize - 1)];
+            if(slot.sequence.load(std::memory_order_acquire) != pQueue->dequeuePos + 1)
+            {
+                break;
+            }
+
+            writeMessage(pQueue, slot, debuggerPresent);
+            if(slot.longText.empty() == false)
+            {
+                std::string().swap(slot.longText);
+            }
+
+            // Hand the slot back to the producers
+            slot.sequence.store(pQueue->dequeuePos + kQueueSize, std::memory_order_release);
+            pQueue->dequeuePos++;
+            wroteMessages = true;
+        }
+
+        if(wroteMessages)
+        {
+            // A single flush per batch instead of one per message. Errors wait for this point, so they will be in the file in case of a crash.
+            fflush(pQueue->pFile);
+            pQueue->writtenCount.store(pQueue->dequeuePos, std::memory_order_release);
+        }
+        return wroteMessages;
+    }
+
+    static void writerThread(LogQueue* pQueue)
+    {
+        while(true)
+        {
+            if(drainQueue(pQueue) == false)
+            {
+                if(pQueue->terminate.load())
+                {
+                    // Producers which claimed a ticket before shutdown() may still be copying their message
+                    if(pQueue->dequeuePos == pQueue->enqueuePos.load())
+                    {
+                        break;
+                    }
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(pQueue->wakeMutex);
+                pQueue->wakeWriter.wait_for(lock, kWriterInterval);
+            }
+        }
+    }
+
+    /** Gives a thread access to the queue. shutdown() clears spQueue and then waits for all of the users to leave before it releases the queue.
+        The user count is incremented before the pointer is read, so either the user sees a null queue or shutdown() sees the user.
+    */
+    class QueueRef
+    {
+    public:
+        QueueRef() { sQueueUsers++; mpQueue = spQueue.load(); }
+        ~QueueRef() { sQueueUsers--; }
+        LogQueue* get() const { return mpQueue; }
+    private:
+        LogQueue* mpQueue;
+    };
+
+    /** Wait until the writer thread wrote the message with the ticket
+    */
+    static void waitForWriter(LogQueue* pQueue, uint64_t ticket)
+    {
+        while(pQueue->writtenCount.load(std::memory_order_acquire) <= ticket)
+        {
+            pQueue->wakeWriter.notify_one();
+            std::this_thread::yield();
+        }
+    }
+
     void Logger::init()
     {
 #if _LOG_ENABLED
         if(sInit == false)
         {
-            sLogFile = openLogFile();
-            sInit = sLogFile != nullptr;
+            FILE* pFile = openLogFile(sFormat);
+            sInit = pFile != nullptr;
             assert(sInit);
+            if(sInit == false)
+            {
+                return;
+            }
+
+            LogQueue* pQueue = new LogQueue;
+            for(uint64_t i = 0; i < kQueueSize; i++)
+            {
+                pQueue->slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            pQueue->enqueuePos.store(0);
+            pQueue->writtenCount.store(0);
+            pQueue->terminate.store(false);
+            pQueue->pFile = pFile;
+            pQueue->format = sFormat;
+            pQueue->startTime = std::chrono::steady_clock::now();
+
+            if(sFormat == Format::Binary)
+            {
+                uint32_t header[2] = { kBinaryFileMagic, kBinaryFileVersion };
+                fwrite(header, sizeof(header), 1, pFile);
+            }
+
+            pQueue->writerThread = std::thread(writerThread, pQueue);
+            spQueue.store(pQueue);
         }
 #endif
     }
@@ -80,46 +278,103 @@ namespace Falcor
     void Logger::shutdown()
     {
 #if _LOG_ENABLED
-        if(sLogFile)
+        LogQueue* pQueue = spQueue.exchange(nullptr);
+        if(pQueue)
         {
-            fclose(sLogFile);
-            sLogFile = nullptr;
             sInit = false;
+
+            // Threads which got the queue before it was cleared may still be writing a message. The writer keeps draining the queue until they are done.
+            while(sQueueUsers.load() != 0)
+            {
+                pQueue->wakeWriter.notify_one();
+                std::this_thread::yield();
+            }
+
+            pQueue->terminate.store(true);
+            pQueue->wakeWriter.notify_one();
+            pQueue->writerThread.join();
+
+            fclose(pQueue->pFile);
+            delete pQueue;
         }
 #endif
     }
 
-    const char* getLogLevelString(Logger::Level L)
+    void Logger::flush()
     {
-        const char* c = nullptr;
-#define create_level_case(_l) case _l: c = "(" #_l ")" ;break;
-        switch(L)
+#if _LOG_ENABLED
+        QueueRef queue;
+        LogQueue* pQueue = queue.get();
+        if(pQueue)
         {
-            create_level_case(Logger::Level::Info);
-            create_level_case(Logger::Level::Warning);
-            create_level_case(Logger::Level::Error);
-        default:
-            should_not_get_here();
+            uint64_t pos = pQueue->enqueuePos.load();
+            if(pos > 0)
+            {
+                waitForWriter(pQueue, pos - 1);
+            }
         }
-#undef create_level_case
-        return c;
+#endif
     }
 
-    void Logger::log(Level L, const std::string& msg, const bool forceMsgBox /* = false*/)
+    static void enqueueMessage(LogQueue* pQueue, Logger::Level L, const std::string& msg)
     {
-#if _LOG_ENABLED
-        if(sInit)
+        // Claim a slot
+        uint64_t pos = pQueue->enqueuePos.load(std::memory_order_relaxed);
+        LogSlot* pSlot;
+        while(true)
         {
-            if(L >= sVerbosity)
+            pSlot = &pQueue->slots[pos & (kQueueSize - 1)];
+            int64_t diff = (int64_t)(pSlot->sequence.load(std::memory_order_acquire) - pos);
+            if(diff == 0)
             {
-                std::string s = getLogLevelString(L) + std::string("\t") + msg + "\n";
-                fprintf_s(sLogFile, "%s", s.c_str());
-                fflush(sLogFile);   // Slows down execution, but ensures that the message will be printed in case of a crash
-                if (isDebuggerPresent())
+                if(pQueue->enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
                 {
-                    printToDebugWindow(s);
+                    break;
                 }
             }
+            else if(diff < 0)
+            {
+                // The queue is full. Messages are never dropped, wait for the writer to catch up.
+                pQueue->wakeWriter.notify_one();
+                std::this_thread::yield();
+                pos = pQueue->enqueuePos.load(std::memory_order_relaxed);
+            }
+            else
+            {
+                pos = pQueue->enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        pSlot->level = L;
+        pSlot->threadIndex = tThreadIndex;
+        pSlot->timestamp = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - pQueue->startTime).count();
+        pSlot->length = (uint32_t)msg.size();
+        if(msg.size() <= kInlineTextSize)
+        {
+            memcpy(pSlot->text, msg.data(), msg.size());
+        }
+        else
+        {
+            pSlot->longText = msg;
+        }
+        pSlot->sequence.store(pos + 1, std::memory_order_release);
+
+        if(L >= Logger::Level::Error)
+        {
+            waitForWriter(pQueue, pos);
+        }
+    }
+
+    void Logger::log(Level L, const std::string& msg, const bool forceMsgBox /* = false*/)
+    {
+#if _LOG_ENABLED
+        if(isLevelEnabled(L))
+        {
+            QueueRef queue;
+            if(queue.get())
+            {
+                enqueueMessage(queue.get(), L, msg);
+            }
         }
 #endif
 
@@ -136,4 +391,4 @@ namespace Falcor
             }
         }
     }
-}
\ No newline at end of file
+}
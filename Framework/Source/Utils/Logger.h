@@ -32,8 +32,10 @@
 namespace Falcor
 {
     /** Container class for logging messages. 
-    *   To enable log messages, make sure _LOG_ENABLED is set to true in FalcorConfig.h.
+    *   To enable log messages, make sure _LOG_ENABLED is set to true in FalcorConfig.h. Messages below _LOG_MIN_LEVEL are compiled out.
     *   Messages are printed to a log file in the application directory. Using Logger#ShowBoxOnError() you can control if a message box will be shown as well.
+    *   Logging is thread-safe. The calling thread only copies the message into a lock-free queue, a background thread writes it to the file.
+    *   Errors are written before the call returns, so that they are in the file in case the application crashes.
     */
     class Logger
     {
@@ -49,12 +51,41 @@ namespace Falcor
             Disabled = -1
         };
 
-        /** Initialize the logger. Has to be called once before logging is possible. This function will create the log file.
+        /** Log file format
+        */
+        enum class Format
+        {
+            Text,               ///< Human readable text, one message per line
+            Binary,             ///< A file header followed by a BinaryRecord and the message text for every message
+        };
+
+        /** Header of each message in a binary log file. The header is followed by 'length' characters of text.
+            The record is 24 bytes. The reserved field makes the padding explicit, so that no uninitialized bytes are written to the file.
+        */
+        struct BinaryRecord
+        {
+            uint64_t timestamp;     ///< Nanoseconds since Logger::init()
+            uint32_t threadIndex;   ///< Sequential index of the thread which logged the message
+            uint32_t level;         ///< Logger::Level
+            uint32_t length;        ///< Length of the message text
+            uint32_t reserved = 0;  ///< Always 0
+        };
+        static_assert(sizeof(BinaryRecord) == 24, "Logger::BinaryRecord is part of the binary log file format");
+        static const uint32_t kBinaryFileMagic = 0x474F4C46;   // 'FLOG'
+        static const uint32_t kBinaryFileVersion = 1;
+
+        /** Initialize the logger. Has to be called once before logging is possible. This function will create the log file and start the writer thread.
         */
         static void init();
-        /** Shutdown the logger and close the log file.
+        /** Shutdown the logger. Writes all pending messages and closes the log file.
         */
         static void shutdown();
+        /** Block until all the messages logged so far are written to the file
+        */
+        static void flush();
+        /** Set the log file format. Has to be called before init().
+        */
+        static void setFormat(Format format) { sFormat = format; }
         /** Controls weather or not to show message box on log messages.
             \param[in] showBox true to show a message box, false to disable it.
         */
@@ -69,6 +100,10 @@ namespace Falcor
         */
         static constexpr bool enabled() { return _LOG_ENABLED != 0; }
 
+        /** Check if messages of a specific level will be written to the log. The check is done inline, so filtered messages don't cost more than a compare.
+        */
+        static bool isLevelEnabled(Level L) { return enabled() && ((int32_t)L >= _LOG_MIN_LEVEL) && (L >= sVerbosity); }
+
         /** Set the logger verbosity
         */
         static void setVerbosity(Level level) { sVerbosity = level; }
@@ -82,13 +117,13 @@ namespace Falcor
 
         Logger() = delete;
         static bool sShowErrorBox;
-        static FILE* sLogFile;
         static bool sInit;
         static Level sVerbosity;
+        static Format sFormat;
     };
 
-    inline void logInfo(const std::string& msg, const bool forceMsgBox = false) { Logger::log(Logger::Level::Info, msg, forceMsgBox); }
-    inline void logWarning(const std::string& msg, const bool forceMsgBox = false) { Logger::log(Logger::Level::Warning, msg, forceMsgBox); }
+    inline void logInfo(const std::string& msg, const bool forceMsgBox = false) { if(Logger::isLevelEnabled(Logger::Level::Info)) Logger::log(Logger::Level::Info, msg, forceMsgBox); }
+    inline void logWarning(const std::string& msg, const bool forceMsgBox = false) { if(Logger::isLevelEnabled(Logger::Level::Warning)) Logger::log(Logger::Level::Warning, msg, forceMsgBox); }
     inline void logError(const std::string& msg, const bool forceMsgBox = false) { Logger::log(Logger::Level::Error, msg, forceMsgBox); }
-    inline void logErrorAndExit(const std::string& msg, const bool forceMsgBox = false) { Logger::log(Logger::Level::Error, msg + "\nTerminating...", forceMsgBox); exit(1); }
+    inline void logErrorAndExit(const std::string& msg, const bool forceMsgBox = false) { Logger::log(Logger::Level::Error, msg + "\nTerminating...", forceMsgBox); Logger::shutdown(); exit(1); }
 }
@@ -0,0 +1,335 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "BoundingVolumeHierarchy.h"
+#include <algorithm>
+#include <cfloat>
+
+namespace Falcor
+{
+    static const uint32_t kMaxLeafSize = 4;
+    static const uint32_t kBinCount = 16;
+
+    // Deeper than this, nodes are split at the median, which bounds the depth of the tree and the traversal stacks
+    static const uint32_t kMaxSahDepth = 40;
+    static const uint32_t kStackSize = 128;
+
+    // Relative cost of traversing a node, compared to testing a primitive
+    static const float kTraversalCost = 1.0f;
+
+    static float getSurfaceArea(const glm::vec3& minPos, const glm::vec3& maxPos)
+    {
+        glm::vec3 size = glm::max(maxPos - minPos, glm::vec3(0));
+        return 2 * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    struct Bin
+    {
+        glm::vec3 minPos = glm::vec3(FLT_MAX);
+        glm::vec3 maxPos = glm::vec3(-FLT_MAX);
+        uint32_t count = 0;
+
+        void grow(const glm::vec3& boxMin, const glm::vec3& boxMax)
+        {
+            minPos = glm::min(minPos, boxMin);
+            maxPos = glm::max(maxPos, boxMax);
+        }
+
+        void grow(const Bin& other)
+        {
+            minPos = glm::min(minPos, other.minPos);
+            maxPos = glm::max(maxPos, other.maxPos);
+            count += other.count;
+        }
+    };
+
+    void BoundingVolumeHierarchy::build(const BoundingBoxArray& boxes)
+    {
+        const uint32_t count = boxes.size();
+        mNodes.clear();
+        mPrimitives.resize(count);
+        mCentroids.resize(count);
+        for(uint32_t i = 0; i < count; i++)
+        {
+            mPrimitives[i] = i;
+            mCentroids[i] = glm::vec3(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+        }
+
+        if(count > 0)
+        {
+            mNodes.reserve(2 * count / kMaxLeafSize + 1);
+            mNodes.emplace_back();
+            buildNode(boxes, 0, 0, count, 0);
+        }
+
+        mCentroids.clear();
+        mCentroids.shrink_to_fit();
+    }
+
+    void BoundingVolumeHierarchy::buildNode(const BoundingBoxArray& boxes, uint32_t nodeIndex, uint32_t begin, uint32_t end, uint32_t depth)
+    {
+        // Node bounds, and bounds of the centroids to choose split planes
+        Bin bounds;
+        glm::vec3 centroidMin(FLT_MAX);
+        glm::vec3 centroidMax(-FLT_MAX);
+        for(uint32_t i = begin; i < end; i++)
+        {
+            const BoundingBox box = boxes.get(mPrimitives[i]);
+            bounds.grow(box.getMinPos(), box.getMaxPos());
+            centroidMin = glm::min(centroidMin, mCentroids[mPrimitives[i]]);
+            centroidMax = glm::max(centroidMax, mCentroids[mPrimitives[i]]);
+        }
+        mNodes[nodeIndex].minPos = bounds.minPos;
+        mNodes[nodeIndex].maxPos = bounds.maxPos;
+
+        const uint32_t count = end - begin;
+        const glm::vec3 centroidExtent = centroidMax - centroidMin;
+        const float leafCost = (float)count;
+        if(count <= kMaxLeafSize || (centroidExtent.x <= 0 && centroidExtent.y <= 0 && centroidExtent.z <= 0))
+        {
+            mNodes[nodeIndex].first = begin;
+            mNodes[nodeIndex].primitiveCount = count;
+            return;
+        }
+
+        // Binned SAH. Try splitting between every pair of bins on every axis.
+        float bestCost = FLT_MAX;
+        uint32_t bestAxis = 0;
+        uint32_t bestSplit = 0;
+        const float parentArea = getSurfaceArea(bounds.minPos, bounds.maxPos);
+        for(uint32_t axis = 0; axis < 3 && depth < kMaxSahDepth; axis++)
+        {
+            if(centroidExtent[axis] <= 0)
+            {
+                continue;
+            }
+
+            Bin bins[kBinCount];
+            const float binScale = kBinCount / centroidExtent[axis];
+            for(uint32_t i = begin; i < end; i++)
+            {
+                const uint32_t primitive = mPrimitives[i];
+                uint32_t binIndex = std::min(kBinCount - 1, (uint32_t)((mCentroids[primitive][axis] - centroidMin[axis]) * binScale));
+                const BoundingBox box = boxes.get(primitive);
+                bins[binIndex].grow(box.getMinPos(), box.getMaxPos());
+                bins[binIndex].count++;
+            }
+
+            // Sweep from the right to get the cost of every right side, then from the left
+            float rightCost[kBinCount];
+            Bin right;
+            for(uint32_t split = kBinCount - 1; split > 0; split--)
+            {
+                right.grow(bins[split]);
+                rightCost[split] = right.count ? right.count * getSurfaceArea(right.minPos, right.maxPos) : 0;
+            }
+
+            Bin left;
+            for(uint32_t split = 1; split < kBinCount; split++)
+            {
+                left.grow(bins[split - 1]);
+                if(left.count == 0 || left.count == count)
+                {
+                    continue;
+                }
+                const float cost = kTraversalCost + (left.count * getSurfaceArea(left.minPos, left.maxPos) + rightCost[split]) / parentArea;
+                if(cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = split;
+                }
+            }
+        }
+
+        uint32_t middle = begin;
+        if(bestCost < leafCost || count > 4 * kMaxLeafSize || depth >= kMaxSahDepth)
+        {
+            if(bestSplit != 0)
+            {
+                const float binScale = kBinCount / centroidExtent[bestAxis];
+                const float axisMin = centroidMin[bestAxis];
+                middle = (uint32_t)(std::partition(mPrimitives.begin() + begin, mPrimitives.begin() + end, [&](uint32_t primitive)
+                {
+                    uint32_t binIndex = std::min(kBinCount - 1, (uint32_t)((mCentroids[primitive][bestAxis] - axisMin) * binScale));
+                    return binIndex < bestSplit;
+                }) - mPrimitives.begin());
+            }
+
+            // If the bins couldn't separate the primitives, split at the median of the longest axis
+            if(middle == begin || middle == end)
+            {
+                uint32_t axis = (centroidExtent.x > centroidExtent.y) ? ((centroidExtent.x > centroidExtent.z) ? 0 : 2) : ((centroidExtent.y > centroidExtent.z) ? 1 : 2);
+                middle = begin + count / 2;
+                std::nth_element(mPrimitives.begin() + begin, mPrimitives.begin() + middle, mPrimitives.begin() + end, [&](uint32_t a, uint32_t b)
+                {
+                    return mCentroids[a][axis] < mCentroids[b][axis];
+                });
+            }
+        }
+
+        if(middle == begin || middle == end)
+        {
+            mNodes[nodeIndex].first = begin;
+            mNodes[nodeIndex].primitiveCount = count;
+            return;
+        }
+
+        // Children are allocated next to each other, and always after their parent. refit() relies on that.
+        const uint32_t leftChild = (uint32_t)mNodes.size();
+        mNodes.emplace_back();
+        mNodes.emplace_back();
+        mNodes[nodeIndex].first = leftChild;
+        mNodes[nodeIndex].primitiveCount = 0;
+
+        buildNode(boxes, leftChild, begin, middle, depth + 1);
+        buildNode(boxes, leftChild + 1, middle, end, depth + 1);
+    }
+
+    void BoundingVolumeHierarchy::refit(const BoundingBoxArray& boxes)
+    {
+        assert(boxes.size() == mPrimitives.size());
+
+        // Children come after their parents, so walking backwards updates the children first
+        for(size_t i = mNodes.size(); i-- > 0;)
+        {
+            Node& node = mNodes[i];
+            if(node.primitiveCount)
+            {
+                Bin bounds;
+                for(uint32_t p = node.first; p < node.first + node.primitiveCount; p++)
+                {
+                    const BoundingBox box = boxes.get(mPrimitives[p]);
+                    bounds.grow(box.getMinPos(), box.getMaxPos());
+                }
+                node.minPos = bounds.minPos;
+                node.maxPos = bounds.maxPos;
+            }
+            else
+            {
+                const Node& left = mNodes[node.first];
+                const Node& right = mNodes[node.first + 1];
+                node.minPos = glm::min(left.minPos, right.minPos);
+                node.maxPos = glm::max(left.maxPos, right.maxPos);
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::collectPrimitives(uint32_t nodeIndex, std::vector<uint32_t>& indices) const
+    {
+        const Node& node = mNodes[nodeIndex];
+        if(node.primitiveCount)
+        {
+            indices.insert(indices.end(), mPrimitives.begin() + node.first, mPrimitives.begin() + node.first + node.primitiveCount);
+        }
+        else
+        {
+            collectPrimitives(node.first, indices);
+            collectPrimitives(node.first + 1, indices);
+        }
+    }
+
+    void BoundingVolumeHierarchy::cull(const BoundingBoxArray& boxes, const CullingFrustum* pFrusta, uint32_t frustumCount, std::vector<uint32_t>& indices) const
+    {
+        assert(frustumCount <= 32);
+        if(mNodes.empty() || frustumCount == 0)
+        {
+            return;
+        }
+
+        // Each stack entry carries the mask of frusta the node may still intersect. Frusta the parent was outside of don't need to be tested again.
+        struct StackEntry
+        {
+            uint32_t node;
+            uint32_t frustumMask;
+        };
+        StackEntry stack[kStackSize];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = { 0, (frustumCount == 32) ? ~0u : ((1u << frustumCount) - 1) };
+
+        while(stackSize)
+        {
+            const StackEntry entry = stack[--stackSize];
+            const Node& node = mNodes[entry.node];
+            const BoundingBox nodeBox = BoundingBox::fromMinMax(node.minPos, node.maxPos);
+
+            uint32_t intersectingMask = 0;
+            bool inside = false;
+            for(uint32_t f = 0; f < frustumCount && (inside == false); f++)
+            {
+                if(entry.frustumMask & (1u << f))
+                {
+                    switch(pFrusta[f].test(nodeBox))
+                    {
+                    case CullingFrustum::Result::Inside:
+                        inside = true;
+                        break;
+                    case CullingFrustum::Result::Intersecting:
+                        intersectingMask |= (1u << f);
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+
+            if(inside)
+            {
+                collectPrimitives(entry.node, indices);
+            }
+            else if(intersectingMask)
+            {
+                if(node.primitiveCount)
+                {
+                    for(uint32_t p = node.first; p < node.first + node.primitiveCount; p++)
+                    {
+                        const BoundingBox box = boxes.get(mPrimitives[p]);
+                        for(uint32_t f = 0; f < frustumCount; f++)
+                        {
+                            if((intersectingMask & (1u << f)) && pFrusta[f].test(box) != CullingFrustum::Result::Outside)
+                            {
+                                indices.push_back(mPrimitives[p]);
+                                break;
+                            }
+                        }
+                    }
+                }
+                else if(stackSize + 2 <= arraysize(stack))
+                {
+                    stack[stackSize++] = { node.first + 1, intersectingMask };
+                    stack[stackSize++] = { node.first, intersectingMask };
+                }
+                else
+                {
+                    // Too deep to traverse. Keep everything below this node, culling is conservative.
+                    collectPrimitives(entry.node, indices);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "Utils/AABB.h"
+
+namespace Falcor
+{
+    /** Bounding volume hierarchy over a set of bounding boxes, used to cull large numbers of objects.
+        Primitives are identified by their index in the BoundingBoxArray the hierarchy was built from.
+    */
+    class BoundingVolumeHierarchy
+    {
+    public:
+        /** Build the hierarchy using the surface area heuristic. Call this when boxes are added or removed.
+        */
+        void build(const BoundingBoxArray& boxes);
+
+        /** Recompute the node bounds after boxes moved, keeping the tree structure. The box count must be the same as in the last build() call.
+            Refitting is much cheaper than building, but the tree gets less efficient as objects move away from their original positions.
+        */
+        void refit(const BoundingBoxArray& boxes);
+
+        /** Find the primitives which are inside or intersect at least one of the frusta. Subtrees which are completely inside a frustum are accepted without testing their primitives.
+            \param[in] boxes The boxes the hierarchy was built from
+            \param[in] pFrusta Array of frusta to test against
+            \param[in] frustumCount Number of frusta. Must be at most 32.
+            \param[out] indices The indices of the visible primitives are appended to this vector, in no particular order
+        */
+        void cull(const BoundingBoxArray& boxes, const CullingFrustum* pFrusta, uint32_t frustumCount, std::vector<uint32_t>& indices) const;
+
+        /** Get the number of primitives the hierarchy was built for
+        */
+        uint32_t getPrimitiveCount() const { return (uint32_t)mPrimitives.size(); }
+
+    private:
+        struct Node
+        {
+            glm::vec3 minPos;
+            glm::vec3 maxPos;
+            uint32_t first = 0;             ///< For leaves, the first entry in mPrimitives. For internal nodes, the index of the first child. The second child follows it.
+            uint32_t primitiveCount = 0;    ///< 0 for internal nodes
+        };
+
+        void buildNode(const BoundingBoxArray& boxes, uint32_t nodeIndex, uint32_t begin, uint32_t end, uint32_t depth);
+        void collectPrimitives(uint32_t nodeIndex, std::vector<uint32_t>& indices) const;
+
+        std::vector<Node> mNodes;
+        std::vector<uint32_t> mPrimitives;     ///< Primitive indices, sorted so that every leaf references a contiguous range
+        std::vector<glm::vec3> mCentroids;     ///< Scratch data used during build
+    };
+}
@@ -0,0 +1,103 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Utils/MemoryMappedFile.h"
+
+namespace Falcor
+{
+    bool MemoryMappedFile::open(const std::string& filename)
+    {
+        close();
+        mFilename = filename;
+
+        HANDLE hFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(hFile == INVALID_HANDLE_VALUE)
+        {
+            logError("Can't open file '" + filename + "' for memory mapping");
+            return false;
+        }
+        mFileHandle = hFile;
+
+        LARGE_INTEGER fileSize;
+        if(GetFileSizeEx(hFile, &fileSize) == FALSE)
+        {
+            logError("Can't get the size of file '" + filename + "'");
+            close();
+            return false;
+        }
+        mSize = (size_t)fileSize.QuadPart;
+
+        // Windows can't map an empty file. Treat it as an open file with no data.
+        if(mSize == 0)
+        {
+            static const uint8_t kEmpty = 0;
+            mpData = &kEmpty;
+            return true;
+        }
+
+        HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(hMapping == nullptr)
+        {
+            logError("Can't create a file mapping for '" + filename + "'");
+            close();
+            return false;
+        }
+        mMappingHandle = hMapping;
+
+        mpData = (const uint8_t*)MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+        if(mpData == nullptr)
+        {
+            logError("Can't map a view of file '" + filename + "'");
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void MemoryMappedFile::close()
+    {
+        if(mpData && mMappingHandle)
+        {
+            UnmapViewOfFile(mpData);
+        }
+        mpData = nullptr;
+        mSize = 0;
+
+        if(mMappingHandle)
+        {
+            CloseHandle((HANDLE)mMappingHandle);
+            mMappingHandle = nullptr;
+        }
+
+        if(mFileHandle)
+        {
+            CloseHandle((HANDLE)mFileHandle);
+            mFileHandle = nullptr;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+
+namespace Falcor
+{
+    /** Read-only view of a file mapped into the process address space.
+        The OS pages the file in on demand, so large files can be parsed directly from memory without going through a stream.
+    */
+    class MemoryMappedFile
+    {
+    public:
+        MemoryMappedFile() = default;
+        MemoryMappedFile(const std::string& filename)
+        {
+            open(filename);
+        }
+
+        ~MemoryMappedFile()
+        {
+            close();
+        }
+
+        MemoryMappedFile(const MemoryMappedFile&) = delete;
+        MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+        /** Map a file. The function expects a full path to the file, and will not look in the data directories.
+            \param[in] filename The file to map
+            \return true if the file was mapped successfully, otherwise false
+        */
+        bool open(const std::string& filename);
+
+        /** Unmap the file and release the OS handles
+        */
+        void close();
+
+        /** Check if a file is currently mapped
+        */
+        bool isOpen() const { return mpData != nullptr; }
+
+        /** Get a pointer to the start of the mapped view
+        */
+        const uint8_t* getData() const { return mpData; }
+
+        /** Get the size of the mapped file in bytes
+        */
+        size_t getSize() const { return mSize; }
+
+        /** Get the name of the mapped file
+        */
+        const std::string& getFilename() const { return mFilename; }
+
+    private:
+        std::string mFilename;
+        const uint8_t* mpData = nullptr;
+        size_t mSize = 0;
+        void* mFileHandle = nullptr;
+        void* mMappingHandle = nullptr;
+    };
+}
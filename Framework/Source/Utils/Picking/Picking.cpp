@@ -194,6 +194,24 @@ namespace Falcor
         return true;
     }
 
+    void Picking::getCullingFrusta(const Camera* pCamera, std::vector<CullingFrustum>& frusta)
+    {
+        // Only the scissored pixel is rendered, so cull against the part of the view frustum which covers it, padded by a pixel on each side
+        const glm::vec2 fboSize((float)mpFBO->getWidth(), (float)mpFBO->getHeight());
+        const glm::vec2 minNdc = glm::vec2((float)mScissor.left - 1, fboSize.y - (float)mScissor.bottom - 1) / fboSize * 2.0f - 1.0f;
+        const glm::vec2 maxNdc = glm::vec2((float)mScissor.right + 1, fboSize.y - (float)mScissor.top + 1) / fboSize * 2.0f - 1.0f;
+        const glm::vec2 center = (maxNdc + minNdc) * 0.5f;
+        const glm::vec2 halfSize = (maxNdc - minNdc) * 0.5f;
+
+        // Remap the pixel's NDC rectangle to [-1, 1]
+        glm::mat4 pixelMat(1.0f);
+        pixelMat[0][0] = 1.0f / halfSize.x;
+        pixelMat[1][1] = 1.0f / halfSize.y;
+        pixelMat[3][0] = -center.x / halfSize.x;
+        pixelMat[3][1] = -center.y / halfSize.y;
+        frusta.push_back(CullingFrustum::fromViewProjMatrix(pixelMat * pCamera->getViewProjMatrix()));
+    }
+
     void Picking::calculateScissor(const glm::vec2& mousePos)
     {
         glm::vec2 mouseCoords = mousePos * glm::vec2(mpFBO->getWidth(), mpFBO->getHeight());;
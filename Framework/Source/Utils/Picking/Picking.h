@@ -86,6 +86,9 @@ namespace Falcor
         virtual bool setPerModelInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, uint32_t instanceID) override;
         virtual bool setPerMeshInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t drawInstanceID) override;
         virtual bool setPerMaterialData(const CurrentWorkingData& currentData, const Material* pMaterial) override;
+        virtual void getCullingFrusta(const Camera* pCamera, std::vector<CullingFrustum>& frusta) override;
+        virtual bool supportsRenderQueue() const override { return false; }
+        virtual bool supportsParallelInstanceData() const override { return false; }
 
         void calculateScissor(const glm::vec2& mousePos);
 
@@ -32,6 +32,9 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
+#include <deque>
+#include <mutex>
 
 namespace Falcor
 {
@@ -41,6 +44,10 @@ namespace Falcor
     uint32_t Profiler::sCurrentLevel = 0;
     uint32_t Profiler::sGpuTimerIndex = 0;
     std::vector<Profiler::EventData*> Profiler::sProfilerVector;
+    std::map<size_t, size_t> Profiler::sCounterIndices;
+    std::vector<Profiler::CounterData> Profiler::sCounters;
+    static std::mutex sCounterMutex;    // Counters can be updated from any thread
+    std::atomic<bool> Profiler::sTraceEnabled(false);
     
     std::hash<std::string> HashedString::hashFunc;
 
@@ -146,9 +153,275 @@ namespace Falcor
             profileResults += event;
         }
 
+        std::lock_guard<std::mutex> counterLock(sCounterMutex);
+        if(sCounters.size())
+        {
+            profileResults += "\nCounter\t\t\tValue\n";
+            for(auto& counter : sCounters)
+            {
+                char line[1000];
+                // Names longer than the column are followed by a single space
+                int32_t valueIndent = std::max<int32_t>(32 - (1 + (int32_t)counter.name.size()), 0);
+                sprintf_s(line, " %s %*llu\n", counter.name.c_str(), valueIndent, counter.value);
+                profileResults += line;
+                counter.value = 0;
+            }
+        }
+
         sGpuTimerIndex = 1 - sGpuTimerIndex;
     }
 
+    void Profiler::addToCounter(const HashedString& name, uint64_t value)
+    {
+        std::lock_guard<std::mutex> lock(sCounterMutex);
+        auto it = sCounterIndices.find(name.hash);
+        if(it == sCounterIndices.end())
+        {
+            it = sCounterIndices.insert({name.hash, sCounters.size()}).first;
+            sCounters.push_back({name.str, 0});
+        }
+        sCounters[it->second].value += value;
+    }
+
+    static const uint32_t kMaxTraceDepth = 64;
+
+    struct TraceEventData
+    {
+        const char* name;
+        int64_t start;      // Nanoseconds since the trace epoch
+        int64_t duration;
+    };
+
+    /** Every thread records into its own buffer. Only the owner thread writes into it, the lock is only contended while the trace is dumped.
+    */
+    struct ThreadTraceBuffer
+    {
+        std::mutex mutex;
+        std::vector<TraceEventData> events;     // Ring-buffer
+        uint64_t writeCount = 0;
+        std::string name;
+        uint32_t threadIndex = 0;
+
+        // Open events. Only accessed by the owner thread.
+        TraceEventData openEvents[kMaxTraceDepth];
+        uint32_t depth = 0;
+    };
+
+    static std::mutex sTraceMutex;  // Protects the list of buffers, the settings and the frame history
+    static std::vector<std::unique_ptr<ThreadTraceBuffer>> sTraceBuffers;
+    static Profiler::TraceDesc sTraceDesc;
+    static std::deque<int64_t> sTraceFrameEnds;
+    static uint32_t sFramesSinceTraceDump = 0;
+    static const CpuTimer::TimePoint sTraceEpoch = CpuTimer::getCurrentTimePoint();
+    static thread_local ThreadTraceBuffer* tpTraceBuffer = nullptr;
+    static thread_local std::string tTraceThreadName;   // Used once the thread's buffer is created
+
+    static int64_t getTraceTime()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(CpuTimer::getCurrentTimePoint() - sTraceEpoch).count();
+    }
+
+    static ThreadTraceBuffer* getThreadTraceBuffer()
+    {
+        if(tpTraceBuffer == nullptr)
+        {
+            // Buffers are never released, so the events of threads which exited can still be dumped
+            std::lock_guard<std::mutex> lock(sTraceMutex);
+            sTraceBuffers.push_back(std::make_unique<ThreadTraceBuffer>());
+            tpTraceBuffer = sTraceBuffers.back().get();
+            tpTraceBuffer->threadIndex = (uint32_t)sTraceBuffers.size();
+            tpTraceBuffer->name = tTraceThreadName.size() ? tTraceThreadName : "Thread " + std::to_string(tpTraceBuffer->threadIndex);
+            tpTraceBuffer->events.resize(sTraceDesc.eventsPerThread);
+        }
+        return tpTraceBuffer;
+    }
+
+    void Profiler::startTraceCapture(const TraceDesc& desc)
+    {
+        std::lock_guard<std::mutex> lock(sTraceMutex);
+        sTraceDesc = desc;
+        sTraceDesc.frameCount = std::max(sTraceDesc.frameCount, 1u);
+        sTraceDesc.eventsPerThread = std::max(sTraceDesc.eventsPerThread, 1u);
+        for(auto& pBuffer : sTraceBuffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(pBuffer->mutex);
+            pBuffer->events.clear();
+            pBuffer->events.resize(sTraceDesc.eventsPerThread);
+            pBuffer->writeCount = 0;
+        }
+        sTraceFrameEnds.clear();
+        sFramesSinceTraceDump = 0;
+        sTraceEnabled = true;
+    }
+
+    void Profiler::stopTraceCapture()
+    {
+        sTraceEnabled = false;
+    }
+
+    void Profiler::beginTraceEvent(const char* name)
+    {
+        ThreadTraceBuffer* pBuffer = getThreadTraceBuffer();
+        if(pBuffer->depth < kMaxTraceDepth)
+        {
+            pBuffer->openEvents[pBuffer->depth].name = name;
+            pBuffer->openEvents[pBuffer->depth].start = getTraceTime();
+        }
+        pBuffer->depth++;
+    }
+
+    void Profiler::endTraceEvent()
+    {
+        ThreadTraceBuffer* pBuffer = getThreadTraceBuffer();
+        if(pBuffer->depth == 0)
+        {
+            logWarning("Profiler::endTraceEvent() called without a matching beginTraceEvent()");
+            return;
+        }
+
+        pBuffer->depth--;
+        if(pBuffer->depth < kMaxTraceDepth)
+        {
+            TraceEventData event = pBuffer->openEvents[pBuffer->depth];
+            event.duration = getTraceTime() - event.start;
+
+            std::lock_guard<std::mutex> lock(pBuffer->mutex);
+            if(pBuffer->events.size())
+            {
+                pBuffer->events[pBuffer->writeCount % pBuffer->events.size()] = event;
+                pBuffer->writeCount++;
+            }
+        }
+    }
+
+    void Profiler::setTraceThreadName(const std::string& name)
+    {
+        // Don't allocate a buffer for threads which never record events
+        tTraceThreadName = name;
+        if(tpTraceBuffer)
+        {
+            std::lock_guard<std::mutex> lock(tpTraceBuffer->mutex);
+            tpTraceBuffer->name = name;
+        }
+    }
+
+    void Profiler::endTraceFrame()
+    {
+        if(isTraceCaptureEnabled() == false)
+        {
+            return;
+        }
+
+        int64_t now = getTraceTime();
+        std::string dumpFilename;
+        double frameTime = 0;
+        {
+            std::lock_guard<std::mutex> lock(sTraceMutex);
+            frameTime = sTraceFrameEnds.empty() ? 0 : (now - sTraceFrameEnds.back()) * 1.0e-6;
+
+            // Keep one more boundary than the history size, the oldest one is where the first frame starts
+            sTraceFrameEnds.push_back(now);
+            if(sTraceFrameEnds.size() > sTraceDesc.frameCount + 1)
+            {
+                sTraceFrameEnds.pop_front();
+            }
+            sFramesSinceTraceDump++;
+
+            // Don't dump again until the history contains only new frames
+            bool slowFrame = (sTraceDesc.dumpThreshold > 0) && (frameTime > sTraceDesc.dumpThreshold);
+            if(slowFrame && sFramesSinceTraceDump >= sTraceDesc.frameCount)
+            {
+                if(findAvailableFilename(sTraceDesc.dumpPrefix, getExecutableDirectory(), "json", dumpFilename))
+                {
+                    sFramesSinceTraceDump = 0;
+                }
+            }
+        }
+
+        if(dumpFilename.size())
+        {
+            logWarning("Frame took " + std::to_string(frameTime) + "ms. Dumping trace to " + dumpFilename);
+            dumpTrace(dumpFilename);
+        }
+    }
+
+    static std::string escapeJsonString(const std::string& s)
+    {
+        std::string escaped;
+        for(char c : s)
+        {
+            if(c == '"' || c == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    bool Profiler::dumpTrace(const std::string& filename)
+    {
+        struct ThreadEvents
+        {
+            std::string name;
+            uint32_t threadIndex;
+            std::vector<TraceEventData> events;
+        };
+        std::vector<ThreadEvents> threads;
+        std::vector<int64_t> frameEnds;
+
+        // Copy the history, so that the threads are only blocked for the duration of the copy
+        {
+            std::lock_guard<std::mutex> lock(sTraceMutex);
+            frameEnds.assign(sTraceFrameEnds.begin(), sTraceFrameEnds.end());
+            int64_t windowStart = (frameEnds.size() > sTraceDesc.frameCount) ? frameEnds.front() : INT64_MIN;
+
+            for(auto& pBuffer : sTraceBuffers)
+            {
+                std::lock_guard<std::mutex> bufferLock(pBuffer->mutex);
+                threads.push_back({ pBuffer->name, pBuffer->threadIndex });
+                uint64_t capacity = pBuffer->events.size();
+                uint64_t first = (pBuffer->writeCount > capacity) ? pBuffer->writeCount - capacity : 0;
+                for(uint64_t i = first; i < pBuffer->writeCount; i++)
+                {
+                    const TraceEventData& event = pBuffer->events[i % capacity];
+                    if(event.start + event.duration >= windowStart)
+                    {
+                        threads.back().events.push_back(event);
+                    }
+                }
+            }
+        }
+
+        std::ofstream file(filename);
+        if(file.fail())
+        {
+            logError("Can't open trace file " + filename);
+            return false;
+        }
+
+        // Chrome expects microseconds
+        auto toUs = [](int64_t ns) { return (double)ns * 1.0e-3; };
+        file << std::fixed << std::setprecision(3);
+        file << "{\"traceEvents\":[\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Frames\"}}";
+        for(size_t i = 1; i < frameEnds.size(); i++)
+        {
+            file << ",\n{\"name\":\"Frame\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":" << toUs(frameEnds[i - 1]) << ",\"dur\":" << toUs(frameEnds[i] - frameEnds[i - 1]) << "}";
+        }
+
+        for(const auto& thread : threads)
+        {
+            file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread.threadIndex << ",\"args\":{\"name\":\"" << escapeJsonString(thread.name) << "\"}}";
+            for(const auto& event : thread.events)
+            {
+                file << ",\n{\"name\":\"" << escapeJsonString(event.name) << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread.threadIndex << ",\"ts\":" << toUs(event.start) << ",\"dur\":" << toUs(event.duration) << "}";
+            }
+        }
+        file << "\n]}\n";
+        return true;
+    }
+
 #if _PROFILING_LOG == 1
 	void Profiler::flushLog() {
 		for (EventData* pData : sProfilerVector)
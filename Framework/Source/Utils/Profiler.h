@@ -30,6 +30,7 @@
 #include <map>
 #include <functional>
 #include <vector>
+#include <atomic>
 #include "API/GpuTimer.h"
 #include "Utils/CpuTimer.h"
 #include "FalcorConfig.h"
@@ -135,11 +136,68 @@ namespace Falcor
         */
         static void clearEvents();
 
+        /** Add a value to a per-frame counter, creating the counter if it doesn't exist. Counters are reported by endFrame() after the events and are reset every frame.
+        */
+        static void addToCounter(const HashedString& name, uint64_t value);
+
+        /** CPU trace capture settings
+        */
+        struct TraceDesc
+        {
+            uint32_t frameCount = 60;               ///< Number of frames kept in the history
+            uint32_t eventsPerThread = 64 * 1024;   ///< Capacity of each thread's event ring-buffer. Older events are overwritten.
+            float dumpThreshold = 0;                ///< If non-zero, the history is dumped to a file when a frame takes longer than this many milliseconds
+            std::string dumpPrefix = "Trace";       ///< Prefix of the files created when the threshold is exceeded. The files are created in the executable directory.
+        };
+
+        /** Start recording CPU trace events.
+            Unlike the events above, trace events can be recorded from any thread. Every thread writes into its own buffer, so recording doesn't serialize the threads.
+        */
+        static void startTraceCapture(const TraceDesc& desc = TraceDesc());
+
+        /** Stop recording trace events. The recorded history is kept and can still be dumped.
+        */
+        static void stopTraceCapture();
+
+        /** Check if trace events are being recorded
+        */
+        static bool isTraceCaptureEnabled() { return sTraceEnabled.load(std::memory_order_relaxed); }
+
+        /** Start a trace event on the calling thread. Events on the same thread must be properly nested.
+            \param[in] name The event name. The string is referenced, not copied, so it has to outlive the capture. Use string literals.
+        */
+        static void beginTraceEvent(const char* name);
+
+        /** End the last trace event started on the calling thread
+        */
+        static void endTraceEvent();
+
+        /** Mark the end of a frame in the trace. Called by the sample once per frame.
+        */
+        static void endTraceFrame();
+
+        /** Name the calling thread in the trace
+        */
+        static void setTraceThreadName(const std::string& name);
+
+        /** Write the trace history to a file, using the Chrome trace-event JSON format (load it in chrome://tracing)
+        */
+        static bool dumpTrace(const std::string& filename);
+
     private:
+        struct CounterData
+        {
+            std::string name;
+            uint64_t value = 0;
+        };
+
+        static std::map<size_t, size_t> sCounterIndices;
+        static std::vector<CounterData> sCounters;
         static std::map<size_t, EventData*> sProfilerEvents;
         static std::vector<EventData*> sProfilerVector;
         static uint32_t sCurrentLevel;
         static uint32_t sGpuTimerIndex;
+        static std::atomic<bool> sTraceEnabled;
     };
 
     /** Helper class for starting and ending profiling events.
@@ -160,9 +218,23 @@ namespace Falcor
         const HashedString mName;
     };
 
+    /** Helper class for scoped trace events. Use the TRACE_EVENT macro instead of creating the objects directly.
+    */
+    class TraceEvent
+    {
+    public:
+        TraceEvent(const char* name) : mActive(Profiler::isTraceCaptureEnabled()) { if(mActive) { Profiler::beginTraceEvent(name); } }
+        ~TraceEvent() { if(mActive) { Profiler::endTraceEvent(); } }
+
+    private:
+        const bool mActive;
+    };
+
 #if _PROFILING_ENABLED
-#define PROFILE(_name) static const Falcor::HashedString hashed ## _name(#_name); Falcor::ProfilerEvent _profileEvent(hashed ## _name);
+#define PROFILE(_name) static const Falcor::HashedString hashed ## _name(#_name); Falcor::ProfilerEvent _profileEvent(hashed ## _name); Falcor::TraceEvent _traceEvent(#_name);
+#define TRACE_EVENT(_name) Falcor::TraceEvent _traceEvent ## _name(#_name);
 #else
 #define PROFILE(_name)
+#define TRACE_EVENT(_name)
 #endif
 }
@@ -27,7 +27,30 @@
 ***************************************************************************/
 
 #include "FalcorConfig.h"
+#include "Externals/Spire/Spire.h"
+#include <cstdio>
+#include <string>
 
 #if FALCOR_BUILD_SPIRE
 #include "Externals/Spire/SpireAllSource.h"
 #endif
+
+namespace Falcor
+{
+    // The shader cache uses this to identify the Spire version. It is a hash of the binary which contains Spire, so entries are invalidated whenever the compiler or its stdlib change. Returns an empty string if the hash isn't available.
+    const std::string& getSpireBuildId()
+    {
+        static const std::string buildId = []()
+        {
+            unsigned long long hash = spGetCompilerHash();
+            if(hash == 0)
+            {
+                return std::string();
+            }
+            char hashString[32];
+            snprintf(hashString, sizeof(hashString), "%016llx", hash);
+            return std::string(hashString);
+        }();
+        return buildId;
+    }
+}
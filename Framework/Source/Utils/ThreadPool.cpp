@@ -0,0 +1,192 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/Profiler.h"
+
+namespace Falcor
+{
+    ThreadPool::SharedPtr ThreadPool::create(uint32_t threadCount)
+    {
+        if(threadCount == 0)
+        {
+            uint32_t hwThreads = std::thread::hardware_concurrency();
+            threadCount = (hwThreads > 1) ? hwThreads - 1 : 1;
+        }
+        return SharedPtr(new ThreadPool(threadCount));
+    }
+
+    ThreadPool& ThreadPool::getGlobalPool()
+    {
+        static SharedPtr spGlobalPool = create();
+        return *spGlobalPool;
+    }
+
+    ThreadPool::ThreadPool(uint32_t threadCount)
+    {
+        mThreads.reserve(threadCount);
+        for(uint32_t i = 0; i < threadCount; i++)
+        {
+            mThreads.emplace_back(&ThreadPool::workerThread, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+        mCondition.notify_all();
+
+        for(auto& t : mThreads)
+        {
+            t.join();
+        }
+    }
+
+    void ThreadPool::enqueue(Task&& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQueue.push_back(std::move(task));
+        }
+        mCondition.notify_one();
+    }
+
+    void ThreadPool::workerThread()
+    {
+        static std::atomic<uint32_t> sWorkerCount(0);
+        Profiler::setTraceThreadName("Worker " + std::to_string(sWorkerCount++));
+
+        while(true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this]() { return mTerminate || mQueue.empty() == false; });
+                if(mQueue.empty())
+                {
+                    // Only get here when terminating. Pending tasks are drained before exiting.
+                    return;
+                }
+                task = std::move(mQueue.front());
+                mQueue.pop_front();
+            }
+            TRACE_EVENT(Task);
+            task();
+        }
+    }
+
+    // Shared between the caller of parallelFor() and the helper tasks. Helpers might start after the loop is done, so it can't live on the caller's stack.
+    struct ParallelForData
+    {
+        std::function<void(uint32_t)> func;
+        uint32_t count = 0;
+        std::atomic<uint32_t> nextItem{ 0 };
+        std::atomic<uint32_t> completedItems{ 0 };
+        std::atomic<bool> failed{ false };
+        std::exception_ptr pException;     // The first exception thrown by func. Protected by the mutex
+        std::mutex mutex;
+        std::condition_variable doneCondition;
+    };
+
+    static void executeParallelForItems(ParallelForData* pData)
+    {
+        while(true)
+        {
+            uint32_t item = pData->nextItem.fetch_add(1);
+            if(item >= pData->count)
+            {
+                return;
+            }
+
+            // Once an item threw, the remaining ones are skipped. They still count as completed so the caller's wait finishes.
+            if(pData->failed.load() == false)
+            {
+                try
+                {
+                    pData->func(item);
+                }
+                catch(...)
+                {
+                    std::lock_guard<std::mutex> lock(pData->mutex);
+                    if(pData->pException == nullptr)
+                    {
+                        pData->pException = std::current_exception();
+                    }
+                    pData->failed = true;
+                }
+            }
+
+            if(pData->completedItems.fetch_add(1) + 1 == pData->count)
+            {
+                std::lock_guard<std::mutex> lock(pData->mutex);
+                pData->doneCondition.notify_all();
+            }
+        }
+    }
+
+    void ThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t)>& func)
+    {
+        if(count == 0)
+        {
+            return;
+        }
+
+        if(count == 1 || mThreads.empty())
+        {
+            for(uint32_t i = 0; i < count; i++)
+            {
+                func(i);
+            }
+            return;
+        }
+
+        auto pData = std::make_shared<ParallelForData>();
+        pData->func = func;
+        pData->count = count;
+
+        // The calling thread takes part in the loop, so we need at most count-1 helpers
+        uint32_t helperCount = std::min(getThreadCount(), count - 1);
+        for(uint32_t i = 0; i < helperCount; i++)
+        {
+            enqueue([pData]() { executeParallelForItems(pData.get()); });
+        }
+
+        executeParallelForItems(pData.get());
+
+        // Helpers may still be running func, which can reference the caller's stack, so always wait for all of the items before returning or rethrowing
+        std::unique_lock<std::mutex> lock(pData->mutex);
+        pData->doneCondition.wait(lock, [&pData]() { return pData->completedItems.load() == pData->count; });
+        if(pData->pException)
+        {
+            std::rethrow_exception(pData->pException);
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <exception>
+
+namespace Falcor
+{
+    /** A fixed-size pool of worker threads.
+        Use submit() to run a single task asynchronously, or parallelFor() to split a loop across the workers.
+        parallelFor() executes items on the calling thread as well, so it is safe to call it from inside a task.
+    */
+    class ThreadPool
+    {
+    public:
+        using SharedPtr = std::shared_ptr<ThreadPool>;
+        using Task = std::function<void()>;
+
+        /** Create a new thread pool.
+            \param[in] threadCount Number of worker threads. 0 will create one thread per hardware thread, minus one for the calling thread.
+        */
+        static SharedPtr create(uint32_t threadCount = 0);
+
+        /** Get the pool shared by the framework systems (model/scene loading, etc.). Created on first use.
+        */
+        static ThreadPool& getGlobalPool();
+
+        ~ThreadPool();
+
+        /** Get the number of worker threads
+        */
+        uint32_t getThreadCount() const { return (uint32_t)mThreads.size(); }
+
+        /** Queue a task for asynchronous execution.
+            \return A future which becomes ready once the task finished. It holds the task's return value.
+        */
+        template<typename Func>
+        auto submit(Func&& func) -> std::future<decltype(func())>
+        {
+            using ResultType = decltype(func());
+            auto pTask = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Func>(func));
+            std::future<ResultType> result = pTask->get_future();
+            enqueue([pTask]() { (*pTask)(); });
+            return result;
+        }
+
+        /** Execute func(i) for every i in [0, count) and wait for all of them to finish.
+            The order in which items are executed is undefined. Items are executed on the workers and on the calling thread.
+            If func throws, the items which haven't started yet are skipped, and once the running ones finish, the first exception is rethrown on the calling thread.
+        */
+        void parallelFor(uint32_t count, const std::function<void(uint32_t)>& func);
+
+    private:
+        ThreadPool(uint32_t threadCount);
+        void enqueue(Task&& task);
+        void workerThread();
+
+        std::vector<std::thread> mThreads;
+        std::deque<Task> mQueue;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        bool mTerminate = false;
+    };
+}
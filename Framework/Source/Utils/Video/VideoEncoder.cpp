@@ -28,12 +28,14 @@
 #include "Framework.h"
 #include "VideoEncoder.h"
 #include "Utils/BinaryFileStream.h"
+#include "Utils/ThreadPool.h"
 #include <direct.h>
 extern "C"
 {
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
 #include "libswscale/swscale.h"
+#include "libavutil/pixdesc.h"
 }
 
 namespace Falcor
@@ -292,15 +294,62 @@ namespace Falcor
 
         mForamt = desc.format;
         mRowPitch = getInputFormatBytesPerPixel(desc.format) * desc.width;
-        if(desc.flipY)
+        mHeight = desc.height;
+        mFlipY = desc.flipY;
+
+        if(initConversion(desc) == false)
+        {
+            return false;
+        }
+
+        mAsync = desc.asyncEncoding;
+        if(mAsync)
+        {
+            // The encoder thread owns the codec from here on. All buffers are allocated upfront, so appendFrame() never allocates
+            mQueuePolicy = desc.queuePolicy;
+            uint32_t queueSize = std::max(desc.queueSize, 1u);
+            mFrameBuffers.resize(queueSize);
+            for(uint32_t i = 0; i < queueSize; i++)
+            {
+                mFrameBuffers[i].resize(desc.height * mRowPitch);
+                mFreeBuffers.push_back(i);
+            }
+            mEncoderThread = std::thread(&VideoEncoder::encoderThread, this);
+        }
+        else if(mFlipY)
         {
-            mpFlippedImage = new uint8_t[desc.height * mRowPitch];
+            mFlippedImage.resize(desc.height * mRowPitch);
         }
+        return true;
+    }
+
+    bool VideoEncoder::initConversion(const Desc& desc)
+    {
+        AVPixelFormat srcFormat = getPictureFormatFromFalcorFormat(desc.format);
+        AVPixelFormat dstFormat = mpCodecContext->pix_fmt;
+
+        // In subsampled formats, a slice must start on a row which has its own chroma row
+        int chromaShiftX, chromaShiftY;
+        av_pix_fmt_get_chroma_sub_sample(dstFormat, &chromaShiftX, &chromaShiftY);
+        mChromaShiftY = (uint32_t)chromaShiftY;
+        uint32_t rowAlignment = 1 << mChromaShiftY;
 
-        mpSwsContext = sws_getContext(desc.width, desc.height, getPictureFormatFromFalcorFormat(desc.format), desc.width, desc.height, mpCodecContext->pix_fmt, SWS_POINT, nullptr, nullptr, nullptr);
-        if(mpSwsContext == nullptr)
+        uint32_t sliceCount = std::min(std::max(desc.conversionSlices, 1u), std::max(desc.height / rowAlignment, 1u));
+        uint32_t rowsPerSlice = (desc.height / sliceCount) & ~(rowAlignment - 1);
+
+        uint32_t firstRow = 0;
+        for(uint32_t i = 0; i < sliceCount; i++)
         {
-            return error(mFilename, "Failed to allocate SWScale context");
+            ConversionSlice slice;
+            slice.firstRow = firstRow;
+            slice.rowCount = (i == sliceCount - 1) ? (desc.height - firstRow) : rowsPerSlice;
+            slice.pContext = sws_getContext(desc.width, slice.rowCount, srcFormat, desc.width, slice.rowCount, dstFormat, SWS_POINT, nullptr, nullptr, nullptr);
+            if(slice.pContext == nullptr)
+            {
+                return error(mFilename, "Failed to allocate SWScale context");
+            }
+            mSlices.push_back(slice);
+            firstRow += slice.rowCount;
         }
         return true;
     }
@@ -340,6 +389,17 @@ namespace Falcor
 
     void VideoEncoder::endCapture()
     {
+        if(mEncoderThread.joinable())
+        {
+            // The thread encodes the frames still in the queue before exiting
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mTerminate = true;
+            }
+            mFrameQueued.notify_one();
+            mEncoderThread.join();
+        }
+
         if(mpOutputContext)
         {
             // Flush the codex
@@ -351,36 +411,153 @@ namespace Falcor
             avio_closep(&mpOutputContext->pb);
             avcodec_free_context(&mpCodecContext);
             av_frame_free(&mpFrame);
-            sws_freeContext(mpSwsContext);
             avformat_free_context(mpOutputContext);
             mpOutputContext = nullptr;
             mpOutputStream = nullptr;
         }
-        safe_delete(mpFlippedImage)
+
+        for(auto& slice : mSlices)
+        {
+            sws_freeContext(slice.pContext);
+        }
+        mSlices.clear();
+        mFlippedImage.clear();
+        mFrameBuffers.clear();
+        mFreeBuffers.clear();
+    }
+
+    void VideoEncoder::copyFrame(const void* pSrc, uint8_t* pDst) const
+    {
+        if(mFlipY)
+        {
+            for(uint32_t h = 0; h < mHeight; h++)
+            {
+                const uint8_t* pSrcRow = (const uint8_t*)pSrc + h * mRowPitch;
+                uint8_t* pDstRow = pDst + (mHeight - 1 - h) * mRowPitch;
+                memcpy(pDstRow, pSrcRow, mRowPitch);
+            }
+        }
+        else
+        {
+            memcpy(pDst, pSrc, mHeight * mRowPitch);
+        }
     }
 
     void VideoEncoder::appendFrame(const void* pData)
     {
-        if(mpFlippedImage)
+        if(mpOutputContext == nullptr)
+        {
+            return;
+        }
+
+        if(mAsync == false)
+        {
+            CpuTimer::TimePoint submitTime = CpuTimer::getCurrentTimePoint();
+            if(mFlipY)
+            {
+                copyFrame(pData, mFlippedImage.data());
+                pData = mFlippedImage.data();
+            }
+            encodeFrame((const uint8_t*)pData);
+
+            double latency = CpuTimer::calcDuration(submitTime, CpuTimer::getCurrentTimePoint());
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.framesSubmitted++;
+            mStats.framesEncoded++;
+            mStats.totalLatency += latency;
+            mStats.maxLatency = std::max(mStats.maxLatency, latency);
+            return;
+        }
+
+        PendingFrame frame;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mStats.framesSubmitted++;
+            if(mFreeBuffers.empty())
+            {
+                if(mQueuePolicy == QueuePolicy::DropFrame)
+                {
+                    mStats.framesDropped++;
+                    return;
+                }
+                mBufferReleased.wait(lock, [this]() { return mFreeBuffers.empty() == false; });
+            }
+            frame.bufferIndex = mFreeBuffers.back();
+            mFreeBuffers.pop_back();
+        }
+
+        // The buffer is owned by this thread until it's queued, so the copy happens outside the lock
+        frame.submitTime = CpuTimer::getCurrentTimePoint();
+        copyFrame(pData, mFrameBuffers[frame.bufferIndex].data());
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mPendingFrames.push_back(frame);
+            mStats.queueDepth = (uint32_t)mPendingFrames.size();
+            mStats.maxQueueDepth = std::max(mStats.maxQueueDepth, mStats.queueDepth);
+        }
+        mFrameQueued.notify_one();
+    }
+
+    void VideoEncoder::encoderThread()
+    {
+        while(true)
         {
-            // Flip the image
-            for(int32_t h = 0; h < mpCodecContext->height; h++)
+            PendingFrame frame;
             {
-                const uint8_t* pSrc = (uint8_t*)pData + h * mRowPitch;
-                uint8_t* pDst = mpFlippedImage + (mpCodecContext->height - 1 - h) * mRowPitch;
-                memcpy(pDst, pSrc, mRowPitch);
+                std::unique_lock<std::mutex> lock(mMutex);
+                mFrameQueued.wait(lock, [this]() { return mTerminate || (mPendingFrames.empty() == false); });
+                if(mPendingFrames.empty())
+                {
+                    return;
+                }
+                frame = mPendingFrames.front();
+                mPendingFrames.pop_front();
             }
 
-            pData = mpFlippedImage;
+            encodeFrame(mFrameBuffers[frame.bufferIndex].data());
+            double latency = CpuTimer::calcDuration(frame.submitTime, CpuTimer::getCurrentTimePoint());
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mFreeBuffers.push_back(frame.bufferIndex);
+                mStats.queueDepth = (uint32_t)mPendingFrames.size();
+                mStats.framesEncoded++;
+                mStats.totalLatency += latency;
+                mStats.maxLatency = std::max(mStats.maxLatency, latency);
+            }
+            mBufferReleased.notify_one();
         }
+    }
 
-        uint8_t* src[AV_NUM_DATA_POINTERS] = {0};
-        int32_t rowPitch[AV_NUM_DATA_POINTERS] = {0};
-        src[0] = (uint8_t*)pData;
-        rowPitch[0] = (int32_t)mRowPitch;
+    void VideoEncoder::encodeFrame(const uint8_t* pData)
+    {
+        // Convert the image. Every slice writes its own rows of the frame, so they can run concurrently
+        auto convertSlice = [this, pData](uint32_t sliceIndex)
+        {
+            const ConversionSlice& slice = mSlices[sliceIndex];
+            const uint8_t* src[AV_NUM_DATA_POINTERS] = {0};
+            int32_t rowPitch[AV_NUM_DATA_POINTERS] = {0};
+            src[0] = pData + slice.firstRow * mRowPitch;
+            rowPitch[0] = (int32_t)mRowPitch;
+
+            uint8_t* dst[AV_NUM_DATA_POINTERS] = {0};
+            for(uint32_t plane = 0; plane < AV_NUM_DATA_POINTERS && mpFrame->data[plane]; plane++)
+            {
+                uint32_t row = (plane == 0) ? slice.firstRow : (slice.firstRow >> mChromaShiftY);
+                dst[plane] = mpFrame->data[plane] + row * mpFrame->linesize[plane];
+            }
+            sws_scale(slice.pContext, src, rowPitch, 0, slice.rowCount, dst, mpFrame->linesize);
+        };
 
-        // Scale and convert the image
-        sws_scale(mpSwsContext, src, rowPitch, 0, mpCodecContext->height, mpFrame->data, mpFrame->linesize);
+        if(mSlices.size() == 1)
+        {
+            convertSlice(0);
+        }
+        else
+        {
+            ThreadPool::getGlobalPool().parallelFor((uint32_t)mSlices.size(), convertSlice);
+        }
 
         // Encode the frame
         int r = avcodec_send_frame(mpCodecContext, mpFrame);
@@ -399,6 +576,12 @@ namespace Falcor
         }
     }
 
+    VideoEncoder::Stats VideoEncoder::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
     const std::string VideoEncoder::getSupportedContainerForCodec(CodecID codec)
     {
         const std::string AVI = std::string("AVI (Audio Video Interleaved)") + '\0' + "*.avi" + '\0';
@@ -27,6 +27,12 @@
 ***************************************************************************/
 #pragma once
 #include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Utils/CpuTimer.h"
 
 struct AVFormatContext;
 struct AVStream;
@@ -56,6 +62,14 @@ namespace Falcor
             R8G8B8A8,
         };
 
+        /** What appendFrame() does when all of the frame buffers are waiting to be encoded
+        */
+        enum class QueuePolicy
+        {
+            Block,      ///< Wait for the encoder thread to release a buffer. No frames are lost
+            DropFrame,  ///< Discard the new frame. The caller never waits, but the video will skip frames
+        };
+
         struct Desc
         {
             uint32_t fps = 60;
@@ -67,28 +81,88 @@ namespace Falcor
             InputFormat format = InputFormat::R8G8B8A8;
             bool flipY = false;
             std::string filename;
+
+            bool asyncEncoding = true;                  ///< Encode on a separate thread. appendFrame() only copies the frame into a queue
+            uint32_t queueSize = 4;                     ///< Number of frame buffers in the queue. Only used with asyncEncoding
+            QueuePolicy queuePolicy = QueuePolicy::Block;
+            uint32_t conversionSlices = 1;              ///< Number of horizontal slices the color conversion is split into. Slices are converted in parallel on the global thread pool
+        };
+
+        struct Stats
+        {
+            uint64_t framesSubmitted = 0;   ///< Number of appendFrame() calls
+            uint64_t framesEncoded = 0;
+            uint64_t framesDropped = 0;     ///< Frames discarded by QueuePolicy::DropFrame
+            uint32_t queueDepth = 0;        ///< Frames currently waiting to be encoded
+            uint32_t maxQueueDepth = 0;
+            double totalLatency = 0;        ///< Sum of the times from appendFrame() until the frame was encoded, in milliseconds
+            double maxLatency = 0;
+
+            double getAverageLatency() const { return framesEncoded ? totalLatency / framesEncoded : 0; }
         };
 
         ~VideoEncoder();
 
         static UniquePtr create(const Desc& desc);
+
+        /** Add a frame to the video. With asyncEncoding, the call returns once the frame was copied into the queue.
+        */
         void appendFrame(const void* pData);
+
+        /** Encode all of the queued frames and close the file
+        */
         void endCapture();
 
+        Stats getStats() const;
+
         static const std::string getSupportedContainerForCodec(CodecID codec);
     private:
         VideoEncoder(const std::string& filename);
         bool init(const Desc& desc);
+        bool initConversion(const Desc& desc);
+        void copyFrame(const void* pSrc, uint8_t* pDst) const;
+        void encodeFrame(const uint8_t* pData);
+        void encoderThread();
 
         AVFormatContext* mpOutputContext = nullptr;
         AVStream*        mpOutputStream  = nullptr;
         AVFrame*         mpFrame         = nullptr;
-        SwsContext*      mpSwsContext    = nullptr;
         AVCodecContext*  mpCodecContext = nullptr;
 
+        // The color conversion is split into horizontal slices, each with its own context
+        struct ConversionSlice
+        {
+            SwsContext* pContext = nullptr;
+            uint32_t firstRow = 0;
+            uint32_t rowCount = 0;
+        };
+        std::vector<ConversionSlice> mSlices;
+        uint32_t mChromaShiftY = 0;
+
         const std::string mFilename;
         InputFormat mForamt;
         uint32_t mRowPitch = 0;
-        uint8_t* mpFlippedImage = nullptr; // Used in case the image memory layout if bottom->top
+        uint32_t mHeight = 0;
+        bool mFlipY = false;
+        std::vector<uint8_t> mFlippedImage; // Used in case the image memory layout if bottom->top and the encoding is synchronous
+
+        // Asynchronous encoding. The buffers cycle from the free list to the pending queue and back once the encoder thread is done with them
+        struct PendingFrame
+        {
+            uint32_t bufferIndex;
+            CpuTimer::TimePoint submitTime;
+        };
+
+        bool mAsync = false;
+        QueuePolicy mQueuePolicy = QueuePolicy::Block;
+        std::vector<std::vector<uint8_t>> mFrameBuffers;
+        std::vector<uint32_t> mFreeBuffers;
+        std::deque<PendingFrame> mPendingFrames;
+        std::thread mEncoderThread;
+        mutable std::mutex mMutex;
+        std::condition_variable mFrameQueued;
+        std::condition_variable mBufferReleased;
+        bool mTerminate = false;
+        Stats mStats;
     };
 }
\ No newline at end of file
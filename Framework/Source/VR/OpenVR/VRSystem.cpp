@@ -358,6 +358,10 @@ namespace Falcor
     {
         if(!mpCompositor) return false;
 
+#ifdef FALCOR_NULL
+        // The null backend has no textures the compositor can consume
+        return false;
+#else
         vr::D3D12TextureData_t submitTex;
 
         submitTex.m_pResource = displayTex->getApiHandle();
@@ -372,12 +376,17 @@ namespace Falcor
 
         mpCompositor->Submit((whichEye == VRDisplay::Eye::Right) ? vr::Eye_Right : vr::Eye_Left, &subTex, NULL);
         return true;
+#endif
     }
     
     bool VRSystem::submit(VRDisplay::Eye whichEye, Fbo::SharedConstPtr displayFbo, RenderContext* pRenderCtx)
     {
         if (!mpCompositor) return false;
 
+#ifdef FALCOR_NULL
+        // The null backend has no textures the compositor can consume
+        return false;
+#else
         vr::D3D12TextureData_t submitTex;
 
         submitTex.m_pResource = displayFbo->getColorTexture(0)->getApiHandle();
@@ -392,6 +401,7 @@ namespace Falcor
 
         mpCompositor->Submit((whichEye == VRDisplay::Eye::Right) ? vr::Eye_Right : vr::Eye_Left, &subTex, NULL);
         return true;
+#endif
     }
 
 
@@ -28,6 +28,9 @@
 
 #include "ShaderCommon.h"
 #include "Shading.h"
+#ifdef _CLUSTERED_LIGHTING
+#include "ClusteredLighting.h"
+#endif
 #define _COMPILE_DEFAULT_VS
 #include "VertexAttrib.h"
 
@@ -37,11 +40,23 @@ vec4 main(VS_OUT vOut) : SV_TARGET
     prepareShadingAttribs(gMaterial, vOut.posW, gCam.position, vOut.normalW, vOut.bitangentW, vOut.texC, shAttr);
 
     ShadingOutput result;
+    result.finalValue = 0;
 
+#ifdef _CLUSTERED_LIGHTING
+    // The unbounded lights come first, then the lights listed in the pixel's cluster
+    uint2 range = gClusterLightRanges[getLightClusterIndex(vOut.posW)];
+    uint lightCount = gUnboundedLightCount + range.y;
+    for (uint l = 0; l < lightCount; l++)
+    {
+        uint lightIndex = (l < gUnboundedLightCount) ? l : gClusterLightIndices[range.x + l - gUnboundedLightCount];
+        evalMaterial(shAttr, gClusteredLights[lightIndex], result, l == 0);
+    }
+#else
     for (uint l = 0; l < gLightsCount; l++)
     {
         evalMaterial(shAttr, gLights[l], result, l == 0);
     }
+#endif
 
     vec4 finalColor = vec4(result.finalValue, 1.f);
 
@@ -47,6 +47,12 @@ void StereoRendering::onGuiRender()
     {
         setRenderMode();
     }
+    if (mpScene && mpGui->addCheckBox("Clustered Lighting", mClusteredLighting))
+    {
+        setRenderMode();
+        // The clustered lighting resources are only declared when the define is set
+        mpProgramVars = GraphicsVars::create(mpProgram->getActiveVersion()->getReflector());
+    }
 }
 
 void StereoRendering::initVR()
@@ -125,6 +131,15 @@ void StereoRendering::setRenderMode()
             mpGraphicsState->toggleSinglePassStereo(true);
             break;
         }
+        if (mClusteredLighting)
+        {
+            mpProgram->addDefine("_CLUSTERED_LIGHTING");
+        }
+        else
+        {
+            mpProgram->removeDefine("_CLUSTERED_LIGHTING");
+        }
+        mpSceneRenderer->setClusteredLightingEnabled(mClusteredLighting);
         mpSceneRenderer->setRenderMode(mRenderMode);
     }
 }
@@ -62,6 +62,7 @@ private:
     FullScreenPass::UniquePtr mpBlit;
     GraphicsVars::SharedPtr mpBlitVars;
     bool mShowStereoViews = true;
+    bool mClusteredLighting = false;
     void submitSinglePassStereo();
     void setRenderMode();
 };
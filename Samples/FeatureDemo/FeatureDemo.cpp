@@ -94,6 +94,7 @@ void FeatureDemo::initScene(Scene::SharedPtr pScene)
     mpSceneRenderer = SceneRenderer::create(pScene);
     mpSceneRenderer->setCameraControllerType(SceneRenderer::CameraControllerType::FirstPerson);
     mpSceneRenderer->toggleStaticMaterialCompilation(mOptimizedShaders);
+    mpSceneRenderer->setRenderQueueEnabled(true);
     setActiveCameraAspectRatio();
     initLightingPass();
     initShadowPass();
@@ -161,5 +161,7 @@ void FeatureDemo::onGuiRender()
             }
             mpGui->endGroup();
         }
+
+        mpSceneRenderer->renderUI(mpGui.get(), "Scene Renderer");
     }
 }
@@ -0,0 +1,114 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Falcor.h"
+
+using namespace Falcor;
+
+static void printSyntax()
+{
+    printf("Syntax: TextureBaker [options] <list of image files>\n");
+    printf("Writes a DDS file next to each image, with the mip-chain generated and compressed.\n");
+    printf("Options:\n");
+    printf("    -bc1 | -bc3 | -bc5 | -bc7 | -rgba8    Output format. Default is -bc7\n");
+    printf("    -kaiser | -box | -nomips               Mip filter. Default is -kaiser\n");
+    printf("    -linear                                The images are not in sRGB space (normal maps, roughness, etc.)\n");
+}
+
+static bool parseOption(const std::string& arg, TextureBakeDesc& desc)
+{
+    if(arg == "-bc1")         desc.compression = TextureBakeDesc::Compression::BC1;
+    else if(arg == "-bc3")    desc.compression = TextureBakeDesc::Compression::BC3;
+    else if(arg == "-bc5")    desc.compression = TextureBakeDesc::Compression::BC5;
+    else if(arg == "-bc7")    desc.compression = TextureBakeDesc::Compression::BC7;
+    else if(arg == "-rgba8")  desc.compression = TextureBakeDesc::Compression::None;
+    else if(arg == "-kaiser") desc.mipFilter = TextureBakeDesc::MipFilter::Kaiser;
+    else if(arg == "-box")    desc.mipFilter = TextureBakeDesc::MipFilter::Box;
+    else if(arg == "-nomips") desc.mipFilter = TextureBakeDesc::MipFilter::None;
+    else if(arg == "-linear") desc.isSrgb = false;
+    else return false;
+    return true;
+}
+
+static bool bakeTexture(const std::string& filename, const TextureBakeDesc& desc)
+{
+    printf("Baking %s ...\n", filename.c_str());
+
+    std::string fullpath;
+    if(findFileInDataDirectories(filename, fullpath) == false)
+    {
+        printf("    Cannot find the image file.\n");
+        return false;
+    }
+
+    std::string ddsFilename = fullpath.substr(0, fullpath.find_last_of('.')) + ".dds";
+    if(bakeTextureToDds(fullpath, ddsFilename, desc) == false)
+    {
+        printf("    Failed.\n");
+        return false;
+    }
+
+    printf("    Wrote %s\n", ddsFilename.c_str());
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    TextureBakeDesc desc;
+    std::vector<std::string> files;
+
+    for(int argi = 1; argi < argc; ++argi)
+    {
+        std::string arg(argv[argi]);
+        if(arg[0] == '-')
+        {
+            if(parseOption(arg, desc) == false)
+            {
+                printf("Unknown option %s\n", arg.c_str());
+                printSyntax();
+                return 1;
+            }
+        }
+        else
+        {
+            files.push_back(arg);
+        }
+    }
+
+    if(files.empty())
+    {
+        printSyntax();
+        return 1;
+    }
+
+    uint32_t failed = 0;
+    for(const auto& file : files)
+    {
+        failed += bakeTexture(file, desc) ? 0 : 1;
+    }
+    return failed ? 1 : 0;
+}
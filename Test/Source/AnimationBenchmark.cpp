@@ -0,0 +1,200 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "AnimationBenchmark.h"
+#include "TestHelper.h"
+#include "Graphics/Model/AnimationController.h"
+#include "glm/gtx/transform.hpp"
+#include <random>
+
+static const uint32_t kBoneCount = 64;
+static const uint32_t kKeyCount = 40;
+static const uint32_t kModelCount = 256;
+static const uint32_t kFrameCount = 30;
+static const float kDuration = 100;
+static const float kTicksPerSecond = 25;
+
+// The evaluation AnimationController used to do: a linear key search per channel, three 4x4 matrices per bone and a scalar parent-to-child loop
+class ReferenceSkeleton
+{
+public:
+    ReferenceSkeleton(const std::vector<Bone>& bones, const std::vector<Animation::AnimationSet>& sets) : mBones(bones), mSets(sets)
+    {
+        mLastKeys.resize(mSets.size() * 3, 0);
+        mBoneTransforms.resize(mBones.size());
+    }
+
+    void animate(double time)
+    {
+        float ticks = (float)fmod(time * kTicksPerSecond, kDuration);
+        for(size_t i = 0; i < mSets.size(); i++)
+        {
+            const auto& set = mSets[i];
+            glm::mat4 translation;
+            translation[3] = glm::vec4(sample(set.translation.keys, mLastKeys[i * 3 + 0], ticks), 1);
+            glm::mat4 scaling = glm::scale(sample(set.scaling.keys, mLastKeys[i * 3 + 1], ticks));
+            glm::mat4 rotation = glm::mat4_cast(sample(set.rotation.keys, mLastKeys[i * 3 + 2], ticks));
+            mBones[set.boneID].localTransform = translation * rotation * scaling;
+        }
+
+        for(uint32_t i = 0; i < mBones.size(); i++)
+        {
+            mBones[i].globalTransform = mBones[i].localTransform;
+            if(mBones[i].parentID != AnimationController::kInvalidBoneID)
+            {
+                mBones[i].globalTransform = mBones[mBones[i].parentID].globalTransform * mBones[i].globalTransform;
+            }
+            mBoneTransforms[i] = mBones[i].globalTransform * mBones[i].offset;
+        }
+    }
+
+    const std::vector<glm::mat4>& getBoneMatrices() const { return mBoneTransforms; }
+
+private:
+    static glm::vec3 interpolate(const glm::vec3& start, const glm::vec3& end, float ratio) { return start + ((end - start) * ratio); }
+    static glm::quat interpolate(const glm::quat& start, const glm::quat& end, float ratio) { return glm::slerp(start, end, ratio); }
+
+    template<typename T>
+    static T sample(const std::vector<Animation::AnimationKey<T>>& keys, uint32_t& lastKey, float ticks)
+    {
+        if(ticks < keys[lastKey].time)
+        {
+            lastKey = 0;
+        }
+        while(lastKey < keys.size() - 1 && keys[lastKey + 1].time <= ticks)
+        {
+            lastKey++;
+        }
+
+        const auto& curKey = keys[lastKey];
+        const auto& nextKey = keys[(lastKey + 1) % keys.size()];
+        float diff = nextKey.time - curKey.time;
+        if(diff < 0)
+        {
+            diff += kDuration;
+        }
+        return interpolate(curKey.value, nextKey.value, (ticks - curKey.time) / diff);
+    }
+
+    std::vector<Bone> mBones;
+    std::vector<Animation::AnimationSet> mSets;
+    std::vector<uint32_t> mLastKeys;
+    std::vector<glm::mat4> mBoneTransforms;
+};
+
+static std::vector<Bone> createSkeleton()
+{
+    // A binary tree, so that every level but the root has several bones
+    std::vector<Bone> bones(kBoneCount);
+    for(uint32_t i = 0; i < kBoneCount; i++)
+    {
+        bones[i].boneID = i;
+        bones[i].parentID = (i == 0) ? AnimationController::kInvalidBoneID : (i - 1) / 2;
+        bones[i].name = "Bone" + std::to_string(i);
+        bones[i].offset = glm::translate(glm::vec3(0, -float(i), 0));
+    }
+    return bones;
+}
+
+static std::vector<Animation::AnimationSet> createAnimationSets(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-1, 1);
+    std::vector<Animation::AnimationSet> sets(kBoneCount);
+    for(uint32_t i = 0; i < kBoneCount; i++)
+    {
+        sets[i].boneID = i;
+        for(uint32_t k = 0; k < kKeyCount; k++)
+        {
+            float time = kDuration * float(k) / float(kKeyCount);
+            sets[i].translation.keys.push_back({ glm::vec3(dist(rng), 1 + dist(rng), dist(rng)), time });
+            sets[i].scaling.keys.push_back({ glm::vec3(1 + 0.1f * dist(rng)), time });
+            sets[i].rotation.keys.push_back({ glm::normalize(glm::quat(dist(rng), dist(rng), dist(rng), dist(rng))), time });
+        }
+    }
+    return sets;
+}
+
+void AnimationBenchmark::addTests()
+{
+    addTestToList<TestAnimation>();
+}
+
+testing_func(AnimationBenchmark, TestAnimation)
+{
+    std::mt19937 rng(1234);
+    std::vector<Bone> bones = createSkeleton();
+
+    std::vector<AnimationController::UniquePtr> controllers;
+    std::vector<ReferenceSkeleton> references;
+    for(uint32_t i = 0; i < kModelCount; i++)
+    {
+        std::vector<Animation::AnimationSet> sets = createAnimationSets(rng);
+        controllers.push_back(AnimationController::create(bones));
+        controllers.back()->addAnimation(Animation::create("Animation", sets, kDuration, kTicksPerSecond));
+        controllers.back()->setActiveAnimation(0);
+        references.emplace_back(bones, sets);
+    }
+
+    // Both paths should produce the same skinning matrices, including after the animation wraps around
+    const double checkTimes[] = { 0.0, 0.37, 1.5, 3.99, 4.01, 10.2, 0.5 };
+    for(double time : checkTimes)
+    {
+        for(uint32_t i = 0; i < kModelCount; i++)
+        {
+            controllers[i]->animate(time);
+            references[i].animate(time);
+            const glm::mat4* pMatrices = controllers[i]->getBoneMatrices();
+            const auto& refMatrices = references[i].getBoneMatrices();
+            for(uint32_t b = 0; b < kBoneCount; b++)
+            {
+                for(uint32_t c = 0; c < 4; c++)
+                {
+                    glm::vec4 diff = glm::abs(pMatrices[b][c] - refMatrices[b][c]);
+                    if(glm::max(glm::max(diff.x, diff.y), glm::max(diff.z, diff.w)) > 1e-3f)
+                    {
+                        return test_fail("Bone matrix doesn't match the reference evaluation");
+                    }
+                }
+            }
+        }
+    }
+
+    float referenceTime = TestHelper::timeAverage(kFrameCount, [&](uint32_t frame) { for(auto& ref : references) ref.animate(double(frame) / 60.0); });
+    float soaTime = TestHelper::timeAverage(kFrameCount, [&](uint32_t frame) { for(auto& pController : controllers) pController->animate(double(frame) / 60.0); });
+
+    TestHelper::reportBenchmark("Animating " + std::to_string(kModelCount) + " models with " + std::to_string(kBoneCount) + " bones, per frame",
+        { { "Per-bone matrices", referenceTime }, { "SoA keys and SIMD hierarchy", soaTime } });
+    return test_pass();
+}
+
+int main()
+{
+    AnimationBenchmark ab;
+    ab.init(false);
+    ab.run();
+    return 0;
+}
@@ -0,0 +1,175 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ClusteredLightingBenchmark.h"
+#include "TestHelper.h"
+#include "Graphics/ClusteredLightCulling.h"
+#include "Graphics/Camera/Camera.h"
+#include "Utils/ThreadPool.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+static const float kSceneSize = 200;
+static const uint32_t kPointCount = 20000;
+static const uint32_t kFrameCount = 10;
+
+static Camera::SharedPtr createCamera()
+{
+    Camera::SharedPtr pCamera = Camera::create();
+    pCamera->setPosition(glm::vec3(0, 5, 0));
+    pCamera->setTarget(glm::vec3(0.3f, 4, -1));
+    pCamera->setUpVector(glm::vec3(0, 1, 0));
+    pCamera->setAspectRatio(16.0f / 9.0f);
+    pCamera->setDepthRange(0.1f, 150);
+    return pCamera;
+}
+
+// Point lights, spot lights of every opening angle and a few directional lights scattered around the camera
+static std::vector<Light::SharedPtr> createLights(uint32_t count, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(0, 1);
+    std::vector<Light::SharedPtr> lights;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(i % 64 == 63)
+        {
+            DirectionalLight::SharedPtr pLight = DirectionalLight::create();
+            pLight->setWorldDirection(glm::normalize(glm::vec3(dist(rng) - 0.5f, -1, dist(rng) - 0.5f)));
+            lights.push_back(pLight);
+            continue;
+        }
+
+        PointLight::SharedPtr pLight = PointLight::create();
+        pLight->setWorldPosition((glm::vec3(dist(rng), dist(rng), dist(rng)) - 0.5f) * kSceneSize);
+        pLight->setIntensity(glm::vec3(dist(rng), dist(rng), dist(rng)) * 0.5f);
+        if(i % 2)
+        {
+            pLight->setWorldDirection(glm::normalize(glm::vec3(dist(rng), dist(rng), dist(rng)) - 0.5f));
+            pLight->setOpeningAngle(dist(rng) * (float)M_PI);
+        }
+        lights.push_back(pLight);
+    }
+    return lights;
+}
+
+void ClusteredLightingBenchmark::addTests()
+{
+    addTestToList<TestClusterAssignment>();
+    addTestToList<TestClusterBuildScaling>();
+}
+
+testing_func(ClusteredLightingBenchmark, TestClusterAssignment)
+{
+    std::mt19937 rng(1234);
+    Camera::SharedPtr pCamera = createCamera();
+    std::vector<Light::SharedPtr> lights = createLights(4096, rng);
+
+    ClusteredLightCulling::UniquePtr pSerial = ClusteredLightCulling::create();
+    ClusteredLightCulling::UniquePtr pParallel = ClusteredLightCulling::create();
+    pSerial->setIntensityThreshold(1e-2f);
+    pParallel->setIntensityThreshold(1e-2f);
+    pSerial->build(pCamera.get(), lights, false);
+    pParallel->build(pCamera.get(), lights, true);
+
+    if(pSerial->getClusterRanges() != pParallel->getClusterRanges() || pSerial->getLightIndices() != pParallel->getLightIndices())
+    {
+        return test_fail("Parallel build doesn't match the serial build");
+    }
+
+    // Every light whose bounding sphere contains a point must be in the list of the point's cluster
+    const auto& lightData = pSerial->getLightData();
+    const auto& ranges = pSerial->getClusterRanges();
+    const auto& indices = pSerial->getLightIndices();
+    const glm::mat4& proj = pCamera->getProjMatrix();
+    const glm::mat4 invView = glm::inverse(pCamera->getViewMatrix());
+    std::uniform_real_distribution<float> dist(-0.999f, 0.999f);
+    std::uniform_real_distribution<float> logDepth(log(pCamera->getNearPlane()), log(pCamera->getFarPlane()));
+
+    for(uint32_t p = 0; p < kPointCount; p++)
+    {
+        float depth = exp(logDepth(rng));
+        glm::vec3 posV(depth * (dist(rng) + proj[2][0]) / proj[0][0], depth * (dist(rng) + proj[2][1]) / proj[1][1], -depth);
+        glm::vec3 posW = glm::vec3(invView * glm::vec4(posV, 1));
+
+        glm::uvec2 range = ranges[pSerial->getClusterIndex(posV)];
+        for(uint32_t l = pSerial->getUnboundedLightCount(); l < (uint32_t)lightData.size(); l++)
+        {
+            glm::vec3 center;
+            float radius = pSerial->getLightBoundingSphere(lightData[l], center);
+            if(glm::length(posW - center) > radius * 0.999f)
+            {
+                continue;
+            }
+            if(std::find(indices.begin() + range.x, indices.begin() + range.x + range.y, l) == indices.begin() + range.x + range.y)
+            {
+                return test_fail("A light which reaches a point is missing from the point's cluster");
+            }
+        }
+    }
+
+    // Report how many of the lights a pixel still has to evaluate
+    if(TestHelper::isBenchmarkOutputEnabled())
+    {
+        float averageCount = float(indices.size()) / float(pSerial->getClusterCount());
+        std::cout << "Average lights per cluster: " << averageCount << " out of " << lightData.size() - pSerial->getUnboundedLightCount() << std::endl;
+    }
+    return test_pass();
+}
+
+testing_func(ClusteredLightingBenchmark, TestClusterBuildScaling)
+{
+    std::mt19937 rng(1234);
+    Camera::SharedPtr pCamera = createCamera();
+    ClusteredLightCulling::UniquePtr pCulling = ClusteredLightCulling::create();
+    pCulling->setIntensityThreshold(1e-2f);
+
+    const std::string description = "Building " + std::to_string(pCulling->getClusterCount()) + " clusters, " + std::to_string(ThreadPool::getGlobalPool().getThreadCount()) + " worker threads, ";
+    const uint32_t lightCounts[] = { 256, 1024, 4096, 16384 };
+    for(uint32_t lightCount : lightCounts)
+    {
+        std::vector<Light::SharedPtr> lights = createLights(lightCount, rng);
+        float times[2];
+        for(uint32_t parallel = 0; parallel < 2; parallel++)
+        {
+            // Warm up the allocations
+            pCulling->build(pCamera.get(), lights, parallel != 0);
+            times[parallel] = TestHelper::timeAverage(kFrameCount, [&](uint32_t) { pCulling->build(pCamera.get(), lights, parallel != 0); });
+        }
+        TestHelper::reportBenchmark(description + std::to_string(lightCount) + " lights, " + std::to_string(pCulling->getLightIndices().size()) + " cluster entries, per frame",
+            { { "Serial", times[0] }, { "Parallel", times[1] } });
+    }
+    return test_pass();
+}
+
+int main()
+{
+    ClusteredLightingBenchmark clb;
+    clb.init(false);
+    clb.run();
+    return 0;
+}
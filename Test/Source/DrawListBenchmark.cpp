@@ -0,0 +1,170 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "DrawListBenchmark.h"
+#include "TestHelper.h"
+#include "Graphics/Scene/DrawList.h"
+#include "glm/gtx/transform.hpp"
+#include <random>
+
+static const uint32_t kItemCount = 100000;
+static const uint32_t kInstancesPerDraw = 64;
+static const uint32_t kFrameCount = 20;
+
+// Stand-in for the scene's mesh instances. The constants are computed the same way SceneRenderer computes them.
+struct DrawItem
+{
+    glm::mat4 instanceMat;
+    glm::mat4 meshMat;
+};
+
+static std::vector<DrawItem> createItems()
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-100, 100);
+    std::vector<DrawItem> items(kItemCount);
+    for(auto& item : items)
+    {
+        item.instanceMat = glm::translate(glm::vec3(dist(rng), dist(rng), dist(rng))) * glm::rotate(dist(rng), glm::normalize(glm::vec3(dist(rng), dist(rng), 1)));
+        item.meshMat = glm::scale(glm::vec3(1 + dist(rng) * 0.001f));
+    }
+    return items;
+}
+
+static void buildDrawLists(ParallelDrawListBuilder& builder, const std::vector<DrawItem>& items, uint32_t batchesPerChunk, bool parallel)
+{
+    const uint32_t batchCount = (kItemCount + kInstancesPerDraw - 1) / kInstancesPerDraw;
+    builder.build(batchCount, batchesPerChunk, [&items](DrawList* pList, uint32_t firstBatch, uint32_t batchCount)
+    {
+        for(uint32_t batch = firstBatch; batch < firstBatch + batchCount; batch++)
+        {
+            const uint32_t firstItem = batch * kInstancesPerDraw;
+            const uint32_t instanceCount = std::min(kInstancesPerDraw, kItemCount - firstItem);
+            const uint32_t constantsSize = (uint32_t)(instanceCount * (sizeof(glm::mat4) + sizeof(glm::mat3x4)));
+            uint8_t* pConstants = pList->allocateConstants(constantsSize);
+            glm::mat4* pWorldMats = (glm::mat4*)pConstants;
+            glm::mat3x4* pWorldInvTransposeMats = (glm::mat3x4*)(pConstants + instanceCount * sizeof(glm::mat4));
+            for(uint32_t i = 0; i < instanceCount; i++)
+            {
+                pWorldMats[i] = items[firstItem + i].instanceMat * items[firstItem + i].meshMat;
+                pWorldInvTransposeMats[i] = glm::transpose(glm::inverse(glm::mat3(pWorldMats[i])));
+            }
+            pList->addDraw(firstItem, instanceCount, pConstants, constantsSize);
+        }
+    }, parallel);
+}
+
+static size_t getPageMemorySize(const ParallelDrawListBuilder& builder)
+{
+    size_t size = 0;
+    for(uint32_t i = 0; i < builder.getListCount(); i++)
+    {
+        size += builder.getList(i)->getPageMemorySize();
+    }
+    return size;
+}
+
+void DrawListBenchmark::addTests()
+{
+    addTestToList<TestDrawOrder>();
+    addTestToList<TestBuildScaling>();
+}
+
+testing_func(DrawListBenchmark, TestDrawOrder)
+{
+    std::vector<DrawItem> items = createItems();
+    ParallelDrawListBuilder serial;
+    ParallelDrawListBuilder parallel;
+    buildDrawLists(serial, items, 1000000, false);
+    buildDrawLists(parallel, items, 7, true);
+
+    // The lists are submitted in chunk order, so the lists built in parallel must replay exactly like the serial ones
+    std::vector<DrawList::Draw> serialDraws;
+    serial.forEachDraw([&serialDraws](const DrawList::Draw& draw) { serialDraws.push_back(draw); });
+    uint32_t drawIndex = 0;
+    bool match = true;
+    parallel.forEachDraw([&](const DrawList::Draw& draw)
+    {
+        if(drawIndex >= serialDraws.size())
+        {
+            match = false;
+            return;
+        }
+        const DrawList::Draw& ref = serialDraws[drawIndex++];
+        match = match && (draw.firstItem == ref.firstItem) && (draw.itemCount == ref.itemCount) && (draw.constantsSize == ref.constantsSize);
+        match = match && ((((uintptr_t)draw.pConstants) & 15) == 0) && (memcmp(draw.pConstants, ref.pConstants, draw.constantsSize) == 0);
+    });
+
+    if(match == false || drawIndex != serialDraws.size())
+    {
+        return test_fail("The lists built in parallel don't match the serial lists");
+    }
+
+    // Building again reuses the pages
+    size_t pageMemory = getPageMemorySize(parallel);
+    buildDrawLists(parallel, items, 7, true);
+    if(getPageMemorySize(parallel) != pageMemory)
+    {
+        return test_fail("Draw lists allocated new pages when building the same draws again");
+    }
+    return test_pass();
+}
+
+template<typename BuildFunc>
+static float timeBuild(BuildFunc build)
+{
+    // Warm up the pages
+    build();
+    return TestHelper::timeAverage(kFrameCount, [&](uint32_t) { build(); });
+}
+
+testing_func(DrawListBenchmark, TestBuildScaling)
+{
+    std::vector<DrawItem> items = createItems();
+    ParallelDrawListBuilder builder;
+
+    std::vector<TestHelper::BenchmarkTiming> timings;
+    timings.push_back({ "Serial", timeBuild([&]() { buildDrawLists(builder, items, 1000000, false); }) });
+
+    const uint32_t chunkSizes[] = { 1, 4, 16, 64 };
+    for(uint32_t batchesPerChunk : chunkSizes)
+    {
+        float parallelTime = timeBuild([&]() { buildDrawLists(builder, items, batchesPerChunk, true); });
+        timings.push_back({ "Parallel, " + std::to_string(batchesPerChunk) + " draws per chunk", parallelTime });
+    }
+
+    TestHelper::reportBenchmark("Building draw lists for " + std::to_string(kItemCount) + " instances in draws of " + std::to_string(kInstancesPerDraw) + ", " + std::to_string(ThreadPool::getGlobalPool().getThreadCount()) + " worker threads, per frame", timings);
+    return test_pass();
+}
+
+int main()
+{
+    DrawListBenchmark dlb;
+    dlb.init(false);
+    dlb.run();
+    return 0;
+}
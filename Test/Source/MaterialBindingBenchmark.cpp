@@ -0,0 +1,230 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "MaterialBindingBenchmark.h"
+#include "TestHelper.h"
+
+static const uint32_t kMaterialCount = 10000;
+static const uint32_t kTextureCount = 8;
+static const uint32_t kFrameCount = 10;
+static const uint32_t kApplyCount = 100000;
+static const char* kPerMaterialCbName = "InternalPerMaterialCB";
+
+// The data a material uploads, stored outside of Material so that the old binding code can be replayed
+struct MaterialBlob
+{
+    MaterialDesc desc;
+    MaterialValues values;
+    Texture::SharedPtr pTexture;
+    Sampler::SharedPtr pSampler;
+};
+
+// The binding Material::setIntoProgramVars() used to do: every draw builds the variable names and searches the reflection for them
+static void bindByName(const MaterialBlob& material, ProgramVars* pVars, ConstantBuffer* pCB, const std::string& varName)
+{
+    size_t offset = pCB->getVariableOffset(varName + ".desc.layers[0].type");
+    if(offset == ConstantBuffer::kInvalidOffset)
+    {
+        return;
+    }
+    pCB->setBlob(&material.desc, offset, sizeof(MaterialDesc) + sizeof(MaterialValues));
+
+    const auto pResourceDesc = pVars->getReflection()->getResourceDesc(varName + ".textures.layers");
+    if(pResourceDesc == nullptr)
+    {
+        return;
+    }
+    pVars->setSrv(pResourceDesc->regIndex, material.pTexture->getSRV());
+    pVars->setSampler(varName + ".samplerState", material.pSampler);
+}
+
+template<typename MaterialType, typename BindFunc>
+static float timeMaterialBinding(const std::vector<MaterialType>& materials, BindFunc bind)
+{
+    return TestHelper::timeAverage(kFrameCount, [&](uint32_t)
+    {
+        for(const auto& material : materials)
+        {
+            bind(material);
+        }
+    });
+}
+
+void MaterialBindingBenchmark::addTests()
+{
+    addTestToList<TestMaterialBinding>();
+    addTestToList<TestIncrementalApply>();
+}
+
+testing_func(MaterialBindingBenchmark, TestMaterialBinding)
+{
+    GraphicsProgram::SharedPtr pProgram = GraphicsProgram::createFromFile("", "MaterialBinding.ps.hlsl");
+    ProgramReflection::SharedConstPtr pReflector = pProgram->getActiveVersion()->getReflector();
+    GraphicsVars::SharedPtr pVars = GraphicsVars::create(pReflector);
+    ConstantBuffer::SharedPtr pCB = pVars->getConstantBuffer(kPerMaterialCbName);
+    if(pCB == nullptr)
+    {
+        return test_fail("Can't find the per-material constant buffer");
+    }
+
+    const auto pTextureDesc = pReflector->getResourceDesc("gMaterial.textures.layers");
+    const auto pSamplerDesc = pReflector->getResourceDesc("gMaterial.samplerState");
+    if(pTextureDesc == nullptr || pSamplerDesc == nullptr)
+    {
+        return test_fail("Can't find the material resources in the program reflection");
+    }
+
+    // The scene shares a few textures between all of the materials
+    std::vector<Texture::SharedPtr> textures;
+    std::vector<uint32_t> texels(4 * 4, 0xFFFFFFFF);
+    for(uint32_t i = 0; i < kTextureCount; i++)
+    {
+        textures.push_back(Texture::create2D(4, 4, ResourceFormat::RGBA8Unorm, 1, 1, texels.data()));
+    }
+    Sampler::SharedPtr pSampler = Sampler::create(Sampler::Desc());
+
+    std::vector<Material::SharedPtr> materials;
+    std::vector<MaterialBlob> blobs(kMaterialCount);
+    for(uint32_t i = 0; i < kMaterialCount; i++)
+    {
+        glm::vec4 albedo(float(i % 256) / 255.0f, 0.5f, 0.5f, 1.0f);
+        Material::SharedPtr pMaterial = Material::create("Material" + std::to_string(i));
+        pMaterial->setLayerType(0, Material::Layer::Type::Lambert);
+        pMaterial->setLayerAlbedo(0, albedo);
+        pMaterial->setLayerTexture(0, textures[i % kTextureCount]);
+        pMaterial->setSampler(pSampler);
+        materials.push_back(pMaterial);
+
+        blobs[i].desc.layers[0].type = MatLambert;
+        blobs[i].values.layers[0].albedo = albedo;
+        blobs[i].pTexture = textures[i % kTextureCount];
+        blobs[i].pSampler = pSampler;
+    }
+
+    const std::string varName = "gMaterial";
+    float nameTime = timeMaterialBinding(blobs, [&](const MaterialBlob& blob) { bindByName(blob, pVars.get(), pCB.get(), varName); });
+    float layoutTime = timeMaterialBinding(materials, [&](const Material::SharedPtr& pMaterial) { pMaterial->setIntoProgramVars(pVars.get(), pCB.get(), varName.c_str()); });
+
+    // Both paths should bind the material's resources to the same registers
+    for(uint32_t i = 0; i < kTextureCount; i++)
+    {
+        materials[i]->setIntoProgramVars(pVars.get(), pCB.get(), varName.c_str());
+        if(pVars->getSrv(pTextureDesc->regIndex) != textures[i]->getSRV())
+        {
+            return test_fail("Material texture was bound to the wrong register");
+        }
+        if(pVars->getSampler(pSamplerDesc->regIndex) != pSampler)
+        {
+            return test_fail("Material sampler was bound to the wrong register");
+        }
+    }
+
+    TestHelper::reportBenchmark("Binding " + std::to_string(kMaterialCount) + " materials sharing " + std::to_string(kTextureCount) + " textures, per frame",
+        { { "Lookup by name", nameTime }, { "Cached binding layout", layoutTime } });
+    return test_pass();
+}
+
+static ProgramVars::ApplyStats countApply(GraphicsVars* pVars, RenderContext* pContext)
+{
+    ProgramVars::resetApplyStats();
+    pVars->apply(pContext);
+    return ProgramVars::getApplyStats();
+}
+
+testing_func(MaterialBindingBenchmark, TestIncrementalApply)
+{
+    GraphicsProgram::SharedPtr pProgram = GraphicsProgram::createFromFile("", "MaterialBinding.ps.hlsl");
+    ProgramReflection::SharedConstPtr pReflector = pProgram->getActiveVersion()->getReflector();
+    GraphicsVars::SharedPtr pVars = GraphicsVars::create(pReflector);
+    GraphicsVars::SharedPtr pOtherVars = GraphicsVars::create(pReflector);
+    RenderContext* pContext = gpDevice->getRenderContext().get();
+
+    const auto pTextureDesc = pReflector->getResourceDesc("gMaterial.textures.layers");
+    if(pTextureDesc == nullptr)
+    {
+        return test_fail("Can't find the material texture in the program reflection");
+    }
+
+    std::vector<uint32_t> texels(4 * 4, 0xFFFFFFFF);
+    Texture::SharedPtr pTextures[2];
+    for(auto& pTexture : pTextures)
+    {
+        pTexture = Texture::create2D(4, 4, ResourceFormat::RGBA8Unorm, 1, 1, texels.data());
+    }
+    pVars->setSrv(pTextureDesc->regIndex, pTextures[0]->getSRV());
+
+    // The first apply sets everything, applying the same vars again shouldn't set anything
+    ProgramVars::ApplyStats stats = countApply(pVars.get(), pContext);
+    if(stats.fullApplyCount != 1 || stats.bindingsEmitted == 0 || stats.bindingsSkipped != 0)
+    {
+        return test_fail("The first apply() should set all the root parameters");
+    }
+    uint64_t rootParamCount = stats.bindingsEmitted;
+
+    stats = countApply(pVars.get(), pContext);
+    if(stats.fullApplyCount != 0 || stats.bindingsEmitted != 0 || stats.bindingsSkipped != rootParamCount)
+    {
+        return test_fail("apply() set root parameters which didn't change");
+    }
+
+    // Only the texture's descriptor table should be set again
+    pVars->setSrv(pTextureDesc->regIndex, pTextures[1]->getSRV());
+    stats = countApply(pVars.get(), pContext);
+    if(stats.fullApplyCount != 0 || stats.bindingsEmitted != 1)
+    {
+        return test_fail("apply() didn't set only the changed texture");
+    }
+
+    // Other vars overwrite the root parameters
+    countApply(pOtherVars.get(), pContext);
+    stats = countApply(pVars.get(), pContext);
+    if(stats.fullApplyCount != 1 || stats.bindingsEmitted != rootParamCount)
+    {
+        return test_fail("apply() didn't set all the root parameters after other vars were applied");
+    }
+
+    // Changing the bindings allocates descriptors, so the timing only compares re-applying the same vars
+    float fullTime = TestHelper::timeAverage(kApplyCount, [&](uint32_t)
+    {
+        pContext->invalidateBoundVars();
+        pVars->apply(pContext);
+    });
+    float incrementalTime = TestHelper::timeAverage(kApplyCount, [&](uint32_t) { pVars->apply(pContext); });
+    pContext->flush(true);
+
+    TestHelper::reportBenchmark("Applying vars with " + std::to_string(rootParamCount) + " root parameters, per apply",
+        { { "Full apply", fullTime }, { "Incremental apply", incrementalTime } });
+    return test_pass();
+}
+
+int main()
+{
+    MaterialBindingBenchmark mbb;
+    mbb.init(true);
+    mbb.run();
+    return 0;
+}
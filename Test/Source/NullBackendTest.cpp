@@ -0,0 +1,152 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "NullBackendTest.h"
+
+static const uint32_t kTextureSize = 16;
+
+void NullBackendTest::addTests()
+{
+    addTestToList<TestCopyCounters>();
+    addTestToList<TestDrawCounters>();
+}
+
+static const NullApiCounters& getCounters()
+{
+    return gpDevice->getApiHandle()->counters;
+}
+
+static std::vector<uint32_t> createTexels()
+{
+    std::vector<uint32_t> texels(kTextureSize * kTextureSize);
+    for (uint32_t i = 0; i < texels.size(); i++)
+    {
+        texels[i] = i * 2654435761u;
+    }
+    return texels;
+}
+
+testing_func(NullBackendTest, TestCopyCounters)
+{
+    std::vector<uint32_t> texels = createTexels();
+    Texture::SharedPtr pSrc = Texture::create2D(kTextureSize, kTextureSize, ResourceFormat::RGBA8Unorm, 1, 1, texels.data());
+    Texture::SharedPtr pDst = Texture::create2D(kTextureSize, kTextureSize, ResourceFormat::RGBA8Unorm, 1, 1);
+
+    RenderContext* pContext = gpDevice->getRenderContext().get();
+    pContext->flush(true);
+    const NullApiCounters start = getCounters();
+
+    pContext->copyResource(pDst.get(), pSrc.get());
+    std::vector<uint8_t> result = pContext->readTextureSubresource(pDst.get(), 0);
+    const NullApiCounters end = getCounters();
+
+    // The null backend executes copies on the CPU, so the data must make the round trip
+    const size_t textureBytes = texels.size() * sizeof(uint32_t);
+    if (result.size() != textureBytes || memcmp(result.data(), texels.data(), textureBytes) != 0)
+    {
+        return test_fail("The texture read back doesn't match the data it was copied from");
+    }
+
+    if (end.getCount(NullCommand::CopyResource) - start.getCount(NullCommand::CopyResource) != 1)
+    {
+        return test_fail("copyResource() should record one CopyResource command");
+    }
+
+    if (end.getCount(NullCommand::CopyTextureRegion) - start.getCount(NullCommand::CopyTextureRegion) != 1)
+    {
+        return test_fail("readTextureSubresource() should record one CopyTextureRegion command");
+    }
+
+    if (end.bytesCopied - start.bytesCopied != 2 * textureBytes)
+    {
+        return test_fail("bytesCopied should count the copy and the read-back");
+    }
+
+    if (end.commandListsSubmitted == start.commandListsSubmitted)
+    {
+        return test_fail("readTextureSubresource() should submit the command list");
+    }
+
+    if (end.getDrawCount() != start.getDrawCount() || end.getDispatchCount() != start.getDispatchCount())
+    {
+        return test_fail("Copies shouldn't record draws or dispatches");
+    }
+
+    return test_pass();
+}
+
+testing_func(NullBackendTest, TestDrawCounters)
+{
+    std::vector<uint32_t> texels = createTexels();
+    Texture::SharedPtr pSrc = Texture::create2D(kTextureSize, kTextureSize, ResourceFormat::RGBA8Unorm, 1, 1, texels.data(), Resource::BindFlags::ShaderResource);
+    Texture::SharedPtr pDst = Texture::create2D(kTextureSize, kTextureSize, ResourceFormat::RGBA8Unorm, 1, 1, nullptr, Resource::BindFlags::RenderTarget);
+
+    RenderContext* pContext = gpDevice->getRenderContext().get();
+
+    // The first blit creates the blit pass, which uploads its own buffers
+    pContext->blit(pSrc->getSRV(), pDst->getRTV());
+    pContext->flush(true);
+    const NullApiCounters start = getCounters();
+
+    const uint32_t blitCount = 3;
+    for (uint32_t i = 0; i < blitCount; i++)
+    {
+        pContext->blit(pSrc->getSRV(), pDst->getRTV());
+    }
+    pContext->flush(true);
+    const NullApiCounters end = getCounters();
+
+    if (end.getCount(NullCommand::Draw) - start.getCount(NullCommand::Draw) != blitCount)
+    {
+        return test_fail("Every blit() should record one draw");
+    }
+
+    if (end.getCount(NullCommand::SetPipelineState) - start.getCount(NullCommand::SetPipelineState) != blitCount)
+    {
+        return test_fail("Every draw should set the pipeline state");
+    }
+
+    if (end.commandListsSubmitted - start.commandListsSubmitted != 1)
+    {
+        return test_fail("flush() should submit the recorded draws as one command list");
+    }
+
+    if (end.getDispatchCount() != start.getDispatchCount())
+    {
+        return test_fail("blit() shouldn't record dispatches");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    NullBackendTest nbt;
+    nbt.init(true);
+    nbt.run();
+    return 0;
+}
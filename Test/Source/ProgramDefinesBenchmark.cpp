@@ -0,0 +1,175 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ProgramDefinesBenchmark.h"
+#include "TestHelper.h"
+
+// Exposes the version table, so that the benchmark can register versions without compiling shaders
+class DrawSequenceProgram : public Program
+{
+public:
+    using SharedPtr = std::shared_ptr<DrawSequenceProgram>;
+    static SharedPtr create() { return SharedPtr(new DrawSequenceProgram()); }
+
+    void addVersionForActiveDefines()
+    {
+        mProgramVersions.emplace(mDefineIds, nullptr);
+        mLinkRequired = true;
+    }
+    size_t getVersionCount() const { return mProgramVersions.size(); }
+};
+
+// The version lookup Program used to do: an ordered map keyed by the whole define list
+class MapKeyedProgram
+{
+public:
+    void addDefine(const std::string& name, const std::string& value = "")
+    {
+        if(mDefineList.find(name) != mDefineList.end())
+        {
+            if(mDefineList[name] == value)
+            {
+                return;
+            }
+        }
+        mLinkRequired = true;
+        mDefineList[name] = value;
+    }
+
+    void removeDefine(const std::string& name)
+    {
+        if(mDefineList.find(name) != mDefineList.end())
+        {
+            mLinkRequired = true;
+            mDefineList.erase(name);
+        }
+    }
+
+    ProgramVersion::SharedConstPtr getActiveVersion()
+    {
+        if(mLinkRequired)
+        {
+            const auto& it = mProgramVersions.find(mDefineList);
+            mpActiveProgram = (it == mProgramVersions.end()) ? nullptr : it->second;
+        }
+        return mpActiveProgram;
+    }
+
+    void addVersionForActiveDefines() { mProgramVersions[mDefineList] = nullptr; }
+    size_t getVersionCount() const { return mProgramVersions.size(); }
+
+private:
+    Program::DefineList mDefineList;
+    bool mLinkRequired = true;
+    std::map<const Program::DefineList, ProgramVersion::SharedConstPtr> mProgramVersions;
+    ProgramVersion::SharedConstPtr mpActiveProgram;
+};
+
+static const uint32_t kModelCount = 200;
+static const uint32_t kMeshesPerModel = 8;
+static const uint32_t kMaterialCount = 16;
+static const uint32_t kFrameCount = 100;
+
+// Replays the define changes SceneRenderer makes when rendering a scene with material compilation enabled.
+// Every model with bones is wrapped in _VERTEX_BLENDING, and every draw with a new material sets _MS_STATIC_MATERIAL_DESC.
+template<typename ProgramType, typename DrawFunc>
+static void replayScene(ProgramType& program, const std::vector<std::string>& materialDescs, DrawFunc draw)
+{
+    for(uint32_t model = 0; model < kModelCount; model++)
+    {
+        const bool hasBones = (model % 4) == 0;
+        if(hasBones)
+        {
+            program.addDefine("_VERTEX_BLENDING");
+        }
+
+        for(uint32_t mesh = 0; mesh < kMeshesPerModel; mesh++)
+        {
+            const std::string& desc = materialDescs[(model * kMeshesPerModel + mesh) % kMaterialCount];
+            program.addDefine("_MS_STATIC_MATERIAL_DESC", desc);
+            draw(program);
+            program.removeDefine("_MS_STATIC_MATERIAL_DESC");
+        }
+
+        if(hasBones)
+        {
+            program.removeDefine("_VERTEX_BLENDING");
+        }
+    }
+}
+
+template<typename ProgramType>
+static float timeDrawSequence(ProgramType& program, const std::vector<std::string>& materialDescs)
+{
+    // Register a version for every define list the sequence uses
+    replayScene(program, materialDescs, [](ProgramType& p) { p.addVersionForActiveDefines(); });
+
+    return TestHelper::timeAverage(kFrameCount, [&](uint32_t) { replayScene(program, materialDescs, [](ProgramType& p) { p.getActiveVersion(); }); });
+}
+
+void ProgramDefinesBenchmark::addTests()
+{
+    addTestToList<TestDrawSequence>();
+}
+
+testing_func(ProgramDefinesBenchmark, TestDrawSequence)
+{
+    std::vector<std::string> materialDescs;
+    for(uint32_t i = 0; i < kMaterialCount; i++)
+    {
+        std::string desc = "{" + std::to_string(i);
+        for(uint32_t layer = 0; layer < 3; layer++)
+        {
+            desc += ",{MatLambert,MatNone,MatAlbedo,MatTexture," + std::to_string(i * 3 + layer) + "}";
+        }
+        materialDescs.push_back(desc + "}");
+    }
+
+    MapKeyedProgram mapProgram;
+    float mapTime = timeDrawSequence(mapProgram, materialDescs);
+
+    DrawSequenceProgram::SharedPtr pProgram = DrawSequenceProgram::create();
+    float idTime = timeDrawSequence(*pProgram, materialDescs);
+
+    if(mapProgram.getVersionCount() != pProgram->getVersionCount())
+    {
+        return test_fail("Define ID lists don't identify the same versions as the define lists");
+    }
+
+    const uint32_t drawCount = kModelCount * kMeshesPerModel;
+    TestHelper::reportBenchmark("Draw sequence with " + std::to_string(drawCount) + " draws, " + std::to_string(pProgram->getVersionCount()) + " program versions, per frame",
+        { { "Define list map lookup", mapTime }, { "Define ID lookup", idTime } });
+    return test_pass();
+}
+
+int main()
+{
+    ProgramDefinesBenchmark pdb;
+    pdb.init(false);
+    pdb.run();
+    return 0;
+}
@@ -30,6 +30,7 @@
 void SamplerTest::addTests()
 {
     addTestToList<TestCreate>();
+    addTestToList<TestSharedObjects>();
 }
 
 testing_func(SamplerTest, TestCreate)
@@ -101,6 +102,55 @@ testing_func(SamplerTest, TestCreate)
     return test_pass();
 }
 
+testing_func(SamplerTest, TestSharedObjects)
+{
+    TestDesc desc;
+    desc.setFilterMode(Sampler::Filter::Linear, Sampler::Filter::Linear, Sampler::Filter::Point).setAddressingMode(Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp, Sampler::AddressMode::Clamp);
+    // An unusual LOD bias, so that no other part of the framework holds an equal sampler
+    desc.setLodParams(0, 1000, 0.375f);
+
+    ObjectCacheStats start = Sampler::getCacheStats();
+    TestDesc firstDesc = desc;
+    Sampler::SharedPtr pSampler = Sampler::create(desc);
+    if(Sampler::create(desc) != pSampler)
+    {
+        return test_fail("Equal descs should return the same sampler");
+    }
+
+    desc.setBorderColor(glm::vec4(1, 0, 0, 1));
+    Sampler::SharedPtr pOther = Sampler::create(desc);
+    if(pOther == pSampler || doStatesMatch(pOther, desc) == false)
+    {
+        return test_fail("A different desc should create a new sampler");
+    }
+
+    // Equal root signature descs share the signature as well
+    RootSignature::Desc rootDesc;
+    rootDesc.addSampler(0, pSampler, ShaderVisibility::All).addDescriptor(0, RootSignature::DescType::CBV, ShaderVisibility::All);
+    RootSignature::SharedPtr pRootSig = RootSignature::create(rootDesc);
+    if(RootSignature::create(rootDesc) != pRootSig)
+    {
+        return test_fail("Equal descs should return the same root signature");
+    }
+
+    ObjectCacheStats end = Sampler::getCacheStats();
+    if(end.requested - start.requested != 3 || end.created - start.created != 2)
+    {
+        return test_fail("Sampler cache stats don't match the number of requested samplers");
+    }
+
+    // The cache only holds weak references, so a released sampler is created again
+    pRootSig = nullptr;
+    rootDesc = RootSignature::Desc();
+    pSampler = nullptr;
+    pSampler = Sampler::create(firstDesc);
+    if(Sampler::getCacheStats().created - end.created != 1 || doStatesMatch(pSampler, firstDesc) == false)
+    {
+        return test_fail("Released samplers should be recreated");
+    }
+    return test_pass();
+}
+
 bool SamplerTest::doStatesMatch(Sampler::SharedPtr sampler, TestDesc desc)
 {
     return sampler->getMagFilter() == desc.mMagFilter &&
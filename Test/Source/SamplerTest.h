@@ -39,6 +39,7 @@ private:
     void addTests() override;
     void onInit() override {};
     register_testing_func(TestCreate);
+    register_testing_func(TestSharedObjects);
 
     static bool doStatesMatch(Sampler::SharedPtr sampler, TestDesc desc);
 };
@@ -0,0 +1,226 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "SceneUpdateBenchmark.h"
+#include "TestHelper.h"
+#include "Graphics/Scene/Scene.h"
+#include "glm/gtx/transform.hpp"
+#include <random>
+
+static const uint32_t kModelCount = 64;
+static const uint32_t kInstancesPerModel = 32;
+static const uint32_t kObjectsPerPath = 4;
+static const uint32_t kBoneCount = 48;
+static const uint32_t kKeyCount = 20;
+static const uint32_t kFrameCount = 60;
+static const float kDuration = 100;
+static const float kTicksPerSecond = 25;
+
+static AnimationController::UniquePtr createAnimationController(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-1, 1);
+    std::vector<Bone> bones(kBoneCount);
+    std::vector<Animation::AnimationSet> sets(kBoneCount);
+    for(uint32_t i = 0; i < kBoneCount; i++)
+    {
+        bones[i].boneID = i;
+        bones[i].parentID = (i == 0) ? AnimationController::kInvalidBoneID : (i - 1) / 2;
+        bones[i].name = "Bone" + std::to_string(i);
+
+        sets[i].boneID = i;
+        for(uint32_t k = 0; k < kKeyCount; k++)
+        {
+            float time = kDuration * float(k) / float(kKeyCount);
+            sets[i].translation.keys.push_back({ glm::vec3(dist(rng), 1 + dist(rng), dist(rng)), time });
+            sets[i].scaling.keys.push_back({ glm::vec3(1), time });
+            sets[i].rotation.keys.push_back({ glm::normalize(glm::quat(dist(rng), dist(rng), dist(rng), dist(rng))), time });
+        }
+    }
+
+    AnimationController::UniquePtr pController = AnimationController::create(bones);
+    pController->addAnimation(Animation::create("Animation", sets, kDuration, kTicksPerSecond));
+    pController->setActiveAnimation(0);
+    return pController;
+}
+
+/** Creates the same scene for the same seed. Every path moves kObjectsPerPath instances.
+    If shareObjects is true, some of the instances are attached to two paths.
+*/
+static Scene::SharedPtr createScene(uint32_t seed, bool shareObjects)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-100, 100);
+    Scene::SharedPtr pScene = Scene::create();
+
+    std::vector<IMovableObject::SharedPtr> objects;
+    for(uint32_t m = 0; m < kModelCount; m++)
+    {
+        Model::SharedPtr pModel = Model::create();
+        pModel->setAnimationController(createAnimationController(rng));
+        for(uint32_t i = 0; i < kInstancesPerModel; i++)
+        {
+            glm::vec3 translation(dist(rng), dist(rng), dist(rng));
+            glm::vec3 scaling(1 + 0.01f * std::abs(dist(rng)));
+            pScene->addModelInstance(pModel, "Instance" + std::to_string(i), translation, glm::vec3(), scaling);
+            objects.push_back(pScene->getModelInstance(m, i));
+        }
+    }
+
+    for(uint32_t first = 0; first < objects.size(); first += kObjectsPerPath)
+    {
+        ObjectPath::SharedPtr pPath = ObjectPath::create();
+        pPath->setInterpolationMode((first / kObjectsPerPath) % 2 ? ObjectPath::Interpolation::CubicSpline : ObjectPath::Interpolation::Linear);
+        for(uint32_t k = 0; k < 8; k++)
+        {
+            glm::vec3 position(dist(rng), dist(rng), dist(rng));
+            pPath->addKeyFrame(float(k), position, position + glm::vec3(0, 0, 1), glm::vec3(0, 1, 0));
+        }
+        pPath->setAnimationRepeat(true);
+
+        for(uint32_t i = first; i < first + kObjectsPerPath; i++)
+        {
+            pPath->attachObject(objects[i]);
+        }
+        if(shareObjects)
+        {
+            pPath->attachObject(objects[(first + objects.size() / 2) % objects.size()]);
+        }
+        pScene->addPath(pPath);
+    }
+    return pScene;
+}
+
+static bool isEqual(const glm::mat4& a, const glm::mat4& b)
+{
+    return memcmp(&a, &b, sizeof(glm::mat4)) == 0;
+}
+
+/** Check that two scenes created with the same seed are in exactly the same state
+*/
+static bool compareScenes(Scene* pA, Scene* pB, std::string& error)
+{
+    for(uint32_t m = 0; m < pA->getModelCount(); m++)
+    {
+        const Model* pModelA = pA->getModel(m).get();
+        const Model* pModelB = pB->getModel(m).get();
+        for(uint32_t b = 0; b < pModelA->getBonesCount(); b++)
+        {
+            if(isEqual(pModelA->getBonesMatrices()[b], pModelB->getBonesMatrices()[b]) == false)
+            {
+                error = "Bone matrices don't match";
+                return false;
+            }
+        }
+
+        for(uint32_t i = 0; i < pA->getModelInstanceCount(m); i++)
+        {
+            if(isEqual(pA->getModelInstance(m, i)->getTransformMatrix(), pB->getModelInstance(m, i)->getTransformMatrix()) == false)
+            {
+                error = "Instance transforms don't match";
+                return false;
+            }
+        }
+    }
+
+    if(pA->getCenter() != pB->getCenter() || pA->getRadius() != pB->getRadius())
+    {
+        error = "Scene extents don't match";
+        return false;
+    }
+    return true;
+}
+
+static bool compareUpdates(bool shareObjects, std::string& error)
+{
+    Scene::SharedPtr pSerial = createScene(1234, shareObjects);
+    Scene::SharedPtr pParallel = createScene(1234, shareObjects);
+    pSerial->setParallelUpdate(false);
+
+    const double checkTimes[] = { 0.0, 0.37, 1.5, 3.99, 4.01, 10.2, 0.5 };
+    for(double time : checkTimes)
+    {
+        if(pSerial->update(time) != pParallel->update(time))
+        {
+            error = "Update results don't match";
+            return false;
+        }
+        if(compareScenes(pSerial.get(), pParallel.get(), error) == false)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static float timeUpdate(Scene* pScene)
+{
+    return TestHelper::timeAverage(kFrameCount, [pScene](uint32_t frame) { pScene->update(double(frame) / 60.0); });
+}
+
+void SceneUpdateBenchmark::addTests()
+{
+    addTestToList<TestSceneUpdate>();
+    addTestToList<TestSharedPathObjects>();
+}
+
+testing_func(SceneUpdateBenchmark, TestSceneUpdate)
+{
+    std::string error;
+    if(compareUpdates(false, error) == false)
+    {
+        return test_fail(error);
+    }
+
+    Scene::SharedPtr pScene = createScene(5678, false);
+    pScene->setParallelUpdate(false);
+    float serialTime = timeUpdate(pScene.get());
+    pScene->setParallelUpdate(true);
+    float parallelTime = timeUpdate(pScene.get());
+
+    TestHelper::reportBenchmark("Updating " + std::to_string(kModelCount) + " animated models, " + std::to_string(kModelCount * kInstancesPerModel) + " instances and " + std::to_string(pScene->getPathCount()) + " paths, per frame",
+        { { "Serial", serialTime }, { "Parallel", parallelTime } });
+    return test_pass();
+}
+
+testing_func(SceneUpdateBenchmark, TestSharedPathObjects)
+{
+    // Objects attached to several paths force the paths to be animated in order
+    std::string error;
+    if(compareUpdates(true, error) == false)
+    {
+        return test_fail(error);
+    }
+    return test_pass();
+}
+
+int main()
+{
+    SceneUpdateBenchmark sb;
+    sb.init(false);
+    sb.run();
+    return 0;
+}
@@ -0,0 +1,99 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "SpireSessionBenchmark.h"
+#include "TestHelper.h"
+#include "Utils/OS.h"
+
+static const uint32_t kIterations = 10;
+
+void SpireSessionBenchmark::addTests()
+{
+    addTestToList<TestColdSession>();
+    addTestToList<TestCachedSession>();
+}
+
+float SpireSessionBenchmark::timeSessionCreation(const char* cacheDir, uint32_t iterations)
+{
+    // Only the creation is timed, the sessions are destroyed afterwards
+    std::vector<SpireSession*> sessions(iterations, nullptr);
+    float ms = TestHelper::timeAverage(iterations, [&](uint32_t i) { sessions[i] = spCreateSession(cacheDir); });
+
+    bool failed = false;
+    for (SpireSession* pSession : sessions)
+    {
+        if (pSession == nullptr)
+        {
+            failed = true;
+            continue;
+        }
+        spDestroySession(pSession);
+    }
+    return failed ? -1 : ms;
+}
+
+testing_func(SpireSessionBenchmark, TestColdSession)
+{
+    float ms = timeSessionCreation(nullptr, kIterations);
+    if (ms < 0)
+    {
+        return test_fail("Failed to create a Spire session");
+    }
+    TestHelper::reportBenchmark("Spire session creation", { { "Without a cache", ms } });
+    return test_pass();
+}
+
+testing_func(SpireSessionBenchmark, TestCachedSession)
+{
+    std::string cacheDir = getExecutableDirectory() + "\\SpireSessionBenchmarkCache";
+    if (isDirectoryExists(cacheDir) == false && createDirectory(cacheDir) == false)
+    {
+        return test_fail("Can't create the cache directory");
+    }
+
+    // The first session populates the cache
+    if (timeSessionCreation(cacheDir.c_str(), 1) < 0)
+    {
+        return test_fail("Failed to create a Spire session");
+    }
+
+    float ms = timeSessionCreation(cacheDir.c_str(), kIterations);
+    if (ms < 0)
+    {
+        return test_fail("Failed to create a Spire session");
+    }
+    TestHelper::reportBenchmark("Spire session creation", { { "With a warm cache", ms } });
+    return test_pass();
+}
+
+int main()
+{
+    SpireSessionBenchmark sb;
+    sb.init(false);
+    sb.run();
+    return 0;
+}
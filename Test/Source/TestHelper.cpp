@@ -27,6 +27,8 @@
 ***************************************************************************/
 #include "TestHelper.h"
 #include "API/VertexLayout.h"
+#include "ArgList.h"
+#include <iostream>
 
 namespace Falcor
 {
@@ -79,6 +81,36 @@ namespace Falcor
             return vec4(randFloatZeroToOne(), randFloatZeroToOne(), randFloatZeroToOne(), randFloatZeroToOne());
         }
 
+        bool isBenchmarkOutputEnabled()
+        {
+            static const bool sEnabled = []()
+            {
+                ArgList args;
+                args.parseCommandLine(GetCommandLineA());
+                return args.argExists("benchmark");
+            }();
+            return sEnabled;
+        }
+
+        void reportBenchmark(const std::string& description, const std::vector<BenchmarkTiming>& timings)
+        {
+            if(isBenchmarkOutputEnabled() == false)
+            {
+                return;
+            }
+
+            std::cout << description << std::endl;
+            for(size_t i = 0; i < timings.size(); i++)
+            {
+                std::cout << "  " << timings[i].name << ": " << timings[i].ms << " ms";
+                if(i > 0 && timings[i].ms > 0)
+                {
+                    std::cout << " (" << timings[0].ms / timings[i].ms << "x)";
+                }
+                std::cout << std::endl;
+            }
+        }
+
         bool nearCompare(const float lhs, const float rhs)
         {
             const float ep = 0.0001f;
@@ -38,5 +38,34 @@ namespace Falcor
         vec4 randVec4ZeroToOne();
         bool nearCompare(const float lhs, const float rhs);
         bool nearVec4(const vec4& lhs, const vec4& rhs);
+
+        /** Call func(i) for every i in [0, iterationCount) and return the average duration of a call in milliseconds
+        */
+        template<typename Func>
+        float timeAverage(uint32_t iterationCount, Func func)
+        {
+            CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+            for(uint32_t i = 0; i < iterationCount; i++)
+            {
+                func(i);
+            }
+            return CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / float(iterationCount);
+        }
+
+        /** A timing reported by a benchmark
+        */
+        struct BenchmarkTiming
+        {
+            std::string name;
+            float ms;
+        };
+
+        /** Check if benchmark timings should be printed. Benchmarks only print them when the test is run with '-benchmark', so that by default their output is only pass/fail.
+        */
+        bool isBenchmarkOutputEnabled();
+
+        /** Print a benchmark's timings if isBenchmarkOutputEnabled() returns true. Every timing after the first one also shows its speedup relative to the first one, which is expected to be the baseline.
+        */
+        void reportBenchmark(const std::string& description, const std::vector<BenchmarkTiming>& timings);
     }
 }
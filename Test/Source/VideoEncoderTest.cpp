@@ -0,0 +1,260 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "VideoEncoderTest.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+static const uint32_t kWidth = 16;
+static const uint32_t kHeight = 8;
+static const uint32_t kQueueSize = 2;
+static const uint32_t kFrameCount = 32;
+
+void VideoEncoderTest::addTests()
+{
+    addTestToList<TestFrameOrder>();
+    addTestToList<TestBlockingQueue>();
+    addTestToList<TestDroppingQueue>();
+}
+
+/** Every frame is a different solid color, so the encoded frames can be found in the file without decoding it
+*/
+static glm::uvec3 getFrameColor(uint32_t frame)
+{
+    return glm::uvec3(3 + frame * 7, 250 - frame * 5, 40 + frame * 3);
+}
+
+static std::vector<uint8_t> createFrame(uint32_t frame)
+{
+    glm::uvec3 color = getFrameColor(frame);
+    std::vector<uint8_t> data(kWidth * kHeight * 4);
+    for (size_t i = 0; i < data.size(); i += 4)
+    {
+        data[i + 0] = (uint8_t)color.r;
+        data[i + 1] = (uint8_t)color.g;
+        data[i + 2] = (uint8_t)color.b;
+        data[i + 3] = 255;
+    }
+    return data;
+}
+
+/** Get a frame the way the raw video codec stores it, as BGR24 without row padding
+*/
+static std::vector<uint8_t> getEncodedFrame(uint32_t frame)
+{
+    glm::uvec3 color = getFrameColor(frame);
+    std::vector<uint8_t> data(kWidth * kHeight * 3);
+    for (size_t i = 0; i < data.size(); i += 3)
+    {
+        data[i + 0] = (uint8_t)color.b;
+        data[i + 1] = (uint8_t)color.g;
+        data[i + 2] = (uint8_t)color.r;
+    }
+    return data;
+}
+
+static VideoEncoder::UniquePtr createEncoder(VideoEncoder::QueuePolicy policy, std::string& filename)
+{
+    if (findAvailableFilename("VideoEncoderTest", getExecutableDirectory(), "avi", filename) == false)
+    {
+        return nullptr;
+    }
+
+    VideoEncoder::Desc desc;
+    desc.width = kWidth;
+    desc.height = kHeight;
+    desc.codec = VideoEncoder::CodecID::RawVideo;
+    desc.filename = filename;
+    desc.asyncEncoding = true;
+    desc.queueSize = kQueueSize;
+    desc.queuePolicy = policy;
+    return VideoEncoder::create(desc);
+}
+
+/** Frames which were appended but neither encoded nor dropped yet. Each of them holds one of the queue's buffers.
+*/
+static uint64_t getFramesInFlight(const VideoEncoder::Stats& stats)
+{
+    return stats.framesSubmitted - stats.framesEncoded - stats.framesDropped;
+}
+
+/** Append all of the frames. Returns false if appendFrame() returned while more frames were in flight than there are buffers.
+*/
+static bool appendFrames(VideoEncoder* pEncoder)
+{
+    for (uint32_t i = 0; i < kFrameCount; i++)
+    {
+        std::vector<uint8_t> frame = createFrame(i);
+        pEncoder->appendFrame(frame.data());
+
+        // The frame was copied into the queue, so its memory can be reused right away
+        std::fill(frame.begin(), frame.end(), 0);
+        if (getFramesInFlight(pEncoder->getStats()) > kQueueSize)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Find the frames in the video file and return them in the order they were stored
+*/
+static std::vector<uint32_t> findEncodedFrames(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::remove(filename.c_str());
+
+    std::vector<std::pair<size_t, uint32_t>> offsets;
+    for (uint32_t i = 0; i < kFrameCount; i++)
+    {
+        std::vector<uint8_t> frame = getEncodedFrame(i);
+        auto it = std::search(data.begin(), data.end(), frame.begin(), frame.end());
+        if (it != data.end())
+        {
+            offsets.push_back({ (size_t)(it - data.begin()), i });
+        }
+    }
+    std::sort(offsets.begin(), offsets.end());
+
+    std::vector<uint32_t> frames;
+    for (const auto& o : offsets)
+    {
+        frames.push_back(o.second);
+    }
+    return frames;
+}
+
+testing_func(VideoEncoderTest, TestFrameOrder)
+{
+    std::string filename;
+    VideoEncoder::UniquePtr pEncoder = createEncoder(VideoEncoder::QueuePolicy::Block, filename);
+    if (pEncoder == nullptr)
+    {
+        return test_fail("Can't create the video encoder");
+    }
+
+    appendFrames(pEncoder.get());
+    pEncoder->endCapture();
+
+    std::vector<uint32_t> frames = findEncodedFrames(filename);
+    if (frames.size() != kFrameCount)
+    {
+        return test_fail("The video contains " + std::to_string(frames.size()) + " of the " + std::to_string(kFrameCount) + " frames");
+    }
+    for (uint32_t i = 0; i < kFrameCount; i++)
+    {
+        if (frames[i] != i)
+        {
+            return test_fail("Frame " + std::to_string(frames[i]) + " was encoded at position " + std::to_string(i));
+        }
+    }
+    return test_pass();
+}
+
+testing_func(VideoEncoderTest, TestBlockingQueue)
+{
+    std::string filename;
+    VideoEncoder::UniquePtr pEncoder = createEncoder(VideoEncoder::QueuePolicy::Block, filename);
+    if (pEncoder == nullptr)
+    {
+        return test_fail("Can't create the video encoder");
+    }
+
+    bool bounded = appendFrames(pEncoder.get());
+    pEncoder->endCapture();
+    std::remove(filename.c_str());
+
+    // appendFrame() must wait for a free buffer instead of growing the queue or dropping the frame
+    if (bounded == false)
+    {
+        return test_fail("appendFrame() returned while every buffer was in use");
+    }
+
+    VideoEncoder::Stats stats = pEncoder->getStats();
+    if (stats.maxQueueDepth > kQueueSize)
+    {
+        return test_fail("The queue grew beyond its size");
+    }
+    if (stats.framesDropped != 0)
+    {
+        return test_fail("QueuePolicy::Block dropped frames");
+    }
+
+    // endCapture() must encode every frame which was still queued
+    if (stats.framesSubmitted != kFrameCount || stats.framesEncoded != kFrameCount || stats.queueDepth != 0)
+    {
+        return test_fail("endCapture() didn't encode all of the queued frames");
+    }
+    return test_pass();
+}
+
+testing_func(VideoEncoderTest, TestDroppingQueue)
+{
+    std::string filename;
+    VideoEncoder::UniquePtr pEncoder = createEncoder(VideoEncoder::QueuePolicy::DropFrame, filename);
+    if (pEncoder == nullptr)
+    {
+        return test_fail("Can't create the video encoder");
+    }
+
+    bool bounded = appendFrames(pEncoder.get());
+    pEncoder->endCapture();
+
+    if (bounded == false)
+    {
+        return test_fail("appendFrame() queued a frame while every buffer was in use");
+    }
+
+    VideoEncoder::Stats stats = pEncoder->getStats();
+    if (stats.framesSubmitted != kFrameCount || stats.framesEncoded + stats.framesDropped != kFrameCount || stats.queueDepth != 0)
+    {
+        return test_fail("Every frame must be either encoded or dropped once the capture ended");
+    }
+
+    // The frames which weren't dropped must still be in order
+    std::vector<uint32_t> frames = findEncodedFrames(filename);
+    if (frames.size() != stats.framesEncoded)
+    {
+        return test_fail("The video contains " + std::to_string(frames.size()) + " frames, but " + std::to_string(stats.framesEncoded) + " were encoded");
+    }
+    if (std::is_sorted(frames.begin(), frames.end()) == false)
+    {
+        return test_fail("The frames were encoded out of order");
+    }
+    return test_pass();
+}
+
+int main()
+{
+    VideoEncoderTest vt;
+    vt.init(false);
+    vt.run();
+    return 0;
+}